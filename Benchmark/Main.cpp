@@ -0,0 +1,536 @@
+#include "Defines.hpp"
+
+#include "Math\Math.hpp"
+#include "Math\Physics.hpp"
+#include "Math\Broadphase.hpp"
+#include "Core\Logger.hpp"
+#include "Core\Time.hpp"
+#include "Containers\Vector.hpp"
+#include "Platform\CpuFeatures.hpp"
+#include "Platform\Jobs.hpp"
+
+#include <string.h>
+
+/*
+* Headless physics benchmark, nothing outside of Memory, Jobs and Physics is initialized so it needs no window or GPU
+* Every scene starts from a snapshot of the empty world and reports the average time per stage from Physics::Profile
+* Pass a scene name to run only that scene, e.g. "Benchmark Smash", "Benchmark StaticTree" runs only the tree builders
+*/
+
+static constexpr F32 TimeStep = 1.0f / 60.0f;
+static constexpr I32 SubSteps = 4;
+
+static U32 randomSeed = 12345;
+
+static F32 RandomF32()
+{
+	randomSeed = randomSeed * 1664525 + 1013904223;
+	return (F32)(randomSeed >> 8) / 16777216.0f;
+}
+
+struct PhysicsBenchmark
+{
+	static bool Initialize() { return Physics::Initialize(1.0f / TimeStep, SubSteps); }
+	static void Shutdown() { Physics::Shutdown(); }
+
+	static void Snapshot(Vector<U8>& snapshot) { Physics::Snapshot(snapshot); }
+	static bool Restore(const Vector<U8>& snapshot) { randomSeed = 12345; return Physics::Restore(snapshot); }
+
+	static void Step() { Physics::Step(TimeStep, SubSteps); }
+
+	static RigidBody2D& CreateBody(const RigidBody2DDef& def) { return Physics::rigidBodies.Emplace(def); }
+	static void Reserve(U64 count) { Physics::rigidBodies.Reserve(Physics::rigidBodies.Size() + count); }
+	static U64 BodyCount() { return Physics::rigidBodies.Size(); }
+};
+
+// A dynamic box, circle or capsule, picked by index so every run builds the same scene
+static void CreateMixedShape(const Vector2& position, I32 index, F32 size, bool enableSleep = true)
+{
+	ShapeDef shapeDef{};
+
+	RigidBody2DDef bodyDef{};
+	bodyDef.type = BODY_TYPE_DYNAMIC;
+	bodyDef.position = position;
+	bodyDef.enableSleep = enableSleep;
+
+	RigidBody2D& body = PhysicsBenchmark::CreateBody(bodyDef);
+
+	switch (index % 3)
+	{
+	case 0: body.AddCollider(shapeDef, Physics::CreateBox(size, size)); break;
+	case 1: body.AddCollider(shapeDef, Circle{ Vector2Zero, size }); break;
+	case 2: body.AddCollider(shapeDef, Capsule{ { -size, 0.0f }, { size, 0.0f }, size * 0.5f }); break;
+	}
+}
+
+static void CreateGround(const Vector2& position, F32 halfWidth)
+{
+	ShapeDef shapeDef{};
+
+	RigidBody2DDef groundDef{};
+	groundDef.position = position;
+	PhysicsBenchmark::CreateBody(groundDef).AddCollider(shapeDef, Physics::CreateBox(halfWidth, 0.5f));
+}
+
+// Four walls on one body, static or kinematic
+static void CreateContainer(const RigidBody2DDef& def, F32 halfSize, F32 thickness)
+{
+	ShapeDef shapeDef{};
+
+	RigidBody2D& body = PhysicsBenchmark::CreateBody(def);
+	body.AddCollider(shapeDef, Physics::CreateOffsetBox(halfSize, thickness, { { 0.0f, -halfSize }, Quaternion2Identity }));
+	body.AddCollider(shapeDef, Physics::CreateOffsetBox(halfSize, thickness, { { 0.0f, halfSize }, Quaternion2Identity }));
+	body.AddCollider(shapeDef, Physics::CreateOffsetBox(thickness, halfSize, { { -halfSize, 0.0f }, Quaternion2Identity }));
+	body.AddCollider(shapeDef, Physics::CreateOffsetBox(thickness, halfSize, { { halfSize, 0.0f }, Quaternion2Identity }));
+}
+
+#pragma region Scenes
+
+// One very tall pyramid, deep contact stacks that never sleep while they settle
+static void CreateLargePyramid()
+{
+	constexpr I32 Rows = 100;
+
+	PhysicsBenchmark::Reserve(Rows * (Rows + 1) / 2 + 1);
+
+	CreateGround(Vector2Zero, Rows * 1.0f + 10.0f);
+
+	ShapeDef shapeDef{};
+	ConvexPolygon box = Physics::CreateRoundedBox(0.45f, 0.45f, 0.05f);
+
+	for (I32 row = 0; row < Rows; ++row)
+	{
+		for (I32 column = row; column < Rows; ++column)
+		{
+			RigidBody2DDef bodyDef{};
+			bodyDef.type = BODY_TYPE_DYNAMIC;
+			bodyDef.position = { (column - row * 0.5f - Rows * 0.5f) * 1.0f, 1.0f + row * 1.0f };
+
+			PhysicsBenchmark::CreateBody(bodyDef).AddCollider(shapeDef, box);
+		}
+	}
+}
+
+// Kinematic boxes turning slowly with loose bodies tumbling around inside, lots of short lived contacts
+static void CreateTumblers()
+{
+	constexpr I32 Tumblers = 4;
+	constexpr I32 BodiesPerSide = 12;
+	constexpr F32 HalfSize = 10.0f;
+
+	PhysicsBenchmark::Reserve(Tumblers * Tumblers * (BodiesPerSide * BodiesPerSide + 1));
+
+	for (I32 x = 0; x < Tumblers; ++x)
+	{
+		for (I32 y = 0; y < Tumblers; ++y)
+		{
+			Vector2 center = { x * HalfSize * 2.5f, y * HalfSize * 2.5f };
+
+			RigidBody2DDef tumblerDef{};
+			tumblerDef.type = BODY_TYPE_KINEMATIC;
+			tumblerDef.position = center;
+			tumblerDef.angularVelocity = 0.25f;
+			CreateContainer(tumblerDef, HalfSize, 0.5f);
+
+			for (I32 i = 0; i < BodiesPerSide; ++i)
+			{
+				for (I32 j = 0; j < BodiesPerSide; ++j)
+				{
+					Vector2 offset = { (i - BodiesPerSide * 0.5f) * 1.2f + 0.6f, (j - BodiesPerSide * 0.5f) * 1.2f + 0.6f };
+					CreateMixedShape(center + offset, i + j, 0.25f);
+				}
+			}
+		}
+	}
+}
+
+// Rows of mixed shapes keep falling onto a field of static pegs
+static void CreateRain()
+{
+	constexpr I32 PegRows = 10;
+	constexpr I32 PegColumns = 40;
+
+	PhysicsBenchmark::Reserve(PegRows * PegColumns + 1);
+
+	CreateGround(Vector2Zero, PegColumns * 1.5f + 10.0f);
+
+	ShapeDef shapeDef{};
+	Circle peg = { Vector2Zero, 0.3f };
+
+	for (I32 row = 0; row < PegRows; ++row)
+	{
+		for (I32 column = 0; column < PegColumns; ++column)
+		{
+			RigidBody2DDef pegDef{};
+			pegDef.position = { (column - PegColumns * 0.5f + (row & 1) * 0.5f) * 3.0f, 10.0f + row * 3.0f };
+
+			PhysicsBenchmark::CreateBody(pegDef).AddCollider(shapeDef, peg);
+		}
+	}
+}
+
+static void UpdateRain(U32 step)
+{
+	// There's no body destruction yet, so the rain stops once the pile is big enough
+	constexpr I32 DropsPerRow = 60;
+	constexpr U32 RowCount = 50;
+
+	if (step % 10 != 0 || step / 10 >= RowCount) { return; }
+
+	PhysicsBenchmark::Reserve(DropsPerRow);
+
+	for (I32 i = 0; i < DropsPerRow; ++i)
+	{
+		Vector2 position = { (i - DropsPerRow * 0.5f) * 2.0f + RandomF32(), 50.0f + RandomF32() * 2.0f };
+		CreateMixedShape(position, i + (I32)step, 0.3f + RandomF32() * 0.2f);
+	}
+}
+
+// A heavy block fired into a large grid of boxes without gravity, one big burst of new contacts
+static void CreateSmash()
+{
+	constexpr I32 Columns = 100;
+	constexpr I32 Rows = 60;
+
+	PhysicsBenchmark::Reserve(Columns * Rows + 1);
+
+	ShapeDef shapeDef{};
+	shapeDef.density = 8.0f;
+
+	RigidBody2DDef smasherDef{};
+	smasherDef.type = BODY_TYPE_DYNAMIC;
+	smasherDef.gravityScale = 0.0f;
+	smasherDef.position = { -60.0f, Rows * 0.4f };
+	smasherDef.linearVelocity = { 40.0f, 0.0f };
+	smasherDef.isBullet = true;
+	PhysicsBenchmark::CreateBody(smasherDef).AddCollider(shapeDef, Physics::CreateBox(4.0f, 4.0f));
+
+	shapeDef.density = 1.0f;
+	ConvexPolygon box = Physics::CreateBox(0.4f, 0.4f);
+
+	for (I32 x = 0; x < Columns; ++x)
+	{
+		for (I32 y = 0; y < Rows; ++y)
+		{
+			RigidBody2DDef bodyDef{};
+			bodyDef.type = BODY_TYPE_DYNAMIC;
+			bodyDef.gravityScale = 0.0f;
+			bodyDef.position = { x * 0.8f, y * 0.8f };
+
+			PhysicsBenchmark::CreateBody(bodyDef).AddCollider(shapeDef, box);
+		}
+	}
+}
+
+// A fast kinematic bar stirring a closed box full of mixed shapes, nothing is allowed to sleep
+static void CreateSpinner()
+{
+	constexpr I32 Side = 55;
+	constexpr F32 HalfSize = 40.0f;
+
+	PhysicsBenchmark::Reserve(Side * Side + 2);
+
+	RigidBody2DDef containerDef{};
+	CreateContainer(containerDef, HalfSize, 1.0f);
+
+	ShapeDef shapeDef{};
+
+	RigidBody2DDef spinnerDef{};
+	spinnerDef.type = BODY_TYPE_KINEMATIC;
+	spinnerDef.angularVelocity = 5.0f;
+	PhysicsBenchmark::CreateBody(spinnerDef).AddCollider(shapeDef, Physics::CreateBox(HalfSize - 2.0f, 0.5f));
+
+	for (I32 i = 0; i < Side; ++i)
+	{
+		for (I32 j = 0; j < Side; ++j)
+		{
+			Vector2 position = { (i - Side * 0.5f) * 1.3f + 0.65f, (j - Side * 0.5f) * 1.3f + 0.65f };
+			if (Math::Abs(position.y) < 1.5f) { continue; }
+
+			CreateMixedShape(position, i * Side + j, 0.3f, false);
+		}
+	}
+}
+
+// Waves of bullets fired into a pyramid, continuous collision against both static and dynamic shapes
+static void CreateBullets()
+{
+	constexpr I32 Rows = 40;
+
+	PhysicsBenchmark::Reserve(Rows * (Rows + 1) / 2 + 2);
+
+	CreateGround(Vector2Zero, Rows * 2.0f);
+
+	ShapeDef shapeDef{};
+	ConvexPolygon box = Physics::CreateBox(0.5f, 0.5f);
+
+	for (I32 row = 0; row < Rows; ++row)
+	{
+		for (I32 column = row; column < Rows; ++column)
+		{
+			RigidBody2DDef bodyDef{};
+			bodyDef.type = BODY_TYPE_DYNAMIC;
+			bodyDef.position = { (column - row * 0.5f - Rows * 0.5f) * 1.0f, 1.0f + row * 1.0f };
+
+			PhysicsBenchmark::CreateBody(bodyDef).AddCollider(shapeDef, box);
+		}
+	}
+
+	// A static wall behind the pyramid catches the bullets that make it through
+	RigidBody2DDef wallDef{};
+	wallDef.position = { Rows * 1.0f, Rows * 0.5f };
+	PhysicsBenchmark::CreateBody(wallDef).AddCollider(shapeDef, Physics::CreateBox(0.5f, Rows * 0.5f + 5.0f));
+}
+
+static void UpdateBullets(U32 step)
+{
+	constexpr I32 BulletsPerWave = 50;
+	constexpr U32 WaveCount = 10;
+
+	if (step % 10 != 0 || step / 10 >= WaveCount) { return; }
+
+	PhysicsBenchmark::Reserve(BulletsPerWave);
+
+	ShapeDef shapeDef{};
+	Circle circle = { Vector2Zero, 0.1f };
+
+	for (I32 i = 0; i < BulletsPerWave; ++i)
+	{
+		RigidBody2DDef bodyDef{};
+		bodyDef.type = BODY_TYPE_DYNAMIC;
+		bodyDef.isBullet = true;
+		bodyDef.position = { -60.0f, 1.0f + i * 0.8f };
+		bodyDef.linearVelocity = { 300.0f, RandomF32() * 20.0f - 10.0f };
+
+		PhysicsBenchmark::CreateBody(bodyDef).AddCollider(shapeDef, circle);
+	}
+}
+
+// A trigger heavy level, a grid of static zone sensors with mixed shapes raining through them
+static void CreateSensors()
+{
+	constexpr I32 ZoneRows = 20;
+	constexpr I32 ZoneColumns = 40;
+
+	PhysicsBenchmark::Reserve(ZoneRows * ZoneColumns + 1);
+
+	CreateGround(Vector2Zero, ZoneColumns * 1.5f + 10.0f);
+
+	ShapeDef shapeDef{};
+	shapeDef.isSensor = true;
+	ConvexPolygon zone = Physics::CreateBox(1.2f, 1.2f);
+
+	for (I32 row = 0; row < ZoneRows; ++row)
+	{
+		for (I32 column = 0; column < ZoneColumns; ++column)
+		{
+			RigidBody2DDef zoneDef{};
+			zoneDef.position = { (column - ZoneColumns * 0.5f) * 3.0f, 5.0f + row * 2.0f };
+
+			PhysicsBenchmark::CreateBody(zoneDef).AddCollider(shapeDef, zone);
+		}
+	}
+}
+
+// A hanging net of circles held together by revolute joints, pinned along the middle of the top row, the solver is all joints
+static void CreateJointGrid()
+{
+	constexpr I32 Side = 100;
+	constexpr I32 PinStart = Side / 2 - 3;
+	constexpr I32 PinEnd = Side / 2 + 3;
+
+	PhysicsBenchmark::Reserve(Side * Side);
+
+	// The circles never touch anything, only the joints are measured
+	ShapeDef shapeDef{};
+	shapeDef.filter.layerMask = 0;
+	Circle circle = { Vector2Zero, 0.4f };
+
+	Vector<I32> bodyIds(Side * Side);
+
+	RevoluteJointDef jointDef{};
+	jointDef.drawSize = 0.4f;
+
+	for (I32 column = 0; column < Side; ++column)
+	{
+		for (I32 row = 0; row < Side; ++row)
+		{
+			RigidBody2DDef bodyDef{};
+			bodyDef.type = column >= PinStart && column <= PinEnd && row == 0 ? BODY_TYPE_STATIC : BODY_TYPE_DYNAMIC;
+			bodyDef.position = { column * 1.0f, -row * 1.0f };
+
+			I32 bodyId = Physics::CreateRigidBody(bodyDef);
+			Physics::GetRigidBody(bodyId).AddCollider(shapeDef, circle);
+			bodyIds.Push(bodyId);
+
+			// Link to the body above and the body to the left
+			if (row > 0)
+			{
+				jointDef.bodyIdA = bodyIds[column * Side + row - 1];
+				jointDef.bodyIdB = bodyId;
+				jointDef.localAnchorA = { 0.0f, -0.5f };
+				jointDef.localAnchorB = { 0.0f, 0.5f };
+				Physics::CreateRevoluteJoint(jointDef);
+			}
+
+			if (column > 0)
+			{
+				jointDef.bodyIdA = bodyIds[(column - 1) * Side + row];
+				jointDef.bodyIdB = bodyId;
+				jointDef.localAnchorA = { 0.5f, 0.0f };
+				jointDef.localAnchorB = { -0.5f, 0.0f };
+				Physics::CreateRevoluteJoint(jointDef);
+			}
+		}
+	}
+}
+
+#pragma endregion
+
+struct BenchmarkScene
+{
+	const C8* name;
+	void(*create)();
+	void(*update)(U32 step);
+	U32 stepCount;
+};
+
+static void RunScene(const BenchmarkScene& scene, const Vector<U8>& emptyWorld)
+{
+	if (!PhysicsBenchmark::Restore(emptyWorld)) { Logger::Error("{}: Failed To Reset The World", scene.name); return; }
+
+	scene.create();
+
+	PhysicsProfile total{};
+	F64 start = Time::AbsoluteTime();
+
+	for (U32 step = 0; step < scene.stepCount; ++step)
+	{
+		if (scene.update) { scene.update(step); }
+
+		PhysicsBenchmark::Step();
+
+		const PhysicsProfile& profile = Physics::Profile();
+		total.step += profile.step;
+		total.pairs += profile.pairs;
+		total.collide += profile.collide;
+		total.solve += profile.solve;
+		total.solveConstraints += profile.solveConstraints;
+		total.finalize += profile.finalize;
+		total.continuous += profile.continuous;
+		total.sleepIslands += profile.sleepIslands;
+		total.sensors += profile.sensors;
+	}
+
+	F64 elapsed = Time::AbsoluteTime() - start;
+	F64 inverseCount = 1.0 / scene.stepCount;
+
+	Logger::Info("{}: {} bodies, {} steps in {}s, {} steps/s", scene.name, PhysicsBenchmark::BodyCount(), scene.stepCount, elapsed, scene.stepCount / elapsed);
+	Logger::Info("	step {}ms, pairs {}ms, collide {}ms, solve {}ms", total.step * inverseCount, total.pairs * inverseCount, total.collide * inverseCount, total.solve * inverseCount);
+	Logger::Info("	constraints {}ms, finalize {}ms, continuous {}ms, sleep {}ms, sensors {}ms", total.solveConstraints * inverseCount, total.finalize * inverseCount,
+		total.continuous * inverseCount, total.sleepIslands * inverseCount, total.sensors * inverseCount);
+}
+
+// A static level of 100k scattered proxies built by each tree builder, then hit with packets of small queries
+static void RunTreeBuilders()
+{
+	constexpr I32 ProxyCount = 100000;
+	constexpr U32 QueryCount = 100000;
+	constexpr F32 WorldExtent = 1000.0f;
+
+	static const TreeBuildHeuristic heuristics[] = { TREE_BUILD_MEDIAN, TREE_BUILD_SAH };
+	static const C8* names[] = { "Median", "SAH" };
+
+	randomSeed = 54321;
+
+	Vector<AABB> queries;
+	queries.Reserve(QueryCount);
+
+	for (U32 i = 0; i < QueryCount; ++i)
+	{
+		Vector2 center = { (RandomF32() * 2.0f - 1.0f) * WorldExtent, (RandomF32() * 2.0f - 1.0f) * WorldExtent };
+		queries.Push({ center - Vector2One * 2.0f, center + Vector2One * 2.0f });
+	}
+
+	Vector<PacketHit> hits;
+
+	for (U32 h = 0; h < CountOf(heuristics); ++h)
+	{
+		randomSeed = 12345;
+
+		DynamicTree tree;
+		tree.Create();
+
+		// Mostly small tiles and props with the odd large piece of level geometry
+		for (I32 i = 0; i < ProxyCount; ++i)
+		{
+			Vector2 center = { (RandomF32() * 2.0f - 1.0f) * WorldExtent, (RandomF32() * 2.0f - 1.0f) * WorldExtent };
+			F32 size = i % 100 == 0 ? 5.0f + RandomF32() * 20.0f : 0.25f + RandomF32();
+			Vector2 extent = { size, size * (0.5f + RandomF32()) };
+
+			tree.CreateProxy({ center - extent, center + extent }, DefaultLayerMask, i);
+		}
+
+		F64 start = Time::AbsoluteTime();
+		tree.Rebuild(true, heuristics[h]);
+		F64 buildTime = Time::AbsoluteTime() - start;
+
+		U64 hitCount = 0;
+		start = Time::AbsoluteTime();
+
+		for (U32 i = 0; i < QueryCount; i += NH_SIMD_WIDTH)
+		{
+			hits.Clear();
+			tree.QueryPacket(queries.Data() + i, Math::Min(QueryCount - i, (U32)NH_SIMD_WIDTH), DefaultLayerMask, hits);
+			hitCount += hits.Size();
+		}
+
+		F64 queryTime = Time::AbsoluteTime() - start;
+
+		Logger::Info("StaticTree {}: {} proxies, build {}ms, {} queries {}ms, {} hits, height {}, area ratio {}", names[h], ProxyCount,
+			buildTime * 1000.0, QueryCount, queryTime * 1000.0, hitCount, tree.GetHeight(), tree.GetAreaRatio());
+
+		tree.Destroy();
+	}
+}
+
+int main(int argc, char** argv)
+{
+	static const BenchmarkScene scenes[] = {
+		{ "LargePyramid", CreateLargePyramid, nullptr, 500 },
+		{ "Tumblers", CreateTumblers, nullptr, 500 },
+		{ "Rain", CreateRain, UpdateRain, 1000 },
+		{ "Smash", CreateSmash, nullptr, 300 },
+		{ "Spinner", CreateSpinner, nullptr, 500 },
+		{ "Bullets", CreateBullets, UpdateBullets, 300 },
+		{ "Sensors", CreateSensors, UpdateRain, 1000 },
+		{ "JointGrid", CreateJointGrid, nullptr, 500 },
+	};
+
+	const C8* filter = argc > 1 ? argv[1] : nullptr;
+
+	if (!Jobs::Initialize()) { Logger::Fatal("Failed To Initialize Jobs!"); return 1; }
+
+	Logger::Info("{} wide solver, {}, {} workers", NH_SIMD_WIDTH, CpuFeatures::IsaName(), Jobs::WorkerCount());
+
+	if (PhysicsBenchmark::Initialize())
+	{
+		Vector<U8> emptyWorld;
+		PhysicsBenchmark::Snapshot(emptyWorld);
+
+		for (const BenchmarkScene& scene : scenes)
+		{
+			if (filter && strcmp(filter, scene.name) != 0) { continue; }
+
+			RunScene(scene, emptyWorld);
+		}
+
+		PhysicsBenchmark::Shutdown();
+	}
+
+	if (!filter || strcmp(filter, "StaticTree") == 0) { RunTreeBuilders(); }
+
+	Jobs::Shutdown();
+
+	return 0;
+}
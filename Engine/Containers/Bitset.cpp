@@ -1,6 +1,86 @@
 #include "Bitset.hpp"
 
 #include "Memory/Memory.hpp"
+#include "Platform/CpuFeatures.hpp"
+
+#if defined NH_CPU_X86_X64
+#include <immintrin.h>
+#elif defined NH_CPU_ARM
+#include <arm_neon.h>
+#endif
+
+typedef void(*UnionKernel)(U64* bits, const U64* other, U64 count);
+
+static void UnionScalar(U64* bits, const U64* other, U64 count)
+{
+	for (U64 i = 0; i < count; ++i) { bits[i] |= other[i]; }
+}
+
+#if defined NH_CPU_X86_X64
+static void UnionSSE2(U64* bits, const U64* other, U64 count)
+{
+	U64 i = 0;
+	for (; i + 2 <= count; i += 2)
+	{
+		__m128i a = _mm_loadu_si128((const __m128i*)(bits + i));
+		__m128i b = _mm_loadu_si128((const __m128i*)(other + i));
+		_mm_storeu_si128((__m128i*)(bits + i), _mm_or_si128(a, b));
+	}
+
+	UnionScalar(bits + i, other + i, count - i);
+}
+
+NH_TARGET_AVX2 static void UnionAVX2(U64* bits, const U64* other, U64 count)
+{
+	U64 i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m256i a = _mm256_loadu_si256((const __m256i*)(bits + i));
+		__m256i b = _mm256_loadu_si256((const __m256i*)(other + i));
+		_mm256_storeu_si256((__m256i*)(bits + i), _mm256_or_si256(a, b));
+	}
+
+	UnionScalar(bits + i, other + i, count - i);
+}
+
+NH_TARGET_AVX512 static void UnionAVX512(U64* bits, const U64* other, U64 count)
+{
+	U64 i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m512i a = _mm512_loadu_si512(bits + i);
+		__m512i b = _mm512_loadu_si512(other + i);
+		_mm512_storeu_si512(bits + i, _mm512_or_si512(a, b));
+	}
+
+	UnionScalar(bits + i, other + i, count - i);
+}
+#elif defined NH_CPU_ARM
+static void UnionNEON(U64* bits, const U64* other, U64 count)
+{
+	U64 i = 0;
+	for (; i + 2 <= count; i += 2)
+	{
+		vst1q_u64(bits + i, vorrq_u64(vld1q_u64(bits + i), vld1q_u64(other + i)));
+	}
+
+	UnionScalar(bits + i, other + i, count - i);
+}
+#endif
+
+// Picked once from what the processor supports, not what the engine was compiled for
+static UnionKernel SelectUnion()
+{
+#if defined NH_CPU_X86_X64
+	if (CpuFeatures::Has(CPU_FEATURE_AVX512)) { return UnionAVX512; }
+	if (CpuFeatures::Has(CPU_FEATURE_AVX2)) { return UnionAVX2; }
+	if (CpuFeatures::Has(CPU_FEATURE_SSE2)) { return UnionSSE2; }
+#elif defined NH_CPU_ARM
+	if (CpuFeatures::Has(CPU_FEATURE_NEON)) { return UnionNEON; }
+#endif
+
+	return UnionScalar;
+}
 
 void Bitset::Create(U64 bitCapacity)
 {
@@ -44,10 +124,8 @@ void Bitset::GrowBitSet(U64 blockCount)
 
 void Bitset::InPlaceUnion(const Bitset& other)
 {
-	for (U64 i = 0; i < blockCount; ++i)
-	{
-		bits[i] |= other.bits[i];
-	}
+	static const UnionKernel unionBlocks = SelectUnion();
+	unionBlocks(bits, other.bits, blockCount);
 }
 
 void Bitset::SetBit(U64 bitIndex)
@@ -19,15 +19,28 @@ public:
 	void Reset();
 
 	U32 GetFree();
+
+	/// <summary>
+	/// Like GetFree but doubles the capacity instead of failing when full, not thread safe since it may reallocate
+	/// </summary>
+	U32 GetFreeOrGrow();
+
 	void Release(U32 index);
 
 	bool Full() const;
 	U32 Size() const;
 	U32 Capacity() const;
 	U32 Last() const;
+	U32 FreeCount() const;
+	const U32* FreeIndices() const;
 
 	void Resize(U32 count);
 
+	/// <summary>
+	/// Overwrites the whole state with one read from another freelist's Capacity, Size, Last, FreeCount and FreeIndices
+	/// </summary>
+	void Restore(U32 capacity, U32 used, U32 lastFree, const U32* freeIndices, U32 freeCount);
+
 private:
 	U32 capacity = 0;
 	U32 used = 0;
@@ -96,6 +109,13 @@ inline U32 Freelist::GetFree()
 	return SafeIncrement(&lastFree) - 1;
 }
 
+inline U32 Freelist::GetFreeOrGrow()
+{
+	if (Full()) { Resize(capacity ? capacity * 2 : 8); }
+
+	return GetFree();
+}
+
 inline void Freelist::Release(U32 index)
 {
 	--used;
@@ -130,6 +150,26 @@ inline void Freelist::Resize(U32 count)
 
 	Memory::Reallocate(&freeIndices, count);
 
-	freeCount += capacity - count;
 	capacity = count;
-}
\ No newline at end of file
+}
+
+inline U32 Freelist::FreeCount() const
+{
+	return freeCount;
+}
+
+inline const U32* Freelist::FreeIndices() const
+{
+	return freeIndices;
+}
+
+inline void Freelist::Restore(U32 capacity, U32 used, U32 lastFree, const U32* freeIndices, U32 freeCount)
+{
+	if (capacity > this->capacity) { Memory::Reallocate(&this->freeIndices, capacity); }
+
+	this->capacity = capacity;
+	this->used = used;
+	this->lastFree = lastFree;
+	this->freeCount = freeCount;
+	Copy(this->freeIndices, freeIndices, freeCount);
+}
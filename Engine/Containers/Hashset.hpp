@@ -16,6 +16,7 @@ struct Hashset
 	struct Cell
 	{
 		bool filled;
+		bool removed;	// Tombstone, keeps probe chains intact after a remove
 		Value value;
 	};
 
@@ -77,7 +78,10 @@ public:
 private:
 	static U64 Hash(const Value& key);
 
+	void Rehash(U64 capacity);
+
 	U64 size = 0;
+	U64 removedCount = 0;
 	U64 capacity = 0;
 	U64 capMinusOne = 0;
 	Cell* cells = nullptr;
@@ -99,10 +103,11 @@ inline Hashset<Value>::Hashset(U64 cap)
 
 template<class Value>
 inline Hashset<Value>::Hashset(Hashset&& other) noexcept :
-	cells(other.cells), size(other.size), capacity(other.capacity), capMinusOne(other.capMinusOne)
+	cells(other.cells), size(other.size), removedCount(other.removedCount), capacity(other.capacity), capMinusOne(other.capMinusOne)
 {
 	other.cells = nullptr;
 	other.size = 0;
+	other.removedCount = 0;
 	other.capacity = 0;
 	other.capMinusOne = 0;
 }
@@ -112,11 +117,13 @@ inline Hashset<Value>& Hashset<Value>::operator=(Hashset&& other) noexcept
 {
 	cells = other.cells;
 	size = other.size;
+	removedCount = other.removedCount;
 	capacity = other.capacity;
 	capMinusOne = other.capMinusOne;
 
 	other.cells = nullptr;
 	other.size = 0;
+	other.removedCount = 0;
 	other.capacity = 0;
 	other.capMinusOne = 0;
 
@@ -153,6 +160,7 @@ inline void Hashset<Value>::Destroy()
 
 		Memory::Free(&cells);
 		size = 0;
+		removedCount = 0;
 		capacity = 0;
 		capMinusOne = 0;
 	}
@@ -161,17 +169,31 @@ inline void Hashset<Value>::Destroy()
 template<class Value>
 inline bool Hashset<Value>::Insert(const Value& value)
 {
-	if (size == capacity) { return false; }
+	// Keep the load under half so probe chains stay short, tombstones count as load until the next rehash
+	if ((size + removedCount + 1) * 2 > capacity) { Rehash(size * 2 + 2 > capacity ? capacity * 2 : capacity); }
 
 	U64 hash = Hash(value);
 
-	U32 i = 0;
-	Cell* cell = cells + (hash & capMinusOne);
+	U64 i = 0;
+	U64 index = hash & capMinusOne;
+	Cell* cell = cells + index;
+	Cell* tombstone = nullptr;
 
-	while (cell->filled) { if (cell->value == value) { return false; } ++i; cell = cells + ((hash + i * i) & capMinusOne); }
+	while (cell->filled || cell->removed)
+	{
+		if (cell->filled && cell->value == value) { return false; }
+		if (cell->removed && tombstone == nullptr) { tombstone = cell; }
+
+		++i;
+		index = (index + i) & capMinusOne;
+		cell = cells + index;
+	}
+
+	if (tombstone) { cell = tombstone; --removedCount; }
 
 	++size;
 	cell->filled = true;
+	cell->removed = false;
 	cell->value = value;
 
 	return true;
@@ -185,20 +207,29 @@ inline bool Hashset<Value>::Remove(const Value& value)
 	U64 hash = Hash(value);
 
 	U64 i = 0;
-	Cell* cell = cells + (hash & capMinusOne);
-	while (cell->filled && cell->value != value) { ++i; cell = cells + ((hash + i * i) & capMinusOne); }
+	U64 index = hash & capMinusOne;
+	Cell* cell = cells + index;
 
-	if (cell->filled)
+	while (cell->filled || cell->removed)
 	{
-		--size;
-		if constexpr (IsDestroyable<Value>)
+		if (cell->filled && cell->value == value)
 		{
-			if constexpr (IsPointer<Value>) { cell->value->Destroy(); }
-			else { cell->value.Destroy(); }
+			--size;
+			++removedCount;
+			if constexpr (IsDestroyable<Value>)
+			{
+				if constexpr (IsPointer<Value>) { cell->value->Destroy(); }
+				else { cell->value.Destroy(); }
+			}
+			Zero(cell, sizeof(Cell));
+			cell->removed = true;
+
+			return true;
 		}
-		Zero(cell, sizeof(Cell));
 
-		return true;
+		++i;
+		index = (index + i) & capMinusOne;
+		cell = cells + index;
 	}
 
 	return false;
@@ -212,22 +243,57 @@ inline bool Hashset<Value>::Contains(const Value& value)
 	U64 hash = Hash(value);
 
 	U64 i = 0;
-	Cell* cell = cells + (hash & capMinusOne);
-	while (cell->filled && cell->value != value) { ++i; cell = cells + ((hash + i * i) & capMinusOne); }
+	U64 index = hash & capMinusOne;
+	Cell* cell = cells + index;
+
+	while (cell->filled || cell->removed)
+	{
+		if (cell->filled && cell->value == value) { return true; }
+
+		++i;
+		index = (index + i) & capMinusOne;
+		cell = cells + index;
+	}
 
-	return cell->filled;
+	return false;
 }
 
 template<class Value>
 inline void Hashset<Value>::Reserve(U64 cap)
 {
-	if (cap < capacity) { return; }
+	if (cap <= capacity) { return; }
+
+	Rehash(cap);
+}
+
+template<class Value>
+inline void Hashset<Value>::Rehash(U64 cap)
+{
+	if (cap < 16) { cap = 16; }
+
+	Cell* oldCells = cells;
+	U64 oldCapacity = capacity;
 
-	Memory::Reallocate(&cells, cap, capacity);
+	cells = nullptr;
+	Memory::AllocateArray(&cells, cap, capacity);
 	capacity = BitFloor(capacity);
 	capMinusOne = capacity - 1;
+	removedCount = 0;
+
+	// Triangular probing visits every cell of a power of two table
+	for (Cell* cell = oldCells, *end = oldCells + oldCapacity; cell != end; ++cell)
+	{
+		if (!cell->filled) { continue; }
+
+		U64 i = 0;
+		U64 index = Hash(cell->value) & capMinusOne;
+		while (cells[index].filled) { ++i; index = (index + i) & capMinusOne; }
+
+		cells[index].filled = true;
+		cells[index].value = Move(cell->value);
+	}
 
-	Clear();
+	if (oldCells) { Memory::Free(&oldCells); }
 }
 
 template<class Value>
@@ -254,13 +320,14 @@ inline void Hashset<Value>::Clear()
 
 	Zero(cells, sizeof(Cell) * capacity);
 	size = 0;
+	removedCount = 0;
 }
 
 template<class Value>
 inline U64 Hashset<Value>::Size() const { return size; }
 
 template<class Value>
-inline U64 Hashset<Value>::Capacity() const { return size; }
+inline U64 Hashset<Value>::Capacity() const { return capacity; }
 
 /*------ITERATOR------*/
 
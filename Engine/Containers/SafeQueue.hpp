@@ -7,8 +7,6 @@
 
 #include <atomic>
 
-inline constexpr U64 CacheLineSize = 64;
-
 template <CopyOrMoveable Type, U32 Capacity>
 struct NH_API SafeQueue
 {
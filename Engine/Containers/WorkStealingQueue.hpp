@@ -0,0 +1,108 @@
+#pragma once
+
+#include "Defines.hpp"
+#include "TypeTraits.hpp"
+
+#include "Platform\ThreadSafety.hpp"
+
+#include <atomic>
+
+/*
+* Fixed capacity Chase-Lev deque, see "Correct and Efficient Work-Stealing for Weak Memory Models" (Le et al. 2013)
+* The owning thread pushes and pops from the bottom, any other thread may steal from the top
+*/
+template <Pointer Type, U32 Capacity>
+struct NH_API WorkStealingQueue
+{
+public:
+	WorkStealingQueue() {}
+
+	/// <summary>
+	/// Pushes a value onto the bottom of the queue, must only be called by the owning thread
+	/// </summary>
+	/// <param name="value:">The value to push</param>
+	/// <returns>false if the queue is full, true otherwise</returns>
+	bool Push(Type value)
+	{
+		I64 b = bottom.load(std::memory_order_relaxed);
+		I64 t = top.load(std::memory_order_acquire);
+
+		if (b - t >= (I64)capacity) { return false; }
+
+		buffer[b & capacityMask].store(value, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		bottom.store(b + 1, std::memory_order_relaxed);
+
+		return true;
+	}
+
+	/// <summary>
+	/// Pops a value from the bottom of the queue, must only be called by the owning thread
+	/// </summary>
+	/// <param name="value:">The popped value</param>
+	/// <returns>true if a value was popped, false otherwise</returns>
+	bool Pop(Type& value)
+	{
+		I64 b = bottom.load(std::memory_order_relaxed) - 1;
+		bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		I64 t = top.load(std::memory_order_relaxed);
+
+		if (t > b)
+		{
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return false;
+		}
+
+		value = buffer[b & capacityMask].load(std::memory_order_relaxed);
+
+		if (t != b) { return true; }
+
+		// Last element, race against thieves
+		bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+		bottom.store(b + 1, std::memory_order_relaxed);
+
+		return won;
+	}
+
+	/// <summary>
+	/// Steals a value from the top of the queue, may be called from any thread
+	/// </summary>
+	/// <param name="value:">The stolen value</param>
+	/// <returns>true if a value was stolen, false if the queue was empty or another thread won the race</returns>
+	bool Steal(Type& value)
+	{
+		I64 t = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		I64 b = bottom.load(std::memory_order_acquire);
+
+		if (t >= b) { return false; }
+
+		value = buffer[t & capacityMask].load(std::memory_order_relaxed);
+
+		return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+	}
+
+	U32 Size() const
+	{
+		I64 b = bottom.load(std::memory_order_relaxed);
+		I64 t = top.load(std::memory_order_relaxed);
+		return b > t ? (U32)(b - t) : 0;
+	}
+
+	bool Empty() const { return Size() == 0; }
+
+	bool Full() const { return Size() >= capacity; }
+
+private:
+	static constexpr inline U32 capacity = BitCeiling(Capacity);
+	static constexpr inline U32 capacityMask = capacity - 1;
+
+	alignas(CacheLineSize) std::atomic<I64> top{ 0 };
+	alignas(CacheLineSize) std::atomic<I64> bottom{ 0 };
+	alignas(CacheLineSize) std::atomic<Type> buffer[capacity];
+
+private:
+	WorkStealingQueue(const WorkStealingQueue&) = delete;
+	WorkStealingQueue& operator=(const WorkStealingQueue&) = delete;
+};
\ No newline at end of file
@@ -0,0 +1,200 @@
+#include "Profiler.hpp"
+
+#include "File.hpp"
+#include "Logger.hpp"
+#include "Time.hpp"
+
+#include "Platform\Jobs.hpp"
+#include "Memory\Memory.hpp"
+
+std::atomic<ProfileBuffer*> Profiler::buffers[MaxProfiledThreads];
+std::atomic<U32> Profiler::bufferCount{ 0 };
+std::atomic<bool> Profiler::recording{ true };
+bool Profiler::dumpRequested = false;
+F64 Profiler::hitchThreshold = 0.0;
+F64 Profiler::lastHitchDump = 0.0;
+U64 Profiler::frame = 0;
+
+static thread_local ProfileBuffer* threadBuffer = nullptr;
+
+// Zone and counter names come from user code, escape anything that would end or corrupt the JSON string
+static const C8* EscapeName(const C8* name, C8(&escaped)[256])
+{
+	static constexpr const C8* Hex = "0123456789abcdef";
+
+	U32 length = 0;
+
+	for (const C8* c = name ? name : ""; *c && length < CountOf(escaped) - 7; ++c)
+	{
+		U8 character = (U8)*c;
+
+		if (character == '"' || character == '\\')
+		{
+			escaped[length++] = '\\';
+			escaped[length++] = *c;
+		}
+		else if (character < 0x20)
+		{
+			escaped[length++] = '\\';
+			escaped[length++] = 'u';
+			escaped[length++] = '0';
+			escaped[length++] = '0';
+			escaped[length++] = Hex[character >> 4];
+			escaped[length++] = Hex[character & 0xF];
+		}
+		else { escaped[length++] = *c; }
+	}
+
+	escaped[length] = '\0';
+
+	return escaped;
+}
+
+void Profiler::BeginZone(const C8* name) { Record(PROFILE_EVENT_BEGIN, name, 0); }
+void Profiler::EndZone() { Record(PROFILE_EVENT_END, nullptr, 0); }
+void Profiler::Instant(const C8* name) { Record(PROFILE_EVENT_INSTANT, name, 0); }
+void Profiler::Counter(const C8* name, I64 value) { Record(PROFILE_EVENT_COUNTER, name, value); }
+
+void Profiler::RequestDump() { dumpRequested = true; }
+void Profiler::SetHitchThreshold(F64 seconds) { hitchThreshold = seconds; }
+void Profiler::SetRecording(bool enable) { recording.store(enable, std::memory_order_relaxed); }
+
+void Profiler::Record(ProfileEventType type, const C8* name, I64 value)
+{
+	if (!recording.load(std::memory_order_relaxed)) { return; }
+
+	ProfileBuffer* buffer = ThreadBuffer();
+	if (buffer == nullptr) { return; }
+
+	// Pairs with Dump, either it sees us writing and waits or we see recording stopped and back out
+	buffer->writing.store(true, std::memory_order_seq_cst);
+
+	if (recording.load(std::memory_order_seq_cst))
+	{
+		U64 head = buffer->head.load(std::memory_order_relaxed);
+
+		ProfileEvent& event = buffer->events[head & (ProfileEventsPerThread - 1)];
+		event.timestamp = Time::CoreCounter();
+		event.name = name;
+		event.value = value;
+		event.type = type;
+
+		buffer->head.store(head + 1, std::memory_order_release);
+	}
+
+	buffer->writing.store(false, std::memory_order_release);
+}
+
+ProfileBuffer* Profiler::ThreadBuffer()
+{
+	if (threadBuffer) { return threadBuffer; }
+
+	U32 index = bufferCount.fetch_add(1, std::memory_order_relaxed);
+	if (index >= MaxProfiledThreads) { return nullptr; }
+
+	Memory::Allocate(&threadBuffer);
+	Construct(threadBuffer);
+	threadBuffer->worker = Jobs::CurrentWorker();
+
+	buffers[index].store(threadBuffer, std::memory_order_release);
+
+	return threadBuffer;
+}
+
+void Profiler::EndFrame(F64 frameTime)
+{
+	++frame;
+
+	bool hitch = hitchThreshold > 0.0 && frameTime > hitchThreshold && Time::UpTime() - lastHitchDump > 5.0;
+
+	if (!dumpRequested && !hitch) { return; }
+
+	String path;
+	path.Format(hitch ? "hitch_{}.json" : "profile_{}.json", frame);
+
+	if (Dump(path)) { Logger::Info("Profile Written To {}", path); }
+
+	if (hitch) { lastHitchDump = Time::UpTime(); }
+	dumpRequested = false;
+}
+
+bool Profiler::Dump(const String& path)
+{
+	File file(path, FILE_OPEN_RESOURCE_WRITE);
+	if (!file.Opened()) { Logger::Error("Failed To Open Profile Output: {}", path); return false; }
+
+	bool wasRecording = recording.exchange(false, std::memory_order_seq_cst);
+
+	U32 count = bufferCount.load(std::memory_order_acquire);
+	if (count > MaxProfiledThreads) { count = MaxProfiledThreads; }
+
+	// Let writers that started before recording stopped finish, after this nothing touches the buffers until recording resumes
+	for (U32 thread = 0; thread < count; ++thread)
+	{
+		ProfileBuffer* buffer = buffers[thread].load(std::memory_order_acquire);
+		if (buffer == nullptr) { continue; }
+
+		while (buffer->writing.load(std::memory_order_acquire)) { CpuRelax(); }
+	}
+
+	String line;
+	C8 name[256];
+	bool first = true;
+
+	file.Write(String("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n"));
+
+	for (U32 thread = 0; thread < count; ++thread)
+	{
+		ProfileBuffer* buffer = buffers[thread].load(std::memory_order_acquire);
+		if (buffer == nullptr) { continue; }
+
+		if (buffer->worker == 0) { line.Format("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},\"args\":{\"name\":\"Main\"}}", thread); }
+		else if (buffer->worker != U32_MAX) { line.Format("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},\"args\":{\"name\":\"Worker {}\"}}", thread, buffer->worker); }
+		else { line.Format("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},\"args\":{\"name\":\"Thread {}\"}}", thread, thread); }
+
+		if (!first) { file.Write(String(",\n")); }
+		file.Write(line);
+		first = false;
+
+		U64 head = buffer->head.load(std::memory_order_acquire);
+		U64 start = head > ProfileEventsPerThread ? head - ProfileEventsPerThread : 0;
+
+		// The ring may have dropped the begin of a zone, skip ends we never saw start
+		U32 depth = 0;
+
+		for (U64 i = start; i < head; ++i)
+		{
+			const ProfileEvent& event = buffer->events[i & (ProfileEventsPerThread - 1)];
+			F64 timestamp = Time::CounterToSeconds(event.timestamp) * 1000000.0;
+
+			switch (event.type)
+			{
+			case PROFILE_EVENT_BEGIN: {
+				++depth;
+				line.Format("{\"name\":\"{}\",\"ph\":\"B\",\"ts\":{},\"pid\":1,\"tid\":{}}", EscapeName(event.name, name), timestamp, thread);
+			} break;
+			case PROFILE_EVENT_END: {
+				if (depth == 0) { continue; }
+				--depth;
+				line.Format("{\"ph\":\"E\",\"ts\":{},\"pid\":1,\"tid\":{}}", timestamp, thread);
+			} break;
+			case PROFILE_EVENT_INSTANT: {
+				line.Format("{\"name\":\"{}\",\"ph\":\"i\",\"s\":\"t\",\"ts\":{},\"pid\":1,\"tid\":{}}", EscapeName(event.name, name), timestamp, thread);
+			} break;
+			case PROFILE_EVENT_COUNTER: {
+				line.Format("{\"name\":\"{}\",\"ph\":\"C\",\"ts\":{},\"pid\":1,\"tid\":{},\"args\":{\"value\":{}}}", EscapeName(event.name, name), timestamp, thread, event.value);
+			} break;
+			}
+
+			file.Write(String(",\n"));
+			file.Write(line);
+		}
+	}
+
+	file.Write(String("\n]}\n"));
+	file.Close();
+
+	recording.store(wasRecording, std::memory_order_release);
+
+	return true;
+}
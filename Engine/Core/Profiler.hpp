@@ -0,0 +1,115 @@
+#pragma once
+
+#include "Defines.hpp"
+
+#include "Containers\String.hpp"
+#include "Platform\ThreadSafety.hpp"
+
+#include <atomic>
+
+#define ENABLE_PROFILER 1
+
+enum NH_API ProfileEventType : U8
+{
+	PROFILE_EVENT_BEGIN,
+	PROFILE_EVENT_END,
+	PROFILE_EVENT_INSTANT,
+	PROFILE_EVENT_COUNTER,
+};
+
+struct NH_API ProfileEvent
+{
+	I64 timestamp;
+	const C8* name;		// Must outlive the profiler, use string literals
+	I64 value;
+	ProfileEventType type;
+};
+
+static constexpr inline U32 ProfileEventsPerThread = 8192;
+static constexpr inline U32 MaxProfiledThreads = 256;
+
+/*
+* Each thread writes to its own ring, only the newest ProfileEventsPerThread events are kept
+*/
+struct NH_API alignas(CacheLineSize) ProfileBuffer
+{
+	ProfileEvent events[ProfileEventsPerThread];
+	std::atomic<U64> head{ 0 };
+	std::atomic<bool> writing{ false };
+	U32 worker{ U32_MAX };
+};
+
+/*
+* Records zones, instants and counters into per-thread ring buffers and writes them out as Chrome Trace Event JSON
+* Open the dumps in Perfetto (ui.perfetto.dev) or chrome://tracing
+*/
+class NH_API Profiler
+{
+public:
+	static void BeginZone(const C8* name);
+	static void EndZone();
+	static void Instant(const C8* name);
+	static void Counter(const C8* name, I64 value);
+
+	/// <summary>
+	/// Writes every thread's buffer to a file, recording pauses and in flight writes finish before any buffer is read
+	/// </summary>
+	/// <param name="path:">The file to write, overwritten if it exists</param>
+	/// <returns>true if the file was written, false otherwise</returns>
+	static bool Dump(const String& path);
+
+	/// <summary>
+	/// Dumps to profile_[frame].json at the end of the current frame
+	/// </summary>
+	static void RequestDump();
+
+	/// <summary>
+	/// Frames that take longer than seconds dump to hitch_[frame].json, at most once every few seconds, 0 disables
+	/// </summary>
+	static void SetHitchThreshold(F64 seconds);
+
+	static void SetRecording(bool enable);
+
+private:
+	static void EndFrame(F64 frameTime);
+
+	static void Record(ProfileEventType type, const C8* name, I64 value);
+	static ProfileBuffer* ThreadBuffer();
+
+	static std::atomic<ProfileBuffer*> buffers[MaxProfiledThreads];
+	static std::atomic<U32> bufferCount;
+	static std::atomic<bool> recording;
+
+	static bool dumpRequested;
+	static F64 hitchThreshold;
+	static F64 lastHitchDump;
+	static U64 frame;
+
+	STATIC_CLASS(Profiler);
+	friend class Engine;
+};
+
+struct NH_API ProfileZone
+{
+	ProfileZone(const C8* name) { Profiler::BeginZone(name); }
+	~ProfileZone() { Profiler::EndZone(); }
+
+	ProfileZone(const ProfileZone&) = delete;
+	ProfileZone& operator=(const ProfileZone&) = delete;
+};
+
+#if ENABLE_PROFILER
+#	define PROFILE_CONCAT_INNER(a, b) a##b
+#	define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#	define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#	define PROFILE_BEGIN(name) Profiler::BeginZone(name)
+#	define PROFILE_END() Profiler::EndZone()
+#	define PROFILE_INSTANT(name) Profiler::Instant(name)
+#	define PROFILE_COUNTER(name, value) Profiler::Counter(name, value)
+#else
+#	define PROFILE_ZONE(name)
+#	define PROFILE_BEGIN(name)
+#	define PROFILE_END()
+#	define PROFILE_INSTANT(name)
+#	define PROFILE_COUNTER(name, value)
+#endif
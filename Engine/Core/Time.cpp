@@ -1,9 +1,18 @@
 #include "Time.hpp"
 
+#include "Platform\ThreadSafety.hpp"
+#include "Math\Math.hpp"
+
 #include <time.h>
 
 #if defined(NH_PLATFORM_WINDOWS)
 #include <Windows.h>
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+#elif defined(NH_PLATFORM_LINUX)
+#include <errno.h>
 #endif
 
 F64 Time::clockFrequency = ClockFrequency();
@@ -27,12 +36,21 @@ F64 Time::AbsoluteTime()
 	QueryPerformanceCounter(&nowTime);
 
 	return (F64)nowTime.QuadPart * clockFrequency;
+#elif defined(NH_PLATFORM_LINUX)
+	timespec nowTime;
+	clock_gettime(CLOCK_MONOTONIC, &nowTime);
+
+	return (F64)nowTime.tv_sec + (F64)nowTime.tv_nsec * clockFrequency;
 #endif
 }
 
 U64 Time::SecondsSinceEpoch()
 {
+#if defined(NH_PLATFORM_WINDOWS)
 	return _time64(nullptr);
+#else
+	return (U64)time(nullptr);
+#endif
 }
 
 I64 Time::CoreCounter()
@@ -42,9 +60,24 @@ I64 Time::CoreCounter()
 	QueryPerformanceCounter(&nowTime);
 
 	return nowTime.QuadPart;
+#elif defined(NH_PLATFORM_LINUX)
+	timespec nowTime;
+	clock_gettime(CLOCK_MONOTONIC, &nowTime);
+
+	return (I64)nowTime.tv_sec * 1000000000 + nowTime.tv_nsec;
 #endif
 }
 
+F64 Time::CounterToSeconds(I64 counter)
+{
+	return (F64)counter * clockFrequency;
+}
+
+I64 Time::SecondsToCounter(F64 seconds)
+{
+	return (I64)(seconds / clockFrequency);
+}
+
 bool Time::Initialize()
 {
 	frameEndTime = programStart;
@@ -81,6 +114,8 @@ F64 Time::ClockFrequency()
 	LARGE_INTEGER frequency;
 	QueryPerformanceFrequency(&frequency);
 	return 1.0 / (F64)frequency.QuadPart;
+#elif defined(NH_PLATFORM_LINUX)
+	return 0.000000001;
 #endif
 }
 
@@ -91,6 +126,8 @@ F64 Time::ProgramStart()
 	QueryPerformanceCounter(&startTime);
 
 	return (F64)startTime.QuadPart * clockFrequency;
+#elif defined(NH_PLATFORM_LINUX)
+	return AbsoluteTime();
 #endif
 }
 
@@ -127,4 +164,87 @@ F64 Timer::CurrentTime() const
 	if (running) { return elapsedTime + Time::AbsoluteTime() - start; }
 
 	return elapsedTime;
-}
\ No newline at end of file
+}
+
+FrameLimiter::FrameLimiter()
+{
+#if defined(NH_PLATFORM_WINDOWS)
+	timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+
+	// High resolution timers need Windows 10 1803
+	if (timer == nullptr) { timer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS); }
+
+	wakeErrorMean = (F64)Time::SecondsToCounter(0.001);
+#else
+	wakeErrorMean = (F64)Time::SecondsToCounter(0.0001);
+#endif
+}
+
+FrameLimiter::~FrameLimiter() { Destroy(); }
+
+void FrameLimiter::Destroy()
+{
+#if defined(NH_PLATFORM_WINDOWS)
+	if (timer) { CloseHandle(timer); }
+#endif
+
+	timer = nullptr;
+}
+
+void FrameLimiter::Reset()
+{
+	deadline = 0;
+}
+
+void FrameLimiter::Wait(F64 period)
+{
+	if (period <= 0.0) { deadline = 0; return; }
+
+	I64 periodTicks = Time::SecondsToCounter(period);
+	I64 now = Time::CoreCounter();
+
+	if (deadline == 0) { deadline = now + periodTicks; }
+	else
+	{
+		deadline += periodTicks;
+
+		// Too far behind to catch up smoothly, start a new schedule from now
+		if (now - deadline > periodTicks) { deadline = now; return; }
+	}
+
+	if (now >= deadline) { return; }
+
+	// Leave enough time to absorb almost every late wake up, then spin the rest
+	F64 margin = wakeErrorMean + 3.0 * Math::Sqrt(wakeErrorVariance);
+	I64 sleepTarget = deadline - (I64)margin;
+
+	if (sleepTarget > now)
+	{
+		SleepUntil(sleepTarget);
+
+		F64 error = (F64)(Time::CoreCounter() - sleepTarget);
+		F64 delta = error - wakeErrorMean;
+		wakeErrorMean += delta * 0.1;
+		wakeErrorVariance = (wakeErrorVariance + delta * delta * 0.1) * 0.9;
+	}
+
+	while (Time::CoreCounter() < deadline) { CpuRelax(); }
+}
+
+void FrameLimiter::SleepUntil(I64 target)
+{
+#if defined(NH_PLATFORM_WINDOWS)
+	I64 remaining = target - Time::CoreCounter();
+	if (remaining <= 0) { return; }
+
+	LARGE_INTEGER dueTime;
+	dueTime.QuadPart = -(I64)(Time::CounterToSeconds(remaining) * 10000000.0);
+
+	if (timer && SetWaitableTimerEx(timer, &dueTime, 0, nullptr, nullptr, nullptr, 0)) { WaitForSingleObject(timer, INFINITE); }
+	else { Sleep((UL32)(Time::CounterToSeconds(remaining) * 1000.0)); }
+#elif defined(NH_PLATFORM_LINUX)
+	// CoreCounter is CLOCK_MONOTONIC in nanoseconds so the target can be used directly
+	timespec time{ (time_t)(target / 1000000000), (long)(target % 1000000000) };
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &time, nullptr) == EINTR) {}
+#endif
+}
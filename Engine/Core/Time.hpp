@@ -15,6 +15,8 @@ public:
 	static U64 SecondsSinceEpoch();
 
 	static I64 CoreCounter();
+	static F64 CounterToSeconds(I64 counter);
+	static I64 SecondsToCounter(F64 seconds);
 
 private:
 	static bool Initialize();
@@ -53,4 +55,34 @@ private:
 	F64 start;
 	F64 elapsedTime;
 	bool running;
+};
+
+/*
+* Paces frames to a target period, sleeps on a high resolution timer for most of the wait then spins to the deadline
+* Deadlines advance by exactly one period so the average matches the target, a frame that runs over by more than a period resets the schedule instead of bursting to catch up
+*/
+struct NH_API FrameLimiter
+{
+	FrameLimiter();
+	~FrameLimiter();
+	void Destroy();
+
+	/// <summary>
+	/// Waits until the next frame should start
+	/// </summary>
+	/// <param name="period:">The target frame time in seconds, 0 disables limiting</param>
+	void Wait(F64 period);
+
+	void Reset();
+
+private:
+	void SleepUntil(I64 target);
+
+	I64 deadline{ 0 };
+
+	// How late the OS wakes us in counter ticks, tracked so we stop sleeping early enough to spin the rest
+	F64 wakeErrorMean{ 0.0 };
+	F64 wakeErrorVariance{ 0.0 };
+
+	void* timer{ nullptr };
 };
\ No newline at end of file
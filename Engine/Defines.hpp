@@ -115,7 +115,11 @@ static inline constexpr double F64_MIN = 2.2250738585072014e-308;			//Minimum va
 /*---------SIMD DETECTION---------*/
 
 #ifdef NH_CPU_X86_X64
-#	ifdef __AVX__
+#	ifdef __AVX2__
+#		define NH_SIMD_AVX2
+#		define NH_SIMD_AVX
+#		define NH_SIMD_WIDTH 8
+#	elif defined __AVX__
 #		define NH_SIMD_AVX
 #		define NH_SIMD_WIDTH 8
 #	elif (defined _M_AMD64 || defined _M_X64) || _M_IX86_FP == 2
@@ -196,6 +200,26 @@ class& operator=(class&&) = delete;	\
 #	define NH_NOINLINE										// Tries to force the compiler to not inline a function (NOT AVAILABLE)
 #endif
 
+#if defined NH_COMPILER_CLANG || defined NH_COMPILER_GCC
+#	define NH_TARGET_AVX2 __attribute__((target("avx2")))		// Lets a function use AVX2 intrinsics in a file that isn't compiled for AVX2
+#	define NH_TARGET_AVX512 __attribute__((target("avx512f")))	// Lets a function use AVX-512 intrinsics in a file that isn't compiled for AVX-512
+#else
+#	define NH_TARGET_AVX2										// MSVC allows any intrinsic regardless of /arch
+#	define NH_TARGET_AVX512										// MSVC allows any intrinsic regardless of /arch
+#endif
+
+// Put before a file's includes, the math in the rest of the file is done exactly as written with no FMA contraction,
+// results then only depend on the source and not on the compiler, target or optimization level
+#if defined NH_COMPILER_MSVC
+#	define NH_STRICT_FLOAT __pragma(float_control(precise, on)) __pragma(fp_contract(off))
+#elif defined NH_COMPILER_CLANG
+#	define NH_STRICT_FLOAT _Pragma("float_control(precise, on)") _Pragma("clang fp contract(off)")
+#elif defined NH_COMPILER_GCC
+#	define NH_STRICT_FLOAT _Pragma("GCC optimize(\"fp-contract=off\")")
+#else
+#	define NH_STRICT_FLOAT
+#endif
+
 #ifndef __has_cpp_attribute
 #	define HAS_NODISCARD 0
 #elif __has_cpp_attribute(nodiscard) >= 201603L
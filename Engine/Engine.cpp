@@ -9,6 +9,7 @@
 #include "Platform\Input.hpp"
 #include "Platform\Audio.hpp"
 #include "Platform\Jobs.hpp"
+#include "Platform\CpuFeatures.hpp"
 #include "Networking\Discord.hpp"
 #include "Networking\Steam.hpp"
 #include "Resources\Resources.hpp"
@@ -17,6 +18,7 @@
 #include "Math\Math.hpp"
 #include "Math\Physics.hpp"
 #include "Core\Logger.hpp"
+#include "Core\Profiler.hpp"
 #include "Core\Events.hpp"
 #include "Core\Time.hpp"
 
@@ -30,6 +32,9 @@ bool Engine::inEditor = true;
 
 void Engine::Initialize(const GameInfo& gameInfo_)
 {
+	// Before anything else runs, the rest of the engine may already use instructions this CPU doesn't have
+	if (!CpuFeatures::SupportsCompiledSimd()) { CpuFeatures::ReportUnsupportedSimd(); return; }
+
 	gameInfo = gameInfo_;
 
 	//TODO: Validate gameInfo
@@ -37,12 +42,13 @@ void Engine::Initialize(const GameInfo& gameInfo_)
 	running = true;
 
 	if (!Memory::Initialize()) { Logger::Fatal("Failed To Initialize Memory!"); return; }
-	if (!Jobs::Initialize()) { Logger::Fatal("Failed To Initialize Jobs!"); return; }
+	if (!Jobs::Initialize(gameInfo.jobAffinity)) { Logger::Fatal("Failed To Initialize Jobs!"); return; }
 	if (!Logger::Initialize()) { Logger::Fatal("Failed To Initialize Logger!"); return; }
+	Logger::Info("CPU Instruction Set: {}", CpuFeatures::IsaName());
 	if (!Time::Initialize()) { Logger::Fatal("Failed To Initialize Time!"); return; }
 	if (!Events::Initialize()) { Logger::Fatal("Failed To Initialize Events!"); return; }
 	if (!Settings::Initialize()) { Logger::Fatal("Failed To Initialize Settings!"); return; }
-	if (!Physics::Initialize()) { Logger::Fatal("Failed To Initialize Physics!"); return; }
+	if (!Physics::Initialize(gameInfo.physicsStepRate, gameInfo.physicsSubSteps, gameInfo.maxPhysicsSteps)) { Logger::Fatal("Failed To Initialize Physics!"); return; }
 	if (!Platform::Initialize(gameInfo.gameName)) { Logger::Fatal("Failed To Initialize Platform!"); return; }
 	if (!Renderer::Initialize(gameInfo.gameName, gameInfo.gameVersion)) { Logger::Fatal("Failed To Initialize Renderer!"); return; }
 	if (!Resources::Initialize()) { Logger::Fatal("Failed To Initialize Resources!"); return; }
@@ -105,7 +111,8 @@ void Engine::Shutdown()
 
 void Engine::UpdateLoop()
 {
-	F64 timeAccumulation = 0.0;
+	FrameLimiter limiter;
+
 	while (running)
 	{
 		Time::Update();
@@ -123,29 +130,65 @@ void Engine::UpdateLoop()
 		{
 			inEditor = !inEditor;
 		}
+
+		if (Input::OnButtonDown(BUTTON_CODE_F9))
+		{
+			Profiler::RequestDump();
+		}
 #endif
 
 		bool runFrame = false;
-		if (!Platform::minimised) { runFrame = Renderer::BeginFrame(); }
+		if (!gameInfo.pipelinedFrames && !Platform::minimised) { runFrame = Renderer::BeginFrame(); }
+
+		PROFILE_BEGIN("Physics");
+		Physics::Update(Time::DeltaTime());
+		PROFILE_END();
 
-		Physics::Update((F32)Time::DeltaTime()); //TODO: constant step
+		PROFILE_BEGIN("UI");
 		UI::Update();
+		PROFILE_END();
 
+		PROFILE_BEGIN("Game");
 		gameInfo.GameUpdate();
+		PROFILE_END();
 		//Animations::Update();
 
+		PROFILE_BEGIN("Audio");
 		Audio::Update();
+		PROFILE_END();
 
-		if (runFrame) { Renderer::EndFrame(); }
+		if (gameInfo.pipelinedFrames)
+		{
+			// BeginFrame waits for the last frame's job, this frame is copied out here then recorded, submitted and presented while the next one simulates
+			if (!Platform::minimised && Renderer::BeginFrame())
+			{
+				PROFILE_BEGIN("Extract Frame");
+				Renderer::ExtractFrame();
+				PROFILE_END();
+
+				Renderer::frameJob = Jobs::Excecute([]() {
+					PROFILE_ZONE("Submit Frame");
+					Renderer::SubmitFrame();
+				}, JOB_PRIORITY_HIGH);
+			}
+		}
+		else if (runFrame)
+		{
+			PROFILE_BEGIN("Render");
+			Renderer::EndFrame();
+			PROFILE_END();
+		}
 
 		Steam::Update();
 		Discord::Update();
 
-		F64 remainingFrameTime = targetFrametime - Time::FrameUpTime();
-		U64 remainingUS = (U64)(remainingFrameTime * 990000.0);
+		Profiler::EndFrame(Time::FrameUpTime());
 
-		if (remainingUS > 0) { Jobs::SleepForMicro(remainingUS); }
+		limiter.Wait(targetFrametime);
 	}
+
+	limiter.Destroy();
+	Renderer::WaitForFrame();
 }
 
 #ifdef NH_DEBUG
@@ -3,6 +3,7 @@
 #include "Defines.hpp"
 
 #include "Containers\String.hpp"
+#include "Platform\Topology.hpp"
 
 typedef bool(*InitializeFn)();
 typedef void(*UpdateFn)();
@@ -44,6 +45,33 @@ struct NH_API GameInfo
 	/// The Discord application ID for the game, used when integrating with Discord
 	/// </summary>
 	U64 discordAppId = 0;
+
+	/// <summary>
+	/// How job workers are pinned to processors, by default one worker per physical core
+	/// </summary>
+	JobAffinity jobAffinity = JOB_AFFINITY_PHYSICAL_CORES;
+
+	/// <summary>
+	/// Records, submits and presents each frame on a job while the next frame simulates, so frame time is max(sim, render) instead of the sum
+	/// <para/>Scene and resource updates still run on the main thread after GameUpdate, they copy the frame into a double buffered upload slot the job renders from
+	/// <para/>Game code must not call Renderer directly while this is on, LoadScene waits for the job
+	/// </summary>
+	bool pipelinedFrames = false;
+
+	/// <summary>
+	/// How many fixed physics steps run per second, rendering interpolates between the last two steps
+	/// </summary>
+	F32 physicsStepRate = 60.0f;
+
+	/// <summary>
+	/// Solver substeps per physics step, more substeps make stacks and joints stiffer at a higher cost
+	/// </summary>
+	I32 physicsSubSteps = 4;
+
+	/// <summary>
+	/// The most physics steps a single frame can run, time past this is dropped so a hitch can't snowball
+	/// </summary>
+	I32 maxPhysicsSteps = 8;
 };
 
 class NH_API Engine
@@ -18,15 +18,25 @@
 * 3. This notice may not be removed or altered from any source distribution.
 */
 
+#include "Defines.hpp"
+
+NH_STRICT_FLOAT
+
 #include "Broadphase.hpp"
 
 #include "Physics.hpp"
 
 #include "Memory\Memory.hpp"
 #include "Containers\Stack.hpp"
+#include "Platform\Jobs.hpp"
 
 static constexpr TreeNode DefaultTreeNode = { { { 0.0f, 0.0f }, { 0.0f, 0.0f } }, 0, { NullNode }, NullNode, NullNode, -1, -2, false };
-static constexpr U64 TreeStackSize = 1024;
+
+// Binned SAH, more bins find better splits but cost more per node, 16 is the usual middle ground between 8 and 32
+static constexpr I32 TreeBinCount = 16;
+// Rebuilds with fewer leaves run on the calling thread, bigger ones split their top levels then build the subtrees as jobs
+static constexpr I32 TreeParallelLeafCount = 4096;
+static constexpr I32 TreeSubtreeLeafCount = 1024;
 
 //Tree
 
@@ -57,6 +67,7 @@ void DynamicTree::Create()
 	leafBoxes = nullptr;
 	leafCenters = nullptr;
 	binIndices = nullptr;
+	internalNodes = nullptr;
 	rebuildCapacity = 0;
 }
 
@@ -67,6 +78,7 @@ void DynamicTree::Destroy()
 	Memory::Free(&leafBoxes);
 	Memory::Free(&leafCenters);
 	Memory::Free(&binIndices);
+	Memory::Free(&internalNodes);
 }
 
 I32 DynamicTree::AllocateNode()
@@ -75,13 +87,14 @@ I32 DynamicTree::AllocateNode()
 	if (freeList == NullNode)
 	{
 		// The free list is empty. Rebuild a bigger pool.
+		U32 oldCapacity = nodeCapacity;
 		Memory::Reallocate(&nodes, nodeCapacity + 1, nodeCapacity);
 
 		// Build a linked list for the free list. The parent
-		// pointer becomes the "next" pointer.
-		TreeNode* node = nodes;
+		// pointer becomes the "next" pointer. Only the new nodes, the old ones are all in use
+		TreeNode* node = nodes + oldCapacity;
 
-		for (U32 i = 0; i < nodeCapacity - 1; ++i, ++node)
+		for (U32 i = oldCapacity; i < nodeCapacity - 1; ++i, ++node)
 		{
 			node->next = i + 1;
 			node->height = -1;
@@ -612,12 +625,15 @@ bool DynamicTree::AABBOverlaps(AABB a, AABB b)
 
 void DynamicTree::Query(const AABB& aabb, U64 layerMask, QueryPairContext& context)
 {
-	Stack<I32> stack(256);
+	if (root == NullNode) { return; }
+
+	// Runs on job workers, TreeStack keeps the walk off the allocator
+	TreeStack<I32> stack;
 	stack.Push(root);
 
-	I32 nodeId;
-	while (stack.Pop(nodeId))
+	while (!stack.Empty())
 	{
+		I32 nodeId = stack.Pop();
 		if (nodeId == NullNode) { continue; }
 
 		const TreeNode* node = nodes + nodeId;
@@ -641,12 +657,14 @@ void DynamicTree::Query(const AABB& aabb, U64 layerMask, QueryPairContext& conte
 
 void DynamicTree::QueryContinuous(const AABB& aabb, U64 layerMask, ContinuousContext& context)
 {
-	Stack<I32> stack(256);
+	if (root == NullNode) { return; }
+
+	TreeStack<I32> stack;
 	stack.Push(root);
 
-	I32 nodeId;
-	while (stack.Pop(nodeId))
+	while (!stack.Empty())
 	{
+		I32 nodeId = stack.Pop();
 		if (nodeId == NullNode) { continue; }
 
 		const TreeNode* node = nodes + nodeId;
@@ -655,8 +673,8 @@ void DynamicTree::QueryContinuous(const AABB& aabb, U64 layerMask, ContinuousCon
 		{
 			if (node->child1 == NullNode)
 			{
-				// callback to user code with proxy id
-				bool proceed = Broadphase::ContinuousQueryCallback(nodeId, context);
+				// callback to user code with the shape id
+				bool proceed = Broadphase::ContinuousQueryCallback(node->userData, context);
 				if (proceed == false) { return; }
 			}
 			else
@@ -668,8 +686,329 @@ void DynamicTree::QueryContinuous(const AABB& aabb, U64 layerMask, ContinuousCon
 	}
 }
 
-//TODO: Raycast
-//TODO: Shapecast
+void DynamicTree::Raycast(const RaycastInput& input, U64 layerMask, WorldCastContext& context)
+{
+	if (root == NullNode) { return; }
+
+	Vector2 p1 = input.origin;
+	Vector2 d = input.translation;
+	Vector2 r = d.Normalized();
+
+	// v is perpendicular to the segment
+	Vector2 v = r.CrossInv(1.0f);
+	Vector2 absV = { Math::Abs(v.x), Math::Abs(v.y) };
+
+	F32 maxFraction = input.maxFraction;
+	Vector2 p2 = p1 + d * maxFraction;
+
+	// Build a bounding box for the segment
+	AABB segmentAABB = { Math::Min(p1, p2), Math::Max(p1, p2) };
+
+	TreeStack<I32> stack;
+	stack.Push(root);
+
+	RaycastInput subInput = input;
+
+	while (!stack.Empty())
+	{
+		I32 nodeId = stack.Pop();
+		if (nodeId == NullNode) { continue; }
+
+		const TreeNode* node = nodes + nodeId;
+		if (!AABBOverlaps(node->aabb, segmentAABB) || (node->layers & layerMask) == 0) { continue; }
+
+		// Separating axis for segment (Gino, p80)
+		// |dot(v, p1 - c)| > dot(|v|, h)
+		Vector2 c = node->aabb.Center();
+		Vector2 h = (node->aabb.upperBound - node->aabb.lowerBound) * 0.5f;
+		F32 term1 = Math::Abs(v.Dot(p1 - c));
+		F32 term2 = absV.Dot(h);
+		if (term2 < term1) { continue; }
+
+		if (node->child1 == NullNode)
+		{
+			subInput.maxFraction = maxFraction;
+
+			F32 value = Broadphase::RaycastCallback(subInput, node->userData, context);
+
+			// The callback has asked us to stop
+			if (value == 0.0f) { return; }
+
+			if (0.0f < value && value < maxFraction)
+			{
+				// Clip the rest of the search to the new hit
+				maxFraction = value;
+				p2 = p1 + d * maxFraction;
+				segmentAABB.lowerBound = Math::Min(p1, p2);
+				segmentAABB.upperBound = Math::Max(p1, p2);
+			}
+		}
+		else
+		{
+			stack.Push(node->child1);
+			stack.Push(node->child2);
+		}
+	}
+}
+
+void DynamicTree::Shapecast(const ShapeCastInput& input, U64 layerMask, WorldCastContext& context)
+{
+	if (root == NullNode || input.count == 0) { return; }
+
+	AABB originAABB = { input.points[0], input.points[0] };
+	for (I32 i = 1; i < input.count; ++i)
+	{
+		originAABB.lowerBound = Math::Min(originAABB.lowerBound, input.points[i]);
+		originAABB.upperBound = Math::Max(originAABB.upperBound, input.points[i]);
+	}
+
+	Vector2 radius = { input.radius, input.radius };
+	originAABB.lowerBound -= radius;
+	originAABB.upperBound += radius;
+
+	Vector2 p1 = originAABB.Center();
+	Vector2 extension = (originAABB.upperBound - originAABB.lowerBound) * 0.5f;
+
+	// v is perpendicular to the segment
+	Vector2 d = input.translation;
+	Vector2 r = d.Normalized();
+	Vector2 v = r.CrossInv(1.0f);
+	Vector2 absV = { Math::Abs(v.x), Math::Abs(v.y) };
+
+	F32 maxFraction = input.maxFraction;
+
+	// Sweep the shape's bounds along the whole translation
+	Vector2 t = d * maxFraction;
+	AABB totalAABB = { Math::Min(originAABB.lowerBound, originAABB.lowerBound + t), Math::Max(originAABB.upperBound, originAABB.upperBound + t) };
+
+	TreeStack<I32> stack;
+	stack.Push(root);
+
+	ShapeCastInput subInput = input;
+
+	while (!stack.Empty())
+	{
+		I32 nodeId = stack.Pop();
+		if (nodeId == NullNode) { continue; }
+
+		const TreeNode* node = nodes + nodeId;
+		if (!AABBOverlaps(node->aabb, totalAABB) || (node->layers & layerMask) == 0) { continue; }
+
+		// Separating axis for segment (Gino, p80), the node is extended by the shape's bounds
+		Vector2 c = node->aabb.Center();
+		Vector2 h = (node->aabb.upperBound - node->aabb.lowerBound) * 0.5f + extension;
+		F32 term1 = Math::Abs(v.Dot(p1 - c));
+		F32 term2 = absV.Dot(h);
+		if (term2 < term1) { continue; }
+
+		if (node->child1 == NullNode)
+		{
+			subInput.maxFraction = maxFraction;
+
+			F32 value = Broadphase::ShapecastCallback(subInput, node->userData, context);
+
+			// The callback has asked us to stop
+			if (value == 0.0f) { return; }
+
+			if (0.0f < value && value < maxFraction)
+			{
+				// Clip the rest of the search to the new hit
+				maxFraction = value;
+				t = d * maxFraction;
+				totalAABB.lowerBound = Math::Min(originAABB.lowerBound, originAABB.lowerBound + t);
+				totalAABB.upperBound = Math::Max(originAABB.upperBound, originAABB.upperBound + t);
+			}
+		}
+		else
+		{
+			stack.Push(node->child1);
+			stack.Push(node->child2);
+		}
+	}
+}
+
+// A node still to visit in a packet traversal and the lanes that overlapped its parent
+struct PacketStackItem
+{
+	I32 nodeId;
+	U32 laneMask;
+};
+
+// Workers pass canGrow as false, once hits is full the query stops and returns false so the caller can fall back
+bool DynamicTree::QueryPacket(const AABB* boxes, U32 count, U64 layerMask, Vector<PacketHit>& hits, bool canGrow)
+{
+	if (root == NullNode || count == 0) { return true; }
+
+	// Unused lanes get an inverted box that never overlaps
+	alignas(32) F32 lowerX[NH_SIMD_WIDTH];
+	alignas(32) F32 lowerY[NH_SIMD_WIDTH];
+	alignas(32) F32 upperX[NH_SIMD_WIDTH];
+	alignas(32) F32 upperY[NH_SIMD_WIDTH];
+
+	for (U32 lane = 0; lane < NH_SIMD_WIDTH; ++lane)
+	{
+		if (lane < count)
+		{
+			lowerX[lane] = boxes[lane].lowerBound.x;
+			lowerY[lane] = boxes[lane].lowerBound.y;
+			upperX[lane] = boxes[lane].upperBound.x;
+			upperY[lane] = boxes[lane].upperBound.y;
+		}
+		else
+		{
+			lowerX[lane] = Huge;
+			lowerY[lane] = Huge;
+			upperX[lane] = -Huge;
+			upperY[lane] = -Huge;
+		}
+	}
+
+	FloatW queryLowerX = LoadW(lowerX);
+	FloatW queryLowerY = LoadW(lowerY);
+	FloatW queryUpperX = LoadW(upperX);
+	FloatW queryUpperY = LoadW(upperY);
+
+	// Each entry carries the lanes that still overlap, children are only tested against those
+	TreeStack<PacketStackItem> stack;
+	stack.Push({ root, (1u << count) - 1 });
+
+	while (!stack.Empty())
+	{
+		PacketStackItem item = stack.Pop();
+		I32 nodeId = item.nodeId;
+		U32 laneMask = item.laneMask;
+
+		if (nodeId == NullNode) { continue; }
+
+		const TreeNode* node = nodes + nodeId;
+		if ((node->layers & layerMask) == 0) { continue; }
+
+		FloatW overlap = (queryLowerX <= SplatW(node->aabb.upperBound.x)) & (queryLowerY <= SplatW(node->aabb.upperBound.y)) &
+			(SplatW(node->aabb.lowerBound.x) <= queryUpperX) & (SplatW(node->aabb.lowerBound.y) <= queryUpperY);
+
+		U32 mask = (U32)MaskW(overlap) & laneMask;
+		if (mask == 0) { continue; }
+
+		if (node->child1 == NullNode)
+		{
+			for (U32 lane = 0; lane < count; ++lane)
+			{
+				if ((mask & (1u << lane)) == 0) { continue; }
+				if (!canGrow && hits.Full()) { return false; }
+
+				hits.Push({ lane, node->userData });
+			}
+		}
+		else
+		{
+			stack.Push({ node->child1, mask });
+			stack.Push({ node->child2, mask });
+		}
+	}
+
+	return true;
+}
+
+void DynamicTree::RaycastPacket(const RaycastInput* inputs, U32 count, U64 layerMask, WorldCastContext* contexts)
+{
+	if (root == NullNode || count == 0) { return; }
+
+	alignas(32) F32 originX[NH_SIMD_WIDTH];
+	alignas(32) F32 originY[NH_SIMD_WIDTH];
+	alignas(32) F32 inverseX[NH_SIMD_WIDTH];
+	alignas(32) F32 inverseY[NH_SIMD_WIDTH];
+	alignas(32) F32 maxFractions[NH_SIMD_WIDTH];
+
+	for (U32 lane = 0; lane < NH_SIMD_WIDTH; ++lane)
+	{
+		if (lane < count)
+		{
+			const RaycastInput& input = inputs[lane];
+			originX[lane] = input.origin.x;
+			originY[lane] = input.origin.y;
+
+			// Axis aligned rays get a large but finite inverse so the slab test never sees 0 * inf
+			inverseX[lane] = Math::Abs(input.translation.x) > 1.0e-20f ? 1.0f / input.translation.x : 1.0e30f;
+			inverseY[lane] = Math::Abs(input.translation.y) > 1.0e-20f ? 1.0f / input.translation.y : 1.0e30f;
+
+			// Rays carry their closest hit between trees
+			maxFractions[lane] = contexts[lane].closest.hit ? contexts[lane].closest.fraction : input.maxFraction;
+		}
+		else
+		{
+			originX[lane] = 0.0f;
+			originY[lane] = 0.0f;
+			inverseX[lane] = 0.0f;
+			inverseY[lane] = 0.0f;
+			maxFractions[lane] = -1.0f;
+		}
+	}
+
+	FloatW rayOriginX = LoadW(originX);
+	FloatW rayOriginY = LoadW(originY);
+	FloatW rayInverseX = LoadW(inverseX);
+	FloatW rayInverseY = LoadW(inverseY);
+	FloatW rayMaxFraction = LoadW(maxFractions);
+
+	U32 liveLanes = (1u << count) - 1;
+
+	TreeStack<PacketStackItem> stack;
+	stack.Push({ root, liveLanes });
+
+	while (!stack.Empty())
+	{
+		PacketStackItem item = stack.Pop();
+		I32 nodeId = item.nodeId;
+		U32 laneMask = item.laneMask & liveLanes;
+
+		if (nodeId == NullNode || laneMask == 0) { continue; }
+
+		const TreeNode* node = nodes + nodeId;
+		if ((node->layers & layerMask) == 0) { continue; }
+
+		// Slab test in fractions of each ray's translation
+		FloatW tx1 = (SplatW(node->aabb.lowerBound.x) - rayOriginX) * rayInverseX;
+		FloatW tx2 = (SplatW(node->aabb.upperBound.x) - rayOriginX) * rayInverseX;
+		FloatW ty1 = (SplatW(node->aabb.lowerBound.y) - rayOriginY) * rayInverseY;
+		FloatW ty2 = (SplatW(node->aabb.upperBound.y) - rayOriginY) * rayInverseY;
+
+		FloatW tMin = MaxW(MaxW(MinW(tx1, tx2), MinW(ty1, ty2)), ZeroFloatW);
+		FloatW tMax = MinW(MinW(MaxW(tx1, tx2), MaxW(ty1, ty2)), rayMaxFraction);
+
+		U32 mask = (U32)MaskW(tMin <= tMax) & laneMask;
+		if (mask == 0) { continue; }
+
+		if (node->child1 == NullNode)
+		{
+			bool clipped = false;
+
+			for (U32 lane = 0; lane < count; ++lane)
+			{
+				if ((mask & (1u << lane)) == 0) { continue; }
+
+				RaycastInput subInput = inputs[lane];
+				subInput.maxFraction = maxFractions[lane];
+
+				F32 value = Broadphase::RaycastCallback(subInput, node->userData, contexts[lane]);
+
+				// The callback has asked this ray to stop
+				if (value == 0.0f) { liveLanes &= ~(1u << lane); }
+				else if (0.0f < value && value < maxFractions[lane])
+				{
+					maxFractions[lane] = value;
+					clipped = true;
+				}
+			}
+
+			if (clipped) { rayMaxFraction = LoadW(maxFractions); }
+		}
+		else
+		{
+			stack.Push({ node->child1, mask });
+			stack.Push({ node->child2, mask });
+		}
+	}
+}
 
 I32 DynamicTree::GetHeight()
 {
@@ -734,7 +1073,7 @@ I32 DynamicTree::GetProxyCount()
 	return proxyCount;
 }
 
-I32 DynamicTree::Rebuild(bool fullBuild)
+I32 DynamicTree::Rebuild(bool fullBuild, TreeBuildHeuristic heuristic)
 {
 	if (proxyCount == 0) { return 0; }
 
@@ -746,15 +1085,22 @@ I32 DynamicTree::Rebuild(bool fullBuild)
 		Memory::Free(&leafIndices);
 		Memory::AllocateArray(&leafIndices, newCapacity);
 
+		Memory::Free(&leafBoxes);
+		Memory::AllocateArray(&leafBoxes, newCapacity);
 
 		Memory::Free(&leafCenters);
 		Memory::AllocateArray(&leafCenters, newCapacity);
+
+		Memory::Free(&binIndices);
+		Memory::AllocateArray(&binIndices, newCapacity);
+
+		Memory::Free(&internalNodes);
+		Memory::AllocateArray(&internalNodes, newCapacity);
 		rebuildCapacity = newCapacity;
 	}
 
 	I32 leafCount = 0;
-	I32 stack[TreeStackSize];
-	I32 stackCount = 0;
+	TreeStack<I32> stack;
 
 	I32 nodeIndex = root;
 	TreeNode* node = nodes + nodeIndex;
@@ -769,6 +1115,7 @@ I32 DynamicTree::Rebuild(bool fullBuild)
 		if (node->height == 0 || (node->enlarged == false && fullBuild == false))
 		{
 			leafIndices[leafCount] = nodeIndex;
+			leafBoxes[leafCount] = node->aabb;
 			leafCenters[leafCount] = node->aabb.Center();
 			leafCount += 1;
 
@@ -781,11 +1128,7 @@ I32 DynamicTree::Rebuild(bool fullBuild)
 
 			// Handle children
 			nodeIndex = node->child1;
-
-			if (stackCount < TreeStackSize)
-			{
-				stack[stackCount++] = node->child2;
-			}
+			stack.Push(node->child2);
 
 			node = nodes + nodeIndex;
 
@@ -795,13 +1138,13 @@ I32 DynamicTree::Rebuild(bool fullBuild)
 			continue;
 		}
 
-		if (stackCount == 0) { break; }
+		if (stack.Empty()) { break; }
 
-		nodeIndex = stack[--stackCount];
+		nodeIndex = stack.Pop();
 		node = nodes + nodeIndex;
 	}
 
-	root = BuildTree(leafCount);
+	root = BuildTree(leafCount, heuristic);
 
 	return leafCount;
 }
@@ -817,7 +1160,14 @@ struct RebuildItem
 	I32 endIndex;
 };
 
-I32 DynamicTree::BuildTree(I32 leafCount)
+struct RebuildRange
+{
+	I32 startIndex;
+	I32 endIndex;
+	I32 root;
+};
+
+I32 DynamicTree::BuildTree(I32 leafCount, TreeBuildHeuristic heuristic)
 {
 	if (leafCount == 1)
 	{
@@ -825,15 +1175,53 @@ I32 DynamicTree::BuildTree(I32 leafCount)
 		return leafIndices[0];
 	}
 
+	// Every internal node is allocated up front so the build never grows the pool. The leaf range [start, end) owns
+	// internalNodes [start, end - 1) and its own node is the one just left of its split, disjoint ranges can build at once
+	for (I32 i = 0; i < leafCount - 1; ++i)
+	{
+		internalNodes[i] = AllocateNode();
+	}
+
+	if (leafCount < TreeParallelLeafCount)
+	{
+		I32 root = BuildRange(0, leafCount, heuristic);
+		nodes[root].parent = NullNode;
+		return root;
+	}
+
+	Vector<I32> splits;
+	Vector<RebuildRange> ranges;
+	SplitTop(0, leafCount, heuristic, splits, ranges);
+
+	Jobs::ParallelFor(0, (U32)ranges.Size(), 1, [&](U32 start, U32 end) {
+		for (U32 i = start; i < end; ++i)
+		{
+			RebuildRange& range = ranges[i];
+			range.root = BuildRange(range.startIndex, range.endIndex, heuristic);
+		}
+	});
+
+	U32 splitIndex = 0;
+	U32 rangeIndex = 0;
+	I32 root = LinkTop(0, leafCount, splits, splitIndex, ranges, rangeIndex);
+	nodes[root].parent = NullNode;
+
+	return root;
+}
+
+I32 DynamicTree::BuildRange(I32 startIndex, I32 endIndex, TreeBuildHeuristic heuristic)
+{
+	if (endIndex - startIndex == 1) { return leafIndices[startIndex]; }
+
 	// todo large stack item
 	RebuildItem stack[TreeStackSize];
 	I32 top = 0;
 
-	stack[0].nodeIndex = AllocateNode();
 	stack[0].childCount = -1;
-	stack[0].startIndex = 0;
-	stack[0].endIndex = leafCount;
-	stack[0].splitIndex = PartitionMid(leafIndices, leafCenters, leafCount);
+	stack[0].startIndex = startIndex;
+	stack[0].endIndex = endIndex;
+	stack[0].splitIndex = Partition(startIndex, endIndex, heuristic);
+	stack[0].nodeIndex = internalNodes[stack[0].splitIndex - 1];
 
 	while (true)
 	{
@@ -875,23 +1263,23 @@ I32 DynamicTree::BuildTree(I32 leafCount)
 		}
 		else
 		{
-			I32 startIndex, endIndex;
+			I32 childStart, childEnd;
 			if (item->childCount == 0)
 			{
-				startIndex = item->startIndex;
-				endIndex = item->splitIndex;
+				childStart = item->startIndex;
+				childEnd = item->splitIndex;
 			}
 			else
 			{
-				startIndex = item->splitIndex;
-				endIndex = item->endIndex;
+				childStart = item->splitIndex;
+				childEnd = item->endIndex;
 			}
 
-			I32 count = endIndex - startIndex;
+			I32 count = childEnd - childStart;
 
 			if (count == 1)
 			{
-				I32 childIndex = leafIndices[startIndex];
+				I32 childIndex = leafIndices[childStart];
 				TreeNode* node = nodes + item->nodeIndex;
 
 				if (item->childCount == 0)
@@ -910,12 +1298,16 @@ I32 DynamicTree::BuildTree(I32 leafCount)
 			{
 				top += 1;
 				RebuildItem* newItem = stack + top;
-				newItem->nodeIndex = AllocateNode();
 				newItem->childCount = -1;
-				newItem->startIndex = startIndex;
-				newItem->endIndex = endIndex;
-				newItem->splitIndex = PartitionMid(leafIndices + startIndex, leafCenters + startIndex, count);
-				newItem->splitIndex += startIndex;
+				newItem->startIndex = childStart;
+				newItem->endIndex = childEnd;
+
+				// Lopsided partitions can nest deeper than the stack, once near the end halve the count instead,
+				// that needs at most 31 more levels for any I32 leaf count
+				if (top < TreeStackSize - 32) { newItem->splitIndex = Partition(childStart, childEnd, heuristic); }
+				else { newItem->splitIndex = childStart + count / 2; }
+
+				newItem->nodeIndex = internalNodes[newItem->splitIndex - 1];
 			}
 		}
 	}
@@ -932,6 +1324,60 @@ I32 DynamicTree::BuildTree(I32 leafCount)
 	return stack[0].nodeIndex;
 }
 
+void DynamicTree::SplitTop(I32 startIndex, I32 endIndex, TreeBuildHeuristic heuristic, Vector<I32>& splits, Vector<RebuildRange>& ranges)
+{
+	// Both lists are in preorder so LinkTop can walk them back in the same order
+	if (endIndex - startIndex <= TreeSubtreeLeafCount)
+	{
+		ranges.Push({ startIndex, endIndex, NullNode });
+		return;
+	}
+
+	I32 splitIndex = Partition(startIndex, endIndex, heuristic);
+	splits.Push(splitIndex);
+
+	SplitTop(startIndex, splitIndex, heuristic, splits, ranges);
+	SplitTop(splitIndex, endIndex, heuristic, splits, ranges);
+}
+
+I32 DynamicTree::LinkTop(I32 startIndex, I32 endIndex, const Vector<I32>& splits, U32& splitIndex, const Vector<RebuildRange>& ranges, U32& rangeIndex)
+{
+	if (endIndex - startIndex <= TreeSubtreeLeafCount) { return ranges[rangeIndex++].root; }
+
+	I32 split = splits[splitIndex++];
+	I32 nodeIndex = internalNodes[split - 1];
+
+	I32 childIndex1 = LinkTop(startIndex, split, splits, splitIndex, ranges, rangeIndex);
+	I32 childIndex2 = LinkTop(split, endIndex, splits, splitIndex, ranges, rangeIndex);
+
+	TreeNode* node = nodes + nodeIndex;
+	TreeNode* child1 = nodes + childIndex1;
+	TreeNode* child2 = nodes + childIndex2;
+
+	node->child1 = childIndex1;
+	node->child2 = childIndex2;
+	child1->parent = nodeIndex;
+	child2->parent = nodeIndex;
+
+	node->aabb = AABB::Combine(child1->aabb, child2->aabb);
+	node->height = 1 + Math::Max(child1->height, child2->height);
+	node->layers = child1->layers | child2->layers;
+
+	return nodeIndex;
+}
+
+I32 DynamicTree::Partition(I32 startIndex, I32 endIndex, TreeBuildHeuristic heuristic)
+{
+	I32 count = endIndex - startIndex;
+
+	if (heuristic == TREE_BUILD_SAH)
+	{
+		return startIndex + PartitionSAH(leafIndices + startIndex, binIndices + startIndex, leafBoxes + startIndex, count);
+	}
+
+	return startIndex + PartitionMid(leafIndices + startIndex, leafCenters + startIndex, count);
+}
+
 I32 DynamicTree::PartitionMid(I32* indices, Vector2* centers, I32 count)
 {
 	if (count <= 2) { return count / 2; }
@@ -1031,6 +1477,129 @@ I32 DynamicTree::PartitionMid(I32* indices, Vector2* centers, I32 count)
 	else { return count / 2; }
 }
 
+struct TreeBin
+{
+	AABB aabb;
+	I32 count;
+};
+
+struct TreePlane
+{
+	AABB leftAABB;
+	AABB rightAABB;
+	I32 leftCount;
+	I32 rightCount;
+};
+
+I32 DynamicTree::PartitionSAH(I32* indices, I32* bins, AABB* boxes, I32 count)
+{
+	if (count <= 2) { return count / 2; }
+
+	Vector2 lowerBound = boxes[0].Center();
+	Vector2 upperBound = lowerBound;
+
+	for (I32 i = 1; i < count; ++i)
+	{
+		Vector2 center = boxes[i].Center();
+		lowerBound = Math::Min(lowerBound, center);
+		upperBound = Math::Max(upperBound, center);
+	}
+
+	// Bin the centers along the longest axis
+	Vector2 d = upperBound - lowerBound;
+	I32 axis = d.x > d.y ? 0 : 1;
+	F32 length = axis == 0 ? d.x : d.y;
+	F32 minCenter = axis == 0 ? lowerBound.x : lowerBound.y;
+
+	// Every center is in one spot, no split is better than another
+	if (length <= 0.0f) { return count / 2; }
+
+	F32 binScale = TreeBinCount / length;
+
+	TreeBin treeBins[TreeBinCount];
+	TreePlane planes[TreeBinCount - 1];
+
+	for (I32 i = 0; i < TreeBinCount; ++i)
+	{
+		treeBins[i].aabb = { { F32_MAX, F32_MAX }, { -F32_MAX, -F32_MAX } };
+		treeBins[i].count = 0;
+	}
+
+	for (I32 i = 0; i < count; ++i)
+	{
+		Vector2 center = boxes[i].Center();
+		F32 c = axis == 0 ? center.x : center.y;
+
+		I32 binIndex = Math::Clamp((I32)(binScale * (c - minCenter)), 0, TreeBinCount - 1);
+		bins[i] = binIndex;
+		treeBins[binIndex].count += 1;
+		treeBins[binIndex].aabb = AABB::Combine(treeBins[binIndex].aabb, boxes[i]);
+	}
+
+	constexpr I32 planeCount = TreeBinCount - 1;
+
+	// Sweep from both ends so every plane knows the boxes and counts on either side of it
+	planes[0].leftCount = treeBins[0].count;
+	planes[0].leftAABB = treeBins[0].aabb;
+	for (I32 i = 1; i < planeCount; ++i)
+	{
+		planes[i].leftCount = planes[i - 1].leftCount + treeBins[i].count;
+		planes[i].leftAABB = AABB::Combine(planes[i - 1].leftAABB, treeBins[i].aabb);
+	}
+
+	planes[planeCount - 1].rightCount = treeBins[planeCount].count;
+	planes[planeCount - 1].rightAABB = treeBins[planeCount].aabb;
+	for (I32 i = planeCount - 2; i >= 0; --i)
+	{
+		planes[i].rightCount = planes[i + 1].rightCount + treeBins[i + 1].count;
+		planes[i].rightAABB = AABB::Combine(planes[i + 1].rightAABB, treeBins[i + 1].aabb);
+	}
+
+	// The cost of a split is how likely a query is to enter each side, the perimeter in 2D, times the leaves it finds there
+	F32 minCost = F32_MAX;
+	I32 bestPlane = 0;
+	for (I32 i = 0; i < planeCount; ++i)
+	{
+		if (planes[i].leftCount == 0 || planes[i].rightCount == 0) { continue; }
+
+		F32 cost = planes[i].leftCount * planes[i].leftAABB.Perimeter() + planes[i].rightCount * planes[i].rightAABB.Perimeter();
+
+		if (cost < minCost)
+		{
+			bestPlane = i;
+			minCost = cost;
+		}
+	}
+
+	// Partition using the Hoare partition scheme, bins up to bestPlane go left
+	I32 i1 = 0, i2 = count;
+	while (i1 < i2)
+	{
+		while (i1 < i2 && bins[i1] <= bestPlane)
+		{
+			i1 += 1;
+		};
+
+		while (i1 < i2 && bins[i2 - 1] > bestPlane)
+		{
+			i2 -= 1;
+		};
+
+		if (i1 < i2)
+		{
+			Swap(indices[i1], indices[i2 - 1]);
+			Swap(boxes[i1], boxes[i2 - 1]);
+			Swap(bins[i1], bins[i2 - 1]);
+
+			i1 += 1;
+			i2 -= 1;
+		}
+	}
+
+	if (i1 > 0 && i1 < count) { return i1; }
+	else { return count / 2; }
+}
+
 void DynamicTree::ShiftOrigin(Vector2 newOrigin)
 {
 	for (U32 i = 0; i < nodeCapacity; ++i)
@@ -1063,20 +1632,13 @@ I32 Broadphase::proxyCount;
 Hashset<I32> Broadphase::moveSet(16);
 Vector<I32> Broadphase::moveArray(16);
 
-MoveResult* Broadphase::moveResults;
-MovePair* Broadphase::movePairs;
-I32 Broadphase::movePairCapacity;
-I32_Atomic Broadphase::movePairIndex;
+Vector<MoveResult> Broadphase::moveResults;
 
 Hashset<U64> Broadphase::pairSet(32);
 
 void Broadphase::Initialize()
 {
 	proxyCount = 0;
-	moveResults = nullptr;
-	movePairs = nullptr;
-	movePairCapacity = 0;
-	movePairIndex = 0;
 
 	for (I32 i = 0; i < BODY_TYPE_COUNT; ++i) { trees[i].Create(); }
 }
@@ -1087,6 +1649,7 @@ void Broadphase::Shutdown()
 
 	moveSet.Destroy();
 	moveArray.Destroy();
+	moveResults.Destroy();
 	pairSet.Destroy();
 }
 
@@ -1121,7 +1684,18 @@ void Broadphase::MoveProxy(I32 proxyKey, AABB aabb)
 
 void Broadphase::UnBufferMove(I32 proxyKey)
 {
-	moveSet.Remove(proxyKey + 1);
+	if (moveSet.Remove(proxyKey + 1))
+	{
+		// Purge from move buffer. Linear search.
+		for (U64 i = 0; i < moveArray.Size(); ++i)
+		{
+			if (moveArray[i] == proxyKey)
+			{
+				moveArray.RemoveSwap(i);
+				break;
+			}
+		}
+	}
 }
 
 void Broadphase::EnlargeProxy(I32 proxyKey, AABB aabb)
@@ -1149,66 +1723,84 @@ I32 Broadphase::GetShapeIndex(I32 proxyKey)
 
 void Broadphase::Update()
 {
-	I32 moveCount = (I32)moveSet.Size();
+	I32 moveCount = (I32)moveArray.Size();
 
 	if (moveCount == 0) { return; }
 
-	// todo these could be in the step context
-	Memory::AllocateArray(&moveResults, moveCount);
-	movePairCapacity = 16 * moveCount;
+	moveResults.Resize(moveCount);
 
-	Memory::AllocateArray(&movePairs, movePairCapacity);
-	movePairIndex = 0;
+	// The allocator isn't thread safe so workers never grow their pair buffers, a proxy that runs out of room is
+	// marked and found again below once the workers are done
+	U64 pairCapacity = (U64)moveCount * 4 / Physics::taskContexts.Size() + 256;
+	for (TaskContext& taskContext : Physics::taskContexts)
+	{
+		taskContext.movePairs.Clear();
+		if (taskContext.movePairs.Capacity() < pairCapacity) { taskContext.movePairs.Reserve(pairCapacity); }
+	}
 
-	I32 minRange = 64;
-	FindPairs(0, moveCount);
+	// Each batch appends to its own worker's pairs, the results record where they went so the merge below
+	// doesn't depend on which worker ran which batch
+	U32 minRange = 64;
+	Jobs::ParallelFor(0, (U32)moveCount, minRange, [](U32 startIndex, U32 endIndex) {
+		FindPairs((I32)startIndex, (I32)endIndex, Jobs::CurrentWorker(), false);
+	});
 
-	// Single-threaded work
-	// - Clear move flags
-	// - Create contacts in deterministic order
 	for (I32 i = 0; i < moveCount; ++i)
 	{
-		MoveResult* result = moveResults + i;
-		MovePair* pair = result->pairList;
-		while (pair != nullptr)
-		{
-			I32 shapeIdA = pair->shapeIndexA;
-			I32 shapeIdB = pair->shapeIndexB;
+		if (moveResults[i].overflow) { FindPairs(i, i + 1, moveResults[i].worker, true); }
+	}
 
-			Shape& shapeA = Physics::shapes[shapeIdA];
-			Shape& shapeB = Physics::shapes[shapeIdB];
+	U64 pairCount = 0;
+	for (TaskContext& taskContext : Physics::taskContexts) { pairCount += taskContext.movePairs.Size(); }
 
-			Physics::CreateContact(shapeA, shapeB);
+	if (pairCount > 0)
+	{
+		// Grow everything contact creation touches once instead of pair by pair
+		U64 contactCount = Physics::contacts.Size() + pairCount;
+		if (contactCount > Physics::contacts.Capacity()) { Physics::contacts.Reserve(contactCount); }
 
-			if (pair->heap)
-			{
-				MovePair* temp = pair;
-				pair = pair->next;
-				Memory::Free(&temp);
-			}
-			else
+		Vector<ContactSim>& awakeContactSims = Physics::solverSets[SET_TYPE_AWAKE].contactSims;
+		U64 contactSimCount = awakeContactSims.Size() + pairCount;
+		if (contactSimCount > awakeContactSims.Capacity()) { awakeContactSims.Reserve(contactSimCount); }
+
+		pairSet.Reserve((pairSet.Size() + pairCount) * 2);
+
+		// Single-threaded work
+		// - Create contacts in deterministic order
+		for (I32 i = 0; i < moveCount; ++i)
+		{
+			const MoveResult& result = moveResults[i];
+			const MovePair* pairs = Physics::taskContexts[result.worker].movePairs.Data() + result.pairStart;
+
+			for (U32 j = 0; j < result.pairCount; ++j)
 			{
-				pair = pair->next;
+				Shape& shapeA = Physics::shapes[pairs[j].shapeIndexA];
+				Shape& shapeB = Physics::shapes[pairs[j].shapeIndexB];
+
+				Physics::CreateContact(shapeA, shapeB);
 			}
 		}
 	}
 
 	// Reset move buffer
 	moveSet.Clear();
-
-	Memory::Free(&movePairs);
-	Memory::Free(&moveResults);
+	moveArray.Clear();
 }
 
-void Broadphase::FindPairs(I32 startIndex, I32 endIndex)
+void Broadphase::FindPairs(I32 startIndex, I32 endIndex, U32 worker, bool canGrow)
 {
 	QueryPairContext queryContext;
+	queryContext.pairs = &Physics::taskContexts[worker].movePairs;
+	queryContext.canGrow = canGrow;
 
 	for (I32 i = startIndex; i < endIndex; ++i)
 	{
 		// Initialize move result for this moved proxy
-		queryContext.moveResult = moveResults + i;
-		queryContext.moveResult->pairList = nullptr;
+		queryContext.moveResult = moveResults.Data() + i;
+		queryContext.moveResult->worker = worker;
+		queryContext.moveResult->pairStart = (U32)queryContext.pairs->Size();
+		queryContext.moveResult->pairCount = 0;
+		queryContext.moveResult->overflow = false;
 
 		I32 proxyKey = moveArray[i];
 		if (proxyKey == NullIndex) { continue; }
@@ -1225,6 +1817,9 @@ void Broadphase::FindPairs(I32 startIndex, I32 endIndex)
 		AABB fatAABB = baseTree->GetAABB(proxyId);
 		queryContext.queryShapeIndex = baseTree->GetUserData(proxyId);
 
+		// Moving sensors have nothing to pair with
+		if (Physics::shapes[queryContext.queryShapeIndex].isSensor) { continue; }
+
 		// Query trees. Only dynamic proxies collide with kinematic and static proxies.
 		// Using b2_defaultMaskBits so that b2Filter::groupIndex works.
 		if (proxyType == BODY_TYPE_DYNAMIC)
@@ -1234,13 +1829,40 @@ void Broadphase::FindPairs(I32 startIndex, I32 endIndex)
 			trees[BODY_TYPE_KINEMATIC].Query(fatAABB, U64_MAX, queryContext);
 
 			queryContext.queryTreeType = BODY_TYPE_STATIC;
-			trees[BODY_TYPE_STATIC].Query(fatAABB, U64_MAX, queryContext);
+			if (!queryContext.moveResult->overflow) { trees[BODY_TYPE_STATIC].Query(fatAABB, U64_MAX, queryContext); }
 		}
 
 		// All proxies collide with dynamic proxies
 		// Using b2_defaultMaskBits so that b2Filter::groupIndex works.
 		queryContext.queryTreeType = BODY_TYPE_DYNAMIC;
-		trees[BODY_TYPE_DYNAMIC].Query(fatAABB, U64_MAX, queryContext);
+		if (!queryContext.moveResult->overflow) { trees[BODY_TYPE_DYNAMIC].Query(fatAABB, U64_MAX, queryContext); }
+
+		if (queryContext.moveResult->overflow) { continue; }
+
+		// Tree order depends on how the trees happened to be built, shape order only on the world
+		if (Physics::deterministic)
+		{
+			SortPairs(queryContext.pairs->Data() + queryContext.moveResult->pairStart, queryContext.moveResult->pairCount);
+		}
+	}
+}
+
+// Insertion sort, a moved proxy rarely finds more than a few new pairs
+void Broadphase::SortPairs(MovePair* pairs, U32 count)
+{
+	for (U32 i = 1; i < count; ++i)
+	{
+		MovePair pair = pairs[i];
+		U32 j = i;
+
+		while (j > 0 && (pairs[j - 1].shapeIndexA > pair.shapeIndexA ||
+			(pairs[j - 1].shapeIndexA == pair.shapeIndexA && pairs[j - 1].shapeIndexB > pair.shapeIndexB)))
+		{
+			pairs[j] = pairs[j - 1];
+			--j;
+		}
+
+		pairs[j] = pair;
 	}
 }
 
@@ -1287,8 +1909,8 @@ bool Broadphase::PairQueryCallback(I32 proxyId, I32 shapeId, QueryPairContext& c
 
 	if (!shapeA.filter.ShouldShapesCollide(shapeB.filter)) { return true; }
 
-	// Sensors don't collide with other sensors
-	if (shapeA.isSensor && shapeB.isSensor) { return true; }
+	// Sensor overlaps are found by the sensor pass, they never make contacts
+	if (shapeA.isSensor || shapeB.isSensor) { return true; }
 
 	// Does a joint override collision?
 	RigidBody2D& bodyA = Physics::rigidBodies[bodyIdA];
@@ -1302,25 +1924,14 @@ bool Broadphase::PairQueryCallback(I32 proxyId, I32 shapeId, QueryPairContext& c
 	//	if (!shouldCollide) { return true; }
 	//}
 
-	// #todo per thread to eliminate atomic?
-	I32 pairIndex = movePairIndex.fetch_add(1);
-
-	MovePair* pair;
-	if (pairIndex < movePairCapacity)
-	{
-		pair = movePairs + pairIndex;
-		pair->heap = false;
-	}
-	else
+	if (!context.canGrow && context.pairs->Size() == context.pairs->Capacity())
 	{
-		Memory::Allocate(&pair);
-		pair->heap = true;
+		context.moveResult->overflow = true;
+		return false;
 	}
 
-	pair->shapeIndexA = shapeIdA;
-	pair->shapeIndexB = shapeIdB;
-	pair->next = context.moveResult->pairList;
-	context.moveResult->pairList = pair;
+	context.pairs->Push({ shapeIdA, shapeIdB });
+	context.moveResult->pairCount += 1;
 
 	// continue the query
 	return true;
@@ -1406,6 +2017,48 @@ bool Broadphase::ContinuousQueryCallback(int shapeId, ContinuousContext& context
 	return true;
 }
 
+F32 Broadphase::RaycastCallback(const RaycastInput& input, I32 shapeId, WorldCastContext& context)
+{
+	Shape& shape = Physics::shapes[shapeId];
+
+	// Sensors don't block casts, a negative return filters the shape without clipping
+	if (shape.isSensor || !shape.filter.ShouldShapesCollide(context.filter)) { return -1.0f; }
+
+	RigidBody2D& body = Physics::rigidBodies[shape.bodyId];
+	Transform2D transform = Physics::GetBodySim(body).transform;
+
+	CastOutput output = Physics::RaycastShape(input, shape, transform);
+	if (!output.hit) { return -1.0f; }
+
+	RaycastResult result = { shape.id + 1, shape.bodyId, output.point, output.normal, output.fraction, true };
+
+	// Collecting every hit, keep the full length of the ray
+	if (context.results) { context.results->Push(result); return input.maxFraction; }
+
+	context.closest = result;
+	return output.fraction;
+}
+
+F32 Broadphase::ShapecastCallback(const ShapeCastInput& input, I32 shapeId, WorldCastContext& context)
+{
+	Shape& shape = Physics::shapes[shapeId];
+
+	if (shape.isSensor || !shape.filter.ShouldShapesCollide(context.filter)) { return -1.0f; }
+
+	RigidBody2D& body = Physics::rigidBodies[shape.bodyId];
+	Transform2D transform = Physics::GetBodySim(body).transform;
+
+	CastOutput output = Physics::ShapeCastShape(input, shape, transform);
+	if (!output.hit) { return -1.0f; }
+
+	RaycastResult result = { shape.id + 1, shape.bodyId, output.point, output.normal, output.fraction, true };
+
+	if (context.results) { context.results->Push(result); return input.maxFraction; }
+
+	context.closest = result;
+	return output.fraction;
+}
+
 DistanceProxy Broadphase::MakeProxy(const Vector2* vertices, I32 count, F32 radius)
 {
 	count = Math::Min(count, (I32)MaxPolygonVertices);
@@ -1433,5 +2086,6 @@ bool Broadphase::TestOverlap(I32 proxyKeyA, I32 proxyKeyB)
 
 void Broadphase::BufferMove(I32 queryProxy)
 {
-	moveSet.Insert(queryProxy);
+	// Adding 1 to match the lookups in UnBufferMove and PairQueryCallback
+	if (moveSet.Insert(queryProxy + 1)) { moveArray.Push(queryProxy); }
 }
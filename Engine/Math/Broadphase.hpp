@@ -29,6 +29,49 @@
 static constexpr inline I32 NullNode = -1;
 static constexpr inline U64 DefaultLayerMask = U64_MAX;
 
+// Game code issues casts in bulk, they walk the tree with a fixed stack instead of allocating one per cast
+static constexpr inline I32 TreeStackSize = 1024;
+
+/*
+* Tree traversal stack, it stays on the stack and only moves to the heap if a degenerate tree outgrows TreeStackSize
+* Dropping children once full would silently skip whole subtrees
+*/
+template<class Type>
+struct TreeStack
+{
+	TreeStack() = default;
+	~TreeStack() { if (data != local) { Memory::Free(&data); } }
+
+	TreeStack(const TreeStack&) = delete;
+	TreeStack& operator=(const TreeStack&) = delete;
+
+	void Push(const Type& value)
+	{
+		if (size == capacity)
+		{
+			Type* grown;
+			Memory::AllocateArray(&grown, (U64)capacity * 2);
+			Copy(grown, data, size);
+
+			if (data != local) { Memory::Free(&data); }
+
+			data = grown;
+			capacity *= 2;
+		}
+
+		data[size++] = value;
+	}
+
+	Type Pop() { return data[--size]; }
+	bool Empty() const { return size == 0; }
+
+private:
+	Type local[TreeStackSize];
+	Type* data = local;
+	I32 size = 0;
+	I32 capacity = TreeStackSize;
+};
+
 enum RotateType
 {
 	ROTATE_TYPE_NONE,
@@ -38,6 +81,14 @@ enum RotateType
 	ROTATE_TYPE_CE
 };
 
+enum TreeBuildHeuristic
+{
+	TREE_BUILD_SAH,		// Binned surface area heuristic, slower to build but cheaper to query
+	TREE_BUILD_MEDIAN,	// Splits the longest axis at the middle of the leaf centers
+};
+
+struct RebuildRange;
+
 struct TreeNode
 {
 	AABB aabb;
@@ -57,7 +108,7 @@ struct TreeNode
 	bool enlarged;
 };
 
-struct DynamicTree
+struct NH_API DynamicTree
 {
 public:
 	void Create();
@@ -77,17 +128,24 @@ public:
 	bool AABBOverlaps(AABB a, AABB b);
 	void Query(const AABB& aabb, U64 layerMask, QueryPairContext& context);
 	void QueryContinuous(const AABB& aabb, U64 layerMask, ContinuousContext& context);
-	void Raycast(RaycastInput input, U64 layerMask);
-	void Shapecast(ShapeCastInput input, U64 layerMask);
+	void Raycast(const RaycastInput& input, U64 layerMask, WorldCastContext& context);
+	void Shapecast(const ShapeCastInput& input, U64 layerMask, WorldCastContext& context);
+	bool QueryPacket(const AABB* boxes, U32 count, U64 layerMask, Vector<PacketHit>& hits, bool canGrow);
+	void RaycastPacket(const RaycastInput* inputs, U32 count, U64 layerMask, WorldCastContext* contexts);
 	I32 GetHeight();
 	I32 ComputeHeight(I32 nodeId);
 	I32 ComputeHeight();
 	I32 GetMaxBalance();
 	F32 GetAreaRatio();
 	I32 GetProxyCount();
-	I32 Rebuild(bool fullBuild);
-	I32 BuildTree(I32 leafCount);
+	I32 Rebuild(bool fullBuild, TreeBuildHeuristic heuristic = TREE_BUILD_SAH);
+	I32 BuildTree(I32 leafCount, TreeBuildHeuristic heuristic);
+	I32 BuildRange(I32 startIndex, I32 endIndex, TreeBuildHeuristic heuristic);
+	void SplitTop(I32 startIndex, I32 endIndex, TreeBuildHeuristic heuristic, Vector<I32>& splits, Vector<RebuildRange>& ranges);
+	I32 LinkTop(I32 startIndex, I32 endIndex, const Vector<I32>& splits, U32& splitIndex, const Vector<RebuildRange>& ranges, U32& rangeIndex);
+	I32 Partition(I32 startIndex, I32 endIndex, TreeBuildHeuristic heuristic);
 	I32 PartitionMid(I32* indices, Vector2* centers, I32 count);
+	I32 PartitionSAH(I32* indices, I32* bins, AABB* boxes, I32 count);
 	void ShiftOrigin(Vector2 newOrigin);
 	I32 GetUserData(I32 proxyId) const;
 	AABB GetAABB(I32 proxyId) const;
@@ -103,6 +161,7 @@ public:
 	AABB* leafBoxes;
 	Vector2* leafCenters;
 	I32* binIndices;
+	I32* internalNodes;
 	I32 rebuildCapacity;
 };
 
@@ -113,9 +172,12 @@ private:
 	static void Shutdown();
 
 	static void Update();
-	static void FindPairs(I32 startIndex, I32 endIndex);
+	static void FindPairs(I32 startIndex, I32 endIndex, U32 worker, bool canGrow);
+	static void SortPairs(MovePair* pairs, U32 count);
 	static bool PairQueryCallback(I32 proxyId, I32 shapeId, QueryPairContext& context);
 	static bool ContinuousQueryCallback(I32 shapeId, ContinuousContext& context);
+	static F32 RaycastCallback(const RaycastInput& input, I32 shapeId, WorldCastContext& context);
+	static F32 ShapecastCallback(const ShapeCastInput& input, I32 shapeId, WorldCastContext& context);
 	static DistanceProxy MakeProxy(const Vector2* vertices, I32 count, F32 radius);
 
 	static I32 CreateProxy(BodyType proxyType, AABB aabb, U64 categoryBits, I32 shapeIndex, bool forcePairCreation);
@@ -134,10 +196,7 @@ private:
 	static Hashset<I32> moveSet;
 	static Vector<I32> moveArray;
 
-	static MoveResult* moveResults;
-	static MovePair* movePairs;
-	static I32 movePairCapacity;
-	static I32_Atomic movePairIndex;
+	static Vector<MoveResult> moveResults;
 
 	static Hashset<U64> pairSet;
 
@@ -1,3 +1,7 @@
+#include "Defines.hpp"
+
+NH_STRICT_FLOAT
+
 #include "Manifold.hpp"
 
 #include "Physics.hpp"
@@ -18,12 +18,20 @@
 * 3. This notice may not be removed or altered from any source distribution.
 */
 
+#include "Defines.hpp"
+
+NH_STRICT_FLOAT
+
 #include "Physics.hpp"
 
 #include "Island.hpp"
 #include "Broadphase.hpp"
 
 #include "Core\Logger.hpp"
+#include "Core\Profiler.hpp"
+#include "Core\Time.hpp"
+#include "Platform\CpuFeatures.hpp"
+#include "Platform\Jobs.hpp"
 #include "Resources\Scene.hpp"
 #include "Containers\Vector.hpp"
 #include "Containers\Freelist.hpp"
@@ -49,7 +57,9 @@ Freelist Physics::shapeFreelist(256);
 Vector<Shape> Physics::shapes(16);
 Freelist Physics::chainFreelist(256);
 Vector<ChainShape> Physics::chains(4);
-Vector<TaskContext> Physics::taskContexts(1); //worker count
+Vector<Sensor> Physics::sensors;
+Vector<I32> Physics::sensorMoves;
+Vector<TaskContext> Physics::taskContexts;
 Vector<BodyMoveEvent> Physics::bodyMoveEvents(4);
 Vector<SensorBeginTouchEvent> Physics::sensorBeginEvents(4);
 Vector<SensorEndTouchEvent> Physics::sensorEndEvents(4);
@@ -57,7 +67,8 @@ Vector<ContactBeginTouchEvent> Physics::contactBeginEvents(4);
 Vector<ContactEndTouchEvent> Physics::contactEndEvents(4);
 Vector<ContactHitEvent> Physics::contactHitEvents(4);
 U64 Physics::stepIndex = 0;
-I32 Physics::splitIslandId = NullIndex;
+Vector<I32> Physics::splitIslandIds;
+Vector<IslandSplit> Physics::islandSplits;
 Vector2 Physics::gravity = Vector2{ 0.0f, -9.8f };
 F32 Physics::hitEventThreshold = 1.0f;
 F32 Physics::restitutionThreshold = 1.0f;
@@ -68,7 +79,7 @@ F32 Physics::contactDampingRatio = 10.0f;
 F32 Physics::jointHertz = 60.0f;
 F32 Physics::jointDampingRatio = 2.0f;
 U16 Physics::revision;
-I32 Physics::workerCount = 1;
+I32 Physics::workerCount = 0;
 void* Physics::userTreeTask = nullptr;
 F32 Physics::inv_h;
 I32 Physics::activeTaskCount = 0;
@@ -79,30 +90,53 @@ bool Physics::enableWarmStarting = true;
 bool Physics::enableContinuous = true;
 bool Physics::paused = false;
 bool Physics::singleStep = false;
+bool Physics::deterministic = false;
+bool Physics::enableManifoldReuse = true;
 int Physics::subStepCount = 4;
+F32 Physics::fixedTimeStep = 1.0f / 60.0f;
+F64 Physics::accumulator = 0.0;
+F32 Physics::interpolationAlpha = 1.0f;
+I32 Physics::maxStepsPerFrame = 8;
+U64 Physics::stateHash = 0;
+PhysicsProfile Physics::profile{};
+Physics::SolveContactsKernel Physics::solveContacts = Physics::SolveContactsTask;
 
-bool Physics::Initialize()
+bool Physics::Initialize(F32 stepRate, I32 subSteps, I32 maxSteps)
 {
 	Logger::Trace("Initializing Physics...");
 
+	SetStepRate(stepRate);
+	SetSubStepCount(subSteps);
+	SetMaxStepsPerFrame(maxSteps);
+
+	// A 4 wide build still solves contacts 8 wide when the CPU has AVX2
+#ifdef NH_SIMD_PAIR
+	solveContacts = CpuFeatures::Has(CPU_FEATURE_AVX2) ? SolveContactPairsTask : SolveContactsTask;
+#endif
+
 	Broadphase::Initialize();
 	constraintGraph.Create(16);
 
 	SolverSet set{};
-	set.setIndex = solverSetFreelist.GetFree();
+	set.setIndex = solverSetFreelist.GetFreeOrGrow();
 	solverSets.Push(set);
 
-	set.setIndex = solverSetFreelist.GetFree();
+	set.setIndex = solverSetFreelist.GetFreeOrGrow();
 	solverSets.Push(set);
 
-	set.setIndex = solverSetFreelist.GetFree();
+	set.setIndex = solverSetFreelist.GetFreeOrGrow();
 	solverSets.Push(set);
 
+	// One context per job worker, tasks index them with Jobs::CurrentWorker
+	workerCount = (I32)Jobs::WorkerCount();
+	taskContexts.Resize(workerCount);
+
 	for (int i = 0; i < workerCount; ++i)
 	{
 		taskContexts[i].contactStateBitset.Create(1024);
 		taskContexts[i].enlargedSimBitset.Create(256);
 		taskContexts[i].awakeIslandBitset.Create(256);
+		taskContexts[i].splitIslandBitset.Create(256);
 	}
 
 	return true;
@@ -117,8 +151,29 @@ void Physics::Shutdown()
 		taskContexts[i].contactStateBitset.Destroy();
 		taskContexts[i].enlargedSimBitset.Destroy();
 		taskContexts[i].awakeIslandBitset.Destroy();
+		taskContexts[i].splitIslandBitset.Destroy();
+		taskContexts[i].movePairs.Destroy();
+		taskContexts[i].continuousContexts.Destroy();
+		taskContexts[i].continuousBoxes.Destroy();
+		taskContexts[i].continuousHits.Destroy();
+		taskContexts[i].sensorHits.Destroy();
+		taskContexts[i].touchedSensors.Destroy();
+		taskContexts[i].queryHits.Destroy();
+	}
+
+	for (IslandSplit& split : islandSplits)
+	{
+		split.seeds.Destroy();
+		split.stack.Destroy();
+		split.bodies.Destroy();
+		split.contacts.Destroy();
+		split.joints.Destroy();
+		split.components.Destroy();
 	}
 
+	islandSplits.Destroy();
+	splitIslandIds.Destroy();
+
 	taskContexts.Destroy();
 	bodyMoveEvents.Destroy();
 	sensorBeginEvents.Destroy();
@@ -134,6 +189,8 @@ void Physics::Shutdown()
 
 	shapes.Destroy();
 	chains.Destroy();
+	sensors.Destroy();
+	sensorMoves.Destroy();
 	contacts.Destroy();
 	joints.Destroy();
 	islands.Destroy();
@@ -158,19 +215,435 @@ void Physics::Shutdown()
 	chainFreelist.Destroy();
 }
 
-void Physics::Update(F32 step)
+void Physics::Update(F64 deltaTime)
 {
+	EnableSleeping(enableSleep);
+	EnableWarmStarting(enableWarmStarting);
+	EnableContinuous(enableContinuous);
+
+	// Events are gathered over every step this frame
+	bodyMoveEvents.Clear();
+	sensorBeginEvents.Clear();
+	sensorEndEvents.Clear();
+	contactBeginEvents.Clear();
+	contactEndEvents.Clear();
+	contactHitEvents.Clear();
+
 	if (paused)
 	{
-		if (singleStep) { singleStep = false; }
-		else { step = 0.0f; }
+		accumulator = 0.0;
+		interpolationAlpha = 1.0f;
+
+		if (singleStep)
+		{
+			singleStep = false;
+			StorePreviousTransforms();
+			Step(fixedTimeStep, subStepCount);
+		}
+
+		return;
 	}
 
-	EnableSleeping(enableSleep);
-	EnableWarmStarting(enableWarmStarting);
-	EnableContinuous(enableContinuous);
+	accumulator += deltaTime;
+
+	I32 stepCount = 0;
+	while (accumulator >= fixedTimeStep && stepCount < maxStepsPerFrame)
+	{
+		StorePreviousTransforms();
+		Step(fixedTimeStep, subStepCount);
+
+		accumulator -= fixedTimeStep;
+		++stepCount;
+	}
+
+	// Too far behind, drop the time instead of trying to catch up next frame
+	if (accumulator >= fixedTimeStep) { accumulator = 0.0; }
+
+	interpolationAlpha = (F32)(accumulator / fixedTimeStep);
+}
+
+void Physics::StorePreviousTransforms()
+{
+	for (BodySim& sim : solverSets[SET_TYPE_AWAKE].bodySims)
+	{
+		sim.previousTransform = sim.transform;
+	}
+}
+
+void Physics::SetStepRate(F32 stepsPerSecond)
+{
+	fixedTimeStep = 1.0f / Math::Max(stepsPerSecond, 1.0f);
+}
+
+void Physics::SetSubStepCount(I32 count)
+{
+	subStepCount = Math::Max(count, 1);
+}
+
+void Physics::SetMaxStepsPerFrame(I32 count)
+{
+	maxStepsPerFrame = Math::Max(count, 1);
+}
+
+F32 Physics::InterpolationAlpha()
+{
+	return interpolationAlpha;
+}
+
+Transform2D Physics::InterpolatedTransform(I32 bodyId)
+{
+	RigidBody2D& body = rigidBodies[bodyId];
+	const BodySim& sim = GetBodySim(body);
+
+	// Only awake bodies moved during the last step
+	if (body.setIndex != SET_TYPE_AWAKE) { return sim.transform; }
+
+	Transform2D transform;
+	transform.position = Math::Lerp(sim.previousTransform.position, sim.transform.position, interpolationAlpha);
+	transform.rotation = sim.previousTransform.rotation.NLerp(sim.transform.rotation, interpolationAlpha);
+
+	return transform;
+}
+
+// Snapshots are flat, each array is its element count followed by its raw bytes, so restoring is a handful of memcpys
+static constexpr U32 SnapshotMagic = 0x504E484E;
+static constexpr U32 SnapshotVersion = 5;
+
+template<class... Types>
+static constexpr U64 SnapshotLayout()
+{
+	U64 layout = 0;
+	((layout = layout * 31 + sizeof(Types)), ...);
+	return layout;
+}
+
+struct SnapshotHeader
+{
+	U32 magic;
+	U32 version;
+	U64 layout;	// Changes whenever a saved struct changes size, snapshots from another build are rejected instead of misread
+	U64 size;
+};
+
+static constexpr U64 SnapshotStructLayout = SnapshotLayout<RigidBody2D, Shape, ChainShape, Contact, ContactSim, Joint, JointSim,
+	Island, IslandSim, BodySim, BodyState, TreeNode, SolverSet, GraphColor>();
+
+struct SnapshotWriter
+{
+	template<class Type> void Write(const Type& value) { Write(&value, 1); }
+
+	template<class Type> void Write(const Type* values, U64 count)
+	{
+		U64 bytes = sizeof(Type) * count;
+		if (data && bytes) { Copy(data + size, (const U8*)values, bytes); }
+		size += bytes;
+	}
+
+	template<class Type> void WriteVector(const Vector<Type>& vector)
+	{
+		Write(vector.Size());
+		Write(vector.Data(), vector.Size());
+	}
+
+	template<class Type> void WriteSet(Hashset<Type>& set)
+	{
+		Write(set.Size());
+
+		if (!data) { size += sizeof(Type) * set.Size(); return; }
+
+		for (auto it = set.begin(), end = set.end(); it != end; ++it)
+		{
+			if (it.Valid()) { Write(*it); }
+		}
+	}
+
+	void WriteFreelist(const Freelist& freelist)
+	{
+		Write(freelist.Capacity());
+		Write(freelist.Size());
+		Write(freelist.Last());
+		Write(freelist.FreeCount());
+		Write(freelist.FreeIndices(), freelist.FreeCount());
+	}
+
+	// Null only measures, the buffer is sized once and then written
+	U8* data;
+	U64 size;
+};
+
+struct SnapshotReader
+{
+	template<class Type> void Read(Type& value) { Read(&value, 1); }
+
+	template<class Type> void Read(Type* values, U64 count)
+	{
+		U64 bytes = sizeof(Type) * count;
+		if (bytes) { Copy((U8*)values, data + size, bytes); }
+		size += bytes;
+	}
+
+	// Resize doesn't construct, the elements are plain data and are overwritten straight away
+	template<class Type> void ReadVector(Vector<Type>& vector)
+	{
+		U64 count;
+		Read(count);
+		vector.Resize(count);
+		Read(vector.Data(), count);
+	}
+
+	template<class Type> void ReadSet(Hashset<Type>& set)
+	{
+		U64 count;
+		Read(count);
+
+		set.Clear();
+		set.Reserve(count);
+
+		for (U64 i = 0; i < count; ++i)
+		{
+			Type value;
+			Read(value);
+			set.Insert(value);
+		}
+	}
+
+	void ReadFreelist(Freelist& freelist)
+	{
+		U32 capacity, used, lastFree, freeCount;
+		Read(capacity);
+		Read(used);
+		Read(lastFree);
+		Read(freeCount);
+
+		freelist.Restore(capacity, used, lastFree, (const U32*)(data + size), freeCount);
+		size += sizeof(U32) * freeCount;
+	}
+
+	const U8* data;
+	U64 size;
+};
+
+void Physics::Snapshot(Vector<U8>& buffer)
+{
+	PROFILE_ZONE("Physics Snapshot");
+
+	SnapshotWriter writer{ nullptr, 0 };
+	WriteSnapshot(writer);
+
+	buffer.Resize(writer.size);
+
+	writer = { buffer.Data(), 0 };
+	WriteSnapshot(writer);
+}
+
+void Physics::WriteSnapshot(SnapshotWriter& writer)
+{
+	writer.Write(SnapshotHeader{ SnapshotMagic, SnapshotVersion, SnapshotStructLayout, 0 });
+
+	writer.WriteFreelist(rigidBodyFreelist);
+	writer.WriteVector(rigidBodies);
+	writer.WriteFreelist(shapeFreelist);
+	writer.WriteVector(shapes);
+	writer.WriteFreelist(chainFreelist);
+	writer.WriteVector(chains);
+
+	for (const ChainShape& chain : chains)
+	{
+		U64 count = chain.shapeIndices ? chain.count : 0;
+		writer.Write(count);
+		writer.Write(chain.shapeIndices, count);
+	}
+
+	// Only the current overlaps matter, the next pass swaps them into overlaps1
+	writer.Write(sensors.Size());
+
+	for (const Sensor& sensor : sensors)
+	{
+		writer.Write(sensor.shapeId);
+		writer.Write(sensor.rebuild);
+		writer.WriteVector(sensor.overlaps2);
+	}
+
+	writer.WriteFreelist(contactFreelist);
+	writer.WriteVector(contacts);
+	writer.WriteFreelist(jointFreelist);
+	writer.WriteVector(joints);
+	writer.WriteFreelist(islandFreelist);
+	writer.WriteVector(islands);
+
+	writer.WriteFreelist(solverSetFreelist);
+	writer.Write(solverSets.Size());
+
+	for (const SolverSet& set : solverSets)
+	{
+		writer.Write(set.setIndex);
+		writer.WriteVector(set.bodySims);
+		writer.WriteVector(set.bodyStates);
+		writer.WriteVector(set.jointSims);
+		writer.WriteVector(set.contactSims);
+		writer.WriteVector(set.islandSims);
+	}
+
+	for (const GraphColor& color : constraintGraph.colors)
+	{
+		writer.Write(color.bodySet.blockCount);
+		writer.Write(color.bodySet.bits, color.bodySet.blockCount);
+		writer.WriteVector(color.contactSims);
+		writer.WriteVector(color.jointSims);
+	}
+
+	for (const DynamicTree& tree : Broadphase::trees)
+	{
+		writer.Write(tree.root);
+		writer.Write(tree.nodeCount);
+		writer.Write(tree.nodeCapacity);
+		writer.Write(tree.freeList);
+		writer.Write(tree.proxyCount);
+		writer.Write(tree.nodes, tree.nodeCapacity);
+	}
+
+	writer.Write(Broadphase::proxyCount);
+	writer.WriteVector(Broadphase::moveArray);
+	writer.WriteSet(Broadphase::moveSet);
+	writer.WriteSet(Broadphase::pairSet);
+
+	writer.Write(stepIndex);
+	writer.WriteVector(splitIslandIds);
+	writer.Write(revision);
+	writer.Write(accumulator);
+	writer.Write(interpolationAlpha);
+	writer.Write(stateHash);
+
+	// The total size is only known once everything is measured, patch it into the header
+	if (writer.data) { ((SnapshotHeader*)writer.data)->size = writer.size; }
+}
+
+bool Physics::Restore(const Vector<U8>& buffer)
+{
+	PROFILE_ZONE("Physics Restore");
+
+	if (locked) { Logger::Error("Can't Restore Physics While It's Stepping!"); return false; }
+
+	SnapshotHeader header{};
+	if (buffer.Size() >= sizeof(SnapshotHeader)) { Copy((U8*)&header, buffer.Data(), sizeof(SnapshotHeader)); }
+
+	if (header.magic != SnapshotMagic || header.version != SnapshotVersion || header.layout != SnapshotStructLayout || header.size != buffer.Size())
+	{
+		Logger::Error("Invalid Physics Snapshot!");
+		return false;
+	}
+
+	SnapshotReader reader{ buffer.Data(), sizeof(SnapshotHeader) };
+
+	for (ChainShape& chain : chains) { Memory::Free(&chain.shapeIndices); }
+
+	reader.ReadFreelist(rigidBodyFreelist);
+	reader.ReadVector(rigidBodies);
+	reader.ReadFreelist(shapeFreelist);
+	reader.ReadVector(shapes);
+	reader.ReadFreelist(chainFreelist);
+	reader.ReadVector(chains);
+
+	for (ChainShape& chain : chains)
+	{
+		U64 count;
+		reader.Read(count);
+
+		chain.shapeIndices = nullptr;
+		if (count)
+		{
+			Memory::AllocateArray(&chain.shapeIndices, count);
+			reader.Read(chain.shapeIndices, count);
+		}
+	}
+
+	U64 sensorCount;
+	reader.Read(sensorCount);
+
+	sensors.Clear();
+	for (U64 i = 0; i < sensorCount; ++i)
+	{
+		Sensor& sensor = sensors.Push({});
+		reader.Read(sensor.shapeId);
+		reader.Read(sensor.rebuild);
+		reader.ReadVector(sensor.overlaps2);
+		sensor.nearby = true;
+	}
+
+	reader.ReadFreelist(contactFreelist);
+	reader.ReadVector(contacts);
+	reader.ReadFreelist(jointFreelist);
+	reader.ReadVector(joints);
+	reader.ReadFreelist(islandFreelist);
+	reader.ReadVector(islands);
+
+	reader.ReadFreelist(solverSetFreelist);
+
+	U64 setCount;
+	reader.Read(setCount);
 
-	Step(step, subStepCount);
+	// Sets own their arrays, free the extra ones and construct the new ones so the arrays below are reused where possible
+	for (U64 i = setCount; i < solverSets.Size(); ++i) { solverSets[i].Destroy(); }
+	U64 oldSetCount = solverSets.Size();
+	solverSets.Resize(setCount);
+	for (U64 i = oldSetCount; i < setCount; ++i) { Construct(solverSets.Data() + i); }
+
+	for (SolverSet& set : solverSets)
+	{
+		reader.Read(set.setIndex);
+		reader.ReadVector(set.bodySims);
+		reader.ReadVector(set.bodyStates);
+		reader.ReadVector(set.jointSims);
+		reader.ReadVector(set.contactSims);
+		reader.ReadVector(set.islandSims);
+	}
+
+	for (GraphColor& color : constraintGraph.colors)
+	{
+		U64 blockCount;
+		reader.Read(blockCount);
+		color.bodySet.GrowBitSet(blockCount);
+		reader.Read(color.bodySet.bits, blockCount);
+		reader.ReadVector(color.contactSims);
+		reader.ReadVector(color.jointSims);
+	}
+
+	for (DynamicTree& tree : Broadphase::trees)
+	{
+		U32 nodeCapacity;
+		reader.Read(tree.root);
+		reader.Read(tree.nodeCount);
+		reader.Read(nodeCapacity);
+		reader.Read(tree.freeList);
+		reader.Read(tree.proxyCount);
+
+		// The pool can be bigger than the saved capacity, only the saved nodes are in the free list so it grows the same way it did
+		if (nodeCapacity > tree.nodeCapacity) { Memory::Reallocate(&tree.nodes, nodeCapacity); }
+		tree.nodeCapacity = nodeCapacity;
+		reader.Read(tree.nodes, nodeCapacity);
+	}
+
+	reader.Read(Broadphase::proxyCount);
+	reader.ReadVector(Broadphase::moveArray);
+	reader.ReadSet(Broadphase::moveSet);
+	reader.ReadSet(Broadphase::pairSet);
+
+	reader.Read(stepIndex);
+	reader.ReadVector(splitIslandIds);
+	reader.Read(revision);
+	reader.Read(accumulator);
+	reader.Read(interpolationAlpha);
+	reader.Read(stateHash);
+
+	// Events belong to the steps that were undone
+	bodyMoveEvents.Clear();
+	sensorBeginEvents.Clear();
+	sensorEndEvents.Clear();
+	contactBeginEvents.Clear();
+	contactEndEvents.Clear();
+	contactHitEvents.Clear();
+
+	return true;
 }
 
 ConvexPolygon Physics::CreatePolygon(const Hull& hull, F32 radius)
@@ -491,9 +964,10 @@ MassData Physics::ComputePolygonMass(const ConvexPolygon& shape, F32 density)
 
 Shape& Physics::CreateCircleShape(RigidBody2D& body, const Transform2D& transform, const ShapeDef& def, const Circle& geometry)
 {
-	int shapeId = shapeFreelist.GetFree();
+	int shapeId = shapeFreelist.GetFreeOrGrow();
 
 	if (shapeId == shapes.Size()) { shapes.Push({ def }); }
+	else { shapes[shapeId] = { def }; }
 
 	Shape& shape = shapes[shapeId];
 
@@ -509,9 +983,10 @@ Shape& Physics::CreateCircleShape(RigidBody2D& body, const Transform2D& transfor
 
 Shape& Physics::CreateCapsuleShape(RigidBody2D& body, const Transform2D& transform, const ShapeDef& def, const Capsule& geometry)
 {
-	int shapeId = shapeFreelist.GetFree();
+	int shapeId = shapeFreelist.GetFreeOrGrow();
 
 	if (shapeId == shapes.Size()) { shapes.Push({ def }); }
+	else { shapes[shapeId] = { def }; }
 
 	Shape& shape = shapes[shapeId];
 
@@ -527,9 +1002,10 @@ Shape& Physics::CreateCapsuleShape(RigidBody2D& body, const Transform2D& transfo
 
 Shape& Physics::CreateConvexPolygonShape(RigidBody2D& body, const Transform2D& transform, const ShapeDef& def, const ConvexPolygon& geometry)
 {
-	int shapeId = shapeFreelist.GetFree();
+	int shapeId = shapeFreelist.GetFreeOrGrow();
 
 	if (shapeId == shapes.Size()) { shapes.Push({ def }); }
+	else { shapes[shapeId] = { def }; }
 
 	Shape& shape = shapes[shapeId];
 
@@ -545,9 +1021,10 @@ Shape& Physics::CreateConvexPolygonShape(RigidBody2D& body, const Transform2D& t
 
 Shape& Physics::CreateSegmentShape(RigidBody2D& body, const Transform2D& transform, const ShapeDef& def, const Segment& geometry)
 {
-	int shapeId = shapeFreelist.GetFree();
+	int shapeId = shapeFreelist.GetFreeOrGrow();
 
 	if (shapeId == shapes.Size()) { shapes.Push({ def }); }
+	else { shapes[shapeId] = { def }; }
 
 	Shape& shape = shapes[shapeId];
 
@@ -563,9 +1040,10 @@ Shape& Physics::CreateSegmentShape(RigidBody2D& body, const Transform2D& transfo
 
 Shape& Physics::CreateChainSegmentShape(RigidBody2D& body, const Transform2D& transform, const ShapeDef& def, const ChainSegment& geometry)
 {
-	int shapeId = shapeFreelist.GetFree();
+	int shapeId = shapeFreelist.GetFreeOrGrow();
 
 	if (shapeId == shapes.Size()) { shapes.Push({ def }); }
+	else { shapes[shapeId] = { def }; }
 
 	Shape& shape = shapes[shapeId];
 
@@ -584,7 +1062,16 @@ void Physics::CreateShape(RigidBody2D& body, const Transform2D& transform, const
 	if (body.setIndex != SET_TYPE_DISABLED)
 	{
 		shape.UpdateShapeAABBs(transform, body.type);
-		shape.proxyKey = Broadphase::CreateProxy(body.type, shape.fatAABB, shape.filter.layers, shape.id, def.forceContactCreation || def.isSensor);
+		shape.proxyKey = Broadphase::CreateProxy(body.type, shape.fatAABB, shape.filter.layers, shape.id, def.forceContactCreation && !def.isSensor);
+	}
+
+	if (shape.isSensor)
+	{
+		shape.sensorIndex = (I32)sensors.Size();
+
+		Sensor& sensor = sensors.Push({});
+		sensor.shapeId = shape.id;
+		sensor.rebuild = true;
 	}
 
 	// Add to shape doubly linked list
@@ -600,6 +1087,115 @@ void Physics::CreateShape(RigidBody2D& body, const Transform2D& transform, const
 	body.shapeCount += 1;
 }
 
+// Sensor overlaps are small sets kept sorted by shape id
+static void SortShapeIds(Vector<I32>& ids)
+{
+	I32* data = ids.Data();
+	U64 count = ids.Size();
+
+	for (U64 i = 1; i < count; ++i)
+	{
+		I32 id = data[i];
+		U64 j = i;
+
+		while (j > 0 && data[j - 1] > id)
+		{
+			data[j] = data[j - 1];
+			--j;
+		}
+
+		data[j] = id;
+	}
+}
+
+static U64 FindShapeId(const Vector<I32>& ids, I32 id)
+{
+	U64 low = 0;
+	U64 high = ids.Size();
+
+	while (low < high)
+	{
+		U64 mid = (low + high) / 2;
+		if (ids[mid] < id) { low = mid + 1; }
+		else { high = mid; }
+	}
+
+	return low;
+}
+
+static bool ContainsShapeId(const Vector<I32>& ids, I32 id)
+{
+	U64 index = FindShapeId(ids, id);
+	return index < ids.Size() && ids[index] == id;
+}
+
+static bool RemoveShapeId(Vector<I32>& ids, I32 id)
+{
+	U64 index = FindShapeId(ids, id);
+	if (index == ids.Size() || ids[index] != id) { return false; }
+
+	ids.Remove(index);
+	return true;
+}
+
+void Physics::DestroyShapeInternal(Shape& shape, RigidBody2D& body, bool wakeBodies)
+{
+	I32 shapeId = shape.id;
+
+	// Remove from the body's shape list
+	if (shape.prevShapeId != NullIndex) { shapes[shape.prevShapeId].nextShapeId = shape.nextShapeId; }
+	if (shape.nextShapeId != NullIndex) { shapes[shape.nextShapeId].prevShapeId = shape.prevShapeId; }
+	if (shapeId == body.headShapeId) { body.headShapeId = shape.nextShapeId; }
+	body.shapeCount -= 1;
+
+	if (shape.proxyKey != NullIndex)
+	{
+		Broadphase::DestroyProxy(shape.proxyKey);
+		shape.proxyKey = NullIndex;
+	}
+
+	// Destroy the contacts touching this shape, the body's other contacts stay
+	I32 contactKey = body.headContactKey;
+	while (contactKey != NullIndex)
+	{
+		Contact& contact = contacts[contactKey >> 1];
+		contactKey = contact.edges[contactKey & 1].nextKey;
+
+		if (contact.shapeIdA == shapeId || contact.shapeIdB == shapeId) { DestroyContact(contact, wakeBodies); }
+	}
+
+	if (shape.sensorIndex != NullIndex) { DestroySensor(shape); }
+	else if (shape.enableSensorEvents)
+	{
+		// Sensors see the shape leave now, its id can be reused before the next pass
+		for (Sensor& sensor : sensors)
+		{
+			if (RemoveShapeId(sensor.overlaps2, shapeId)) { sensorEndEvents.Push({ sensor.shapeId + 1, shapeId + 1 }); }
+		}
+	}
+
+	shapeFreelist.Release(shapeId);
+	shape.id = NullIndex;
+}
+
+void Physics::DestroySensor(Shape& shape)
+{
+	Sensor& sensor = sensors[shape.sensorIndex];
+
+	for (I32 visitorId : sensor.overlaps2) { sensorEndEvents.Push({ shape.id + 1, visitorId + 1 }); }
+
+	sensor.overlaps1.Destroy();
+	sensor.overlaps2.Destroy();
+
+	I32 movedIndex = sensors.RemoveSwap(shape.sensorIndex);
+	if (movedIndex != NullIndex)
+	{
+		shapes[sensors[shape.sensorIndex].shapeId].sensorIndex = shape.sensorIndex;
+	}
+
+	shape.sensorIndex = NullIndex;
+}
+
 ShapeExtent Physics::ComputeShapeExtent(const Shape& shape, Vector2 localCenter)
 {
 	ShapeExtent extent;
@@ -654,29 +1250,218 @@ ShapeExtent Physics::ComputeShapeExtent(const Shape& shape, Vector2 localCenter)
 	return extent;
 }
 
+I32 Physics::CreateRigidBody(const RigidBody2DDef& def)
+{
+	return GetBodyID(rigidBodies.Emplace(def));
+}
+
 RigidBody2D& Physics::GetRigidBody(I32 id)
 {
 	return rigidBodies[id];
 }
 
-void Physics::EnableSleeping(bool flag)
+I32 Physics::CreateRevoluteJoint(const RevoluteJointDef& def)
 {
-	if (locked || flag == enableSleep) { return; }
+	JointSim jointSim{};
+	jointSim.bodyIdA = def.bodyIdA;
+	jointSim.bodyIdB = def.bodyIdB;
+	jointSim.type = JOINT_TYPE_REVOLUTE;
+	jointSim.localOriginAnchorA = def.localAnchorA;
+	jointSim.localOriginAnchorB = def.localAnchorB;
 
-	enableSleep = flag;
+	RevoluteJoint& joint = jointSim.revoluteJoint;
+	joint = {};
+	joint.referenceAngle = Math::Clamp(def.referenceAngle, -PI_F, PI_F);
+	joint.hertz = def.hertz;
+	joint.dampingRatio = def.dampingRatio;
+	joint.lowerAngle = Math::Clamp(Math::Min(def.lowerAngle, def.upperAngle), -PI_F, PI_F);
+	joint.upperAngle = Math::Clamp(Math::Max(def.lowerAngle, def.upperAngle), -PI_F, PI_F);
+	joint.maxMotorTorque = def.maxMotorTorque;
+	joint.motorSpeed = def.motorSpeed;
+	joint.enableSpring = def.enableSpring;
+	joint.enableLimit = def.enableLimit;
+	joint.enableMotor = def.enableMotor;
 
-	if (flag == false)
-	{
-		I32 setCount = (I32)solverSets.Size();
-		for (I32 i = SET_TYPE_FIRST_SLEEPING; i < setCount; ++i)
-		{
-			if (solverSets[i].bodySims.Size())
-			{
-				WakeSolverSet(i);
-			}
-		}
-	}
-}
+	I32 jointId = CreateJointInternal(jointSim, def.userData, def.drawSize, def.collideConnected);
+
+	// Contacts that already exist between the bodies would keep pushing them apart
+	if (!def.collideConnected) { DestroyContactsBetweenBodies(rigidBodies[def.bodyIdA], rigidBodies[def.bodyIdB]); }
+
+	return jointId;
+}
+
+void Physics::CastRay(const Vector2& origin, const Vector2& translation, const Filter& filter, Vector<RaycastResult>& results)
+{
+	RaycastInput input = { origin, translation, 1.0f };
+	WorldCastContext context = { filter, &results, {} };
+
+	for (I32 i = 0; i < BODY_TYPE_COUNT; ++i)
+	{
+		Broadphase::trees[i].Raycast(input, filter.layerMask, context);
+	}
+}
+
+RaycastResult Physics::CastRayClosest(const Vector2& origin, const Vector2& translation, const Filter& filter)
+{
+	RaycastInput input = { origin, translation, 1.0f };
+	WorldCastContext context = { filter, nullptr, {} };
+
+	for (I32 i = 0; i < BODY_TYPE_COUNT; ++i)
+	{
+		Broadphase::trees[i].Raycast(input, filter.layerMask, context);
+
+		// Later trees only need to look in front of the closest hit so far
+		if (context.closest.hit) { input.maxFraction = context.closest.fraction; }
+	}
+
+	return context.closest;
+}
+
+void Physics::CastShape(const ShapeCastInput& input, const Filter& filter, Vector<RaycastResult>& results)
+{
+	WorldCastContext context = { filter, &results, {} };
+
+	for (I32 i = 0; i < BODY_TYPE_COUNT; ++i)
+	{
+		Broadphase::trees[i].Shapecast(input, filter.layerMask, context);
+	}
+}
+
+void Physics::QueryBatch(const AABB* boxes, U32 count, const Filter& filter, QueryBatchResults& results)
+{
+	U32 workers = Jobs::WorkerCount();
+	if (results.workerHits.Size() < workers) { results.workerHits.Resize(workers); }
+	for (U32 i = 0; i < workers; ++i) { results.workerHits[i].Clear(); }
+
+	results.records.Resize(count);
+
+	U32 packetCount = (count + NH_SIMD_WIDTH - 1) / NH_SIMD_WIDTH;
+
+	Jobs::ParallelFor(0, packetCount, 16, [&](U32 start, U32 end) {
+		U32 worker = Jobs::CurrentWorker();
+		Vector<I32>& hits = results.workerHits[worker];
+		Vector<PacketHit>& packetHits = taskContexts[worker].queryHits;
+
+		for (U32 packet = start; packet < end; ++packet)
+		{
+			U32 first = packet * NH_SIMD_WIDTH;
+			U32 laneCount = Math::Min(count - first, (U32)NH_SIMD_WIDTH);
+
+			packetHits.Clear();
+
+			for (I32 i = 0; i < BODY_TYPE_COUNT; ++i)
+			{
+				Broadphase::trees[i].QueryPacket(boxes + first, laneCount, filter.layerMask, packetHits, true);
+			}
+
+			// The tree only knows fat AABBs so check the tight ones here, survivors are compacted in place and counted per lane
+			U32 laneCounts[NH_SIMD_WIDTH]{};
+			U32 kept = 0;
+
+			for (U32 i = 0; i < packetHits.Size(); ++i)
+			{
+				PacketHit hit = packetHits[i];
+
+				Shape& shape = shapes[hit.userData];
+				if (shape.isSensor || !shape.filter.ShouldShapesCollide(filter) || !shape.aabb.Overlaps(boxes[first + hit.lane])) { continue; }
+
+				packetHits[kept++] = { hit.lane, shape.id + 1 };
+				++laneCounts[hit.lane];
+			}
+
+			// Counting sort by lane so each query's hits end up contiguous
+			U32 laneOffsets[NH_SIMD_WIDTH];
+			U32 offset = (U32)hits.Size();
+
+			for (U32 lane = 0; lane < laneCount; ++lane)
+			{
+				results.records[first + lane] = { worker, offset, laneCounts[lane] };
+				laneOffsets[lane] = offset;
+				offset += laneCounts[lane];
+			}
+
+			hits.Resize(offset);
+
+			for (U32 i = 0; i < kept; ++i)
+			{
+				const PacketHit& hit = packetHits[i];
+				hits[laneOffsets[hit.lane]++] = hit.userData;
+			}
+		}
+	});
+
+	// Stitch the worker buffers together in query order
+	U32 total = 0;
+	for (const QueryRecord& record : results.records) { total += record.count; }
+
+	results.shapeIds.Resize(total);
+	results.offsets.Resize(count);
+	results.counts.Resize(count);
+
+	U32 offset = 0;
+	for (U32 i = 0; i < count; ++i)
+	{
+		const QueryRecord& record = results.records[i];
+
+		results.offsets[i] = offset;
+		results.counts[i] = record.count;
+
+		Copy(results.shapeIds.Data() + offset, results.workerHits[record.worker].Data() + record.start, record.count);
+		offset += record.count;
+	}
+}
+
+void Physics::CastRayBatch(const RaycastInput* rays, U32 count, const Filter& filter, Vector<RaycastResult>& results)
+{
+	results.Resize(count);
+
+	U32 packetCount = (count + NH_SIMD_WIDTH - 1) / NH_SIMD_WIDTH;
+
+	Jobs::ParallelFor(0, packetCount, 16, [&](U32 start, U32 end) {
+		WorldCastContext contexts[NH_SIMD_WIDTH];
+
+		for (U32 packet = start; packet < end; ++packet)
+		{
+			U32 first = packet * NH_SIMD_WIDTH;
+			U32 laneCount = Math::Min(count - first, (U32)NH_SIMD_WIDTH);
+
+			for (U32 lane = 0; lane < laneCount; ++lane) { contexts[lane] = { filter, nullptr, {} }; }
+
+			for (I32 i = 0; i < BODY_TYPE_COUNT; ++i)
+			{
+				Broadphase::trees[i].RaycastPacket(rays + first, laneCount, filter.layerMask, contexts);
+			}
+
+			for (U32 lane = 0; lane < laneCount; ++lane) { results[first + lane] = contexts[lane].closest; }
+		}
+	});
+}
+
+void Physics::RebuildStaticTree()
+{
+	if (locked) { return; }
+
+	Broadphase::trees[BODY_TYPE_STATIC].Rebuild(true);
+}
+
+void Physics::EnableSleeping(bool flag)
+{
+	if (locked || flag == enableSleep) { return; }
+
+	enableSleep = flag;
+
+	if (flag == false)
+	{
+		I32 setCount = (I32)solverSets.Size();
+		for (I32 i = SET_TYPE_FIRST_SLEEPING; i < setCount; ++i)
+		{
+			if (solverSets[i].bodySims.Size())
+			{
+				WakeSolverSet(i);
+			}
+		}
+	}
+}
 
 void Physics::EnableWarmStarting(bool flag)
 {
@@ -707,7 +1492,10 @@ void Physics::WakeSolverSet(int setIndex)
 		// Reset sleep timer
 		body.sleepTime = 0.0f;
 
-		awakeSet.bodySims.Push(simSrc);
+		// It didn't move while asleep, don't interpolate from wherever it was when it last stepped
+		BodySim& awakeSim = awakeSet.bodySims.Push(simSrc);
+		awakeSim.previousTransform = awakeSim.transform;
+
 		awakeSet.bodyStates.Push(BodyStateIdentity);
 
 		// move non-touching contacts from disabled set to awake set
@@ -772,27 +1560,33 @@ void Physics::WakeSolverSet(int setIndex)
 	set.Destroy();
 }
 
+// Milliseconds since start, start moves up to now for the next stage
+static F64 StageTime(F64& start)
+{
+	F64 now = Time::AbsoluteTime();
+	F64 elapsed = (now - start) * 1000.0;
+	start = now;
+	return elapsed;
+}
+
 void Physics::Step(F32 timeStep, int subStepCount)
 {
 	if (locked) { return; }
 
-	// Prepare to capture events
-	// Ensure user does not access stale data if there is an early return
-	bodyMoveEvents.Clear();
-	sensorBeginEvents.Clear();
-	sensorEndEvents.Clear();
-	contactBeginEvents.Clear();
-	contactEndEvents.Clear();
-	contactHitEvents.Clear();
-
+	// Events are cleared once per frame in Update, each step appends to them
 	if (Math::IsZero(timeStep)) { return; }
 
 	locked = true;
 	activeTaskCount = 0;
 	taskCount = 0;
 
+	profile = {};
+	F64 stepStart = Time::AbsoluteTime();
+	F64 stageStart = stepStart;
+
 	// Update collision pairs and create contacts
 	Broadphase::Update();
+	profile.pairs = StageTime(stageStart);
 
 	StepContext context{};
 	context.dt = timeStep;
@@ -825,12 +1619,72 @@ void Physics::Step(F32 timeStep, int subStepCount)
 	context.maxLinearVelocity = maxLinearVelocity;
 	context.enableWarmStarting = enableWarmStarting;
 
+	// Collide consumes the move buffer, the sensor pass still needs the proxies that moved since the last step
+	if (sensors.Size()) { sensorMoves.Merge(Broadphase::moveArray); }
+
+	stageStart = Time::AbsoluteTime();
 	Collide(context);
+	profile.collide = StageTime(stageStart);
+
 	Solve(context);
+	profile.solve = StageTime(stageStart);
+
+	OverlapSensors();
+	profile.sensors = StageTime(stageStart);
+
+	if (deterministic) { stateHash = HashState(); }
+
+	profile.step = StageTime(stepStart);
 
 	locked = false;
 }
 
+void Physics::SetDeterministic(bool enabled)
+{
+	deterministic = enabled;
+	stateHash = 0;
+}
+
+void Physics::EnableManifoldReuse(bool enabled)
+{
+	enableManifoldReuse = enabled;
+}
+
+bool Physics::Deterministic()
+{
+	return deterministic;
+}
+
+U64 Physics::StateHash()
+{
+	return stateHash;
+}
+
+const PhysicsProfile& Physics::Profile()
+{
+	return profile;
+}
+
+U64 Physics::HashState()
+{
+	const SolverSet& awakeSet = solverSets[SET_TYPE_AWAKE];
+	U64 hash = Hash::SeededHash(stepIndex);
+
+	// Field by field, BodySim has padding that isn't guaranteed to match
+	for (U64 i = 0; i < awakeSet.bodySims.Size(); ++i)
+	{
+		const BodySim& sim = awakeSet.bodySims[i];
+		const BodyState& state = awakeSet.bodyStates[i];
+
+		hash = Hash::SeededHash(sim.bodyId, hash);
+		hash = Hash::SeededHash(sim.transform, hash);
+		hash = Hash::SeededHash(state.linearVelocity, hash);
+		hash = Hash::SeededHash(state.angularVelocity, hash);
+	}
+
+	return hash;
+}
+
 void Physics::AddNonTouchingContact(Contact& contact, ContactSim& contactSim)
 {
 	SolverSet& set = solverSets[SET_TYPE_AWAKE];
@@ -862,6 +1716,8 @@ BodySim& Physics::GetBodySim(RigidBody2D& body)
 // Narrow-phase collision
 void Physics::Collide(StepContext& context)
 {
+	PROFILE_ZONE("Physics Collide");
+
 	// Tasks that can be done in parallel with the narrow-phase
 	// - rebuild the collision tree for dynamic and kinematic bodies to keep their query performance good
 	Broadphase::RebuildTrees();
@@ -911,20 +1767,25 @@ void Physics::Collide(StepContext& context)
 	for (I32 i = 0; i < workerCount; ++i)
 	{
 		taskContexts[i].contactStateBitset.SetBitCountAndClear(contactIdCapacity);
+		taskContexts[i].reusedManifolds = 0;
 	}
 
 	// Task should take at least 40us on a 4GHz CPU (10K cycles)
-	I32 minRange = 64;
-	CollideTask(0, contactCount, 0, context);
+	U32 minRange = 64;
+	Jobs::ParallelFor(0, (U32)contactCount, minRange, [&context](U32 startIndex, U32 endIndex) {
+		CollideTask((int)startIndex, (int)endIndex, (int)Jobs::CurrentWorker(), context);
+	});
 	taskCount += 1;
 
 	context.contacts.Destroy();
 
 	// Bitwise OR all contact bits
 	Bitset& bitset = taskContexts[0].contactStateBitset;
+	profile.reusedManifolds = taskContexts[0].reusedManifolds;
 	for (I32 i = 1; i < workerCount; ++i)
 	{
 		bitset.InPlaceUnion(taskContexts[i].contactStateBitset);
+		profile.reusedManifolds += taskContexts[i].reusedManifolds;
 	}
 
 	SolverSet& awakeSet = solverSets[SET_TYPE_AWAKE];
@@ -979,76 +1840,42 @@ void Physics::Collide(StepContext& context)
 			}
 			else if (simFlags & CONTACT_SIM_FLAG_STARTED_TOUCHING)
 			{
-				if ((flags & CONTACT_FLAG_SENSOR) != 0)
+				if (flags & CONTACT_FLAG_ENABLE_CONTACT_EVENTS)
 				{
-					// Contact is a sensor
-					if ((flags & CONTACT_FLAG_ENABLE_SENSOR_EVENTS) != 0)
-					{
-						if (shapeA->isSensor) { sensorBeginEvents.Push({ shapeIdA, shapeIdB }); }
-
-						if (shapeB->isSensor) { sensorBeginEvents.Push({ shapeIdB, shapeIdA }); }
-					}
-
-					contactSim->simFlags &= ~CONTACT_SIM_FLAG_STARTED_TOUCHING;
-					contact.flags |= CONTACT_FLAG_SENSOR_TOUCHING;
+					contactBeginEvents.Push({ shapeIdA, shapeIdB, contactSim->manifold });
 				}
-				else
-				{
-					// Contact is solid
-					if (flags & CONTACT_FLAG_ENABLE_CONTACT_EVENTS)
-					{
-						contactBeginEvents.Push({ shapeIdA, shapeIdB, contactSim->manifold });
-					}
 
-					// Link first because this wakes colliding bodies and ensures the body sims
-					// are in the correct place.
-					contact.flags |= CONTACT_FLAG_TOUCHING;
-					LinkContact(contact);
+				// Link first because this wakes colliding bodies and ensures the body sims
+				// are in the correct place.
+				contact.flags |= CONTACT_FLAG_TOUCHING;
+				LinkContact(contact);
 
-					// Contact sim pointer may have become orphaned due to awake set growth,
-					// so I just need to refresh it.
-					contactSim = &awakeSet.contactSims[localIndex];
+				// Contact sim pointer may have become orphaned due to awake set growth,
+				// so I just need to refresh it.
+				contactSim = &awakeSet.contactSims[localIndex];
 
-					contactSim->simFlags &= ~CONTACT_SIM_FLAG_STARTED_TOUCHING;
+				contactSim->simFlags &= ~CONTACT_SIM_FLAG_STARTED_TOUCHING;
 
-					constraintGraph.AddContact(*contactSim, contact);
-					RemoveNonTouchingContact(SET_TYPE_AWAKE, localIndex);
-					contactSim = nullptr;
-				}
+				constraintGraph.AddContact(*contactSim, contact);
+				RemoveNonTouchingContact(SET_TYPE_AWAKE, localIndex);
+				contactSim = nullptr;
 			}
 			else if (simFlags & CONTACT_SIM_FLAG_STOPPED_TOUCHING)
 			{
 				contactSim->simFlags &= ~CONTACT_SIM_FLAG_STOPPED_TOUCHING;
+				contact.flags &= ~CONTACT_FLAG_TOUCHING;
 
-				if ((flags & CONTACT_FLAG_SENSOR) != 0)
+				if (contact.flags & CONTACT_FLAG_ENABLE_CONTACT_EVENTS)
 				{
-					// Contact is a sensor
-					contact.flags &= ~CONTACT_FLAG_SENSOR_TOUCHING;
-
-					if ((flags & CONTACT_FLAG_ENABLE_SENSOR_EVENTS) != 0)
-					{
-						if (shapeA->isSensor) { sensorEndEvents.Push({ shapeIdA, shapeIdB }); }
-
-						if (shapeB->isSensor) { sensorEndEvents.Push({ shapeIdB, shapeIdA }); }
-					}
+					contactEndEvents.Push({ shapeIdA, shapeIdB });
 				}
-				else
-				{
-					// Contact is solid
-					contact.flags &= ~CONTACT_FLAG_TOUCHING;
-
-					if (contact.flags & CONTACT_FLAG_ENABLE_CONTACT_EVENTS)
-					{
-						contactEndEvents.Push({ shapeIdA, shapeIdB });
-					}
 
-					UnlinkContact(contact);
-					int bodyIdA = contact.edges[0].bodyId;
-					int bodyIdB = contact.edges[1].bodyId;
+				UnlinkContact(contact);
+				int bodyIdA = contact.edges[0].bodyId;
+				int bodyIdB = contact.edges[1].bodyId;
 
-					AddNonTouchingContact(contact, *contactSim);
-					constraintGraph.RemoveContact(bodyIdA, bodyIdB, colorIndex, localIndex);
-				}
+				AddNonTouchingContact(contact, *contactSim);
+				constraintGraph.RemoveContact(bodyIdA, bodyIdB, colorIndex, localIndex);
 			}
 
 			// Clear the smallest set bit
@@ -1103,8 +1930,18 @@ void Physics::CollideTask(int startIndex, int endIndex, int threadIndex, StepCon
 			Vector2 centerOffsetA = bodySimA.localCenter * transformA.rotation;
 			Vector2 centerOffsetB = bodySimB.localCenter * transformB.rotation;
 
-			// This updates solid contacts and sensors
-			bool touching = UpdateContact(*contactSim, shapeA, transformA, centerOffsetA, shapeB, transformB, centerOffsetB);
+			bool touching;
+
+			// Resting contacts barely move relative to each other, their last manifold is still good
+			if (wasTouching && enableManifoldReuse && ReuseManifold(*contactSim, shapeA, transformA, centerOffsetA, shapeB, transformB, centerOffsetB))
+			{
+				touching = true;
+				taskContext.reusedManifolds += 1;
+			}
+			else
+			{
+				touching = UpdateContact(*contactSim, shapeA, transformA, centerOffsetA, shapeB, transformB, centerOffsetB);
+			}
 
 			// State changes that affect island connectivity. Also contact and sensor events.
 			if (touching == true && wasTouching == false)
@@ -1123,6 +1960,10 @@ void Physics::CollideTask(int startIndex, int endIndex, int threadIndex, StepCon
 
 void Physics::Solve(StepContext& stepContext)
 {
+	PROFILE_ZONE("Physics Solve");
+
+	F64 stageStart = Time::AbsoluteTime();
+
 	stepIndex += 1;
 
 	MergeAwakeIslands();
@@ -1158,9 +1999,10 @@ void Physics::Solve(StepContext& stepContext)
 			awakeJointCount += perColorJointCount;
 		}
 
-		// Deal with void**
+		// This step's move events go after the ones from earlier steps this frame
 		{
-			bodyMoveEvents.Resize(awakeBodyCount);
+			stepContext.moveEventOffset = (I32)bodyMoveEvents.Size();
+			bodyMoveEvents.Resize(bodyMoveEvents.Size() + awakeBodyCount);
 		}
 
 		// Each worker receives at most M blocks of work. The workers may receive less than there is not sufficient work.
@@ -1171,8 +2013,11 @@ void Physics::Solve(StepContext& stepContext)
 		// 2. keep M large enough for other workers to be able to steal work
 		// The block size is a power of two to make math efficient.
 
+		// The solver syncs on every stage so it gets at most one worker per job thread
+		const int solverWorkerCount = Math::Min(workerCount, (I32)MaxWorkers);
+
 		const int blocksPerWorker = 4;
-		const int maxBlockCount = blocksPerWorker * workerCount;
+		const int maxBlockCount = blocksPerWorker * solverWorkerCount;
 
 		// Configure blocks for tasks that parallel-for bodies
 		int bodyBlockSize = 1 << 5;
@@ -1274,8 +2119,11 @@ void Physics::Solve(StepContext& stepContext)
 		JointSim** joints;
 		Memory::AllocateArray(&joints, awakeJointCount);
 
-		ContactConstraintSIMD* simdContactConstraints;
-		Memory::AllocateArray(&simdContactConstraints, simdContactCount);
+		// FloatW is 32 bytes with AVX but the pools only promise 16 byte alignment, so over allocate and align by hand
+		constexpr U64 simdAlignment = alignof(ContactConstraintSIMD);
+		U8* simdContactMemory;
+		Memory::AllocateSize(&simdContactMemory, simdContactCount * sizeof(ContactConstraintSIMD) + simdAlignment);
+		ContactConstraintSIMD* simdContactConstraints = (ContactConstraintSIMD*)(((U64)simdContactMemory + simdAlignment - 1) & ~(simdAlignment - 1));
 
 		int overflowContactCount = (I32)colors[OverflowIndex].contactSims.Size();
 		ContactConstraint* overflowContactConstraints;
@@ -1378,18 +2226,6 @@ void Physics::Solve(StepContext& stepContext)
 		SolverBlock* graphBlocks;
 		Memory::AllocateArray(&graphBlocks, graphBlockCount);
 
-		// Split an awake island. This modifies:
-		// - stack allocator
-		// - world island array and solver set
-		// - island indices on bodies, contacts, and joints
-		// I'm squeezing this task in here because it may be expensive and this is a safe place to put it.
-		// Note: cannot split islands in parallel with FinalizeBodies
-		if (splitIslandId != NullIndex)
-		{
-			SplitIsland(splitIslandId);
-			taskCount += 1;
-		}
-
 		// Prepare body work blocks
 		for (int i = 0; i < bodyBlockCount; ++i)
 		{
@@ -1573,22 +2409,64 @@ void Physics::Solve(StepContext& stepContext)
 		stepContext.contacts = contacts;
 		stepContext.simdContactConstraints = simdContactConstraints;
 		stepContext.activeColorCount = activeColorCount;
-		stepContext.workerCount = workerCount;
+		stepContext.workerCount = solverWorkerCount;
 		stepContext.stageCount = stageCount;
 		stepContext.stages = stages;
 		stepContext.atomicSyncBits = 0;
 
-		// Must use worker index because thread 0 can be assigned multiple tasks by enkiTS
-		for (int i = 0; i < workerCount; ++i)
+		// Solver worker indices are logical, any job thread can run any of them. Worker 0 drives the stages from
+		// this thread, the rest spin on the sync bits. Blocks are claimed atomically so the stages still complete
+		// if some of the jobs haven't started yet.
+		JobHandle solverHandle{};
+		for (int i = 0; i < solverWorkerCount; ++i)
 		{
 			workerContext[i].context = &stepContext;
 			workerContext[i].workerIndex = i;
 			workerContext[i].userTask = nullptr;
-			SolverTask(workerContext[i]);
-			taskCount += 1;
 		}
 
-		splitIslandId = NullIndex;
+		if (solverWorkerCount > 1)
+		{
+			solverHandle = Jobs::Dispatch(solverWorkerCount - 1, 1, [&workerContext](DispatchArgs args) {
+				SolverTask(workerContext[args.jobIndex + 1]);
+			}, JOB_PRIORITY_HIGH);
+		}
+
+		// Split the islands flagged last step. The searches only read the constraint graph and mark their own island's bodies,
+		// contacts and joints, none of which the solver touches, so they run alongside it. Creating the new islands changes the
+		// island arrays and the island indices finalize reads, so that waits until both are done.
+		// Note: cannot split islands in parallel with FinalizeBodies
+		JobHandle splitHandle{};
+		U32 splitCount = (U32)splitIslandIds.Size();
+		profile.splitIslands = splitCount;
+
+		if (splitCount > 0)
+		{
+			while (islandSplits.Size() < splitCount) { islandSplits.Push({}); }
+
+			for (U32 i = 0; i < splitCount; ++i) { PrepareIslandSplit(islandSplits[i], splitIslandIds[i]); }
+
+			splitHandle = Jobs::Dispatch(splitCount, 1, [](DispatchArgs args) {
+				SearchIslandSplit(islandSplits[args.jobIndex]);
+			});
+		}
+
+		SolverTask(workerContext[0]);
+		Jobs::WaitFor(solverHandle);
+		taskCount += solverWorkerCount;
+
+		if (splitCount > 0)
+		{
+			Jobs::WaitFor(splitHandle);
+
+			for (U32 i = 0; i < splitCount; ++i) { ApplyIslandSplit(islandSplits[i]); }
+
+			taskCount += splitCount;
+		}
+
+		splitIslandIds.Clear();
+
+		profile.solveConstraints = StageTime(stageStart);
 
 		// Prepare contact, enlarged body, and island bit sets used in body finalization.
 		int awakeIslandCount = (I32)awakeSet.islandSims.Size();
@@ -1597,12 +2475,13 @@ void Physics::Solve(StepContext& stepContext)
 			TaskContext* taskContext = taskContexts.Data() + i;
 			taskContext->enlargedSimBitset.SetBitCountAndClear(awakeBodyCount);
 			taskContext->awakeIslandBitset.SetBitCountAndClear(awakeIslandCount);
-			taskContext->splitIslandId = NullIndex;
-			taskContext->splitSleepTime = 0.0f;
+			taskContext->splitIslandBitset.SetBitCountAndClear(awakeIslandCount);
 		}
 
 		// Finalize bodies. Must happen after the constraint solver and after island splitting.
-		FinalizeBodiesTask(0, awakeBodyCount, 0, stepContext);
+		Jobs::ParallelFor(0, (U32)awakeBodyCount, 64, [&stepContext](U32 startIndex, U32 endIndex) {
+			FinalizeBodiesTask((int)startIndex, (int)endIndex, Jobs::CurrentWorker(), stepContext);
+		});
 		taskCount += 1;
 
 		Memory::Free(&graphBlocks);
@@ -1611,7 +2490,7 @@ void Physics::Solve(StepContext& stepContext)
 		Memory::Free(&bodyBlocks);
 		Memory::Free(&stages);
 		Memory::Free(&overflowContactConstraints);
-		Memory::Free(&simdContactConstraints);
+		Memory::Free(&simdContactMemory);
 		Memory::Free(&joints);
 	}
 
@@ -1697,6 +2576,13 @@ void Physics::Solve(StepContext& stepContext)
 				BodySim* bodySim = bodySimArray + bodySimIndex;
 				RigidBody2D& body = rigidBodies[bodySim->bodyId];
 
+				// Gathered here instead of during finalize so continuous collision runs in sim order
+				if (bodySim->isFast)
+				{
+					if (bodySim->isBullet) { stepContext.bulletBodies[stepContext.bulletBodyCount++] = bodySimIndex; }
+					else { stepContext.fastBodies[stepContext.fastBodyCount++] = bodySimIndex; }
+				}
+
 				int shapeId = body.headShapeId;
 				while (shapeId != NullIndex)
 				{
@@ -1722,12 +2608,18 @@ void Physics::Solve(StepContext& stepContext)
 		}
 	}
 
+	profile.finalize = StageTime(stageStart);
+
 	// Parallel continuous collision
 	if (stepContext.fastBodyCount > 0)
 	{
+		ReserveContinuous(stepContext.fastBodies, stepContext.fastBodyCount);
+
 		// fast bodies
-		int minRange = 8;
-		FastBodyTask(0, stepContext.fastBodyCount, 0, stepContext);
+		U32 minRange = 8;
+		Jobs::ParallelFor(0, (U32)stepContext.fastBodyCount, minRange, [&stepContext](U32 startIndex, U32 endIndex) {
+			FastBodyTask((int)startIndex, (int)endIndex, Jobs::CurrentWorker(), stepContext);
+		});
 		taskCount += 1;
 	}
 
@@ -1743,7 +2635,7 @@ void Physics::Solve(StepContext& stepContext)
 		int* fastBodySimIndices = stepContext.fastBodies;
 		int fastBodyCount = stepContext.fastBodyCount;
 
-		// This loop has non-deterministic order but it shouldn't affect the result
+		// Same sim order as the move array
 		for (int i = 0; i < fastBodyCount; ++i)
 		{
 			BodySim* fastBodySim = bodySimArray + fastBodySimIndices[i];
@@ -1781,9 +2673,13 @@ void Physics::Solve(StepContext& stepContext)
 
 	if (stepContext.bulletBodyCount > 0)
 	{
+		ReserveContinuous(stepContext.bulletBodies, stepContext.bulletBodyCount);
+
 		// bullet bodies
-		int minRange = 8;
-		BulletBodyTask(0, stepContext.bulletBodyCount, 0, stepContext);
+		U32 minRange = 8;
+		Jobs::ParallelFor(0, (U32)stepContext.bulletBodyCount, minRange, [&stepContext](U32 startIndex, U32 endIndex) {
+			BulletBodyTask((int)startIndex, (int)endIndex, Jobs::CurrentWorker(), stepContext);
+		});
 		taskCount += 1;
 	}
 
@@ -1799,7 +2695,7 @@ void Physics::Solve(StepContext& stepContext)
 		int* bulletBodySimIndices = stepContext.bulletBodies;
 		int bulletBodyCount = stepContext.bulletBodyCount;
 
-		// This loop has non-deterministic order but it shouldn't affect the result
+		// Same sim order as the move array
 		for (int i = 0; i < bulletBodyCount; ++i)
 		{
 			BodySim* bulletBodySim = bodySimArray + bulletBodySimIndices[i];
@@ -1845,26 +2741,25 @@ void Physics::Solve(StepContext& stepContext)
 	stepContext.fastBodies = NULL;
 	stepContext.fastBodyCount = 0;
 
+	profile.continuous = StageTime(stageStart);
+
 	// Island sleeping
 	// This must be done last because putting islands to sleep invalidates the enlarged body bits.
 	if (enableSleep)
 	{
-		// Collect split island candidate for the next time step. No need to split if sleeping is disabled.
-		float splitSleepTimer = 0.0f;
-		for (int i = 0; i < workerCount; ++i)
+		// Collect split island candidates for the next time step. No need to split if sleeping is disabled.
+		// Read in island order before any island sleeps and moves, so the candidates don't depend on work stealing.
+		// Only awake islands are flagged, sleeping ones keep their removed constraints until they wake and settle again.
+		Bitset& splitIslandBitset = taskContexts[0].splitIslandBitset;
+		for (int i = 1; i < workerCount; ++i)
 		{
-			TaskContext* taskContext = taskContexts.Data() + i;
-			if (taskContext->splitIslandId != NullIndex && taskContext->splitSleepTime >= splitSleepTimer)
-			{
-				// Tie breaking for determinism. Largest island id wins. Needed due to work stealing.
-				if (taskContext->splitSleepTime == splitSleepTimer && taskContext->splitIslandId < splitIslandId)
-				{
-					continue;
-				}
+			splitIslandBitset.InPlaceUnion(taskContexts[i].splitIslandBitset);
+		}
 
-				splitIslandId = taskContext->splitIslandId;
-				splitSleepTimer = taskContext->splitSleepTime;
-			}
+		int awakeIslandCount = (I32)awakeSet.islandSims.Size();
+		for (int islandIndex = 0; islandIndex < awakeIslandCount && (I32)splitIslandIds.Size() < MaxSplitIslands; ++islandIndex)
+		{
+			if (splitIslandBitset.GetBit(islandIndex)) { splitIslandIds.Push(awakeSet.islandSims[islandIndex].islandId); }
 		}
 
 		Bitset& awakeIslandBitset = taskContexts[0].awakeIslandBitset;
@@ -1886,10 +2781,14 @@ void Physics::Solve(StepContext& stepContext)
 			TrySleepIsland(islandId);
 		}
 	}
+
+	profile.sleepIslands = StageTime(stageStart);
 }
 
 void Physics::SolverTask(WorkerContext& workerContext)
 {
+	PROFILE_ZONE("Physics Solver Worker");
+
 	int workerIndex = workerContext.workerIndex;
 	StepContext* context = workerContext.context;
 	int activeColorCount = context->activeColorCount;
@@ -2081,6 +2980,8 @@ void Physics::SolverTask(WorkerContext& workerContext)
 
 void Physics::ExecuteStage(SolverStage& stage, StepContext* context, int previousSyncIndex, int syncIndex, int workerIndex)
 {
+	PROFILE_ZONE("Physics Solver Stage");
+
 	int completedCount = 0;
 	SolverBlock* blocks = stage.blocks;
 	int blockCount = stage.blockCount;
@@ -2172,22 +3073,22 @@ void Physics::ExecuteBlock(SolverStage& stage, StepContext& context, SolverBlock
 	case SOLVER_STAGE_WARM_START: {
 		if (enableWarmStarting)
 		{
-			if (blockType == SOLVER_BLOCK_TYPE_CONTACT) { WarmStartContactsTask(startIndex, endIndex, context, stage.colorIndex); }
-			else if (blockType == SOLVER_BLOCK_TYPE_JOINT) { WarmStartJointsTask(startIndex, endIndex, context, stage.colorIndex); }
+			if (blockType == SOLVER_BLOCK_TYPE_GRAPH_CONTACT) { WarmStartContactsTask(startIndex, endIndex, context, stage.colorIndex); }
+			else if (blockType == SOLVER_BLOCK_TYPE_GRAPH_JOINT) { WarmStartJointsTask(startIndex, endIndex, context, stage.colorIndex); }
 		}
 	} break;
 	case SOLVER_STAGE_SOLVE: {
-		if (blockType == SOLVER_BLOCK_TYPE_CONTACT) { SolveContactsTask(startIndex, endIndex, context, stage.colorIndex, true); }
-		else if (blockType == SOLVER_BLOCK_TYPE_JOINT) { SolveJointsTask(startIndex, endIndex, context, stage.colorIndex, true); }
+		if (blockType == SOLVER_BLOCK_TYPE_GRAPH_CONTACT) { solveContacts(startIndex, endIndex, context, stage.colorIndex, true); }
+		else if (blockType == SOLVER_BLOCK_TYPE_GRAPH_JOINT) { SolveJointsTask(startIndex, endIndex, context, stage.colorIndex, true); }
 	} break;
 	case SOLVER_STAGE_INTEGRATE_POSITIONS: { IntegratePositionsTask(startIndex, endIndex, context); } break;
 	case SOLVER_STAGE_RELAX: {
-		if (blockType == SOLVER_BLOCK_TYPE_CONTACT) { SolveContactsTask(startIndex, endIndex, context, stage.colorIndex, false); }
-		else if (blockType == SOLVER_BLOCK_TYPE_JOINT) { SolveJointsTask(startIndex, endIndex, context, stage.colorIndex, false); }
+		if (blockType == SOLVER_BLOCK_TYPE_GRAPH_CONTACT) { solveContacts(startIndex, endIndex, context, stage.colorIndex, false); }
+		else if (blockType == SOLVER_BLOCK_TYPE_GRAPH_JOINT) { SolveJointsTask(startIndex, endIndex, context, stage.colorIndex, false); }
 	} break;
 
 	case SOLVER_STAGE_RESTITUTION: {
-		if (blockType == SOLVER_BLOCK_TYPE_CONTACT) { ApplyRestitutionTask(startIndex, endIndex, context, stage.colorIndex); }
+		if (blockType == SOLVER_BLOCK_TYPE_GRAPH_CONTACT) { ApplyRestitutionTask(startIndex, endIndex, context, stage.colorIndex); }
 	} break;
 
 	case SOLVER_STAGE_STORE_IMPULSES: { StoreImpulsesTask(startIndex, endIndex, context); } break;
@@ -2863,206 +3764,338 @@ void Physics::WarmStartContactsTask(int startIndex, int endIndex, StepContext& c
 	}
 }
 
-void Physics::SolveContactsTask(int startIndex, int endIndex, StepContext& context, int colorIndex, bool useBias)
+// Written once for both lane types so the FloatPairW solve below matches the FloatW one lane for lane
+template<class Wide>
+static void SolveContact(ContactConstraintT<Wide>& c, SimdBodyT<Wide>& bA, SimdBodyT<Wide>& bB, Wide inv_h, Wide minBiasVel, Wide zero, Wide one, bool useBias)
 {
-	BodyState* states = context.states;
-	ContactConstraintSIMD* constraints = context.graph->colors[colorIndex].simdConstraints;
-	FloatW inv_h = SplatW(context.inv_h);
-	FloatW minBiasVel = SplatW(-contactPushoutVelocity);
+	Wide biasRate, massScale, impulseScale;
+	if (useBias)
+	{
+		biasRate = c.biasRate;
+		massScale = c.massScale;
+		impulseScale = c.impulseScale;
+	}
+	else
+	{
+		biasRate = zero;
+		massScale = one;
+		impulseScale = zero;
+	}
 
-	for (int i = startIndex; i < endIndex; ++i)
+	Vector2T<Wide> dp = { bB.dp.x - bA.dp.x, bB.dp.y - bA.dp.y };
+
+	// point1 non-penetration constraint
 	{
-		ContactConstraintSIMD& c = constraints[i];
+		// moving anchors for current separation
+		Vector2T<Wide> rsA = RotateVectorW(bA.dq, c.anchorA1);
+		Vector2T<Wide> rsB = RotateVectorW(bB.dq, c.anchorB1);
 
-		SimdBody bA = GatherBodies(states, c.indexA);
-		SimdBody bB = GatherBodies(states, c.indexB);
+		// compute current separation
+		// this is subject to round-off error if the anchor is far from the body center of mass
+		Vector2T<Wide> ds = { dp.x + (rsB.x - rsA.x), dp.y + (rsB.y - rsA.y) };
+		Wide s = DotW(c.normal, ds) + c.baseSeparation1;
 
-		FloatW biasRate, massScale, impulseScale;
-		if (useBias)
-		{
-			biasRate = c.biasRate;
-			massScale = c.massScale;
-			impulseScale = c.impulseScale;
-		}
-		else
-		{
-			biasRate = ZeroFloatW;
-			massScale = SplatW(1.0f);
-			impulseScale = ZeroFloatW;
-		}
+		// Apply speculative bias if separation is greater than zero, otherwise apply soft constraint bias
+		Wide mask = s > zero;
+		Wide specBias = s * inv_h;
+		Wide softBias = MaxW(biasRate * s, minBiasVel);
+		Wide bias = BlendW(softBias, specBias, mask);
 
-		Vector2W dp = { bB.dp.x - bA.dp.x, bB.dp.y - bA.dp.y };
+		// fixed anchors for Jacobians
+		Vector2T<Wide> rA = c.anchorA1;
+		Vector2T<Wide> rB = c.anchorB1;
 
-		// point1 non-penetration constraint
-		{
-			// moving anchors for current separation
-			Vector2W rsA = RotateVectorW(bA.dq, c.anchorA1);
-			Vector2W rsB = RotateVectorW(bB.dq, c.anchorB1);
+		// Relative velocity at contact
+		Wide dvx = (bB.v.x - bB.w * rB.y) - (bA.v.x - bA.w * rA.y);
+		Wide dvy = (bB.v.y + bB.w * rB.x) - (bA.v.y + bA.w * rA.x);
+		Wide vn = dvx * c.normal.x + dvy * c.normal.y;
 
-			// compute current separation
-			// this is subject to round-off error if the anchor is far from the body center of mass
-			Vector2W ds = { dp.x + (rsB.x - rsA.x), dp.y + (rsB.y - rsA.y) };
-			FloatW s = DotW(c.normal, ds) + c.baseSeparation1;
+		// Compute normal impulse
+		Wide negImpulse = c.normalMass1 * massScale * (vn + bias) + impulseScale * c.normalImpulse1;
 
-			// Apply speculative bias if separation is greater than zero, otherwise apply soft constraint bias
-			FloatW mask = s > ZeroFloatW;
-			FloatW specBias = s * inv_h;
-			FloatW softBias = MaxW(biasRate * s, minBiasVel);
-			FloatW bias = BlendW(softBias, specBias, mask);
+		// Clamp the accumulated impulse
+		Wide newImpulse = MaxW(c.normalImpulse1 - negImpulse, zero);
+		Wide impulse = newImpulse - c.normalImpulse1;
+		c.normalImpulse1 = newImpulse;
+		c.maxNormalImpulse1 = MaxW(c.maxNormalImpulse1, newImpulse);
 
-			// fixed anchors for Jacobians
-			Vector2W rA = c.anchorA1;
-			Vector2W rB = c.anchorB1;
+		// Apply contact impulse
+		Wide Px = impulse * c.normal.x;
+		Wide Py = impulse * c.normal.y;
 
-			// Relative velocity at contact
-			FloatW dvx = (bB.v.x - bB.w * rB.y) - (bA.v.x - bA.w * rA.y);
-			FloatW dvy = (bB.v.y + bB.w * rB.x) - (bA.v.y + bA.w * rA.x);
-			FloatW vn = dvx * c.normal.x + dvy * c.normal.y;
+		bA.v.x = MulSubW(bA.v.x, c.invMassA, Px);
+		bA.v.y = MulSubW(bA.v.y, c.invMassA, Py);
+		bA.w = MulSubW(bA.w, c.invIA, rA.x * Py - rA.y * Px);
 
-			// Compute normal impulse
-			FloatW negImpulse = c.normalMass1 * massScale * (vn + bias) + impulseScale * c.normalImpulse1;
+		bB.v.x = MulAddW(bB.v.x, c.invMassB, Px);
+		bB.v.y = MulAddW(bB.v.y, c.invMassB, Py);
+		bB.w = MulAddW(bB.w, c.invIB, rB.x * Py - rB.y * Px);
+	}
 
-			// Clamp the accumulated impulse
-			FloatW newImpulse = MaxW(c.normalImpulse1 - negImpulse, ZeroFloatW);
-			FloatW impulse = newImpulse - c.normalImpulse1;
-			c.normalImpulse1 = newImpulse;
-			c.maxNormalImpulse1 = MaxW(c.maxNormalImpulse1, newImpulse);
+	// second point non-penetration constraint
+	{
+		// moving anchors for current separation
+		Vector2T<Wide> rsA = RotateVectorW(bA.dq, c.anchorA2);
+		Vector2T<Wide> rsB = RotateVectorW(bB.dq, c.anchorB2);
 
-			// Apply contact impulse
-			FloatW Px = impulse * c.normal.x;
-			FloatW Py = impulse * c.normal.y;
+		// compute current separation
+		Vector2T<Wide> ds = { (dp.x + (rsB.x - rsA.x)), (dp.y + (rsB.y - rsA.y)) };
+		Wide s = DotW(c.normal, ds) + c.baseSeparation2;
 
-			bA.v.x = MulSubW(bA.v.x, c.invMassA, Px);
-			bA.v.y = MulSubW(bA.v.y, c.invMassA, Py);
-			bA.w = MulSubW(bA.w, c.invIA, rA.x * Py - rA.y * Px);
+		Wide mask = s > zero;
+		Wide specBias = s * inv_h;
+		Wide softBias = MaxW(biasRate * s, minBiasVel);
+		Wide bias = BlendW(softBias, specBias, mask);
 
-			bB.v.x = MulAddW(bB.v.x, c.invMassB, Px);
-			bB.v.y = MulAddW(bB.v.y, c.invMassB, Py);
-			bB.w = MulAddW(bB.w, c.invIB, rB.x * Py - rB.y * Px);
-		}
+		// fixed anchors for Jacobians
+		Vector2T<Wide> rA = c.anchorA2;
+		Vector2T<Wide> rB = c.anchorB2;
 
-		// second point non-penetration constraint
-		{
-			// moving anchors for current separation
-			Vector2W rsA = RotateVectorW(bA.dq, c.anchorA2);
-			Vector2W rsB = RotateVectorW(bB.dq, c.anchorB2);
+		// Relative velocity at contact
+		Wide dvx = (bB.v.x - bB.w * rB.y) - (bA.v.x - bA.w * rA.y);
+		Wide dvy = (bB.v.y + bB.w * rB.x) - (bA.v.y + bA.w * rA.x);
+		Wide vn = dvx * c.normal.x + dvy * c.normal.y;
 
-			// compute current separation
-			Vector2W ds = { (dp.x + (rsB.x - rsA.x)), (dp.y + (rsB.y - rsA.y)) };
-			FloatW s = DotW(c.normal, ds) + c.baseSeparation2;
+		// Compute normal impulse
+		Wide negImpulse = c.normalMass2 * massScale * (vn + bias) + impulseScale * c.normalImpulse2;
 
-			FloatW mask = s > ZeroFloatW;
-			FloatW specBias = s * inv_h;
-			FloatW softBias = MaxW(biasRate * s, minBiasVel);
-			FloatW bias = BlendW(softBias, specBias, mask);
+		// Clamp the accumulated impulse
+		Wide newImpulse = MaxW(c.normalImpulse2 - negImpulse, zero);
+		Wide impulse = newImpulse - c.normalImpulse2;
+		c.normalImpulse2 = newImpulse;
+		c.maxNormalImpulse2 = MaxW(c.maxNormalImpulse2, newImpulse);
 
-			// fixed anchors for Jacobians
-			Vector2W rA = c.anchorA2;
-			Vector2W rB = c.anchorB2;
+		// Apply contact impulse
+		Wide Px = impulse * c.normal.x;
+		Wide Py = impulse * c.normal.y;
 
-			// Relative velocity at contact
-			FloatW dvx = (bB.v.x - bB.w * rB.y) - (bA.v.x - bA.w * rA.y);
-			FloatW dvy = (bB.v.y + bB.w * rB.x) - (bA.v.y + bA.w * rA.x);
-			FloatW vn = dvx * c.normal.x + dvy * c.normal.y;
+		bA.v.x = MulSubW(bA.v.x, c.invMassA, Px);
+		bA.v.y = MulSubW(bA.v.y, c.invMassA, Py);
+		bA.w = MulSubW(bA.w, c.invIA, rA.x * Py - rA.y * Px);
 
-			// Compute normal impulse
-			FloatW negImpulse = c.normalMass2 * massScale * (vn + bias) + impulseScale * c.normalImpulse2;
+		bB.v.x = MulAddW(bB.v.x, c.invMassB, Px);
+		bB.v.y = MulAddW(bB.v.y, c.invMassB, Py);
+		bB.w = MulAddW(bB.w, c.invIB, rB.x * Py - rB.y * Px);
+	}
 
-			// Clamp the accumulated impulse
-			FloatW newImpulse = MaxW(c.normalImpulse2 - negImpulse, ZeroFloatW);
-			FloatW impulse = newImpulse - c.normalImpulse2;
-			c.normalImpulse2 = newImpulse;
-			c.maxNormalImpulse2 = MaxW(c.maxNormalImpulse2, newImpulse);
+	Wide tangentX = c.normal.y;
+	Wide tangentY = zero - c.normal.x;
 
-			// Apply contact impulse
-			FloatW Px = impulse * c.normal.x;
-			FloatW Py = impulse * c.normal.y;
+	// point 1 friction constraint
+	{
+		// fixed anchors for Jacobians
+		Vector2T<Wide> rA = c.anchorA1;
+		Vector2T<Wide> rB = c.anchorB1;
 
-			bA.v.x = MulSubW(bA.v.x, c.invMassA, Px);
-			bA.v.y = MulSubW(bA.v.y, c.invMassA, Py);
-			bA.w = MulSubW(bA.w, c.invIA, rA.x * Py - rA.y * Px);
+		// Relative velocity at contact
+		Wide dvx = (bB.v.x - bB.w * rB.y) - (bA.v.x - bA.w * rA.y);
+		Wide dvy = (bB.v.y + bB.w * rB.x) - (bA.v.y + bA.w * rA.x);
+		Wide vt = dvx * tangentX + dvy * tangentY;
 
-			bB.v.x = MulAddW(bB.v.x, c.invMassB, Px);
-			bB.v.y = MulAddW(bB.v.y, c.invMassB, Py);
-			bB.w = MulAddW(bB.w, c.invIB, rB.x * Py - rB.y * Px);
-		}
+		// Compute tangent force
+		Wide negImpulse = c.tangentMass1 * vt;
 
-		FloatW tangentX = c.normal.y;
-		FloatW tangentY = ZeroFloatW - c.normal.x;
+		// Clamp the accumulated force
+		Wide maxFriction = c.friction * c.normalImpulse1;
+		Wide newImpulse = c.tangentImpulse1 - negImpulse;
+		newImpulse = MaxW(zero - maxFriction, MinW(newImpulse, maxFriction));
+		Wide impulse = newImpulse - c.tangentImpulse1;
+		c.tangentImpulse1 = newImpulse;
 
-		// point 1 friction constraint
-		{
-			// fixed anchors for Jacobians
-			Vector2W rA = c.anchorA1;
-			Vector2W rB = c.anchorB1;
+		// Apply contact impulse
+		Wide Px = impulse * tangentX;
+		Wide Py = impulse * tangentY;
 
-			// Relative velocity at contact
-			FloatW dvx = (bB.v.x - bB.w * rB.y) - (bA.v.x - bA.w * rA.y);
-			FloatW dvy = (bB.v.y + bB.w * rB.x) - (bA.v.y + bA.w * rA.x);
-			FloatW vt = dvx * tangentX + dvy * tangentY;
+		bA.v.x = MulSubW(bA.v.x, c.invMassA, Px);
+		bA.v.y = MulSubW(bA.v.y, c.invMassA, Py);
+		bA.w = MulSubW(bA.w, c.invIA, rA.x * Py - rA.y * Px);
 
-			// Compute tangent force
-			FloatW negImpulse = c.tangentMass1 * vt;
+		bB.v.x = MulAddW(bB.v.x, c.invMassB, Px);
+		bB.v.y = MulAddW(bB.v.y, c.invMassB, Py);
+		bB.w = MulAddW(bB.w, c.invIB, rB.x * Py - rB.y * Px);
+	}
 
-			// Clamp the accumulated force
-			FloatW maxFriction = c.friction * c.normalImpulse1;
-			FloatW newImpulse = c.tangentImpulse1 - negImpulse;
-			newImpulse = MaxW(ZeroFloatW - maxFriction, MinW(newImpulse, maxFriction));
-			FloatW impulse = newImpulse - c.tangentImpulse1;
-			c.tangentImpulse1 = newImpulse;
+	// second point friction constraint
+	{
+		// fixed anchors for Jacobians
+		Vector2T<Wide> rA = c.anchorA2;
+		Vector2T<Wide> rB = c.anchorB2;
 
-			// Apply contact impulse
-			FloatW Px = impulse * tangentX;
-			FloatW Py = impulse * tangentY;
+		// Relative velocity at contact
+		Wide dvx = (bB.v.x - bB.w * rB.y) - (bA.v.x - bA.w * rA.y);
+		Wide dvy = (bB.v.y + bB.w * rB.x) - (bA.v.y + bA.w * rA.x);
+		Wide vt = dvx * tangentX + dvy * tangentY;
 
-			bA.v.x = MulSubW(bA.v.x, c.invMassA, Px);
-			bA.v.y = MulSubW(bA.v.y, c.invMassA, Py);
-			bA.w = MulSubW(bA.w, c.invIA, rA.x * Py - rA.y * Px);
+		// Compute tangent force
+		Wide negImpulse = c.tangentMass2 * vt;
 
-			bB.v.x = MulAddW(bB.v.x, c.invMassB, Px);
-			bB.v.y = MulAddW(bB.v.y, c.invMassB, Py);
-			bB.w = MulAddW(bB.w, c.invIB, rB.x * Py - rB.y * Px);
-		}
+		// Clamp the accumulated force
+		Wide maxFriction = c.friction * c.normalImpulse2;
+		Wide newImpulse = c.tangentImpulse2 - negImpulse;
+		newImpulse = MaxW(zero - maxFriction, MinW(newImpulse, maxFriction));
+		Wide impulse = newImpulse - c.tangentImpulse2;
+		c.tangentImpulse2 = newImpulse;
 
-		// second point friction constraint
-		{
-			// fixed anchors for Jacobians
-			Vector2W rA = c.anchorA2;
-			Vector2W rB = c.anchorB2;
+		// Apply contact impulse
+		Wide Px = impulse * tangentX;
+		Wide Py = impulse * tangentY;
 
-			// Relative velocity at contact
-			FloatW dvx = (bB.v.x - bB.w * rB.y) - (bA.v.x - bA.w * rA.y);
-			FloatW dvy = (bB.v.y + bB.w * rB.x) - (bA.v.y + bA.w * rA.x);
-			FloatW vt = dvx * tangentX + dvy * tangentY;
+		bA.v.x = MulSubW(bA.v.x, c.invMassA, Px);
+		bA.v.y = MulSubW(bA.v.y, c.invMassA, Py);
+		bA.w = MulSubW(bA.w, c.invIA, rA.x * Py - rA.y * Px);
 
-			// Compute tangent force
-			FloatW negImpulse = c.tangentMass2 * vt;
+		bB.v.x = MulAddW(bB.v.x, c.invMassB, Px);
+		bB.v.y = MulAddW(bB.v.y, c.invMassB, Py);
+		bB.w = MulAddW(bB.w, c.invIB, rB.x * Py - rB.y * Px);
+	}
+}
 
-			// Clamp the accumulated force
-			FloatW maxFriction = c.friction * c.normalImpulse2;
-			FloatW newImpulse = c.tangentImpulse2 - negImpulse;
-			newImpulse = MaxW(ZeroFloatW - maxFriction, MinW(newImpulse, maxFriction));
-			FloatW impulse = newImpulse - c.tangentImpulse2;
-			c.tangentImpulse2 = newImpulse;
+void Physics::SolveContactsTask(int startIndex, int endIndex, StepContext& context, int colorIndex, bool useBias)
+{
+	BodyState* states = context.states;
+	ContactConstraintSIMD* constraints = context.graph->colors[colorIndex].simdConstraints;
+	FloatW inv_h = SplatW(context.inv_h);
+	FloatW minBiasVel = SplatW(-contactPushoutVelocity);
+	FloatW one = SplatW(1.0f);
 
-			// Apply contact impulse
-			FloatW Px = impulse * tangentX;
-			FloatW Py = impulse * tangentY;
+	for (int i = startIndex; i < endIndex; ++i)
+	{
+		ContactConstraintSIMD& c = constraints[i];
 
-			bA.v.x = MulSubW(bA.v.x, c.invMassA, Px);
-			bA.v.y = MulSubW(bA.v.y, c.invMassA, Py);
-			bA.w = MulSubW(bA.w, c.invIA, rA.x * Py - rA.y * Px);
+		SimdBody bA = GatherBodies(states, c.indexA);
+		SimdBody bB = GatherBodies(states, c.indexB);
 
-			bB.v.x = MulAddW(bB.v.x, c.invMassB, Px);
-			bB.v.y = MulAddW(bB.v.y, c.invMassB, Py);
-			bB.w = MulAddW(bB.w, c.invIB, rB.x * Py - rB.y * Px);
-		}
+		SolveContact(c, bA, bB, inv_h, minBiasVel, ZeroFloatW, one, useBias);
 
 		ScatterBodies(states, c.indexA, bA);
 		ScatterBodies(states, c.indexB, bB);
 	}
 }
 
+#ifdef NH_SIMD_PAIR
+
+NH_TARGET_AVX2 static SimdBodyT<FloatPairW> JoinBodies(const SimdBody& low, const SimdBody& high)
+{
+	SimdBodyT<FloatPairW> body;
+	body.v.x = JoinW(low.v.x, high.v.x);
+	body.v.y = JoinW(low.v.y, high.v.y);
+	body.w = JoinW(low.w, high.w);
+	body.flags = JoinW(low.flags, high.flags);
+	body.dp.x = JoinW(low.dp.x, high.dp.x);
+	body.dp.y = JoinW(low.dp.y, high.dp.y);
+	body.dq.c = JoinW(low.dq.c, high.dq.c);
+	body.dq.s = JoinW(low.dq.s, high.dq.s);
+	return body;
+}
+
+// Scatter only writes the velocities back
+NH_TARGET_AVX2 static void SplitBodies(const SimdBodyT<FloatPairW>& body, SimdBody& low, SimdBody& high)
+{
+	low.v.x = LowW(body.v.x);
+	low.v.y = LowW(body.v.y);
+	low.w = LowW(body.w);
+	low.flags = LowW(body.flags);
+	high.v.x = HighW(body.v.x);
+	high.v.y = HighW(body.v.y);
+	high.w = HighW(body.w);
+	high.flags = HighW(body.flags);
+}
+
+// Everything SolveContact reads, restitution and relative velocity aren't used by it
+NH_TARGET_AVX2 static ContactConstraintT<FloatPairW> JoinConstraints(const ContactConstraintSIMD& low, const ContactConstraintSIMD& high)
+{
+	ContactConstraintT<FloatPairW> c;
+	c.invMassA = JoinW(low.invMassA, high.invMassA);
+	c.invMassB = JoinW(low.invMassB, high.invMassB);
+	c.invIA = JoinW(low.invIA, high.invIA);
+	c.invIB = JoinW(low.invIB, high.invIB);
+	c.normal.x = JoinW(low.normal.x, high.normal.x);
+	c.normal.y = JoinW(low.normal.y, high.normal.y);
+	c.friction = JoinW(low.friction, high.friction);
+	c.biasRate = JoinW(low.biasRate, high.biasRate);
+	c.massScale = JoinW(low.massScale, high.massScale);
+	c.impulseScale = JoinW(low.impulseScale, high.impulseScale);
+	c.anchorA1.x = JoinW(low.anchorA1.x, high.anchorA1.x);
+	c.anchorA1.y = JoinW(low.anchorA1.y, high.anchorA1.y);
+	c.anchorB1.x = JoinW(low.anchorB1.x, high.anchorB1.x);
+	c.anchorB1.y = JoinW(low.anchorB1.y, high.anchorB1.y);
+	c.normalMass1 = JoinW(low.normalMass1, high.normalMass1);
+	c.tangentMass1 = JoinW(low.tangentMass1, high.tangentMass1);
+	c.baseSeparation1 = JoinW(low.baseSeparation1, high.baseSeparation1);
+	c.normalImpulse1 = JoinW(low.normalImpulse1, high.normalImpulse1);
+	c.maxNormalImpulse1 = JoinW(low.maxNormalImpulse1, high.maxNormalImpulse1);
+	c.tangentImpulse1 = JoinW(low.tangentImpulse1, high.tangentImpulse1);
+	c.anchorA2.x = JoinW(low.anchorA2.x, high.anchorA2.x);
+	c.anchorA2.y = JoinW(low.anchorA2.y, high.anchorA2.y);
+	c.anchorB2.x = JoinW(low.anchorB2.x, high.anchorB2.x);
+	c.anchorB2.y = JoinW(low.anchorB2.y, high.anchorB2.y);
+	c.normalMass2 = JoinW(low.normalMass2, high.normalMass2);
+	c.tangentMass2 = JoinW(low.tangentMass2, high.tangentMass2);
+	c.baseSeparation2 = JoinW(low.baseSeparation2, high.baseSeparation2);
+	c.normalImpulse2 = JoinW(low.normalImpulse2, high.normalImpulse2);
+	c.maxNormalImpulse2 = JoinW(low.maxNormalImpulse2, high.maxNormalImpulse2);
+	c.tangentImpulse2 = JoinW(low.tangentImpulse2, high.tangentImpulse2);
+	return c;
+}
+
+// The accumulated impulses are all SolveContact writes
+NH_TARGET_AVX2 static void SplitImpulses(const ContactConstraintT<FloatPairW>& c, ContactConstraintSIMD& low, ContactConstraintSIMD& high)
+{
+	low.normalImpulse1 = LowW(c.normalImpulse1);
+	low.maxNormalImpulse1 = LowW(c.maxNormalImpulse1);
+	low.tangentImpulse1 = LowW(c.tangentImpulse1);
+	low.normalImpulse2 = LowW(c.normalImpulse2);
+	low.maxNormalImpulse2 = LowW(c.maxNormalImpulse2);
+	low.tangentImpulse2 = LowW(c.tangentImpulse2);
+	high.normalImpulse1 = HighW(c.normalImpulse1);
+	high.maxNormalImpulse1 = HighW(c.maxNormalImpulse1);
+	high.tangentImpulse1 = HighW(c.tangentImpulse1);
+	high.normalImpulse2 = HighW(c.normalImpulse2);
+	high.maxNormalImpulse2 = HighW(c.maxNormalImpulse2);
+	high.tangentImpulse2 = HighW(c.tangentImpulse2);
+}
+
+// Constraints of one color never share a body, so two of them can be solved together in one 8 wide pass
+NH_TARGET_AVX2 void Physics::SolveContactPairsTask(int startIndex, int endIndex, StepContext& context, int colorIndex, bool useBias)
+{
+	BodyState* states = context.states;
+	ContactConstraintSIMD* constraints = context.graph->colors[colorIndex].simdConstraints;
+	FloatPairW inv_h = SplatPairW(context.inv_h);
+	FloatPairW minBiasVel = SplatPairW(-contactPushoutVelocity);
+	FloatPairW zero = SplatPairW(0.0f);
+	FloatPairW one = SplatPairW(1.0f);
+
+	int i = startIndex;
+	for (; i + 1 < endIndex; i += 2)
+	{
+		ContactConstraintSIMD& low = constraints[i];
+		ContactConstraintSIMD& high = constraints[i + 1];
+
+		ContactConstraintT<FloatPairW> c = JoinConstraints(low, high);
+		SimdBodyT<FloatPairW> bA = JoinBodies(GatherBodies(states, low.indexA), GatherBodies(states, high.indexA));
+		SimdBodyT<FloatPairW> bB = JoinBodies(GatherBodies(states, low.indexB), GatherBodies(states, high.indexB));
+
+		SolveContact(c, bA, bB, inv_h, minBiasVel, zero, one, useBias);
+
+		SplitImpulses(c, low, high);
+
+		SimdBody lowA, highA, lowB, highB;
+		SplitBodies(bA, lowA, highA);
+		SplitBodies(bB, lowB, highB);
+
+		ScatterBodies(states, low.indexA, lowA);
+		ScatterBodies(states, high.indexA, highA);
+		ScatterBodies(states, low.indexB, lowB);
+		ScatterBodies(states, high.indexB, highB);
+	}
+
+	_mm256_zeroupper();
+
+	if (i < endIndex) { SolveContactsTask(i, endIndex, context, colorIndex, useBias); }
+}
+
+#endif
+
 void Physics::CreateContact(Shape& shapeA, Shape& shapeB)
 {
 	ShapeType type1 = shapeA.type;
@@ -3095,7 +4128,7 @@ void Physics::CreateContact(Shape& shapeA, Shape& shapeB)
 	SolverSet& set = solverSets[setIndex];
 
 	// Create contact key and contact
-	I32 contactId = contactFreelist.GetFree();
+	I32 contactId = contactFreelist.GetFreeOrGrow();
 	if (contactId == contacts.Size())
 	{
 		contacts.Push({});
@@ -3117,16 +4150,6 @@ void Physics::CreateContact(Shape& shapeA, Shape& shapeB)
 	contact.isMarked = false;
 	contact.flags = 0;
 
-	if (shapeA.isSensor || shapeB.isSensor)
-	{
-		contact.flags |= CONTACT_FLAG_SENSOR;
-	}
-
-	if (shapeA.enableSensorEvents || shapeB.enableSensorEvents)
-	{
-		contact.flags |= CONTACT_FLAG_ENABLE_SENSOR_EVENTS;
-	}
-
 	if (shapeA.enableContactEvents || shapeB.enableContactEvents)
 	{
 		contact.flags |= CONTACT_FLAG_ENABLE_CONTACT_EVENTS;
@@ -3189,6 +4212,9 @@ void Physics::CreateContact(Shape& shapeA, Shape& shapeB)
 	contactSim.restitution = MixRestitution(shapeA.restitution, shapeB.restitution);
 	contactSim.tangentSpeed = 0.0f;
 	contactSim.simFlags = 0;
+	contactSim.cacheTransformA = {};
+	contactSim.cacheTransformB = {};
+	contactSim.cacheDrift = 0.0f;
 
 	if (shapeA.enablePreSolveEvents || shapeB.enablePreSolveEvents)
 	{
@@ -3300,82 +4326,107 @@ void Physics::DestroyContact(Contact& contact, bool wakeBodies)
 	}
 }
 
-bool Physics::UpdateContact(ContactSim& contactSim, Shape& shapeA, const Transform2D& transformA, const Vector2& centerOffsetA,
-	Shape& shapeB, const Transform2D& transformB, const Vector2& centerOffsetB)
+void Physics::DestroyContactsBetweenBodies(RigidBody2D& bodyA, RigidBody2D& bodyB)
 {
-	bool touching;
+	I32 contactKey;
+	I32 otherBodyId;
 
-	// Is this contact a sensor?
-	if (shapeA.isSensor || shapeB.isSensor)
+	// use the smaller of the two contact lists
+	if (bodyA.contactCount < bodyB.contactCount)
 	{
-		// Sensors don't generate manifolds or hit events
-		touching = TestShapeOverlap(shapeA, transformA, shapeB, transformB, contactSim.cache);
+		contactKey = bodyA.headContactKey;
+		otherBodyId = bodyB.id;
 	}
 	else
 	{
-		Manifold oldManifold = contactSim.manifold;
-
-		// Compute TOI
-		ManifoldFn* fcn = contactRegister[shapeA.type][shapeB.type].fcn;
-
-		contactSim.manifold = fcn(shapeA, transformA, shapeB, transformB, contactSim.cache);
+		contactKey = bodyB.headContactKey;
+		otherBodyId = bodyA.id;
+	}
 
-		int pointCount = contactSim.manifold.pointCount;
-		touching = pointCount > 0;
+	while (contactKey != NullIndex)
+	{
+		I32 contactId = contactKey >> 1;
+		I32 edgeIndex = contactKey & 1;
 
-		//TODO: preSolve function?
-		//if (touching && world->preSolveFcn && (contactSim.simFlags & CONTACT_SIM_FLAG_ENABLE_PRESOLVE_EVENTS) != 0)
-		//{
-		//	I32 shapeIdA = shapeA.id + 1;
-		//	I32 shapeIdB = shapeB.id + 1;
-		//
-		//	// this call assumes thread safety
-		//	touching = world->preSolveFcn(shapeIdA, shapeIdB, &contactSim.manifold, world->preSolveContext);
-		//	if (touching == false)
-		//	{
-		//		// disable contact
-		//		contactSim.manifold.pointCount = 0;
-		//	}
-		//}
+		Contact& contact = contacts[contactId];
+		contactKey = contact.edges[edgeIndex].nextKey;
 
-		if (touching && (shapeA.enableHitEvents || shapeB.enableHitEvents))
-		{
-			contactSim.simFlags |= CONTACT_SIM_FLAG_ENABLE_HIT_EVENT;
-		}
-		else
+		I32 otherEdgeIndex = edgeIndex ^ 1;
+		if (contact.edges[otherEdgeIndex].bodyId == otherBodyId)
 		{
-			contactSim.simFlags &= ~CONTACT_SIM_FLAG_ENABLE_HIT_EVENT;
+			// Bodies are joined so the contact won't be recreated, no need to wake them
+			DestroyContact(contact, false);
 		}
+	}
+}
 
-		// Match old contact ids to new contact ids and copy the
-		// stored impulses to warm start the solver.
-		for (int i = 0; i < pointCount; ++i)
-		{
-			ManifoldPoint& mp2 = contactSim.manifold.points[i];
+bool Physics::UpdateContact(ContactSim& contactSim, Shape& shapeA, const Transform2D& transformA, const Vector2& centerOffsetA,
+	Shape& shapeB, const Transform2D& transformB, const Vector2& centerOffsetB)
+{
+	bool touching;
 
-			// shift anchors to be center of mass relative
-			mp2.anchorA = mp2.anchorA - centerOffsetA;
-			mp2.anchorB = mp2.anchorB - centerOffsetB;
+	Manifold oldManifold = contactSim.manifold;
 
-			mp2.normalImpulse = 0.0f;
-			mp2.tangentImpulse = 0.0f;
-			mp2.maxNormalImpulse = 0.0f;
-			mp2.normalVelocity = 0.0f;
-			mp2.persisted = false;
+	// Compute TOI
+	ManifoldFn* fcn = contactRegister[shapeA.type][shapeB.type].fcn;
 
-			U16 id2 = mp2.id;
+	contactSim.manifold = fcn(shapeA, transformA, shapeB, transformB, contactSim.cache);
 
-			for (U32 j = 0; j < oldManifold.pointCount; ++j)
-			{
-				ManifoldPoint& mp1 = oldManifold.points[j];
+	int pointCount = contactSim.manifold.pointCount;
+	touching = pointCount > 0;
 
-				if (mp1.id == id2)
-				{
-					mp2.normalImpulse = mp1.normalImpulse;
-					mp2.tangentImpulse = mp1.tangentImpulse;
-					mp2.persisted = true;
-					break;
-				}
+	//TODO: preSolve function?
+	//if (touching && world->preSolveFcn && (contactSim.simFlags & CONTACT_SIM_FLAG_ENABLE_PRESOLVE_EVENTS) != 0)
+	//{
+	//	I32 shapeIdA = shapeA.id + 1;
+	//	I32 shapeIdB = shapeB.id + 1;
+	//
+	//	// this call assumes thread safety
+	//	touching = world->preSolveFcn(shapeIdA, shapeIdB, &contactSim.manifold, world->preSolveContext);
+	//	if (touching == false)
+	//	{
+	//		// disable contact
+	//		contactSim.manifold.pointCount = 0;
+	//	}
+	//}
+
+	if (touching && (shapeA.enableHitEvents || shapeB.enableHitEvents))
+	{
+		contactSim.simFlags |= CONTACT_SIM_FLAG_ENABLE_HIT_EVENT;
+	}
+	else
+	{
+		contactSim.simFlags &= ~CONTACT_SIM_FLAG_ENABLE_HIT_EVENT;
+	}
+
+	// Match old contact ids to new contact ids and copy the
+	// stored impulses to warm start the solver.
+	for (int i = 0; i < pointCount; ++i)
+	{
+		ManifoldPoint& mp2 = contactSim.manifold.points[i];
+
+		// shift anchors to be center of mass relative
+		mp2.anchorA = mp2.anchorA - centerOffsetA;
+		mp2.anchorB = mp2.anchorB - centerOffsetB;
+
+		mp2.normalImpulse = 0.0f;
+		mp2.tangentImpulse = 0.0f;
+		mp2.maxNormalImpulse = 0.0f;
+		mp2.normalVelocity = 0.0f;
+		mp2.persisted = false;
+
+		U16 id2 = mp2.id;
+
+		for (U32 j = 0; j < oldManifold.pointCount; ++j)
+		{
+			ManifoldPoint& mp1 = oldManifold.points[j];
+
+			if (mp1.id == id2)
+			{
+				mp2.normalImpulse = mp1.normalImpulse;
+				mp2.tangentImpulse = mp1.tangentImpulse;
+				mp2.persisted = true;
+				break;
 			}
 		}
 	}
@@ -3389,9 +4440,74 @@ bool Physics::UpdateContact(ContactSim& contactSim, Shape& shapeA, const Transfo
 		contactSim.simFlags &= ~CONTACT_SIM_FLAG_TOUCHING;
 	}
 
+	contactSim.cacheTransformA = transformA;
+	contactSim.cacheTransformB = transformB;
+	contactSim.cacheDrift = 0.0f;
+
 	return touching;
 }
 
+// The furthest any point of the shape is from its body's origin
+static F32 ShapeRadius(const Shape& shape, const Vector2& origin)
+{
+	Vector2 halfExtents = (shape.aabb.upperBound - shape.aabb.lowerBound) * 0.5f;
+	return (shape.aabb.Center() - origin).Magnitude() + halfExtents.Magnitude();
+}
+
+bool Physics::ReuseManifold(ContactSim& contactSim, const Shape& shapeA, const Transform2D& transformA, const Vector2& centerOffsetA,
+	const Shape& shapeB, const Transform2D& transformB, const Vector2& centerOffsetB)
+{
+	const Transform2D& oldA = contactSim.cacheTransformA;
+	const Transform2D& oldB = contactSim.cacheTransformB;
+
+	Transform2D oldRelative = oldA ^ oldB;
+	Transform2D relative = transformA ^ transformB;
+	Quaternion2 relativeRotation = oldRelative.rotation ^ relative.rotation;
+
+	if (relativeRotation.y <= 0.0f) { return false; }
+
+	// Bound how far any point of B moved in A's frame, or of A in B's frame, whichever shape is smaller gives the tighter bound.
+	// Sin of the angle is close enough at angles this small
+	F32 angle = Math::Abs(relativeRotation.x);
+	F32 moveB = (relative.position - oldRelative.position).Magnitude() + angle * ShapeRadius(shapeB, transformB.position);
+	F32 moveA = ((transformB ^ transformA).position - (oldB ^ oldA).position).Magnitude() + angle * ShapeRadius(shapeA, transformA.position);
+
+	F32 drift = contactSim.cacheDrift + Math::Min(moveA, moveB);
+
+	// The drift adds up over every reuse so a slow creep still reaches the narrowphase
+	if (drift > ManifoldReuseDistance) { return false; }
+
+	// The manifold moves rigidly with A, each separation picks up how far B's side of the point moved along the normal
+	Quaternion2 rotationA = oldA.rotation ^ transformA.rotation;
+
+	Manifold& manifold = contactSim.manifold;
+	manifold.normal = manifold.normal * rotationA;
+
+	for (U32 i = 0; i < manifold.pointCount; ++i)
+	{
+		ManifoldPoint& mp = manifold.points[i];
+
+		Vector2 pointA = transformA.position + (mp.point - oldA.position) * rotationA;
+		Vector2 pointB = transformB.position + ((mp.point - oldB.position) ^ oldB.rotation) * transformB.rotation;
+
+		mp.separation += (pointB - pointA).Dot(manifold.normal);
+		mp.point = pointA;
+		mp.anchorA = pointA - transformA.position - centerOffsetA;
+		mp.anchorB = pointA - transformB.position - centerOffsetB;
+
+		// Same as UpdateContact, the impulses carry over to warm start the solver
+		mp.maxNormalImpulse = 0.0f;
+		mp.normalVelocity = 0.0f;
+		mp.persisted = true;
+	}
+
+	contactSim.cacheTransformA = transformA;
+	contactSim.cacheTransformB = transformB;
+	contactSim.cacheDrift = drift;
+
+	return true;
+}
+
 void Physics::LinkContact(Contact& contact)
 {
 	int bodyIdA = contact.edges[0].bodyId;
@@ -3492,22 +4608,120 @@ void Physics::UnlinkContact(Contact& contact)
 		nextContact.islandPrev = contact.islandPrev;
 	}
 
-	if (island.headContact == contact.contactId)
-	{
-		island.headContact = contact.islandNext;
-	}
+	if (island.headContact == contact.contactId)
+	{
+		island.headContact = contact.islandNext;
+	}
+
+	if (island.tailContact == contact.contactId)
+	{
+		island.tailContact = contact.islandPrev;
+	}
+
+	island.contactCount -= 1;
+	island.constraintRemoveCount += 1;
+
+	contact.islandId = NullIndex;
+	contact.islandPrev = NullIndex;
+	contact.islandNext = NullIndex;
+}
+
+I32 Physics::CreateJointInternal(const JointSim& jointSim, void* userData, F32 drawSize, bool collideConnected)
+{
+	int bodyIdA = jointSim.bodyIdA;
+	int bodyIdB = jointSim.bodyIdB;
+
+	int jointId = jointFreelist.GetFreeOrGrow();
+	if (jointId == joints.Size())
+	{
+		joints.Push({});
+	}
+
+	Joint& joint = joints[jointId];
+	joint.jointId = jointId;
+	joint.userData = userData;
+	joint.revision += 1;
+	joint.setIndex = NullIndex;
+	joint.colorIndex = NullIndex;
+	joint.localIndex = NullIndex;
+	joint.islandId = NullIndex;
+	joint.islandPrev = NullIndex;
+	joint.islandNext = NullIndex;
+	joint.drawSize = drawSize;
+	joint.type = jointSim.type;
+	joint.collideConnected = collideConnected;
+	joint.isMarked = false;
+
+	// Doubly linked list on bodyA
+	RigidBody2D& bodyA = rigidBodies[bodyIdA];
+	joint.edges[0].bodyId = bodyIdA;
+	joint.edges[0].prevKey = NullIndex;
+	joint.edges[0].nextKey = bodyA.headJointKey;
+
+	int keyA = (jointId << 1) | 0;
+	if (bodyA.headJointKey != NullIndex)
+	{
+		Joint& jointA = joints[bodyA.headJointKey >> 1];
+		JointEdge& edgeA = jointA.edges[bodyA.headJointKey & 1];
+		edgeA.prevKey = keyA;
+	}
+
+	bodyA.headJointKey = keyA;
+	bodyA.jointCount += 1;
+
+	// Doubly linked list on bodyB
+	RigidBody2D& bodyB = rigidBodies[bodyIdB];
+	joint.edges[1].bodyId = bodyIdB;
+	joint.edges[1].prevKey = NullIndex;
+	joint.edges[1].nextKey = bodyB.headJointKey;
+
+	int keyB = (jointId << 1) | 1;
+	if (bodyB.headJointKey != NullIndex)
+	{
+		Joint& jointB = joints[bodyB.headJointKey >> 1];
+		JointEdge& edgeB = jointB.edges[bodyB.headJointKey & 1];
+		edgeB.prevKey = keyB;
+	}
+
+	bodyB.headJointKey = keyB;
+	bodyB.jointCount += 1;
+
+	if (bodyA.setIndex == SET_TYPE_DISABLED || bodyB.setIndex == SET_TYPE_DISABLED)
+	{
+		// if either body is disabled, create in disabled set
+		SolverSet& set = solverSets[SET_TYPE_DISABLED];
+		joint.setIndex = SET_TYPE_DISABLED;
+		joint.localIndex = (I32)set.jointSims.Size();
+
+		JointSim& sim = set.jointSims.Push(jointSim);
+		sim.jointId = jointId;
+	}
+	else if (bodyA.setIndex == SET_TYPE_STATIC && bodyB.setIndex == SET_TYPE_STATIC)
+	{
+		// joint is connecting static bodies
+		SolverSet& set = solverSets[SET_TYPE_STATIC];
+		joint.setIndex = SET_TYPE_STATIC;
+		joint.localIndex = (I32)set.jointSims.Size();
+
+		JointSim& sim = set.jointSims.Push(jointSim);
+		sim.jointId = jointId;
+	}
+	else
+	{
+		// There is no solver set merge, so a joint touching a sleeping body wakes it and lives in the awake set
+		WakeBody(bodyA);
+		WakeBody(bodyB);
+
+		joint.setIndex = SET_TYPE_AWAKE;
+		constraintGraph.AddJoint(jointSim, joint);
+
+		JointSim& sim = constraintGraph.colors[joint.colorIndex].jointSims[joint.localIndex];
+		sim.jointId = jointId;
 
-	if (island.tailContact == contact.contactId)
-	{
-		island.tailContact = contact.islandPrev;
+		LinkJoint(joint);
 	}
 
-	island.contactCount -= 1;
-	island.constraintRemoveCount += 1;
-
-	contact.islandId = NullIndex;
-	contact.islandPrev = NullIndex;
-	contact.islandNext = NullIndex;
+	return jointId;
 }
 
 void Physics::DestroyJointInternal(Joint& joint, bool wakeBodies)
@@ -3609,6 +4823,75 @@ void Physics::DestroyJointInternal(Joint& joint, bool wakeBodies)
 	}
 }
 
+void Physics::LinkJoint(Joint& joint)
+{
+	RigidBody2D& bodyA = rigidBodies[joint.edges[0].bodyId];
+	RigidBody2D& bodyB = rigidBodies[joint.edges[1].bodyId];
+
+	int islandIdA = bodyA.islandId;
+	int islandIdB = bodyB.islandId;
+
+	// Static bodies have no island
+	if (islandIdA == NullIndex && islandIdB == NullIndex) { return; }
+
+	if (islandIdA == islandIdB)
+	{
+		// Joint in same island
+		AddJointToIsland(islandIdA, joint);
+		return;
+	}
+
+	// Union-find root of islandA
+	Island* islandA = nullptr;
+	if (islandIdA != NullIndex)
+	{
+		islandA = &islands[islandIdA];
+		while (islandA->parentIsland != NullIndex)
+		{
+			Island* parent = &islands[islandA->parentIsland];
+			if (parent->parentIsland != NullIndex)
+			{
+				// path compression
+				islandA->parentIsland = parent->parentIsland;
+			}
+
+			islandIdA = islandA->parentIsland;
+			islandA = parent;
+		}
+	}
+
+	// Union-find root of islandB
+	Island* islandB = nullptr;
+	if (islandIdB != NullIndex)
+	{
+		islandB = &islands[islandIdB];
+		while (islandB->parentIsland != NullIndex)
+		{
+			Island* parent = &islands[islandB->parentIsland];
+			if (parent->parentIsland != NullIndex)
+			{
+				// path compression
+				islandB->parentIsland = parent->parentIsland;
+			}
+
+			islandIdB = islandB->parentIsland;
+			islandB = parent;
+		}
+	}
+
+	// Union-Find link island roots
+	if (islandA != islandB && islandA != nullptr && islandB != nullptr)
+	{
+		islandB->parentIsland = islandIdA;
+	}
+
+	if (islandA != nullptr) { AddJointToIsland(islandIdA, joint); }
+	else { AddJointToIsland(islandIdB, joint); }
+
+	// Joints are created outside the step so merge now instead of waiting for the next solve
+	MergeAwakeIslands();
+}
+
 void Physics::UnlinkJoint(Joint& joint)
 {
 	// remove from island
@@ -5754,30 +7037,30 @@ void Physics::StoreImpulsesTask(int startIndex, int endIndex, StepContext& conte
 
 #endif
 
-#if defined( NH_SIMD_AVX2 )
+#if defined( NH_SIMD_AVX )
 
 // This is a load and 8x8 transpose
 SimdBody Physics::GatherBodies(const BodyState* states, int* indices)
 {
 	// b2BodyState b2_identityBodyState = {{0.0f, 0.0f}, 0.0f, 0, {0.0f, 0.0f}, {1.0f, 0.0f}};
-	FloatW identity = _mm256_setr_ps(0.0f, 0.0f, 0.0f, 0, 0.0f, 0.0f, 1.0f, 0.0f);
-	FloatW b0 = indices[0] == NullIndex ? identity : _mm256_load_ps((float*)(states + indices[0]));
-	FloatW b1 = indices[1] == NullIndex ? identity : _mm256_load_ps((float*)(states + indices[1]));
-	FloatW b2 = indices[2] == NullIndex ? identity : _mm256_load_ps((float*)(states + indices[2]));
-	FloatW b3 = indices[3] == NullIndex ? identity : _mm256_load_ps((float*)(states + indices[3]));
-	FloatW b4 = indices[4] == NullIndex ? identity : _mm256_load_ps((float*)(states + indices[4]));
-	FloatW b5 = indices[5] == NullIndex ? identity : _mm256_load_ps((float*)(states + indices[5]));
-	FloatW b6 = indices[6] == NullIndex ? identity : _mm256_load_ps((float*)(states + indices[6]));
-	FloatW b7 = indices[7] == NullIndex ? identity : _mm256_load_ps((float*)(states + indices[7]));
-
-	FloatW t0 = _mm256_unpacklo_ps(b0, b1);
-	FloatW t1 = _mm256_unpackhi_ps(b0, b1);
-	FloatW t2 = _mm256_unpacklo_ps(b2, b3);
-	FloatW t3 = _mm256_unpackhi_ps(b2, b3);
-	FloatW t4 = _mm256_unpacklo_ps(b4, b5);
-	FloatW t5 = _mm256_unpackhi_ps(b4, b5);
-	FloatW t6 = _mm256_unpacklo_ps(b6, b7);
-	FloatW t7 = _mm256_unpackhi_ps(b6, b7);
+	FloatW identity = SetW(0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f);
+	FloatW b0 = indices[0] == NullIndex ? identity : LoadW((float*)(states + indices[0]));
+	FloatW b1 = indices[1] == NullIndex ? identity : LoadW((float*)(states + indices[1]));
+	FloatW b2 = indices[2] == NullIndex ? identity : LoadW((float*)(states + indices[2]));
+	FloatW b3 = indices[3] == NullIndex ? identity : LoadW((float*)(states + indices[3]));
+	FloatW b4 = indices[4] == NullIndex ? identity : LoadW((float*)(states + indices[4]));
+	FloatW b5 = indices[5] == NullIndex ? identity : LoadW((float*)(states + indices[5]));
+	FloatW b6 = indices[6] == NullIndex ? identity : LoadW((float*)(states + indices[6]));
+	FloatW b7 = indices[7] == NullIndex ? identity : LoadW((float*)(states + indices[7]));
+
+	FloatW t0 = UnpackLoW(b0, b1);
+	FloatW t1 = UnpackHiW(b0, b1);
+	FloatW t2 = UnpackLoW(b2, b3);
+	FloatW t3 = UnpackHiW(b2, b3);
+	FloatW t4 = UnpackLoW(b4, b5);
+	FloatW t5 = UnpackHiW(b4, b5);
+	FloatW t6 = UnpackLoW(b6, b7);
+	FloatW t7 = UnpackHiW(b6, b7);
 	FloatW tt0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
 	FloatW tt1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
 	FloatW tt2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
@@ -5802,14 +7085,14 @@ SimdBody Physics::GatherBodies(const BodyState* states, int* indices)
 // This writes everything back to the solver bodies but only the velocities change
 void Physics::ScatterBodies(BodyState* states, int* indices, const SimdBody& simdBody)
 {
-	FloatW t0 = _mm256_unpacklo_ps(simdBody.v.x, simdBody.v.y);
-	FloatW t1 = _mm256_unpackhi_ps(simdBody.v.x, simdBody.v.y);
-	FloatW t2 = _mm256_unpacklo_ps(simdBody.w, simdBody.flags);
-	FloatW t3 = _mm256_unpackhi_ps(simdBody.w, simdBody.flags);
-	FloatW t4 = _mm256_unpacklo_ps(simdBody.dp.x, simdBody.dp.y);
-	FloatW t5 = _mm256_unpackhi_ps(simdBody.dp.x, simdBody.dp.y);
-	FloatW t6 = _mm256_unpacklo_ps(simdBody.dq.c, simdBody.dq.s);
-	FloatW t7 = _mm256_unpackhi_ps(simdBody.dq.c, simdBody.dq.s);
+	FloatW t0 = UnpackLoW(simdBody.v.x, simdBody.v.y);
+	FloatW t1 = UnpackHiW(simdBody.v.x, simdBody.v.y);
+	FloatW t2 = UnpackLoW(simdBody.w, simdBody.flags);
+	FloatW t3 = UnpackHiW(simdBody.w, simdBody.flags);
+	FloatW t4 = UnpackLoW(simdBody.dp.x, simdBody.dp.y);
+	FloatW t5 = UnpackHiW(simdBody.dp.x, simdBody.dp.y);
+	FloatW t6 = UnpackLoW(simdBody.dq.c, simdBody.dq.s);
+	FloatW t7 = UnpackHiW(simdBody.dq.c, simdBody.dq.s);
 	FloatW tt0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
 	FloatW tt1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
 	FloatW tt2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
@@ -5821,14 +7104,14 @@ void Physics::ScatterBodies(BodyState* states, int* indices, const SimdBody& sim
 
 	// I don't use any dummy body in the body array because this will lead to multithreaded sharing and the
 	// associated cache flushing.
-	if (indices[0] != NullIndex) { _mm256_store_ps((float*)(states + indices[0]), _mm256_permute2f128_ps(tt0, tt4, 0x20)); }
-	if (indices[1] != NullIndex) { _mm256_store_ps((float*)(states + indices[1]), _mm256_permute2f128_ps(tt1, tt5, 0x20)); }
-	if (indices[2] != NullIndex) { _mm256_store_ps((float*)(states + indices[2]), _mm256_permute2f128_ps(tt2, tt6, 0x20)); }
-	if (indices[3] != NullIndex) { _mm256_store_ps((float*)(states + indices[3]), _mm256_permute2f128_ps(tt3, tt7, 0x20)); }
-	if (indices[4] != NullIndex) { _mm256_store_ps((float*)(states + indices[4]), _mm256_permute2f128_ps(tt0, tt4, 0x31)); }
-	if (indices[5] != NullIndex) { _mm256_store_ps((float*)(states + indices[5]), _mm256_permute2f128_ps(tt1, tt5, 0x31)); }
-	if (indices[6] != NullIndex) { _mm256_store_ps((float*)(states + indices[6]), _mm256_permute2f128_ps(tt2, tt6, 0x31)); }
-	if (indices[7] != NullIndex) { _mm256_store_ps((float*)(states + indices[7]), _mm256_permute2f128_ps(tt3, tt7, 0x31)); }
+	if (indices[0] != NullIndex) { StoreW((float*)(states + indices[0]), _mm256_permute2f128_ps(tt0, tt4, 0x20)); }
+	if (indices[1] != NullIndex) { StoreW((float*)(states + indices[1]), _mm256_permute2f128_ps(tt1, tt5, 0x20)); }
+	if (indices[2] != NullIndex) { StoreW((float*)(states + indices[2]), _mm256_permute2f128_ps(tt2, tt6, 0x20)); }
+	if (indices[3] != NullIndex) { StoreW((float*)(states + indices[3]), _mm256_permute2f128_ps(tt3, tt7, 0x20)); }
+	if (indices[4] != NullIndex) { StoreW((float*)(states + indices[4]), _mm256_permute2f128_ps(tt0, tt4, 0x31)); }
+	if (indices[5] != NullIndex) { StoreW((float*)(states + indices[5]), _mm256_permute2f128_ps(tt1, tt5, 0x31)); }
+	if (indices[6] != NullIndex) { StoreW((float*)(states + indices[6]), _mm256_permute2f128_ps(tt2, tt6, 0x31)); }
+	if (indices[7] != NullIndex) { StoreW((float*)(states + indices[7]), _mm256_permute2f128_ps(tt3, tt7, 0x31)); }
 }
 
 #elif defined( NH_SIMD_NEON )
@@ -6078,8 +7361,8 @@ void Physics::FinalizeBodiesTask(int startIndex, int endIndex, U32 threadIndex,
 	float timeStep = stepContext.dt;
 	float invTimeStep = stepContext.inv_dt;
 
-	// The body move event array has should already have the correct size
-	BodyMoveEvent* moveEvents = bodyMoveEvents.Data();
+	// The body move event array already has room for this step, offset past the earlier steps' events
+	BodyMoveEvent* moveEvents = bodyMoveEvents.Data() + stepContext.moveEventOffset;
 
 	Bitset& enlargedSimBitSet = taskContexts[threadIndex].enlargedSimBitset;
 	Bitset& awakeIslandBitSet = taskContexts[threadIndex].awakeIslandBitset;
@@ -6115,7 +7398,7 @@ void Physics::FinalizeBodiesTask(int startIndex, int endIndex, U32 threadIndex,
 
 		// cache miss here, however I need the shape list below
 		RigidBody2D& body = rigidBodies[sim.bodyId];
-		body.bodyMoveIndex = simIndex;
+		body.bodyMoveIndex = stepContext.moveEventOffset + simIndex;
 		moveEvents[simIndex].transform = sim.transform;
 		moveEvents[simIndex].bodyId = sim.bodyId + 1;
 		moveEvents[simIndex].userData = body.userData;
@@ -6138,20 +7421,9 @@ void Physics::FinalizeBodiesTask(int startIndex, int endIndex, U32 threadIndex,
 			const float saftetyFactor = 0.5f;
 			if (body.type == BODY_TYPE_DYNAMIC && enableContinuous && maxVelocity * timeStep > saftetyFactor * sim.minExtent)
 			{
-				// Store in fast array for the continuous collision stage
-				// This is deterministic because the order of TOI sweeps doesn't matter
-				if (sim.isBullet)
-				{
-					int bulletIndex = stepContext.bulletBodyCount.fetch_add(1);
-					stepContext.bulletBodies[bulletIndex] = simIndex;
-				}
-				else
-				{
-					int fastIndex = stepContext.fastBodyCount.fetch_add(1);
-					stepContext.fastBodies[fastIndex] = simIndex;
-				}
-
+				// The enlarged bit puts this body in the fast or bullet array for the continuous collision stage
 				sim.isFast = true;
+				enlargedSimBitSet.SetBit(simIndex);
 			}
 			else
 			{
@@ -6179,12 +7451,7 @@ void Physics::FinalizeBodiesTask(int startIndex, int endIndex, U32 threadIndex,
 		else if (island.constraintRemoveCount > 0)
 		{
 			// body wants to sleep but its island needs splitting first
-			if (body.sleepTime > taskContext.splitSleepTime)
-			{
-				// pick the sleepiest candidate
-				taskContext.splitIslandId = body.islandId;
-				taskContext.splitSleepTime = body.sleepTime;
-			}
+			taskContext.splitIslandBitset.SetBit(island.localIndex);
 		}
 
 		// Update shapes AABBs
@@ -6200,9 +7467,6 @@ void Physics::FinalizeBodiesTask(int startIndex, int endIndex, U32 threadIndex,
 				// The AABB is updated after continuous collision.
 				// Add to moved shapes regardless of AABB changes.
 				shape.isFast = true;
-
-				// Bit-set to keep the move array sorted
-				enlargedSimBitSet.SetBit(simIndex);
 			}
 			else
 			{
@@ -6236,160 +7500,491 @@ void Physics::FinalizeBodiesTask(int startIndex, int endIndex, U32 threadIndex,
 
 void Physics::FastBodyTask(int startIndex, int endIndex, U32 threadIndex, StepContext& stepContext)
 {
-	for (int i = startIndex; i < endIndex; ++i)
-	{
-		int simIndex = stepContext.fastBodies[i];
-		SolveContinuous(simIndex);
-	}
+	SolveContinuous(stepContext.fastBodies + startIndex, endIndex - startIndex, taskContexts[threadIndex]);
 }
 
 void Physics::BulletBodyTask(int startIndex, int endIndex, U32 threadIndex, StepContext& stepContext)
 {
-	for (int i = startIndex; i < endIndex; ++i)
-	{
-		int simIndex = stepContext.bulletBodies[i];
-		SolveContinuous(simIndex);
-	}
+	SolveContinuous(stepContext.bulletBodies + startIndex, endIndex - startIndex, taskContexts[threadIndex]);
 }
 
-void Physics::SolveContinuous(int bodySimIndex)
+void Physics::ReserveContinuous(const I32* simIndices, int count)
 {
-	SolverSet& awakeSet = solverSets[SET_TYPE_AWAKE];
-	BodySim& fastBodySim = awakeSet.bodySims[bodySimIndex];
+	// Any worker can end up with every body, one context and box per shape means the workers never have to grow them
+	BodySim* sims = solverSets[SET_TYPE_AWAKE].bodySims.Data();
 
-	Sweep sweep;
-	sweep.Create(fastBodySim);
+	U64 shapeCount = 0;
+	for (int i = 0; i < count; ++i) { shapeCount += rigidBodies[sims[simIndices[i]].bodyId].shapeCount; }
 
-	Transform2D xf1;
-	xf1.rotation = sweep.q1;
-	xf1.position = sweep.c1 - sweep.localCenter * sweep.q1;
+	for (TaskContext& taskContext : taskContexts)
+	{
+		if (taskContext.continuousContexts.Capacity() < shapeCount) { taskContext.continuousContexts.Reserve(shapeCount); }
+		if (taskContext.continuousBoxes.Capacity() < shapeCount) { taskContext.continuousBoxes.Reserve(shapeCount); }
+		if (taskContext.continuousHits.Capacity() < ContinuousHitCapacity) { taskContext.continuousHits.Reserve(ContinuousHitCapacity); }
+	}
+}
 
-	Transform2D xf2;
-	xf2.rotation = sweep.q2;
-	xf2.position = sweep.c2 - sweep.localCenter * sweep.q2;
+void Physics::SolveContinuous(const I32* simIndices, int count, TaskContext& taskContext)
+{
+	SolverSet& awakeSet = solverSets[SET_TYPE_AWAKE];
+	BodySim* sims = awakeSet.bodySims.Data();
 
 	DynamicTree& staticTree = Broadphase::trees[BODY_TYPE_STATIC];
 	DynamicTree& kinematicTree = Broadphase::trees[BODY_TYPE_KINEMATIC];
 	DynamicTree& dynamicTree = Broadphase::trees[BODY_TYPE_DYNAMIC];
 
-	ContinuousContext context;
-	context.sweep = sweep;
-	context.fastBodySim = &fastBodySim;
-	context.fraction = 1.0f;
+	Vector<ContinuousContext>& contexts = taskContext.continuousContexts;
+	Vector<AABB>& boxes = taskContext.continuousBoxes;
+	Vector<PacketHit>& hits = taskContext.continuousHits;
+	contexts.Clear();
+	boxes.Clear();
 
-	bool isBullet = fastBodySim.isBullet;
-
-	RigidBody2D& fastBody = rigidBodies[fastBodySim.bodyId];
-	int shapeId = fastBody.headShapeId;
-	while (shapeId != NullIndex)
+	// Sweep every shape in the range first so the static tree can be queried a packet at a time
+	for (int i = 0; i < count; ++i)
 	{
-		Shape& fastShape = shapes[shapeId];
+		BodySim& fastBodySim = sims[simIndices[i]];
+
+		Sweep sweep;
+		sweep.Create(fastBodySim);
+
+		Transform2D xf1;
+		xf1.rotation = sweep.q1;
+		xf1.position = sweep.c1 - sweep.localCenter * sweep.q1;
+
+		Transform2D xf2;
+		xf2.rotation = sweep.q2;
+		xf2.position = sweep.c2 - sweep.localCenter * sweep.q2;
+
+		RigidBody2D& fastBody = rigidBodies[fastBodySim.bodyId];
+		int shapeId = fastBody.headShapeId;
+		while (shapeId != NullIndex)
+		{
+			Shape& fastShape = shapes[shapeId];
+
+			shapeId = fastShape.nextShapeId;
 
-		shapeId = fastShape.nextShapeId;
+			// Clear flag (keep set on body)
+			fastShape.isFast = false;
 
-		// Clear flag (keep set on body)
-		fastShape.isFast = false;
+			AABB box1 = fastShape.aabb;
+			AABB box2 = fastShape.ComputeShapeAABB(xf2);
+			AABB box = AABB::Combine(box1, box2);
 
-		context.fastShape = &fastShape;
-		context.centroid1 = fastShape.localCentroid * xf1;
-		context.centroid2 = fastShape.localCentroid * xf2;
+			// Store this for later
+			fastShape.aabb = box2;
 
-		AABB box1 = fastShape.aabb;
-		AABB box2 = fastShape.ComputeShapeAABB(xf2);
-		AABB box = AABB::Combine(box1, box2);
+			// No continuous collision for sensors
+			if (fastShape.isSensor) { continue; }
 
-		// Store this for later
-		fastShape.aabb = box2;
+			ContinuousContext context;
+			context.sweep = sweep;
+			context.fastBodySim = &fastBodySim;
+			context.fastShape = &fastShape;
+			context.centroid1 = fastShape.localCentroid * xf1;
+			context.centroid2 = fastShape.localCentroid * xf2;
+			context.fraction = 1.0f;
+
+			contexts.Push(context);
+			boxes.Push(box);
+		}
+	}
 
-		// No continuous collision for sensors
-		if (fastShape.isSensor) { continue; }
+	U32 contextCount = (U32)contexts.Size();
 
-		staticTree.QueryContinuous(box, DefaultLayerMask, context);
+	// Static geometry is where most fast bodies end up, each lane's hits come back in the same order a single query would find them
+	for (U32 first = 0; first < contextCount; first += NH_SIMD_WIDTH)
+	{
+		U32 laneCount = Math::Min(contextCount - first, (U32)NH_SIMD_WIDTH);
 
-		if (isBullet)
+		hits.Clear();
+		if (staticTree.QueryPacket(boxes.Data() + first, laneCount, DefaultLayerMask, hits, false))
+		{
+			for (const PacketHit& hit : hits)
+			{
+				Broadphase::ContinuousQueryCallback(hit.userData, contexts[first + hit.lane]);
+			}
+		}
+		else
 		{
-			kinematicTree.QueryContinuous(box, DefaultLayerMask, context);
-			dynamicTree.QueryContinuous(box, DefaultLayerMask, context);
+			// Too many hits for the buffer reserved on the main thread, the lanes query alone without allocating
+			for (U32 lane = 0; lane < laneCount; ++lane)
+			{
+				staticTree.QueryContinuous(boxes[first + lane], DefaultLayerMask, contexts[first + lane]);
+			}
 		}
 	}
 
+	// Bullets also sweep against everything that moved, fast bodies have already been advanced
+	for (U32 i = 0; i < contextCount; ++i)
+	{
+		ContinuousContext& context = contexts[i];
+		if (context.fastBodySim->isBullet == false) { continue; }
+
+		kinematicTree.QueryContinuous(boxes[i], DefaultLayerMask, context);
+		dynamicTree.QueryContinuous(boxes[i], DefaultLayerMask, context);
+	}
+
 	const float speculativeDistance = SpeculativeDistance;
 	const float aabbMargin = AABBMargin;
 
-	if (context.fraction < 1.0f)
+	// Contexts were pushed in body order, each body stops at the earliest impact of any of its shapes
+	U32 contextIndex = 0;
+	for (int i = 0; i < count; ++i)
+	{
+		BodySim& fastBodySim = sims[simIndices[i]];
+
+		F32 fraction = 1.0f;
+		while (contextIndex < contextCount && contexts[contextIndex].fastBodySim == &fastBodySim)
+		{
+			fraction = Math::Min(fraction, contexts[contextIndex].fraction);
+			++contextIndex;
+		}
+
+		RigidBody2D& fastBody = rigidBodies[fastBodySim.bodyId];
+
+		if (fraction < 1.0f)
+		{
+			// Handle time of impact event
+			Sweep sweep;
+			sweep.Create(fastBodySim);
+
+			Quaternion2 q = sweep.q1.NLerp(sweep.q2, fraction);
+			Vector2 c = Math::Lerp(sweep.c1, sweep.c2, fraction);
+			Vector2 origin = c - sweep.localCenter * q;
+
+			// Advance body
+			Transform2D transform = { origin, q };
+			fastBodySim.transform = transform;
+			fastBodySim.center = c;
+			fastBodySim.rotation0 = q;
+			fastBodySim.center0 = c;
+
+			// Prepare AABBs for broad-phase
+			int shapeId = fastBody.headShapeId;
+			while (shapeId != NullIndex)
+			{
+				Shape& shape = shapes[shapeId];
+
+				// Must recompute aabb at the interpolated transform
+				AABB aabb = shape.ComputeShapeAABB(transform);
+				aabb.lowerBound.x -= speculativeDistance;
+				aabb.lowerBound.y -= speculativeDistance;
+				aabb.upperBound.x += speculativeDistance;
+				aabb.upperBound.y += speculativeDistance;
+				shape.aabb = aabb;
+
+				if (shape.fatAABB.Contains(aabb) == false)
+				{
+					AABB fatAABB;
+					fatAABB.lowerBound.x = aabb.lowerBound.x - aabbMargin;
+					fatAABB.lowerBound.y = aabb.lowerBound.y - aabbMargin;
+					fatAABB.upperBound.x = aabb.upperBound.x + aabbMargin;
+					fatAABB.upperBound.y = aabb.upperBound.y + aabbMargin;
+					shape.fatAABB = fatAABB;
+
+					shape.enlargedAABB = true;
+					fastBodySim.enlargeAABB = true;
+				}
+
+				shapeId = shape.nextShapeId;
+			}
+		}
+		else
+		{
+			// No time of impact event
+
+			// Advance body
+			fastBodySim.rotation0 = fastBodySim.transform.rotation;
+			fastBodySim.center0 = fastBodySim.center;
+
+			// Prepare AABBs for broad-phase
+			int shapeId = fastBody.headShapeId;
+			while (shapeId != NullIndex)
+			{
+				Shape& shape = shapes[shapeId];
+
+				// shape->aabb is still valid
+
+				if (shape.fatAABB.Contains(shape.aabb) == false)
+				{
+					AABB fatAABB;
+					fatAABB.lowerBound.x = shape.aabb.lowerBound.x - aabbMargin;
+					fatAABB.lowerBound.y = shape.aabb.lowerBound.y - aabbMargin;
+					fatAABB.upperBound.x = shape.aabb.upperBound.x + aabbMargin;
+					fatAABB.upperBound.y = shape.aabb.upperBound.y + aabbMargin;
+					shape.fatAABB = fatAABB;
+
+					shape.enlargedAABB = true;
+					fastBodySim.enlargeAABB = true;
+				}
+
+				shapeId = shape.nextShapeId;
+			}
+		}
+	}
+}
+
+void Physics::OverlapSensors()
+{
+	U32 sensorCount = (U32)sensors.Size();
+	if (sensorCount == 0) { return; }
+
+	// A static sensor with nothing nearby can only gain overlaps from proxies whose fat AABB grew this step,
+	// when those are fewer than the idle sensors they look the sensors up in the static tree and the rest skip their query
+	sensorMoves.Merge(Broadphase::moveArray);
+
+	// overlaps1 becomes this step's overlaps2, give it room for last step's overlaps and some more so the jobs rarely run out
+	U32 idleCount = 0;
+	for (Sensor& sensor : sensors)
+	{
+		idleCount += !sensor.nearby && !sensor.rebuild && rigidBodies[shapes[sensor.shapeId].bodyId].setIndex == SET_TYPE_STATIC;
+
+		U64 overlapCapacity = sensor.overlaps2.Size() * 2 + 8;
+		if (sensor.overlaps1.Capacity() < overlapCapacity) { sensor.overlaps1.Reserve(overlapCapacity); }
+	}
+
+	for (TaskContext& taskContext : taskContexts)
+	{
+		if (taskContext.sensorHits.Capacity() < SensorHitCapacity) { taskContext.sensorHits.Reserve(SensorHitCapacity); }
+	}
+
+	bool touchAll = idleCount > 0 && sensorMoves.Size() >= idleCount;
+
+	if (idleCount > 0 && !touchAll)
+	{
+		U32 moveCount = (U32)sensorMoves.Size();
+		U32 movePacketCount = (moveCount + NH_SIMD_WIDTH - 1) / NH_SIMD_WIDTH;
+
+		for (TaskContext& taskContext : taskContexts)
+		{
+			taskContext.touchedSensors.Clear();
+			taskContext.touchedOverflow = false;
+
+			if (taskContext.touchedSensors.Capacity() < idleCount) { taskContext.touchedSensors.Reserve(idleCount); }
+		}
+
+		Jobs::ParallelFor(0, movePacketCount, 4, [moveCount](U32 startIndex, U32 endIndex) {
+			TouchSensorsTask((I32)(startIndex * NH_SIMD_WIDTH), (I32)Math::Min(endIndex * NH_SIMD_WIDTH, moveCount), taskContexts[Jobs::CurrentWorker()]);
+		});
+		taskCount += 1;
+
+		// Touching too many sensors is only slower, a worker that ran out of room touches them all
+		for (const TaskContext& taskContext : taskContexts)
+		{
+			touchAll |= taskContext.touchedOverflow;
+			for (I32 sensorIndex : taskContext.touchedSensors) { sensors[sensorIndex].touched = true; }
+		}
+	}
+
+	if (touchAll)
+	{
+		for (Sensor& sensor : sensors) { sensor.touched = true; }
+	}
+
+	sensorMoves.Clear();
+
+	// Tasks take whole packets of sensors so they can query the trees together
+	U32 packetCount = (sensorCount + NH_SIMD_WIDTH - 1) / NH_SIMD_WIDTH;
+
+	Jobs::ParallelFor(0, packetCount, 4, [sensorCount](U32 startIndex, U32 endIndex) {
+		SensorTask((I32)(startIndex * NH_SIMD_WIDTH), (I32)Math::Min(endIndex * NH_SIMD_WIDTH, sensorCount), taskContexts[Jobs::CurrentWorker()], false);
+	});
+	taskCount += 1;
+
+	// Events are diffed serially in sensor order so they come out the same every run,
+	// sensors a job ran out of room on are redone first here where their buffers can grow
+	for (U32 sensorIndex = 0; sensorIndex < sensorCount; ++sensorIndex)
+	{
+		if (sensors[sensorIndex].overflow) { SensorTask((I32)sensorIndex, (I32)sensorIndex + 1, taskContexts[0], true); }
+
+		const Sensor& sensor = sensors[sensorIndex];
+		if (!sensor.changed) { continue; }
+
+		I32 sensorShapeId = sensor.shapeId + 1;
+		const Vector<I32>& previous = sensor.overlaps1;
+		const Vector<I32>& current = sensor.overlaps2;
+		U64 i = 0, j = 0;
+
+		while (i < previous.Size() || j < current.Size())
+		{
+			if (j == current.Size() || (i < previous.Size() && previous[i] < current[j])) { sensorEndEvents.Push({ sensorShapeId, previous[i++] + 1 }); }
+			else if (i == previous.Size() || current[j] < previous[i]) { sensorBeginEvents.Push({ sensorShapeId, current[j++] + 1 }); }
+			else { ++i; ++j; }
+		}
+	}
+}
+
+void Physics::TouchSensorsTask(I32 startIndex, I32 endIndex, TaskContext& taskContext)
+{
+	DynamicTree& staticTree = Broadphase::trees[BODY_TYPE_STATIC];
+	Vector<PacketHit>& hits = taskContext.sensorHits;
+
+	AABB boxes[NH_SIMD_WIDTH];
+
+	for (I32 first = startIndex; first < endIndex; first += NH_SIMD_WIDTH)
+	{
+		U32 laneCount = (U32)Math::Min(endIndex - first, (I32)NH_SIMD_WIDTH);
+
+		for (U32 lane = 0; lane < laneCount; ++lane)
+		{
+			I32 proxyKey = sensorMoves[first + lane];
+			boxes[lane] = Broadphase::trees[PROXY_TYPE(proxyKey)].GetAABB(PROXY_ID(proxyKey));
+		}
+
+		hits.Clear();
+		if (!staticTree.QueryPacket(boxes, laneCount, DefaultLayerMask, hits, false))
+		{
+			taskContext.touchedOverflow = true;
+			return;
+		}
+
+		for (const PacketHit& hit : hits)
+		{
+			const Shape& shape = shapes[hit.userData];
+			if (shape.sensorIndex == NullIndex) { continue; }
+
+			if (taskContext.touchedSensors.Full())
+			{
+				taskContext.touchedOverflow = true;
+				return;
+			}
+
+			taskContext.touchedSensors.Push(shape.sensorIndex);
+		}
+	}
+}
+
+void Physics::SensorTask(I32 startIndex, I32 endIndex, TaskContext& taskContext, bool canGrow)
+{
+	DynamicTree& kinematicTree = Broadphase::trees[BODY_TYPE_KINEMATIC];
+	DynamicTree& dynamicTree = Broadphase::trees[BODY_TYPE_DYNAMIC];
+	Vector<PacketHit>& hits = taskContext.sensorHits;
+
+	AABB boxes[NH_SIMD_WIDTH];
+	Transform2D transforms[NH_SIMD_WIDTH];
+	bool moved[NH_SIMD_WIDTH];
+	bool skipped[NH_SIMD_WIDTH];
+
+	for (I32 first = startIndex; first < endIndex; first += NH_SIMD_WIDTH)
 	{
-		// Handle time of impact event
-		Quaternion2 q = sweep.q1.NLerp(sweep.q2, context.fraction);
-		Vector2 c = Math::Lerp(sweep.c1, sweep.c2, context.fraction);
-		Vector2 origin = c - sweep.localCenter * q;
+		U32 laneCount = (U32)Math::Min(endIndex - first, (I32)NH_SIMD_WIDTH);
+
+		for (U32 lane = 0; lane < laneCount; ++lane)
+		{
+			Sensor& sensor = sensors[first + lane];
+			Shape& sensorShape = shapes[sensor.shapeId];
+			RigidBody2D& body = rigidBodies[sensorShape.bodyId];
+
+			if (canGrow)
+			{
+				// A retry only redoes the lanes a job ran out of room on, those already swapped their overlaps
+				skipped[lane] = !sensor.overflow;
+				sensor.overflow = false;
+			}
+			else
+			{
+				// Nothing can have reached an idle static sensor, its overlaps stay as they are. An inverted box never overlaps
+				skipped[lane] = body.setIndex == SET_TYPE_STATIC && !sensor.rebuild && !sensor.nearby && !sensor.touched;
+				sensor.touched = false;
+
+				if (!skipped[lane]) { Swap(sensor.overlaps1, sensor.overlaps2); }
+			}
+
+			if (skipped[lane])
+			{
+				boxes[lane] = { { Huge, Huge }, { -Huge, -Huge } };
+				moved[lane] = false;
+				continue;
+			}
+
+			sensor.overlaps2.Clear();
+
+			// Disabled sensors see nothing, staying nearby makes the first pass after they're enabled query
+			sensor.nearby = body.setIndex == SET_TYPE_DISABLED;
+
+			if (body.setIndex == SET_TYPE_DISABLED)
+			{
+				boxes[lane] = { { Huge, Huge }, { -Huge, -Huge } };
+				moved[lane] = false;
+				continue;
+			}
+
+			boxes[lane] = sensorShape.aabb;
+			transforms[lane] = GetBodySim(body).transform;
+			moved[lane] = body.setIndex == SET_TYPE_AWAKE || sensor.rebuild;
+		}
+
+		// Only kinematic and dynamic shapes visit sensors, static shapes are never queried
+		hits.Clear();
+		if (!kinematicTree.QueryPacket(boxes, laneCount, DefaultLayerMask, hits, canGrow) ||
+			!dynamicTree.QueryPacket(boxes, laneCount, DefaultLayerMask, hits, canGrow))
+		{
+			// Out of room, the main thread redoes these sensors where the buffers can grow
+			for (U32 lane = 0; lane < laneCount; ++lane)
+			{
+				if (!skipped[lane]) { sensors[first + lane].overflow = true; }
+			}
+
+			hits.Clear();
+		}
+
+		for (const PacketHit& hit : hits)
+		{
+			Sensor& sensor = sensors[first + hit.lane];
+			Shape& sensorShape = shapes[sensor.shapeId];
+			Shape& visitor = shapes[hit.userData];
+
+			if (visitor.isSensor || visitor.bodyId == sensorShape.bodyId) { continue; }
+
+			sensor.nearby = true;
+
+			if (!visitor.enableSensorEvents || !sensorShape.filter.ShouldShapesCollide(visitor.filter)) { continue; }
+
+			RigidBody2D& visitorBody = rigidBodies[visitor.bodyId];
 
-		// Advance body
-		Transform2D transform = { origin, q };
-		fastBodySim.transform = transform;
-		fastBodySim.center = c;
-		fastBodySim.rotation0 = q;
-		fastBodySim.center0 = c;
+			bool overlaps;
+			if (moved[hit.lane] || visitorBody.setIndex == SET_TYPE_AWAKE)
+			{
+				if (!boxes[hit.lane].Overlaps(visitor.aabb)) { continue; }
 
-		// Prepare AABBs for broad-phase
-		shapeId = fastBody.headShapeId;
-		while (shapeId != NullIndex)
-		{
-			Shape& shape = shapes[shapeId];
+				DistanceCache cache{};
+				overlaps = TestShapeOverlap(sensorShape, transforms[hit.lane], visitor, GetBodySim(visitorBody).transform, cache);
+			}
+			else
+			{
+				// Neither side moved, last step's answer still holds
+				overlaps = ContainsShapeId(sensor.overlaps1, visitor.id);
+			}
 
-			// Must recompute aabb at the interpolated transform
-			AABB aabb = shape.ComputeShapeAABB(transform);
-			aabb.lowerBound.x -= speculativeDistance;
-			aabb.lowerBound.y -= speculativeDistance;
-			aabb.upperBound.x += speculativeDistance;
-			aabb.upperBound.y += speculativeDistance;
-			shape.aabb = aabb;
+			if (!overlaps) { continue; }
 
-			if (shape.fatAABB.Contains(aabb) == false)
+			if (!canGrow && sensor.overlaps2.Full())
 			{
-				AABB fatAABB;
-				fatAABB.lowerBound.x = aabb.lowerBound.x - aabbMargin;
-				fatAABB.lowerBound.y = aabb.lowerBound.y - aabbMargin;
-				fatAABB.upperBound.x = aabb.upperBound.x + aabbMargin;
-				fatAABB.upperBound.y = aabb.upperBound.y + aabbMargin;
-				shape.fatAABB = fatAABB;
-
-				shape.enlargedAABB = true;
-				fastBodySim.enlargeAABB = true;
+				sensor.overflow = true;
+				continue;
 			}
 
-			shapeId = shape.nextShapeId;
+			sensor.overlaps2.Push(visitor.id);
 		}
-	}
-	else
-	{
-		// No time of impact event
-
-		// Advance body
-		fastBodySim.rotation0 = fastBodySim.transform.rotation;
-		fastBodySim.center0 = fastBodySim.center;
 
-		// Prepare AABBs for broad-phase
-		shapeId = fastBody.headShapeId;
-		while (shapeId != NullIndex)
+		for (U32 lane = 0; lane < laneCount; ++lane)
 		{
-			Shape& shape = shapes[shapeId];
+			Sensor& sensor = sensors[first + lane];
 
-			// shape->aabb is still valid
-
-			if (shape.fatAABB.Contains(shape.aabb) == false)
+			// A retry leaves the lanes it skipped as the job finished them
+			if (skipped[lane])
 			{
-				AABB fatAABB;
-				fatAABB.lowerBound.x = shape.aabb.lowerBound.x - aabbMargin;
-				fatAABB.lowerBound.y = shape.aabb.lowerBound.y - aabbMargin;
-				fatAABB.upperBound.x = shape.aabb.upperBound.x + aabbMargin;
-				fatAABB.upperBound.y = shape.aabb.upperBound.y + aabbMargin;
-				shape.fatAABB = fatAABB;
-
-				shape.enlargedAABB = true;
-				fastBodySim.enlargeAABB = true;
+				if (!canGrow) { sensor.changed = false; }
+				continue;
 			}
 
-			shapeId = shape.nextShapeId;
+			if (sensor.overflow) { continue; }
+
+			SortShapeIds(sensor.overlaps2);
+
+			sensor.rebuild = false;
+			sensor.changed = sensor.overlaps1.Size() != sensor.overlaps2.Size() ||
+				!Compare(sensor.overlaps1.Data(), sensor.overlaps2.Data(), sensor.overlaps1.Size() * sizeof(I32));
 		}
 	}
 }
@@ -6769,7 +8364,7 @@ Transform2D Physics::GetSweepTransform(const Sweep& sweep, F32 time)
 
 Island& Physics::CreateIsland(int setIndex)
 {
-	int islandId = islandFreelist.GetFree();
+	int islandId = islandFreelist.GetFreeOrGrow();
 
 	if (islandId == islands.Size()) { islands.Push({}); }
 
@@ -6840,6 +8435,27 @@ void Physics::AddContactToIsland(I32 islandId, Contact& contact)
 	contact.islandId = islandId;
 }
 
+void Physics::AddJointToIsland(I32 islandId, Joint& joint)
+{
+	Island& island = islands[islandId];
+
+	if (island.headJoint != NullIndex)
+	{
+		joint.islandNext = island.headJoint;
+		Joint& headJoint = joints[island.headJoint];
+		headJoint.islandPrev = joint.jointId;
+	}
+
+	island.headJoint = joint.jointId;
+	if (island.tailJoint == NullIndex)
+	{
+		island.tailJoint = island.headJoint;
+	}
+
+	island.jointCount += 1;
+	joint.islandId = islandId;
+}
+
 void Physics::TrySleepIsland(int islandId)
 {
 	Island& island = islands[islandId];
@@ -6853,7 +8469,7 @@ void Physics::TrySleepIsland(int islandId)
 	// - identify non-touching contacts that should move to sleeping solver set or disabled set
 	// - remove old island
 	// - fix island
-	int sleepSetId = solverSetFreelist.GetFree();
+	int sleepSetId = solverSetFreelist.GetFreeOrGrow();
 	if (sleepSetId == solverSets.Size())
 	{
 		SolverSet set = { 0 };
@@ -7061,30 +8677,45 @@ void Physics::TrySleepIsland(int islandId)
 	}
 }
 
-void Physics::SplitIsland(int baseId)
+void Physics::PrepareIslandSplit(IslandSplit& split, I32 baseId)
 {
-	Island& baseIsland = islands[baseId];
-	int setIndex = baseIsland.setIndex;
+	split.baseId = baseId;
+	split.seeds.Clear();
+	split.bodies.Clear();
+	split.contacts.Clear();
+	split.joints.Clear();
+	split.components.Clear();
+
+	const Island& baseIsland = islands[baseId];
 
-	if (setIndex != SET_TYPE_AWAKE) { return; }
+	// The island may have merged or gone to sleep since it was flagged
+	if (baseIsland.setIndex != SET_TYPE_AWAKE || baseIsland.constraintRemoveCount == 0)
+	{
+		split.baseId = NullIndex;
+		return;
+	}
 
-	if (baseIsland.constraintRemoveCount == 0) { return; }
+	// Reserved here so the search doesn't allocate
+	split.seeds.Reserve(baseIsland.bodyCount);
+	split.stack.Resize(baseIsland.bodyCount);
+	split.bodies.Reserve(baseIsland.bodyCount);
+	split.contacts.Reserve(baseIsland.contactCount);
+	split.joints.Reserve(baseIsland.jointCount);
+	split.components.Reserve(baseIsland.bodyCount);
+}
 
-	int bodyCount = baseIsland.bodyCount;
+void Physics::SearchIslandSplit(IslandSplit& split)
+{
+	if (split.baseId == NullIndex) { return; }
 
-	// No lock is needed because I ensure the allocator is not used while this task is active.
-	int* stack;
-	Memory::AllocateArray(&stack, bodyCount);
-	int* bodyIds;
-	Memory::AllocateArray(&bodyIds, bodyCount);
+	const Island& baseIsland = islands[split.baseId];
 
 	// Build array containing all body indices from base island. These
 	// serve as seed bodies for the depth first search (DFS).
-	int index = 0;
 	int nextBody = baseIsland.headBody;
 	while (nextBody != NullIndex)
 	{
-		bodyIds[index++] = nextBody;
+		split.seeds.Push(nextBody);
 		RigidBody2D& body = rigidBodies[nextBody];
 
 		// Clear visitation mark
@@ -7112,13 +8743,11 @@ void Physics::SplitIsland(int baseId)
 		nextJoint = joint.islandNext;
 	}
 
-	// Done with the base split island.
-	DestroyIsland(baseId);
+	I32* stack = split.stack.Data();
 
 	// Each island is found as a depth first search starting from a seed body
-	for (int i = 0; i < bodyCount; ++i)
+	for (I32 seedIndex : split.seeds)
 	{
-		int seedIndex = bodyIds[i];
 		RigidBody2D& seed = rigidBodies[seedIndex];
 
 		if (seed.isMarked == true)
@@ -7131,13 +8760,6 @@ void Physics::SplitIsland(int baseId)
 		stack[stackCount++] = seedIndex;
 		seed.isMarked = true;
 
-		// Create new island
-		// No lock needed because only a single island can split per time step. No islands are being used during the constraint
-		// solve. However, islands are touched during body finalization.
-		Island& island = CreateIsland(setIndex);
-
-		int islandId = island.islandId;
-
 		// Perform a depth first search (DFS) on the constraint graph.
 		while (stackCount > 0)
 		{
@@ -7145,22 +8767,7 @@ void Physics::SplitIsland(int baseId)
 			int bodyId = stack[--stackCount];
 			RigidBody2D& body = rigidBodies[bodyId];
 
-			// Add body to island
-			body.islandId = islandId;
-			if (island.tailBody != NullIndex)
-			{
-				rigidBodies[island.tailBody].islandNext = bodyId;
-			}
-			body.islandPrev = island.tailBody;
-			body.islandNext = NullIndex;
-			island.tailBody = bodyId;
-
-			if (island.headBody == NullIndex)
-			{
-				island.headBody = bodyId;
-			}
-
-			island.bodyCount += 1;
+			split.bodies.Push(bodyId);
 
 			// Search all contacts connected to this body.
 			int contactKey = body.headContactKey;
@@ -7177,9 +8784,6 @@ void Physics::SplitIsland(int baseId)
 				// Has this contact already been added to this island?
 				if (contact.isMarked) { continue; }
 
-				// Skip sensors
-				if (contact.flags & CONTACT_FLAG_SENSOR) { continue; }
-
 				// Is this contact enabled and touching?
 				if ((contact.flags & CONTACT_FLAG_TOUCHING) == 0) { continue; }
 
@@ -7196,23 +8800,7 @@ void Physics::SplitIsland(int baseId)
 					otherBody.isMarked = true;
 				}
 
-				// Add contact to island
-				contact.islandId = islandId;
-				if (island.tailContact != NullIndex)
-				{
-					Contact& tailContact = contacts[island.tailContact];
-					tailContact.islandNext = contactId;
-				}
-				contact.islandPrev = island.tailContact;
-				contact.islandNext = NullIndex;
-				island.tailContact = contactId;
-
-				if (island.headContact == NullIndex)
-				{
-					island.headContact = contactId;
-				}
-
-				island.contactCount += 1;
+				split.contacts.Push(contactId);
 			}
 
 			// Search all joints connect to this body.
@@ -7246,29 +8834,76 @@ void Physics::SplitIsland(int baseId)
 					otherBody.isMarked = true;
 				}
 
-				// Add joint to island
-				joint.islandId = islandId;
-				if (island.tailJoint != NullIndex)
-				{
-					Joint& tailJoint = joints[island.tailJoint];
-					tailJoint.islandNext = jointId;
-				}
-				joint.islandPrev = island.tailJoint;
-				joint.islandNext = NullIndex;
-				island.tailJoint = jointId;
-
-				if (island.headJoint == NullIndex)
-				{
-					island.headJoint = jointId;
-				}
-
-				island.jointCount += 1;
+				split.joints.Push(jointId);
 			}
 		}
+
+		split.components.Push({ (I32)split.bodies.Size(), (I32)split.contacts.Size(), (I32)split.joints.Size() });
 	}
+}
+
+void Physics::ApplyIslandSplit(const IslandSplit& split)
+{
+	if (split.baseId == NullIndex) { return; }
+
+	// Done with the base split island.
+	DestroyIsland(split.baseId);
+
+	I32 bodyStart = 0;
+	I32 contactStart = 0;
+	I32 jointStart = 0;
+
+	for (const SplitComponent& component : split.components)
+	{
+		Island& island = CreateIsland(SET_TYPE_AWAKE);
+		int islandId = island.islandId;
+
+		island.bodyCount = component.bodyEnd - bodyStart;
+		island.headBody = split.bodies[bodyStart];
+		island.tailBody = split.bodies[component.bodyEnd - 1];
+
+		for (I32 i = bodyStart; i < component.bodyEnd; ++i)
+		{
+			RigidBody2D& body = rigidBodies[split.bodies[i]];
+			body.islandId = islandId;
+			body.islandPrev = i > bodyStart ? split.bodies[i - 1] : NullIndex;
+			body.islandNext = i + 1 < component.bodyEnd ? split.bodies[i + 1] : NullIndex;
+		}
+
+		island.contactCount = component.contactEnd - contactStart;
+		if (island.contactCount > 0)
+		{
+			island.headContact = split.contacts[contactStart];
+			island.tailContact = split.contacts[component.contactEnd - 1];
+		}
+
+		for (I32 i = contactStart; i < component.contactEnd; ++i)
+		{
+			Contact& contact = contacts[split.contacts[i]];
+			contact.islandId = islandId;
+			contact.islandPrev = i > contactStart ? split.contacts[i - 1] : NullIndex;
+			contact.islandNext = i + 1 < component.contactEnd ? split.contacts[i + 1] : NullIndex;
+		}
+
+		island.jointCount = component.jointEnd - jointStart;
+		if (island.jointCount > 0)
+		{
+			island.headJoint = split.joints[jointStart];
+			island.tailJoint = split.joints[component.jointEnd - 1];
+		}
+
+		for (I32 i = jointStart; i < component.jointEnd; ++i)
+		{
+			Joint& joint = joints[split.joints[i]];
+			joint.islandId = islandId;
+			joint.islandPrev = i > jointStart ? split.joints[i - 1] : NullIndex;
+			joint.islandNext = i + 1 < component.jointEnd ? split.joints[i + 1] : NullIndex;
+		}
 
-	Memory::Free(&bodyIds);
-	Memory::Free(&stack);
+		bodyStart = component.bodyEnd;
+		contactStart = component.contactEnd;
+		jointStart = component.jointEnd;
+	}
 }
 
 void Physics::CreateIslandForBody(int setIndex, RigidBody2D& body)
@@ -7964,3 +9599,445 @@ void Physics::ComputeSimplexWitnessPoints(Vector2& a, Vector2& b, const Simplex&
 	default: break;
 	}
 }
+
+Vector2 Physics::ComputeSimplexClosestPoint(const Simplex& s)
+{
+	switch (s.count)
+	{
+	case 1: return s.v1.w;
+	case 2: return Weight2(s.v1.a, s.v1.w, s.v2.a, s.v2.w);
+	default: return Vector2Zero;
+	}
+}
+
+CastOutput Physics::RaycastCircle(const RaycastInput& input, const Circle& shape)
+{
+	CastOutput output = {};
+
+	Vector2 p = shape.center;
+
+	// Shift ray so circle center is the origin
+	Vector2 s = input.origin - p;
+
+	Vector2 translation = input.translation;
+	F32 length;
+	Vector2 d = translation.Normalized(length);
+	if (length == 0.0f) { return output; }
+
+	// Find closest point on ray to origin
+	// solve: dot(s + t * d, d) = 0
+	F32 t = -s.Dot(d);
+
+	// c is the closest point on the line to the origin
+	Vector2 c = s + d * t;
+	F32 cc = c.Dot(c);
+	F32 rr = shape.radius * shape.radius;
+
+	if (cc > rr) { return output; }
+
+	// Pythagoras
+	F32 h = Math::Sqrt(rr - cc);
+	F32 fraction = t - h;
+
+	if (fraction < 0.0f || input.maxFraction * length < fraction) { return output; }
+
+	// Hit point relative to center
+	Vector2 hitPoint = s + d * fraction;
+
+	output.fraction = fraction / length;
+	output.normal = hitPoint.Normalized();
+	output.point = p + output.normal * shape.radius;
+	output.hit = true;
+
+	return output;
+}
+
+CastOutput Physics::RaycastCapsule(const RaycastInput& input, const Capsule& shape)
+{
+	CastOutput output = {};
+
+	Vector2 v1 = shape.center1;
+	Vector2 v2 = shape.center2;
+
+	Vector2 e = v2 - v1;
+	F32 capsuleLength;
+	Vector2 a = e.Normalized(capsuleLength);
+
+	// Capsule is really a circle
+	if (capsuleLength < Traits<F32>::Epsilon) { return RaycastCircle(input, { v1, shape.radius }); }
+
+	Vector2 p1 = input.origin;
+	Vector2 d = input.translation;
+
+	// Ray from capsule start to ray start
+	Vector2 q = p1 - v1;
+	F32 qa = q.Dot(a);
+
+	// Vector to ray start that is perpendicular to capsule axis
+	Vector2 qp = q - a * qa;
+
+	F32 radius = shape.radius;
+
+	// Does the ray start within the infinite length capsule?
+	if (qp.Dot(qp) < radius * radius)
+	{
+		// Start point behind capsule segment
+		if (qa < 0.0f) { return RaycastCircle(input, { v1, radius }); }
+
+		// Start point ahead of capsule segment
+		if (qa > capsuleLength) { return RaycastCircle(input, { v2, radius }); }
+
+		// Ray starts inside capsule -> no hit
+		return output;
+	}
+
+	// Perpendicular to capsule axis, pointing right
+	Vector2 n = a.PerpendicularRight();
+
+	F32 rayLength;
+	Vector2 u = d.Normalized(rayLength);
+
+	// Intersect ray with infinite length capsule
+	// v1 + radius * n + s1 * a = p1 + s2 * u
+	// v1 - radius * n + s1 * a = p1 + s2 * u
+
+	// s1 * a - s2 * u = b
+	// b = q + radius * n
+	// b = q - radius * n
+
+	// Cramer's rule [a -u]
+	F32 den = -a.x * u.y + u.x * a.y;
+
+	// Ray is parallel to capsule and outside infinite length capsule
+	if (-Traits<F32>::Epsilon < den && den < Traits<F32>::Epsilon) { return output; }
+
+	Vector2 b1 = q - n * radius;
+	Vector2 b2 = q + n * radius;
+
+	F32 invDen = 1.0f / den;
+
+	// Cramer's rule [a b1]
+	F32 s21 = (a.x * b1.y - b1.x * a.y) * invDen;
+
+	// Cramer's rule [a b2]
+	F32 s22 = (a.x * b2.y - b2.x * a.y) * invDen;
+
+	F32 s2;
+	Vector2 b;
+	if (s21 < s22)
+	{
+		s2 = s21;
+		b = b1;
+	}
+	else
+	{
+		s2 = s22;
+		b = b2;
+		n = -n;
+	}
+
+	if (s2 < 0.0f || input.maxFraction * rayLength < s2) { return output; }
+
+	// Cramer's rule [b -u]
+	F32 s1 = (-b.x * u.y + u.x * b.y) * invDen;
+
+	// Ray passes behind capsule segment (v1)
+	if (s1 < 0.0f) { return RaycastCircle(input, { v1, radius }); }
+
+	// Ray passes ahead of capsule segment (v2)
+	if (capsuleLength < s1) { return RaycastCircle(input, { v2, radius }); }
+
+	// Ray hits capsule side
+	output.fraction = s2 / rayLength;
+	output.point = Math::Lerp(v1, v2, s1 / capsuleLength) + n * radius;
+	output.normal = n;
+	output.hit = true;
+
+	return output;
+}
+
+CastOutput Physics::RaycastSegment(const RaycastInput& input, const Segment& shape, bool oneSided)
+{
+	CastOutput output = {};
+
+	// Skip left-side collision
+	if (oneSided && (input.origin - shape.point1).Cross(shape.point2 - shape.point1) < 0.0f) { return output; }
+
+	Vector2 p1 = input.origin;
+	Vector2 d = input.translation;
+
+	Vector2 v1 = shape.point1;
+	Vector2 e = shape.point2 - v1;
+
+	F32 length;
+	Vector2 eUnit = e.Normalized(length);
+	if (length == 0.0f) { return output; }
+
+	// Normal points to the right, looking from v1 towards v2
+	Vector2 normal = eUnit.PerpendicularRight();
+
+	// Intersect ray with infinite segment using normal
+	// Similar to intersecting a ray with an infinite plane
+	// p = p1 + t * d
+	// dot(normal, p - v1) = 0
+	// dot(normal, p1 - v1) + t * dot(normal, d) = 0
+	F32 numerator = normal.Dot(v1 - p1);
+	F32 denominator = normal.Dot(d);
+
+	// Parallel
+	if (denominator == 0.0f) { return output; }
+
+	F32 t = numerator / denominator;
+	if (t < 0.0f || input.maxFraction < t) { return output; }
+
+	Vector2 p = p1 + d * t;
+
+	F32 s = (p - v1).Dot(eUnit);
+	if (s < 0.0f || length < s) { return output; }
+
+	if (numerator > 0.0f) { normal = -normal; }
+
+	output.fraction = t;
+	output.point = p;
+	output.normal = normal;
+	output.hit = true;
+
+	return output;
+}
+
+CastOutput Physics::RaycastPolygon(const RaycastInput& input, const ConvexPolygon& shape)
+{
+	// Rounded polygons need the full GJK cast
+	if (shape.radius > 0.0f)
+	{
+		ShapeCastPairInput castInput;
+		castInput.proxyA = MakeProxy(shape.vertices, shape.count, shape.radius);
+		castInput.proxyB = MakeProxy(&input.origin, 1, 0.0f);
+		castInput.transformA = Transform2D{};
+		castInput.transformB = Transform2D{};
+		castInput.translationB = input.translation;
+		castInput.maxFraction = input.maxFraction;
+		return ShapeCast(castInput);
+	}
+
+	CastOutput output = {};
+
+	Vector2 p1 = input.origin;
+	Vector2 d = input.translation;
+
+	F32 lower = 0.0f;
+	F32 upper = input.maxFraction;
+
+	I32 index = -1;
+
+	for (I32 i = 0; i < shape.count; ++i)
+	{
+		// p = p1 + a * d
+		// dot(normal, p - v) = 0
+		// dot(normal, p1 - v) + a * dot(normal, d) = 0
+		F32 numerator = shape.normals[i].Dot(shape.vertices[i] - p1);
+		F32 denominator = shape.normals[i].Dot(d);
+
+		if (denominator == 0.0f)
+		{
+			if (numerator < 0.0f) { return output; }
+		}
+		else
+		{
+			// Note: we want this predicate without division:
+			// lower < numerator / denominator, where denominator < 0
+			// Since denominator < 0, we have to flip the inequality:
+			// lower < numerator / denominator <==> denominator * lower > numerator.
+			if (denominator < 0.0f && numerator < lower * denominator)
+			{
+				// Increase lower. The segment enters this half-space.
+				lower = numerator / denominator;
+				index = i;
+			}
+			else if (denominator > 0.0f && numerator < upper * denominator)
+			{
+				// Decrease upper. The segment exits this half-space.
+				upper = numerator / denominator;
+			}
+		}
+
+		if (upper < lower) { return output; }
+	}
+
+	if (index >= 0)
+	{
+		output.fraction = lower;
+		output.normal = shape.normals[index];
+		output.point = p1 + d * lower;
+		output.hit = true;
+	}
+
+	return output;
+}
+
+CastOutput Physics::RaycastShape(const RaycastInput& input, const Shape& shape, const Transform2D& transform)
+{
+	// Cast in the shape's local space, then move the hit back out
+	RaycastInput localInput = input;
+	localInput.origin = (input.origin - transform.position) ^ transform.rotation;
+	localInput.translation = input.translation ^ transform.rotation;
+
+	CastOutput output = {};
+
+	switch (shape.type)
+	{
+	case SHAPE_TYPE_CAPSULE: output = RaycastCapsule(localInput, shape.capsule); break;
+	case SHAPE_TYPE_CIRCLE: output = RaycastCircle(localInput, shape.circle); break;
+	case SHAPE_TYPE_POLYGON: output = RaycastPolygon(localInput, shape.polygon); break;
+	case SHAPE_TYPE_SEGMENT: output = RaycastSegment(localInput, shape.segment, false); break;
+	case SHAPE_TYPE_CHAIN_SEGMENT: output = RaycastSegment(localInput, shape.chainSegment.segment, true); break;
+	default: return output;
+	}
+
+	output.point = output.point * transform;
+	output.normal = output.normal * transform.rotation;
+
+	return output;
+}
+
+CastOutput Physics::ShapeCastShape(const ShapeCastInput& input, const Shape& shape, const Transform2D& transform)
+{
+	ShapeCastPairInput pairInput;
+	pairInput.proxyA = MakeShapeDistanceProxy(shape);
+	pairInput.proxyB = MakeProxy(input.points, input.count, input.radius);
+	pairInput.transformA = transform;
+	pairInput.transformB = Transform2D{};
+	pairInput.translationB = input.translation;
+	pairInput.maxFraction = input.maxFraction;
+
+	return ShapeCast(pairInput);
+}
+
+// GJK-raycast
+// Algorithm by Gino van den Bergen.
+// "Smooth Mesh Contacts with GJK" in Game Physics Pearls. 2010
+CastOutput Physics::ShapeCast(const ShapeCastPairInput& input)
+{
+	CastOutput output = {};
+	output.fraction = input.maxFraction;
+
+	DistanceProxy proxyA = input.proxyA;
+
+	Transform2D xfA = input.transformA;
+	Transform2D xfB = input.transformB;
+	Transform2D xf = xfA ^ xfB;
+
+	// Put proxyB in proxyA's frame to reduce round-off error
+	DistanceProxy proxyB;
+	proxyB.count = input.proxyB.count;
+	proxyB.radius = input.proxyB.radius;
+
+	for (I32 i = 0; i < proxyB.count; ++i) { proxyB.points[i] = input.proxyB.points[i] * xf; }
+
+	F32 radius = proxyA.radius + proxyB.radius;
+
+	Vector2 r = input.translationB * xf.rotation;
+	F32 lambda = 0.0f;
+	F32 maxFraction = input.maxFraction;
+
+	// Initial simplex
+	Simplex simplex;
+	simplex.count = 0;
+
+	// Get simplex vertices as an array.
+	SimplexVertex* vertices[] = { &simplex.v1, &simplex.v2, &simplex.v3 };
+
+	// Get support point in -r direction
+	I32 indexA = FindSupport(proxyA, -r);
+	Vector2 wA = proxyA.points[indexA];
+	I32 indexB = FindSupport(proxyB, r);
+	Vector2 wB = proxyB.points[indexB];
+	Vector2 v = wA - wB;
+
+	// Sigma is the target distance between proxies
+	const F32 sigma = Math::Max(LinearSlop, radius - LinearSlop);
+
+	// Main iteration loop.
+	const F32 tolerance = 0.5f * LinearSlop;
+	const I32 maxIterations = 20;
+	I32 iteration = 0;
+	while (iteration < maxIterations && v.Magnitude() > sigma + tolerance)
+	{
+		output.iterations += 1;
+
+		// Support in direction -v (A - B)
+		indexA = FindSupport(proxyA, -v);
+		wA = proxyA.points[indexA];
+		indexB = FindSupport(proxyB, v);
+		wB = proxyB.points[indexB];
+		Vector2 p = wA - wB;
+
+		// -v is a normal at p, normalize to work with sigma
+		v.Normalize();
+
+		// Intersect ray with plane
+		F32 vp = v.Dot(p);
+		F32 vr = v.Dot(r);
+		if (vp - sigma > lambda * vr)
+		{
+			// Miss
+			if (vr <= 0.0f) { return output; }
+
+			lambda = (vp - sigma) / vr;
+
+			// Too far
+			if (lambda > maxFraction) { return output; }
+
+			// Reset the simplex
+			simplex.count = 0;
+		}
+
+		// Reverse simplex since it works with B - A.
+		// Shift by lambda * r because we want the closest point to the current clip point.
+		// Note that the support point p is not shifted because we want the plane equation
+		// to be formed in unshifted space.
+		SimplexVertex* vertex = vertices[simplex.count];
+		vertex->indexA = indexB;
+		vertex->wA = wB + r * lambda;
+		vertex->indexB = indexA;
+		vertex->wB = wA;
+		vertex->w = vertex->wB - vertex->wA;
+		vertex->a = 1.0f;
+		simplex.count += 1;
+
+		switch (simplex.count)
+		{
+		case 1: break;
+		case 2: SolveSimplex2(simplex); break;
+		case 3: SolveSimplex3(simplex); break;
+		default: break;
+		}
+
+		// If we have 3 points, then the origin is in the corresponding triangle, overlap
+		if (simplex.count == 3) { return output; }
+
+		// Get search direction.
+		v = ComputeSimplexClosestPoint(simplex);
+
+		// Iteration count is equated to the number of support point calls.
+		++iteration;
+	}
+
+	// Initial overlap
+	if (iteration == 0 || lambda == 0.0f) { return output; }
+
+	// Prepare output
+	Vector2 pointA, pointB;
+	ComputeSimplexWitnessPoints(pointB, pointA, simplex);
+
+	Vector2 n = (-v).Normalized();
+	Vector2 point = pointA + n * proxyA.radius;
+
+	output.point = point * xfA;
+	output.normal = n * xfA.rotation;
+	output.fraction = lambda;
+	output.iterations = iteration;
+	output.hit = true;
+
+	return output;
+}
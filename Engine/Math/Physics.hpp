@@ -27,6 +27,7 @@
 #include "Containers\Freelist.hpp"
 
 struct Scene;
+struct SnapshotWriter;
 
 class NH_API Physics
 {
@@ -47,13 +48,125 @@ public:
 	static AABB ComputeCapsuleAABB(const Capsule& shape, const Transform2D& transform);
 	static ShapeExtent ComputeShapeExtent(const Shape& shape, Vector2 localCenter);
 
+	/// <summary>
+	/// Creates a body, bodies live in one array so keep the id rather than a reference, references move as more bodies are created
+	/// </summary>
+	/// <returns>The body's id, pass it to GetRigidBody</returns>
+	static I32 CreateRigidBody(const RigidBody2DDef& def);
 	static RigidBody2D& GetRigidBody(I32 id);
 
+	/// <summary>
+	/// Pins two bodies together at a shared anchor so they can only rotate relative to each other
+	/// </summary>
+	/// <returns>The joint's id</returns>
+	static I32 CreateRevoluteJoint(const RevoluteJointDef& def);
+
+	static CastOutput RaycastCircle(const RaycastInput& input, const Circle& shape);
+	static CastOutput RaycastCapsule(const RaycastInput& input, const Capsule& shape);
+	static CastOutput RaycastSegment(const RaycastInput& input, const Segment& shape, bool oneSided);
+	static CastOutput RaycastPolygon(const RaycastInput& input, const ConvexPolygon& shape);
+	static CastOutput RaycastShape(const RaycastInput& input, const Shape& shape, const Transform2D& transform);
+	static CastOutput ShapeCast(const ShapeCastPairInput& input);
+	static CastOutput ShapeCastShape(const ShapeCastInput& input, const Shape& shape, const Transform2D& transform);
+
+	/// <summary>
+	/// Casts a ray against the static, kinematic and dynamic trees, sensors are ignored
+	/// </summary>
+	/// <param name="origin:">The start of the ray in world space</param>
+	/// <param name="translation:">The direction and length of the ray</param>
+	/// <param name="filter:">Shapes must pass ShouldShapesCollide with this filter to be hit</param>
+	/// <param name="results:">Every hit is appended, in no particular order</param>
+	static void CastRay(const Vector2& origin, const Vector2& translation, const Filter& filter, Vector<RaycastResult>& results);
+
+	/// <summary>
+	/// Casts a ray and returns only the nearest hit, each hit clips the rest of the search so this is much cheaper than CastRay
+	/// </summary>
+	/// <returns>The nearest hit, hit is false if nothing was hit</returns>
+	static RaycastResult CastRayClosest(const Vector2& origin, const Vector2& translation, const Filter& filter = DefaultQueryFilter);
+
+	/// <summary>
+	/// Sweeps a convex shape along input.translation, points are in world space
+	/// </summary>
+	/// <param name="results:">Every hit is appended, in no particular order</param>
+	static void CastShape(const ShapeCastInput& input, const Filter& filter, Vector<RaycastResult>& results);
+
+	/// <summary>
+	/// Finds the shapes overlapping each box, the boxes walk the trees together in packets of NH_SIMD_WIDTH and the packets are split across the job workers
+	/// <para/>Call from the main thread or a job, not while physics is stepping
+	/// </summary>
+	/// <param name="boxes:">The boxes to test in world space</param>
+	/// <param name="count:">The number of boxes</param>
+	/// <param name="results:">Receives the hits of every box in order, reuse it between calls to keep its memory</param>
+	static void QueryBatch(const AABB* boxes, U32 count, const Filter& filter, QueryBatchResults& results);
+
+	/// <summary>
+	/// Casts many rays at once in packets of NH_SIMD_WIDTH, split across the job workers
+	/// </summary>
+	/// <param name="results:">Resized to count, results[i] is the closest hit of rays[i]</param>
+	static void CastRayBatch(const RaycastInput* rays, U32 count, const Filter& filter, Vector<RaycastResult>& results);
+
+	/// <summary>
+	/// Rebuilds the static tree from scratch, static proxies are only ever inserted one at a time so call this once a level is loaded
+	/// </summary>
+	static void RebuildStaticTree();
+
+	/// <summary>
+	/// Sets how many fixed steps run per second
+	/// </summary>
+	static void SetStepRate(F32 stepsPerSecond);
+	static void SetSubStepCount(I32 count);
+	static void SetMaxStepsPerFrame(I32 count);
+
+	/// <summary>
+	/// How far the current frame is between the previous and latest fixed step, 0 to 1
+	/// </summary>
+	static F32 InterpolationAlpha();
+
+	/// <summary>
+	/// The body's transform blended between the last two fixed steps, use this for rendering so motion stays smooth at any frame rate
+	/// </summary>
+	static Transform2D InterpolatedTransform(I32 bodyId);
+
+	/// <summary>
+	/// Saves the whole world into a flat buffer, bodies, shapes, contacts with their cached impulses, joints, islands, solver sets, broadphase trees and id freelists
+	/// <para/>Only valid for Restore in the same build, reuse the buffer between calls to keep its memory
+	/// </summary>
+	static void Snapshot(Vector<U8>& buffer);
+
+	/// <summary>
+	/// Puts the world back exactly as it was when the snapshot was taken, stepping from here matches the original bit for bit
+	/// <para/>Ids stay valid but references to bodies and shapes may move, events from the undone steps are cleared
+	/// </summary>
+	/// <returns>false if the buffer isn't a snapshot from this build or physics is stepping</returns>
+	static bool Restore(const Vector<U8>& buffer);
+
+	/// <summary>
+	/// Deterministic mode creates new contacts in shape order instead of tree order and hashes the world after every step,
+	/// the engine is built /fp:precise and the physics sources add NH_STRICT_FLOAT so the same steps give the same hash on every machine and build
+	/// </summary>
+	static void SetDeterministic(bool enabled);
+	static bool Deterministic();
+
+	/// <summary>
+	/// Touching contacts whose shapes have barely moved relative to each other keep their manifold instead of running the narrowphase, on by default
+	/// </summary>
+	static void EnableManifoldReuse(bool enabled);
+
+	/// <summary>
+	/// The hash of every awake body's transform and velocity after the last step, 0 unless deterministic mode is on
+	/// </summary>
+	static U64 StateHash();
+
+	/// <summary>
+	/// How long each stage of the last step took, Update can run several steps a frame so this is only the final one
+	/// </summary>
+	static const PhysicsProfile& Profile();
+
 private:
-	static bool Initialize();
+	static bool Initialize(F32 stepRate = 60.0f, I32 subSteps = 4, I32 maxSteps = 8);
 	static void Shutdown();
 
-	static void Update(F32 step);
+	static void Update(F64 deltaTime);
 	static void Solve(StepContext& stepContext);
 
 	static void EnableSleeping(bool flag);
@@ -63,6 +176,9 @@ private:
 	static void WakeSolverSet(int setIndex);
 
 	static void Step(F32 timeStep, int subStepCount);
+	static void StorePreviousTransforms();
+	static void WriteSnapshot(SnapshotWriter& writer);
+	static U64 HashState();
 	static void Collide(StepContext& context);
 	static void CollideTask(int startIndex, int endIndex, int threadIndex, StepContext& stepContext);
 
@@ -72,21 +188,31 @@ private:
 	static Shape& CreateConvexPolygonShape(RigidBody2D& body, const Transform2D& transform, const ShapeDef& def, const ConvexPolygon& geometry);
 	static Shape& CreateSegmentShape(RigidBody2D& body, const Transform2D& transform, const ShapeDef& def, const Segment& geometry);
 	static Shape& CreateChainSegmentShape(RigidBody2D& body, const Transform2D& transform, const ShapeDef& def, const ChainSegment& geometry);
+	static void DestroyShapeInternal(Shape& shape, RigidBody2D& body, bool wakeBodies);
+	static void DestroySensor(Shape& shape);
 	static BodySim& GetBodySim(RigidBody2D& body);
 	
 	static void PrepareOverflowContacts(StepContext& context);
 	static void PrepareContactsTask(int startIndex, int endIndex, StepContext& context);
 	static void WarmStartContactsTask(int startIndex, int endIndex, StepContext& context, int colorIndex);
 	static void SolveContactsTask(int startIndex, int endIndex, StepContext& context, int colorIndex, bool useBias);
+#ifdef NH_SIMD_PAIR
+	NH_TARGET_AVX2 static void SolveContactPairsTask(int startIndex, int endIndex, StepContext& context, int colorIndex, bool useBias);
+#endif
 
 	static void CreateContact(Shape& shapeA, Shape& shapeB);
 	static void DestroyContact(Contact& contact, bool wakeBodies);
+	static void DestroyContactsBetweenBodies(RigidBody2D& bodyA, RigidBody2D& bodyB);
 	static bool UpdateContact(ContactSim& contactSim, Shape& shapeA, const Transform2D& transformA, const Vector2& centerOffsetA,
 		Shape& shapeB, const Transform2D& transformB, const Vector2& centerOffsetB);
+	static bool ReuseManifold(ContactSim& contactSim, const Shape& shapeA, const Transform2D& transformA, const Vector2& centerOffsetA,
+		const Shape& shapeB, const Transform2D& transformB, const Vector2& centerOffsetB);
 	static void LinkContact(Contact& contact);
 	static void UnlinkContact(Contact& contact);
 
+	static I32 CreateJointInternal(const JointSim& jointSim, void* userData, F32 drawSize, bool collideConnected);
 	static void DestroyJointInternal(Joint& joint, bool wakeBodies);
+	static void LinkJoint(Joint& joint);
 	static void UnlinkJoint(Joint& joint);
 	static void RemoveJointFromGraph(int bodyIdA, int bodyIdB, int colorIndex, int localIndex);
 	static bool WakeBody(RigidBody2D& body);
@@ -147,16 +273,20 @@ private:
 	static Vector2 ComputeSimplexSearchDirection(const Simplex& simplex);
 	static I32 FindSupport(const DistanceProxy& proxy, const Vector2& direction);
 	static void ComputeSimplexWitnessPoints(Vector2& a, Vector2& b, const Simplex& s);
+	static Vector2 ComputeSimplexClosestPoint(const Simplex& s);
 	static Vector2 Weight2(F32 a1, const Vector2& w1, F32 a2, const Vector2& w2);
 	static Vector2 Weight3(F32 a1, const Vector2& w1, F32 a2, const Vector2& w2, F32 a3, const Vector2& w3);
 
 	static Island& CreateIsland(int setIndex);
 	static void DestroyIsland(int islandId);
 	static void AddContactToIsland(I32 islandId, Contact& contact);
+	static void AddJointToIsland(I32 islandId, Joint& joint);
 	static void MergeAwakeIslands();
 	static void MergeIsland(Island& island);
 	static void TrySleepIsland(int islandId);
-	static void SplitIsland(int baseId);
+	static void PrepareIslandSplit(IslandSplit& split, I32 baseId);
+	static void SearchIslandSplit(IslandSplit& split);
+	static void ApplyIslandSplit(const IslandSplit& split);
 	static void CreateIslandForBody(int setIndex, RigidBody2D& body);
 	static void RemoveBodyFromIsland(RigidBody2D& body);
 	static I32 GetBodyID(RigidBody2D& body);
@@ -174,7 +304,8 @@ private:
 	static void FinalizeBodiesTask(int startIndex, int endIndex, U32 threadIndex, StepContext& stepContext);
 	static void FastBodyTask(int startIndex, int endIndex, U32 threadIndex, StepContext& taskContext);
 	static void BulletBodyTask(int startIndex, int endIndex, U32 threadIndex, StepContext& taskContext);
-	static void SolveContinuous(int bodySimIndex);
+	static void ReserveContinuous(const I32* simIndices, int count);
+	static void SolveContinuous(const I32* simIndices, int count, TaskContext& taskContext);
 	static TOIOutput TimeOfImpact(const TOIInput& input);
 	static SeparationFunction MakeSeparationFunction(const DistanceCache& cache, const DistanceProxy& proxyA, const Sweep& sweepA,
 		const DistanceProxy& proxyB, const Sweep& sweepB, F32 t1);
@@ -182,6 +313,10 @@ private:
 	static float EvaluateSeparation(const SeparationFunction& f, int indexA, int indexB, float t);
 	static Transform2D GetSweepTransform(const Sweep& sweep, F32 time);
 
+	static void OverlapSensors();
+	static void TouchSensorsTask(I32 startIndex, I32 endIndex, TaskContext& taskContext);
+	static void SensorTask(I32 startIndex, I32 endIndex, TaskContext& taskContext, bool canGrow);
+
 	static ConstraintGraph constraintGraph;
 
 	static Freelist rigidBodyFreelist;
@@ -205,6 +340,9 @@ private:
 	static Freelist chainFreelist;
 	static Vector<ChainShape> chains;
 
+	static Vector<Sensor> sensors;
+	static Vector<I32> sensorMoves;
+
 	static Vector<TaskContext> taskContexts;
 
 	static Vector<BodyMoveEvent> bodyMoveEvents;
@@ -223,7 +361,9 @@ private:
 	// - islands that have removed constraints must be put split first because I don't want to wake bodies incorrectly
 	// - otherwise I can use the awake islands that have bodies wanting to sleep as the splitting candidates
 	// - if no bodies want to sleep then there is no reason to perform island splitting
-	static I32 splitIslandId;
+	// Several islands can be split in one step, their searches run as jobs alongside the solver
+	static Vector<I32> splitIslandIds;
+	static Vector<IslandSplit> islandSplits;
 
 	static Vector2 gravity;
 	static F32 hitEventThreshold;
@@ -252,12 +392,28 @@ private:
 	static bool enableContinuous;
 	static bool paused;
 	static bool singleStep;
+	static bool deterministic;
+	static bool enableManifoldReuse;
 	static int subStepCount;
 
+	static F32 fixedTimeStep;
+	static F64 accumulator;
+	static F32 interpolationAlpha;
+	static I32 maxStepsPerFrame;
+
+	static U64 stateHash;
+	static PhysicsProfile profile;
+
+	// The contact solve picked at Initialize from what the CPU supports
+	typedef void(*SolveContactsKernel)(int startIndex, int endIndex, StepContext& context, int colorIndex, bool useBias);
+	static SolveContactsKernel solveContacts;
+
 	STATIC_CLASS(Physics);
 	friend class Engine;
 	friend class Broadphase;
 	friend struct ConstraintGraph;
 	friend struct Scene;
 	friend struct RigidBody2D;
+	friend struct PhysicsTests;
+	friend struct PhysicsBenchmark;
 };
\ No newline at end of file
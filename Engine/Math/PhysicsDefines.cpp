@@ -1,3 +1,7 @@
+#include "Defines.hpp"
+
+NH_STRICT_FLOAT
+
 #include "PhysicsDefines.hpp"
 
 #include "Physics.hpp"
@@ -186,7 +190,7 @@ I32 ConstraintGraph::AssignJointColor(I32 bodyIdA, I32 bodyIdB, bool staticA, bo
 	return OverflowIndex;
 }
 
-void ConstraintGraph::AddJoint(JointSim& jointSim, Joint& joint)
+void ConstraintGraph::AddJoint(const JointSim& jointSim, Joint& joint)
 {
 	int bodyIdA = joint.edges[0].bodyId;
 	int bodyIdB = joint.edges[1].bodyId;
@@ -274,35 +278,35 @@ void SolverSet::Destroy()
 
 JointSim::JointSim() = default;
 
-JointSim::JointSim(const JointSim& other) : jointId(other.jointId), bodyIdA(other.bodyIdA), bodyIdB(bodyIdB), type(other.type),
+JointSim::JointSim(const JointSim& other) : jointId(other.jointId), bodyIdA(other.bodyIdA), bodyIdB(other.bodyIdB), type(other.type),
 	localOriginAnchorA(other.localOriginAnchorA), localOriginAnchorB(other.localOriginAnchorB), 
 	invMassA(other.invMassA), invMassB(other.invMassB), invIA(other.invIA), invIB(other.invIB)
 {
 	switch (type)
 	{
-	case JOINT_TYPE_DISTANCE: distanceJoint = other.distanceJoint;
-	case JOINT_TYPE_MOTOR: motorJoint = other.motorJoint;
-	case JOINT_TYPE_MOUSE: mouseJoint = other.mouseJoint;
-	case JOINT_TYPE_PRISMATIC: revoluteJoint = other.revoluteJoint;
-	case JOINT_TYPE_REVOLUTE: prismaticJoint = other.prismaticJoint;
-	case JOINT_TYPE_WELD: weldJoint = other.weldJoint;
-	case JOINT_TYPE_WHEEL: wheelJoint = other.wheelJoint;
+	case JOINT_TYPE_DISTANCE: distanceJoint = other.distanceJoint; break;
+	case JOINT_TYPE_MOTOR: motorJoint = other.motorJoint; break;
+	case JOINT_TYPE_MOUSE: mouseJoint = other.mouseJoint; break;
+	case JOINT_TYPE_PRISMATIC: prismaticJoint = other.prismaticJoint; break;
+	case JOINT_TYPE_REVOLUTE: revoluteJoint = other.revoluteJoint; break;
+	case JOINT_TYPE_WELD: weldJoint = other.weldJoint; break;
+	case JOINT_TYPE_WHEEL: wheelJoint = other.wheelJoint; break;
 	}
 }
 
-JointSim::JointSim(JointSim&& other) noexcept : jointId(other.jointId), bodyIdA(other.bodyIdA), bodyIdB(bodyIdB), type(other.type),
+JointSim::JointSim(JointSim&& other) noexcept : jointId(other.jointId), bodyIdA(other.bodyIdA), bodyIdB(other.bodyIdB), type(other.type),
 localOriginAnchorA(other.localOriginAnchorA), localOriginAnchorB(other.localOriginAnchorB),
 invMassA(other.invMassA), invMassB(other.invMassB), invIA(other.invIA), invIB(other.invIB)
 {
 	switch (type)
 	{
-	case JOINT_TYPE_DISTANCE: distanceJoint = Move(other.distanceJoint);
-	case JOINT_TYPE_MOTOR: motorJoint = Move(other.motorJoint);
-	case JOINT_TYPE_MOUSE: mouseJoint = Move(other.mouseJoint);
-	case JOINT_TYPE_PRISMATIC: revoluteJoint = Move(other.revoluteJoint);
-	case JOINT_TYPE_REVOLUTE: prismaticJoint = Move(other.prismaticJoint);
-	case JOINT_TYPE_WELD: weldJoint = Move(other.weldJoint);
-	case JOINT_TYPE_WHEEL: wheelJoint = Move(other.wheelJoint);
+	case JOINT_TYPE_DISTANCE: distanceJoint = Move(other.distanceJoint); break;
+	case JOINT_TYPE_MOTOR: motorJoint = Move(other.motorJoint); break;
+	case JOINT_TYPE_MOUSE: mouseJoint = Move(other.mouseJoint); break;
+	case JOINT_TYPE_PRISMATIC: prismaticJoint = Move(other.prismaticJoint); break;
+	case JOINT_TYPE_REVOLUTE: revoluteJoint = Move(other.revoluteJoint); break;
+	case JOINT_TYPE_WELD: weldJoint = Move(other.weldJoint); break;
+	case JOINT_TYPE_WHEEL: wheelJoint = Move(other.wheelJoint); break;
 	}
 }
 
@@ -310,7 +314,7 @@ JointSim& JointSim::operator=(const JointSim& other)
 {
 	jointId = other.jointId;
 	bodyIdA = other.bodyIdA;
-	bodyIdB = bodyIdB;
+	bodyIdB = other.bodyIdB;
 	type = other.type;
 	localOriginAnchorA = other.localOriginAnchorA;
 	localOriginAnchorB = other.localOriginAnchorB;
@@ -321,13 +325,13 @@ JointSim& JointSim::operator=(const JointSim& other)
 
 	switch (type)
 	{
-	case JOINT_TYPE_DISTANCE: distanceJoint = other.distanceJoint;
-	case JOINT_TYPE_MOTOR: motorJoint = other.motorJoint;
-	case JOINT_TYPE_MOUSE: mouseJoint = other.mouseJoint;
-	case JOINT_TYPE_PRISMATIC: revoluteJoint = other.revoluteJoint;
-	case JOINT_TYPE_REVOLUTE: prismaticJoint = other.prismaticJoint;
-	case JOINT_TYPE_WELD: weldJoint = other.weldJoint;
-	case JOINT_TYPE_WHEEL: wheelJoint = other.wheelJoint;
+	case JOINT_TYPE_DISTANCE: distanceJoint = other.distanceJoint; break;
+	case JOINT_TYPE_MOTOR: motorJoint = other.motorJoint; break;
+	case JOINT_TYPE_MOUSE: mouseJoint = other.mouseJoint; break;
+	case JOINT_TYPE_PRISMATIC: prismaticJoint = other.prismaticJoint; break;
+	case JOINT_TYPE_REVOLUTE: revoluteJoint = other.revoluteJoint; break;
+	case JOINT_TYPE_WELD: weldJoint = other.weldJoint; break;
+	case JOINT_TYPE_WHEEL: wheelJoint = other.wheelJoint; break;
 	}
 
 	return *this;
@@ -337,7 +341,7 @@ JointSim& JointSim::operator=(JointSim&& other) noexcept
 {
 	jointId = other.jointId;
 	bodyIdA = other.bodyIdA;
-	bodyIdB = bodyIdB;
+	bodyIdB = other.bodyIdB;
 	type = other.type;
 	localOriginAnchorA = other.localOriginAnchorA;
 	localOriginAnchorB = other.localOriginAnchorB;
@@ -348,13 +352,13 @@ JointSim& JointSim::operator=(JointSim&& other) noexcept
 
 	switch (type)
 	{
-	case JOINT_TYPE_DISTANCE: distanceJoint = Move(other.distanceJoint);
-	case JOINT_TYPE_MOTOR: motorJoint = Move(other.motorJoint);
-	case JOINT_TYPE_MOUSE: mouseJoint = Move(other.mouseJoint);
-	case JOINT_TYPE_PRISMATIC: revoluteJoint = Move(other.revoluteJoint);
-	case JOINT_TYPE_REVOLUTE: prismaticJoint = Move(other.prismaticJoint);
-	case JOINT_TYPE_WELD: weldJoint = Move(other.weldJoint);
-	case JOINT_TYPE_WHEEL: wheelJoint = Move(other.wheelJoint);
+	case JOINT_TYPE_DISTANCE: distanceJoint = Move(other.distanceJoint); break;
+	case JOINT_TYPE_MOTOR: motorJoint = Move(other.motorJoint); break;
+	case JOINT_TYPE_MOUSE: mouseJoint = Move(other.mouseJoint); break;
+	case JOINT_TYPE_PRISMATIC: prismaticJoint = Move(other.prismaticJoint); break;
+	case JOINT_TYPE_REVOLUTE: revoluteJoint = Move(other.revoluteJoint); break;
+	case JOINT_TYPE_WELD: weldJoint = Move(other.weldJoint); break;
+	case JOINT_TYPE_WHEEL: wheelJoint = Move(other.wheelJoint); break;
 	}
 
 	return *this;
@@ -52,6 +52,9 @@ static constexpr inline F32 AllowedPenetration = 0.01f;
 static constexpr inline F32 LinearSlop = 0.005f;
 static constexpr inline F32 AngularSlop = 2.0f / 180.0f * PI_F;
 static constexpr inline F32 TimeToSleep = 0.5f;
+
+// Bounds the islands split in one step, the rest wait for the next
+static constexpr inline I32 MaxSplitIslands = 32;
 static constexpr inline F32 LinearSleepTolerance = 0.01f;
 static constexpr inline F32 LinearSleepToleranceSqr = LinearSleepTolerance * LinearSleepTolerance;
 static constexpr inline F32 AngularSleepTolerance = (2.0f / 180.0f * PI_F);
@@ -66,6 +69,15 @@ static constexpr inline U32 GraphColorCount = 12;
 static constexpr inline U32 OverflowIndex = GraphColorCount - 1;
 static constexpr inline F32 SpeculativeDistance = 4.0f * LinearSlop;
 
+// Static tree hits a continuous packet can hold before its lanes fall back to querying alone
+static constexpr inline U32 ContinuousHitCapacity = 256;
+
+// Tree hits a packet of sensors can hold before the job leaves them to the main thread
+static constexpr inline U32 SensorHitCapacity = 256;
+
+// Touching contacts keep their manifold until the shapes may have moved this far relative to each other since the narrowphase last ran
+static constexpr inline F32 ManifoldReuseDistance = 0.1f * LinearSlop;
+
 enum NH_API ColliderType
 {
 	COLLIDER_TYPE_CIRCLE,
@@ -105,9 +117,6 @@ enum ContactFlag
 {
 	CONTACT_FLAG_TOUCHING = 0x00000001,
 	CONTACT_FLAG_HIT_EVENT = 0x00000002,
-	CONTACT_FLAG_SENSOR = 0x0000004,
-	CONTACT_FLAG_SENSOR_TOUCHING = 0x00000008,
-	CONTACT_FLAG_ENABLE_SENSOR_EVENTS = 0x00000010,
 	CONTACT_FLAG_ENABLE_CONTACT_EVENTS = 0x00000020,
 };
 
@@ -202,6 +211,75 @@ struct CastOutput
 	bool hit;
 };
 
+// Queries hit any shape whose layers overlap layerMask
+static constexpr inline Filter DefaultQueryFilter = { U64_MAX, U64_MAX, 0 };
+
+struct NH_API RaycastResult
+{
+	I32 shapeId;	// Matches the id returned from RigidBody2D::AddCollider
+	I32 bodyId;
+	Vector2 point;
+	Vector2 normal;
+	F32 fraction;
+	bool hit;
+};
+
+// Carried through DynamicTree::Raycast and Shapecast, results is null when only the closest hit is wanted
+struct WorldCastContext
+{
+	Filter filter;
+	Vector<RaycastResult>* results;
+	RaycastResult closest;
+};
+
+// A leaf found by DynamicTree::QueryPacket, lane is the query's index within the packet
+struct PacketHit
+{
+	U32 lane;
+	I32 userData;
+};
+
+// Where one query's hits were written, they sit contiguously in that worker's buffer until they're merged
+struct QueryRecord
+{
+	U32 worker;
+	U32 start;
+	U32 count;
+};
+
+/*
+* Flat output of Physics::QueryBatch, the hits of query i are shapeIds[offsets[i]] to shapeIds[offsets[i] + counts[i]]
+* Keep one of these around between frames, the buffers keep their capacity
+*/
+struct NH_API QueryBatchResults
+{
+	Vector<I32> shapeIds;
+	Vector<U32> offsets;
+	Vector<U32> counts;
+
+	Vector<Vector<I32>> workerHits;
+	Vector<QueryRecord> records;
+};
+
+/*
+* Time spent in each stage of the last Physics::Step in milliseconds
+* Solve covers solveConstraints through sleepIslands, the gaps between stages are small bookkeeping
+*/
+struct NH_API PhysicsProfile
+{
+	F64 step;
+	F64 pairs;				// Broadphase pair finding and contact creation
+	F64 collide;			// Narrowphase
+	F64 solve;
+	F64 solveConstraints;	// Island merging, stage preparation, the solver and island splitting
+	F64 finalize;			// Body finalization, hit events and broadphase proxy updates
+	F64 continuous;
+	F64 sleepIslands;
+	F64 sensors;			// Sensor overlaps and their begin/end events
+	U32 splitIslands;		// Islands split this step, a count rather than a time
+	U32 reusedManifolds;	// Contacts that kept their last manifold instead of running the narrowphase, also a count
+};
+
 struct MassData
 {
 	F32 mass;
@@ -228,6 +306,22 @@ struct ChainShape
 	U16 revision;
 };
 
+/*
+* Sensors don't make contacts, every step they're overlap tested against the kinematic and dynamic shapes in their box
+* The overlaps are kept sorted by shape id, overlaps2 is this step's and overlaps1 the last step's, begin/end events come from diffing them
+*/
+struct Sensor
+{
+	Vector<I32> overlaps1;
+	Vector<I32> overlaps2;
+	I32 shapeId;
+	bool rebuild;	// Retest everything next pass, a new sensor has no previous overlaps to fall back on
+	bool changed;
+	bool nearby;	// The last query found other proxies in the box, they can reach the sensor without growing their fat AABB
+	bool touched;	// A proxy whose fat AABB grew this step overlaps the sensor
+	bool overflow;	// The job ran out of room for this sensor's hits or overlaps, the main thread redoes it
+};
+
 struct ShapeExtent
 {
 	F32 minExtent;
@@ -288,6 +382,7 @@ struct ShapeCastPairInput
 struct BodySim
 {
 	Transform2D transform;
+	Transform2D previousTransform;	// Transform before the last fixed step, for render interpolation
 	Vector2 center;
 	Quaternion2 rotation0;
 	Vector2 center0;
@@ -419,6 +514,11 @@ struct ContactSim
 	U32 simFlags;
 
 	DistanceCache cache;
+
+	// Body transforms when the manifold was last written and how far the shapes may have drifted since the narrowphase ran
+	Transform2D cacheTransformA;
+	Transform2D cacheTransformB;
+	F32 cacheDrift;
 };
 
 struct Softness
@@ -599,6 +699,61 @@ struct RevoluteJoint
 	bool enableLimit;
 };
 
+struct RevoluteJointDef
+{
+	/// The first attached body.
+	I32 bodyIdA = NullIndex;
+
+	/// The second attached body.
+	I32 bodyIdB = NullIndex;
+
+	/// The local anchor point relative to bodyA's origin.
+	Vector2 localAnchorA = Vector2Zero;
+
+	/// The local anchor point relative to bodyB's origin.
+	Vector2 localAnchorB = Vector2Zero;
+
+	/// The bodyB angle minus bodyA angle in the reference state (radians).
+	///	This defines the zero angle for the joint limit.
+	F32 referenceAngle = 0.0f;
+
+	/// Enable a rotational spring on the revolute hinge axis.
+	bool enableSpring = false;
+
+	/// The spring stiffness Hertz, cycles per second.
+	F32 hertz = 0.0f;
+
+	/// The spring damping ratio, non-dimensional.
+	F32 dampingRatio = 0.0f;
+
+	/// A flag to enable joint limits.
+	bool enableLimit = false;
+
+	/// The lower angle for the joint limit in radians.
+	F32 lowerAngle = 0.0f;
+
+	/// The upper angle for the joint limit in radians.
+	F32 upperAngle = 0.0f;
+
+	/// A flag to enable the joint motor.
+	bool enableMotor = false;
+
+	/// The maximum motor torque, typically in newton-meters.
+	F32 maxMotorTorque = 0.0f;
+
+	/// The desired motor speed in radians per second.
+	F32 motorSpeed = 0.0f;
+
+	/// Scale the debug draw.
+	F32 drawSize = 0.25f;
+
+	/// Set this flag to true if the attached bodies should collide.
+	bool collideConnected = false;
+
+	/// User data pointer.
+	void* userData = nullptr;
+};
+
 struct WeldJoint
 {
 	F32 referenceAngle;
@@ -714,43 +869,52 @@ struct ContactConstraint
 	I32 pointCount;
 };
 
-struct ContactConstraintSIMD
+/*
+* The solver only ever stores FloatW constraints, the FloatPairW version is built on the fly by the AVX2 contact solve in 4 wide builds
+*/
+template<class Wide>
+struct ContactConstraintT
 {
-	I32 indexA[NH_SIMD_WIDTH];
-	I32 indexB[NH_SIMD_WIDTH];
-
-	FloatW invMassA, invMassB;
-	FloatW invIA, invIB;
-	Vector2W normal;
-	FloatW friction;
-	FloatW biasRate;
-	FloatW massScale;
-	FloatW impulseScale;
-	Vector2W anchorA1, anchorB1;
-	FloatW normalMass1, tangentMass1;
-	FloatW baseSeparation1;
-	FloatW normalImpulse1;
-	FloatW maxNormalImpulse1;
-	FloatW tangentImpulse1;
-	Vector2W anchorA2, anchorB2;
-	FloatW baseSeparation2;
-	FloatW normalImpulse2;
-	FloatW maxNormalImpulse2;
-	FloatW tangentImpulse2;
-	FloatW normalMass2, tangentMass2;
-	FloatW restitution;
-	FloatW relativeVelocity1, relativeVelocity2;
+	I32 indexA[sizeof(Wide) / sizeof(F32)];
+	I32 indexB[sizeof(Wide) / sizeof(F32)];
+
+	Wide invMassA, invMassB;
+	Wide invIA, invIB;
+	Vector2T<Wide> normal;
+	Wide friction;
+	Wide biasRate;
+	Wide massScale;
+	Wide impulseScale;
+	Vector2T<Wide> anchorA1, anchorB1;
+	Wide normalMass1, tangentMass1;
+	Wide baseSeparation1;
+	Wide normalImpulse1;
+	Wide maxNormalImpulse1;
+	Wide tangentImpulse1;
+	Vector2T<Wide> anchorA2, anchorB2;
+	Wide baseSeparation2;
+	Wide normalImpulse2;
+	Wide maxNormalImpulse2;
+	Wide tangentImpulse2;
+	Wide normalMass2, tangentMass2;
+	Wide restitution;
+	Wide relativeVelocity1, relativeVelocity2;
 };
 
-struct SimdBody
+typedef ContactConstraintT<FloatW> ContactConstraintSIMD;
+
+template<class Wide>
+struct SimdBodyT
 {
-	Vector2W v;
-	FloatW w;
-	FloatW flags;
-	Vector2W dp;
-	Quaternion2W dq;
+	Vector2T<Wide> v;
+	Wide w;
+	Wide flags;
+	Vector2T<Wide> dp;
+	Quaternion2T<Wide> dq;
 };
 
+typedef SimdBodyT<FloatW> SimdBody;
+
 struct GraphColor
 {
 	// This bitset is indexed by bodyId so this is over-sized to encompass static bodies
@@ -778,7 +942,7 @@ struct ConstraintGraph
 	void AddContact(ContactSim& contactSim, Contact& contact);
 	void RemoveContact(I32 bodyIdA, I32 bodyIdB, I32 colorIndex, I32 localIndex);
 	I32 AssignJointColor(I32 bodyIdA, I32 bodyIdB, bool staticA, bool staticB);
-	void AddJoint(JointSim& jointSim, Joint& joint);
+	void AddJoint(const JointSim& jointSim, Joint& joint);
 	void RemoveJoint(I32 bodyIdA, I32 bodyIdB, I32 colorIndex, I32 localIndex);
 
 	// including overflow at the end
@@ -836,17 +1000,20 @@ struct StepContext
 	// shortcut to body sims from awake set
 	BodySim* sims;
 
+	// where this step's body move events start, earlier steps this frame are before it
+	I32 moveEventOffset;
+
 	// array of all shape ids for shapes that have enlarged AABBs
 	I32* enlargedShapes;
 	I32 enlargedShapeCount;
 
-	// Array of fast bodies that need continuous collision handling
+	// Array of fast bodies that need continuous collision handling, in sim order
 	I32* fastBodies;
-	I32_Atomic fastBodyCount; //_Atomic?
+	I32 fastBodyCount;
 
-	// Array of bullet bodies that need continuous collision handling
+	// Array of bullet bodies that need continuous collision handling, in sim order
 	I32* bulletBodies;
-	I32_Atomic bulletBodyCount; //_Atomic?
+	I32 bulletBodyCount;
 
 	// joint pointers for simplified parallel-for access.
 	JointSim** joints;
@@ -919,6 +1086,30 @@ struct IslandSim
 	I32 islandId;
 };
 
+// Where each island found by a split ends in IslandSplit's bodies, contacts and joints
+struct SplitComponent
+{
+	I32 bodyEnd;
+	I32 contactEnd;
+	I32 jointEnd;
+};
+
+// One island being split, the search fills this in as a job and the new islands are created from it afterwards.
+// The memory is kept between steps
+struct IslandSplit
+{
+	I32 baseId;
+
+	Vector<I32> seeds;
+	Vector<I32> stack;
+
+	// Grouped by the island they end up in, in the order they're linked
+	Vector<I32> bodies;
+	Vector<I32> contacts;
+	Vector<I32> joints;
+	Vector<SplitComponent> components;
+};
+
 struct SolverSet
 {
 	void Destroy();
@@ -947,11 +1138,23 @@ struct SolverSet
 	I32 setIndex;
 };
 
+struct MovePair
+{
+	I32 shapeIndexA;
+	I32 shapeIndexB;
+};
+
 struct TaskContext
 {
+	// Candidate pairs found by this worker during the broadphase, cleared every step but the memory is kept
+	Vector<MovePair> movePairs;
+
 	// These bits align with the b2ConstraintGraph::contactBlocks and signal a change in contact status
 	Bitset contactStateBitset;
 
+	// Touching contacts this worker kept the last manifold for instead of running the narrowphase
+	U32 reusedManifolds;
+
 	// Used to track bodies with shapes that have enlarged AABBs. This avoids having a bit array
 	// that is very large when there are many static shapes.
 	Bitset enlargedSimBitset;
@@ -959,27 +1162,39 @@ struct TaskContext
 	// Used to put islands to sleep
 	Bitset awakeIslandBitset;
 
-	// Per worker split island candidate
-	F32 splitSleepTime;
-	I32 splitIslandId;
-};
+	// Awake islands with a body that wants to sleep but removed constraints, they're split next step
+	Bitset splitIslandBitset;
 
-struct MovePair
-{
-	I32 shapeIndexA;
-	I32 shapeIndexB;
-	MovePair* next;
-	bool heap;
+	// Continuous collision for this worker's range of fast bodies, one context and swept box per shape
+	Vector<ContinuousContext> continuousContexts;
+	Vector<AABB> continuousBoxes;
+	Vector<PacketHit> continuousHits;
+
+	// Tree hits for this worker's packets of sensors
+	Vector<PacketHit> sensorHits;
+
+	// Idle static sensors this worker's packets of moved proxies reached, overflow means it ran out of room and every sensor counts as touched
+	Vector<I32> touchedSensors;
+	bool touchedOverflow;
+
+	// Tree hits for this worker's packets in Physics::QueryBatch
+	Vector<PacketHit> queryHits;
 };
 
+// Pairs found for one moved proxy, they sit contiguously in the finding worker's TaskContext::movePairs
 struct MoveResult
 {
-	MovePair* pairList;
+	U32 worker;
+	U32 pairStart;
+	U32 pairCount;
+	bool overflow;
 };
 
 struct QueryPairContext
 {
 	MoveResult* moveResult;
+	Vector<MovePair>* pairs;
+	bool canGrow;
 	BodyType queryTreeType;
 	I32 queryProxyKey;
 	I32 queryShapeIndex;
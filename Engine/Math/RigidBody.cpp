@@ -1,3 +1,7 @@
+#include "Defines.hpp"
+
+NH_STRICT_FLOAT
+
 #include "RigidBody.hpp"
 
 #include "Physics.hpp"
@@ -19,7 +23,7 @@ RigidBody2D::RigidBody2D(const RigidBody2DDef& def)
 	else
 	{
 		// new set for a sleeping body in its own island
-		setId = Physics::solverSetFreelist.GetFree();
+		setId = Physics::solverSetFreelist.GetFreeOrGrow();
 		if (setId == Physics::solverSets.Size())
 		{
 			// Create a zero initialized solver set. All sub-arrays are also zero initialized.
@@ -35,6 +39,7 @@ RigidBody2D::RigidBody2D(const RigidBody2DDef& def)
 	BodySim& bodySim = set.bodySims.Push({});
 	bodySim.transform.position = def.position;
 	bodySim.transform.rotation = def.rotation;
+	bodySim.previousTransform = bodySim.transform;
 	bodySim.center = def.position;
 	bodySim.rotation0 = bodySim.transform.rotation;
 	bodySim.center0 = bodySim.center;
@@ -314,14 +319,125 @@ I32 RigidBody2D::AddCollider(const ShapeDef& shapeDef, const ChainSegment& chain
 	return shape.id + 1;
 }
 
-void RigidBody2D::SetPosition(const Vector2& position)
+I32 RigidBody2D::AddChain(const ShapeDef& shapeDef, const Vector2* points, I32 count, bool loop)
 {
+	if (count < (loop ? 3 : 4)) { return 0; }
+
+	I32 chainId = Physics::chainFreelist.GetFreeOrGrow();
+	if (chainId == Physics::chains.Size()) { Physics::chains.Push({}); }
+
+	ChainShape& chain = Physics::chains[chainId];
+	chain.id = chainId;
+	chain.bodyId = id;
+	chain.nextChainId = headChainId;
+	chain.revision += 1;
+	headChainId = chainId;
+
+	// Open chains spend their first and last point on ghosts
+	chain.count = loop ? count : count - 3;
+	Memory::AllocateArray(&chain.shapeIndices, chain.count);
+
+	Transform2D& transform = Physics::solverSets[setIndex].bodySims[localIndex].transform;
+
+	ChainSegment chainSegment;
+	chainSegment.chainId = chainId;
+
+	for (I32 i = 0; i < chain.count; ++i)
+	{
+		I32 first = loop ? i : i + 1;
+
+		chainSegment.ghost1 = points[(first + count - 1) % count];
+		chainSegment.segment.point1 = points[first];
+		chainSegment.segment.point2 = points[(first + 1) % count];
+		chainSegment.ghost2 = points[(first + 2) % count];
 
+		Shape& shape = Physics::CreateChainSegmentShape(*this, transform, shapeDef, chainSegment);
+		chain.shapeIndices[i] = shape.id;
+	}
+
+	return chainId + 1;
 }
 
-void RigidBody2D::SetRotation(const Quaternion2& rotation)
+void RigidBody2D::DestroyChain(I32 chainId)
+{
+	ChainShape& chain = Physics::chains[--chainId];
+
+	// Unlink from the body's chain list
+	if (headChainId == chainId) { headChainId = chain.nextChainId; }
+	else
+	{
+		I32 previousId = headChainId;
+		while (Physics::chains[previousId].nextChainId != chainId) { previousId = Physics::chains[previousId].nextChainId; }
+		Physics::chains[previousId].nextChainId = chain.nextChainId;
+	}
+
+	for (I32 i = 0; i < chain.count; ++i)
+	{
+		Physics::DestroyShapeInternal(Physics::shapes[chain.shapeIndices[i]], *this, true);
+	}
+
+	Memory::Free(&chain.shapeIndices);
+	chain.shapeIndices = nullptr;
+	chain.count = 0;
+	chain.id = NullIndex;
+
+	Physics::chainFreelist.Release(chainId);
+}
+
+void RigidBody2D::SetTransform(const Vector2& position, const Quaternion2& rotation)
+{
+	BodySim& bodySim = Physics::solverSets[setIndex].bodySims[localIndex];
+
+	bodySim.transform.position = position;
+	bodySim.transform.rotation = rotation;
+	bodySim.center = position + bodySim.localCenter * rotation;
+
+	bodySim.rotation0 = rotation;
+	bodySim.center0 = bodySim.center;
+
+	// A teleport isn't motion, interpolating across it would smear the body between the two places
+	bodySim.previousTransform = bodySim.transform;
+
+	I32 shapeId = headShapeId;
+	while (shapeId != NullIndex)
+	{
+		Shape& shape = Physics::shapes[shapeId];
+
+		AABB aabb = shape.ComputeShapeAABB(bodySim.transform);
+		aabb.lowerBound.x -= SpeculativeDistance;
+		aabb.lowerBound.y -= SpeculativeDistance;
+		aabb.upperBound.x += SpeculativeDistance;
+		aabb.upperBound.y += SpeculativeDistance;
+		shape.aabb = aabb;
+
+		if (shape.fatAABB.Contains(aabb) == false)
+		{
+			AABB fatAABB;
+			fatAABB.lowerBound.x = aabb.lowerBound.x - AABBMargin;
+			fatAABB.lowerBound.y = aabb.lowerBound.y - AABBMargin;
+			fatAABB.upperBound.x = aabb.upperBound.x + AABBMargin;
+			fatAABB.upperBound.y = aabb.upperBound.y + AABBMargin;
+			shape.fatAABB = fatAABB;
+
+			// Disabled bodies have no proxies
+			if (shape.proxyKey != NullIndex) { Broadphase::MoveProxy(shape.proxyKey, fatAABB); }
+		}
+
+		// A teleported sensor can't reuse last step's answers, even on a static or sleeping body
+		if (shape.sensorIndex != NullIndex) { Physics::sensors[shape.sensorIndex].rebuild = true; }
+
+		shapeId = shape.nextShapeId;
+	}
+}
+
+void RigidBody2D::SetPosition(const Vector2& position)
 {
+	SetTransform(position, Physics::solverSets[setIndex].bodySims[localIndex].transform.rotation);
+}
 
+void RigidBody2D::SetRotation(const Quaternion2& rotation)
+{
+	SetTransform(Physics::solverSets[setIndex].bodySims[localIndex].transform.position, rotation);
 }
 
 void RigidBody2D::UpdateMassData()
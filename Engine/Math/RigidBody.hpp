@@ -94,6 +94,24 @@ struct NH_API RigidBody2D
 	I32 AddCollider(const ShapeDef& shapeDef, const Segment& segment);
 	I32 AddCollider(const ShapeDef& shapeDef, const ChainSegment& chainSegment);
 
+	/// <summary>
+	/// Adds a chain of one-sided segments, collision is on the right of each segment so a counter-clockwise loop collides on the outside
+	/// </summary>
+	/// <param name="points:">The chain's vertices in local space, for open chains the first and last points are only ghost vertices that smooth the ends</param>
+	/// <param name="count:">At least 3 points for a loop, 4 for an open chain</param>
+	/// <param name="loop:">Connects the last point back to the first</param>
+	/// <returns>The chain's id, 0 if there weren't enough points</returns>
+	I32 AddChain(const ShapeDef& shapeDef, const Vector2* points, I32 count, bool loop);
+
+	/// <summary>
+	/// Destroys a chain and its segments, touching bodies are woken
+	/// </summary>
+	void DestroyChain(I32 chainId);
+
+	/// <summary>
+	/// Teleports the body, its shapes' bounds are refit and it won't interpolate from where it was
+	/// </summary>
+	void SetTransform(const Vector2& position, const Quaternion2& rotation);
 	void SetPosition(const Vector2& position);
 	void SetRotation(const Quaternion2& rotation);
 
@@ -131,4 +149,5 @@ private:
 
 	friend class Physics;
 	friend struct ConstraintGraph;
+	friend struct PhysicsTests;
 };
\ No newline at end of file
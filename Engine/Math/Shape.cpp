@@ -1,3 +1,7 @@
+#include "Defines.hpp"
+
+NH_STRICT_FLOAT
+
 #include "Shape.hpp"
 
 #include "PhysicsDefines.hpp"
@@ -55,33 +59,12 @@ Shape::Shape(const ShapeDef& def)
 	enablePreSolveEvents = def.enablePreSolveEvents;
 	isFast = false;
 	proxyKey = NullIndex;
+	sensorIndex = NullIndex;
 	localCentroid = GetShapeCentroid();
 	aabb = { Vector2Zero, Vector2Zero };
 	fatAABB = { Vector2Zero, Vector2Zero };
 }
 
-Shape::Shape(const Shape& other)
-{
-
-}
-
-Shape::Shape(Shape&& other) noexcept
-{
-
-}
-
-Shape& Shape::operator=(const Shape& other)
-{
-
-	return *this;
-}
-
-Shape& Shape::operator=(Shape&& other) noexcept
-{
-
-	return *this;
-}
-
 AABB Shape::ComputeShapeAABB(const Transform2D& transform)
 {
 	switch (type)
@@ -125,6 +125,11 @@ struct AABB
 		return (wx + wy) * 2.0f;
 	}
 
+	bool Overlaps(const AABB& aabb) const
+	{
+		return lowerBound.x <= aabb.upperBound.x && lowerBound.y <= aabb.upperBound.y && aabb.lowerBound.x <= upperBound.x && aabb.lowerBound.y <= upperBound.y;
+	}
+
 	bool Contains(const AABB& aabb) const
 	{
 		bool result = true;
@@ -180,7 +185,7 @@ struct ShapeDef
 	/// Normally shapes on static bodies don't invoke contact creation when they are added to the world. This overrides
 	///	that behavior and causes contact creation. This significantly slows down static body creation which can be important
 	///	when there are many static shapes.
-	/// This is implicitly always true for sensors.
+	/// Sensors never create contacts, their overlaps are found by the sensor pass.
 	bool forceContactCreation = false;
 };
 
@@ -190,11 +195,11 @@ struct Shape
 {
 	Shape(const ShapeDef& def);
 
-	Shape(const Shape&);
-	Shape(Shape&&) noexcept;
+	Shape(const Shape&) = default;
+	Shape(Shape&&) noexcept = default;
 
-	Shape& operator=(const Shape&);
-	Shape& operator=(Shape&&) noexcept;
+	Shape& operator=(const Shape&) = default;
+	Shape& operator=(Shape&&) noexcept = default;
 
 	Vector2 GetShapeCentroid();
 	void UpdateShapeAABBs(const Transform2D& transform, BodyType proxyType);
@@ -218,6 +223,7 @@ struct Shape
 	AABB fatAABB;
 	Vector2 localCentroid;
 	I32 proxyKey;
+	I32 sensorIndex;
 
 	Filter filter;
 	void* userData;
@@ -0,0 +1,156 @@
+#include "CpuFeatures.hpp"
+
+// This file is compiled without /arch (see Nihility.vcxproj) so the check runs on any x64 CPU before anything built for AVX does
+#if defined NH_PLATFORM_WINDOWS
+#include <Windows.h>
+#else
+#include <stdio.h>
+#endif
+
+#if defined NH_CPU_X86_X64 && !defined NH_COMPILER_MSVC
+#include <cpuid.h>
+#endif
+
+#if defined NH_CPU_ARM && defined NH_PLATFORM_LINUX
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+bool CpuFeatures::Has(CpuFeature feature) { return (Features() & feature) == (U32)feature; }
+
+// Function statics instead of members so kernels that pick an implementation during static init still see the real features
+U32 CpuFeatures::Features()
+{
+	static const U32 features = Detect();
+	return features;
+}
+
+ISAAvailability CpuFeatures::Isa()
+{
+	static const ISAAvailability isa = DetectIsa();
+	return isa;
+}
+
+#if defined NH_CPU_X86_X64
+static void CpuId(U32 leaf, U32 subleaf, U32 (&registers)[4])
+{
+#if defined NH_COMPILER_MSVC
+	__cpuidex((int*)registers, (int)leaf, (int)subleaf);
+#else
+	__cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+}
+
+// Which register sets the OS saves on a context switch, bit 1 SSE, 2 AVX, 5-7 AVX-512
+static U64 XGetBv()
+{
+#if defined NH_COMPILER_MSVC
+	return _xgetbv(0);
+#else
+	U32 low, high;
+	__asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+	return ((U64)high << 32) | low;
+#endif
+}
+#endif
+
+U32 CpuFeatures::Detect()
+{
+	U32 detected = 0;
+
+#if defined NH_CPU_X86_X64
+	U32 registers[4];
+
+	CpuId(0, 0, registers);
+	U32 maxLeaf = registers[0];
+
+	CpuId(1, 0, registers);
+	U32 ecx1 = registers[2];
+	U32 edx1 = registers[3];
+
+	if (edx1 & (1 << 26)) { detected |= CPU_FEATURE_SSE2; }
+	if (ecx1 & (1 << 20)) { detected |= CPU_FEATURE_SSE42; }
+
+	// The CPU supporting AVX isn't enough, the OS also has to save the wider registers
+	bool osxsave = ecx1 & (1 << 27);
+	U64 xcr0 = osxsave ? XGetBv() : 0;
+	bool osAvx = (xcr0 & 0x06) == 0x06;
+	bool osAvx512 = (xcr0 & 0xE6) == 0xE6;
+
+	if (osAvx && (ecx1 & (1 << 28))) { detected |= CPU_FEATURE_AVX; }
+	if (osAvx && (ecx1 & (1 << 12))) { detected |= CPU_FEATURE_FMA; }
+
+	if (maxLeaf >= 7)
+	{
+		CpuId(7, 0, registers);
+		U32 ebx7 = registers[1];
+
+		if (osAvx && (ebx7 & (1 << 5))) { detected |= CPU_FEATURE_AVX2; }
+		if (osAvx512 && (ebx7 & (1 << 16))) { detected |= CPU_FEATURE_AVX512; }
+	}
+#elif defined NH_CPU_ARM
+#	if defined _M_ARM64 || defined __aarch64__
+	// Advanced SIMD is mandatory on AArch64
+	detected |= CPU_FEATURE_NEON;
+#	elif defined NH_PLATFORM_LINUX
+	if (getauxval(AT_HWCAP) & HWCAP_NEON) { detected |= CPU_FEATURE_NEON; }
+#	elif defined NH_PLATFORM_WINDOWS
+	// Windows on ARM requires NEON
+	detected |= CPU_FEATURE_NEON;
+#	endif
+#endif
+
+	return detected;
+}
+
+ISAAvailability CpuFeatures::DetectIsa()
+{
+#if defined NH_CPU_X86_X64
+	U32 features = Features();
+
+	if ((features & (CPU_FEATURE_AVX512 | CPU_FEATURE_AVX2)) == (CPU_FEATURE_AVX512 | CPU_FEATURE_AVX2)) { return ISA_AVAILABLE_AVX512; }
+	if ((features & (CPU_FEATURE_AVX2 | CPU_FEATURE_FMA)) == (CPU_FEATURE_AVX2 | CPU_FEATURE_FMA)) { return ISA_AVAILABLE_AVX2; }
+	if (features & CPU_FEATURE_AVX) { return ISA_AVAILABLE_AVX; }
+	if (features & CPU_FEATURE_SSE42) { return ISA_AVAILABLE_SSE42; }
+	if (features & CPU_FEATURE_SSE2) { return ISA_AVAILABLE_SSE2; }
+	return ISA_AVAILABLE_X86;
+#elif defined _M_ARM64 || defined __aarch64__
+	return ISA_AVAILABLE_NEON_ARM64;
+#else
+	return Has(CPU_FEATURE_NEON) ? ISA_AVAILABLE_NEON : ISA_AVAILABLE_ARMNT;
+#endif
+}
+
+const C8* CpuFeatures::IsaName()
+{
+#if defined NH_CPU_X86_X64
+	switch (Isa())
+	{
+	case ISA_AVAILABLE_AVX512: return "AVX-512";
+	case ISA_AVAILABLE_AVX2: return "AVX2";
+	case ISA_AVAILABLE_AVX: return "AVX";
+	case ISA_AVAILABLE_SSE42: return "SSE4.2";
+	case ISA_AVAILABLE_SSE2: return "SSE2";
+	default: return "x86";
+	}
+#else
+	switch (Isa())
+	{
+	case ISA_AVAILABLE_NEON_ARM64: return "NEON (ARM64)";
+	case ISA_AVAILABLE_NEON: return "NEON";
+	default: return "ARM";
+	}
+#endif
+}
+
+void CpuFeatures::ReportUnsupportedSimd()
+{
+	static constexpr const C8* Message = "This CPU Doesn't Support The Instruction Set The Engine Was Built For!";
+
+#if defined NH_PLATFORM_WINDOWS
+	MessageBoxA(nullptr, Message, "Error", MB_ICONERROR | MB_OK);
+#else
+	fputs(Message, stderr);
+	fputc('\n', stderr);
+#endif
+}
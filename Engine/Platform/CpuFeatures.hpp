@@ -0,0 +1,65 @@
+#pragma once
+
+#include "Defines.hpp"
+
+/// <summary>
+/// Instruction set extensions the processor and OS both support
+/// </summary>
+enum NH_API CpuFeature
+{
+	CPU_FEATURE_SSE2 = 0x01,
+	CPU_FEATURE_SSE42 = 0x02,
+	CPU_FEATURE_AVX = 0x04,		// Includes OS support for saving the YMM registers
+	CPU_FEATURE_FMA = 0x08,
+	CPU_FEATURE_AVX2 = 0x10,
+	CPU_FEATURE_AVX512 = 0x20,	// AVX-512 Foundation, includes OS support for saving the ZMM registers
+	CPU_FEATURE_NEON = 0x40,
+};
+
+/*
+* Detects the instruction sets the processor supports once at startup, cpuid/xgetbv on x86 and getauxval on ARM Linux
+* Hot kernels use this to pick an implementation at runtime so one binary can use AVX2/AVX-512 without requiring them,
+* FloatW is still chosen at compile time by NH_SIMD_WIDTH but 4 wide builds solve contacts on FloatPairW when the CPU has AVX2
+*/
+class NH_API CpuFeatures
+{
+public:
+	static bool Has(CpuFeature feature);
+
+	/// <summary>
+	/// The best instruction set level available, uses the same levels as the CRT's __isa_available
+	/// </summary>
+	static ISAAvailability Isa();
+	static const C8* IsaName();
+
+	/// <summary>
+	/// Checks the instruction set the caller was compiled for (NH_SIMD_AVX, NH_SIMD_AVX2...) can run on this processor,
+	/// it's inline so the macros are the caller's while the detection itself lives in CpuFeatures.cpp, which is built without /arch
+	/// </summary>
+	static bool SupportsCompiledSimd()
+	{
+#if defined NH_SIMD_AVX2
+		return Has(CPU_FEATURE_AVX2);
+#elif defined NH_SIMD_AVX
+		return Has(CPU_FEATURE_AVX);
+#elif defined NH_SIMD_NEON
+		return Has(CPU_FEATURE_NEON);
+#elif defined NH_SIMD_SSE2 && defined NH_CPU_X86_X64
+		return Has(CPU_FEATURE_SSE2);
+#else
+		return true;
+#endif
+	}
+
+	/// <summary>
+	/// Tells the user their CPU is too old without Memory or the Logger, nothing else is initialized when SupportsCompiledSimd fails
+	/// </summary>
+	static void ReportUnsupportedSimd();
+
+private:
+	static U32 Features();
+	static U32 Detect();
+	static ISAAvailability DetectIsa();
+
+	STATIC_CLASS(CpuFeatures);
+};
@@ -3,12 +3,17 @@
 #include "ThreadSafety.hpp"
 
 #include "Core\Logger.hpp"
+#include "Core\Profiler.hpp"
+#include "Memory\Memory.hpp"
 
-#include <xthreads.h>
-
-#ifdef NH_PLATFORM_WINDOWS
+#if defined NH_PLATFORM_WINDOWS
 #include <Windows.h>
 #include <process.h>
+#elif defined NH_PLATFORM_LINUX
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <errno.h>
 #endif
 
 #ifdef NH_PLATFORM_WINDOWS
@@ -19,82 +24,129 @@ static U32(__stdcall* NtDelayExecution)(BOOL Alertable, PLARGE_INTEGER DelayInte
 bool Jobs::running = false;
 U64 Jobs::threadCount = 1;
 U64 Jobs::activeJobCount = 0;
-Semaphore Jobs::semaphore;
-JobQueue Jobs::jobQueues[JOB_PRIORITY_COUNT];
+std::atomic<U32> Jobs::parkedCount{ 0 };
+std::atomic<U32> Jobs::wakeCursor{ 0 };
+JobWorker* Jobs::workers = nullptr;
+CpuTopology Jobs::topology;
+JobPool Jobs::injectionPool;
+SafeQueue<Job*, MaxInjectedJobs> Jobs::injectionQueues[JOB_PRIORITY_COUNT];
+JobCounter Jobs::counters[MaxJobCounters];
+std::atomic<U32> Jobs::nextCounter{ 0 };
 #ifdef NH_PLATFORM_WINDOWS
 UL32 Jobs::sleepRes;
 #endif
 
-bool Jobs::Initialize()
+static thread_local U32 currentWorker = U32_MAX;
+
+static constexpr const C8* JobZoneNames[JOB_PRIORITY_COUNT]{ "Job (Low)", "Job (Medium)", "Job (High)" };
+static constexpr const C8* QueueDepthNames[JOB_PRIORITY_COUNT]{ "Queue Depth (Low)", "Queue Depth (Medium)", "Queue Depth (High)" };
+static constexpr const C8* InjectionDepthNames[JOB_PRIORITY_COUNT]{ "Injection Depth (Low)", "Injection Depth (Medium)", "Injection Depth (High)" };
+
+struct ParallelForContext
+{
+	alignas(CacheLineSize) std::atomic<U32> next;
+	U32 end;
+	U32 minBatch;
+	U32 divisor;
+	const Function<void(U32, U32)>* body;
+};
+
+static bool ClaimBatch(ParallelForContext& context, U32& start, U32& end)
 {
-	UL32 processorCount = GetActiveProcessorCount(ALL_PROCESSOR_GROUPS);
-	U32 hardwareConcurrency = _Thrd_hardware_concurrency();
+	U32 current = context.next.load(std::memory_order_relaxed);
 
+	while (current < context.end)
+	{
+		U32 remaining = context.end - current;
+		U32 size = remaining / context.divisor;
+		if (size < context.minBatch) { size = context.minBatch; }
+		if (size > remaining) { size = remaining; }
+
+		if (context.next.compare_exchange_weak(current, current + size, std::memory_order_relaxed))
+		{
+			start = current;
+			end = current + size;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void RunBatches(ParallelForContext& context)
+{
+	U32 start, end;
+	while (ClaimBatch(context, start, end)) { (*context.body)(start, end); }
+}
+
+bool Jobs::Initialize(JobAffinity affinity)
+{
 	Logger::Trace("Initializing Jobs...");
 
+#if defined NH_PLATFORM_WINDOWS
 	ZwSetTimerResolution(1, true, &sleepRes);
+#endif
 
-	SYSTEM_INFO sysInfo;
-	GetSystemInfo(&sysInfo);
-	threadCount = sysInfo.dwNumberOfProcessors;
+	if (!topology.Detect()) { Logger::Warn("Failed To Read CPU Topology, Assuming One Thread Per Core"); }
 
-	running = true;
+	Vector<LogicalProcessor> selected;
+	topology.Select(affinity, selected);
 
-	if (processorCount > 64 && hardwareConcurrency < processorCount && hardwareConcurrency < threadCount)
+	threadCount = selected.Size();
+
+	Memory::AllocateArray(&workers, threadCount);
+	for (U32 i = 0; i < threadCount; ++i)
 	{
-		U16 groupCount = GetActiveProcessorGroupCount();
+		Construct(workers + i);
+		workers[i].processor = selected[i];
+		workers[i].randomState = 0x9E3779B97F4A7C15ull * (i + 1);
+	}
 
-		GROUP_AFFINITY mainThreadAffinity;
-		if (!GetThreadGroupAffinity(GetCurrentThread(), &mainThreadAffinity)) { return false; }
+	currentWorker = 0;
+	running = true;
+
+	// The main thread is worker 0 and is left unpinned, the rest are pinned before they start running
+	const bool pin = affinity != JOB_AFFINITY_NONE;
 
-		U16 mainGroup = mainThreadAffinity.Group;
-		UL32 activeProcessorCount = GetActiveProcessorCount(mainGroup);
+	for (U32 i = 1; i < threadCount; ++i)
+	{
+#if defined NH_PLATFORM_WINDOWS
+		HANDLE handle = (HANDLE)_beginthreadex(nullptr, 0, RunThread, (void*)(U64)i, CREATE_SUSPENDED, nullptr);
+		if (handle == nullptr) { return false; }
 
-		U32 group = 0;
-		while (activeProcessorCount < threadCount)
+		if (pin)
 		{
-			++group;
-			U32 currGroup = (group + mainGroup) % groupCount;
-			U32 groupNumLogicalProcessors = GetActiveProcessorCount((WORD)currGroup);
-			U64 GROUPMASK = U64_MAX >> (64 - groupNumLogicalProcessors);
-			for (U32 groupLogicalProcess = 0; (groupLogicalProcess < groupNumLogicalProcessors) && (activeProcessorCount < threadCount); ++groupLogicalProcess, ++activeProcessorCount)
-			{
-				if (activeProcessorCount > 1)
-				{
-					U32 address;
-					HANDLE handle = (HANDLE)_beginthreadex(nullptr, 0, RunThread, nullptr, 0, &address);
-					UL32 affinityMask = 1ull << address;
-					U64 affinityResult = SetThreadAffinityMask(handle, affinityMask);
-					//BOOL priorityResult = SetThreadPriority(handle, THREAD_PRIORITY_HIGHEST);
-
-					GROUP_AFFINITY threadAffinity;
-					GetThreadGroupAffinity(handle, &threadAffinity);
-
-					if (threadAffinity.Group != currGroup)
-					{
-						threadAffinity.Group = (WORD)currGroup;
-						threadAffinity.Mask = GROUPMASK;
-						SetThreadGroupAffinity(handle, &threadAffinity, nullptr);
-					}
-
-					CloseHandle(handle);
-				}
-			}
+			GROUP_AFFINITY groupAffinity{};
+			groupAffinity.Group = selected[i].group;
+			groupAffinity.Mask = 1ull << selected[i].id;
+			SetThreadGroupAffinity(handle, &groupAffinity, nullptr);
 		}
-	}
-	else
-	{
-		for (U32 i = 1; i < threadCount; ++i)
+
+		ResumeThread(handle);
+		CloseHandle(handle);
+#elif defined NH_PLATFORM_LINUX
+		pthread_attr_t attributes;
+		pthread_attr_init(&attributes);
+		pthread_attr_setdetachstate(&attributes, PTHREAD_CREATE_DETACHED);
+
+		if (pin)
 		{
-			U32 address;
-			HANDLE handle = (HANDLE)_beginthreadex(nullptr, 0, RunThread, nullptr, 0, &address);
-			UL32 affinityMask = 1ull << address;
-			U64 affinityResult = SetThreadAffinityMask(handle, affinityMask);
-			//BOOL priorityResult = SetThreadPriority(handle, THREAD_PRIORITY_HIGHEST);
-			CloseHandle(handle);
+			cpu_set_t set;
+			CPU_ZERO(&set);
+			CPU_SET(selected[i].id, &set);
+			pthread_attr_setaffinity_np(&attributes, sizeof(cpu_set_t), &set);
 		}
+
+		pthread_t thread;
+		I32 result = pthread_create(&thread, &attributes, RunThread, (void*)(U64)i);
+		pthread_attr_destroy(&attributes);
+
+		if (result != 0) { return false; }
+#endif
 	}
 
+	selected.Destroy();
+
 	return true;
 }
 
@@ -102,31 +154,42 @@ void Jobs::Shutdown()
 {
 	Logger::Trace("Shutting Down Jobs...");
 
-	semaphore.Destroy();
-
 	running = false;
+
+	for (U64 i = 0; i < threadCount; ++i)
+	{
+		if (workers[i].parker.Unpark()) { parkedCount.fetch_sub(1, std::memory_order_relaxed); }
+	}
 }
 
-void Jobs::Excecute(const Function<void()>& job, JobPriority priority)
+JobHandle Jobs::Excecute(const Function<void()>& job, JobPriority priority)
 {
-	SafeIncrement(&activeJobCount);
+	JobCounter* counter = AcquireCounter(1);
+	JobHandle handle = MakeHandle(counter);
 
-	while (!jobQueues[priority].jobs.Push(job)) { Poll(); }
+	Job* newJob = AllocateJob();
+	newJob->function = job;
+	newJob->counter = counter;
 
-	semaphore.Signal();
+	Submit(newJob, priority);
+
+	return handle;
 }
 
-bool Jobs::Dispatch(U32 jobCount, U32 groupSize, const Function<void(DispatchArgs)>& job, JobPriority priority)
+JobHandle Jobs::Dispatch(U32 jobCount, U32 groupSize, const Function<void(DispatchArgs)>& job, JobPriority priority)
 {
-	if (jobCount == 0 || groupSize == 0) { return false; }
+	if (jobCount == 0 || groupSize == 0) { return {}; }
 
 	const U32 groupCount = (jobCount + groupSize - 1) / groupSize;
 
-	SafeAdd(&jobCount, groupCount);
+	JobCounter* counter = AcquireCounter(groupCount);
+	JobHandle handle = MakeHandle(counter);
 
 	for (U32 groupIndex = 0; groupIndex < groupCount; ++groupIndex)
 	{
-		const auto& jobGroup = [jobCount, groupSize, job, groupIndex]() {
+		Job* newJob = AllocateJob();
+		newJob->counter = counter;
+		newJob->function = [jobCount, groupSize, job, groupIndex]() {
 
 			const U32 groupJobOffset = groupIndex * groupSize;
 			U32 end = groupJobOffset + groupSize;
@@ -142,75 +205,513 @@ bool Jobs::Dispatch(U32 jobCount, U32 groupSize, const Function<void(DispatchArg
 			}
 		};
 
-		while (!jobQueues[priority].jobs.Push(jobGroup)) { Poll(); }
+		Submit(newJob, priority);
+	}
+
+	return handle;
+}
+
+void Jobs::ParallelFor(U32 begin, U32 end, U32 minBatch, const Function<void(U32, U32)>& body, JobPriority priority)
+{
+	if (end <= begin) { return; }
+	if (minBatch == 0) { minBatch = 1; }
+
+	const U32 batchCount = (end - begin + minBatch - 1) / minBatch;
+	const U32 helperCount = batchCount - 1 < threadCount - 1 ? batchCount - 1 : (U32)threadCount - 1;
+
+	if (helperCount == 0) { body(begin, end); return; }
 
-		semaphore.Signal();
+	// Lives on this stack, every helper finishes before we return
+	ParallelForContext context;
+	context.next.store(begin, std::memory_order_relaxed);
+	context.end = end;
+	context.minBatch = minBatch;
+	context.divisor = (helperCount + 1) * 2;
+	context.body = &body;
+
+	JobCounter* counter = AcquireCounter(helperCount);
+	JobHandle handle = MakeHandle(counter);
+
+	// One job per helper thread rather than per batch, each claims batches until the range runs out
+	for (U32 i = 0; i < helperCount; ++i)
+	{
+		Job* job = AllocateJob();
+		job->counter = counter;
+		job->function = [&context]() { RunBatches(context); };
+
+		Submit(job, priority);
 	}
 
-	return true;
+	RunBatches(context);
+
+	WaitFor(handle);
+}
+
+JobHandle Jobs::Then(const JobHandle& handle, const Function<void()>& job, JobPriority priority)
+{
+	JobCounter* counter = AcquireCounter(1);
+	JobHandle result = MakeHandle(counter);
+
+	Job* newJob = AllocateJob();
+	newJob->function = job;
+	newJob->counter = counter;
+	newJob->priority = priority;
+
+	if (JobCounter* dependency = handle.counter)
+	{
+		LockGuard lock(dependency->lock);
+
+		if (dependency->generation.load(std::memory_order_acquire) == handle.generation)
+		{
+			// Still running, the job is submitted when the dependency completes
+			SafeIncrement(&activeJobCount);
+			newJob->next = dependency->continuations;
+			dependency->continuations = newJob;
+			return result;
+		}
+	}
+
+	Submit(newJob, priority);
+
+	return result;
+}
+
+void Jobs::WaitFor(const JobHandle& handle)
+{
+	if (handle.Done()) { return; }
+
+	PROFILE_ZONE("Wait");
+
+	Backoff backoff;
+
+	while (!handle.Done())
+	{
+		if (Job* job = FindJob(currentWorker)) { RunJob(job); backoff.Reset(); continue; }
+
+		// With no workers to finish the job we can't sleep
+		if (!backoff.ShouldPark() || threadCount == 1) { backoff.Pause(); continue; }
+
+		// Nothing left to help with, sleep until the counter completes
+		JobCounter* counter = handle.counter;
+		counter->waiters.fetch_add(1, std::memory_order_seq_cst);
+
+		if (counter->generation.load(std::memory_order_seq_cst) == handle.generation)
+		{
+			ThreadSafety::WaitOnValue(counter->generation, handle.generation);
+		}
+
+		counter->waiters.fetch_sub(1, std::memory_order_relaxed);
+	}
 }
 
 void Jobs::Wait(JobPriority minPriority)
 {
+	Backoff backoff;
+
 	while (activeJobCount)
 	{
-		Poll();
+		if (Job* job = FindJob(currentWorker)) { RunJob(job); backoff.Reset(); }
+		else { backoff.Pause(); }
 	}
 }
 
 void Jobs::Poll()
 {
-	semaphore.Signal();
-	YieldThread();
+	Job* job = FindJob(currentWorker);
+
+	if (job) { RunJob(job); }
+	else { YieldThread(); }
+}
+
+Job* Jobs::AllocateJob()
+{
+	Job* job = AllocateJob(currentWorker < threadCount ? workers[currentWorker].pool : injectionPool);
+	job->counter = nullptr;
+	job->next = nullptr;
+	job->priority = JOB_PRIORITY_MEDIUM;
+
+	return job;
+}
+
+Job* Jobs::AllocateJob(JobPool& pool)
+{
+	while (true)
+	{
+		Job* job = pool.jobs + (pool.next.fetch_add(1, std::memory_order_relaxed) & (MaxJobsPerWorker - 1));
+
+		bool expected = false;
+		if (job->active.compare_exchange_strong(expected, true, std::memory_order_acquire)) { return job; }
+
+		// Every slot in the ring is still in flight, help drain it before trying again
+		Poll();
+	}
+}
+
+JobCounter* Jobs::AcquireCounter(U32 count)
+{
+	while (true)
+	{
+		JobCounter* counter = counters + (nextCounter.fetch_add(1, std::memory_order_relaxed) & (MaxJobCounters - 1));
+
+		bool expected = false;
+		if (counter->active.compare_exchange_strong(expected, true, std::memory_order_acquire))
+		{
+			counter->continuations = nullptr;
+			counter->remaining.store(count, std::memory_order_release);
+			return counter;
+		}
+
+		Poll();
+	}
+}
+
+JobHandle Jobs::MakeHandle(JobCounter* counter)
+{
+	JobHandle handle;
+	handle.counter = counter;
+	handle.generation = counter->generation.load(std::memory_order_acquire);
+
+	return handle;
+}
+
+void Jobs::Submit(Job* job, JobPriority priority)
+{
+	SafeIncrement(&activeJobCount);
+	job->priority = priority;
+
+	Push(job, priority);
+}
+
+void Jobs::Push(Job* job, JobPriority priority)
+{
+	if (currentWorker < threadCount && workers[currentWorker].queues[priority].jobs.Push(job))
+	{
+		PROFILE_COUNTER(QueueDepthNames[priority], workers[currentWorker].queues[priority].jobs.Size());
+	}
+	else
+	{
+		while (!injectionQueues[priority].Push(job))
+		{
+			// Injection queue is saturated, just run the job here
+			if (currentWorker < threadCount) { RunJob(job); return; }
+
+			Poll();
+		}
+
+		PROFILE_COUNTER(InjectionDepthNames[priority], injectionQueues[priority].Size());
+	}
+
+	Notify();
+}
+
+void Jobs::Notify()
+{
+	// Pairs with the fetch_add in RunThread, either we see the parked worker or it sees the job
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	if (parkedCount.load(std::memory_order_relaxed) == 0) { return; }
+
+	// Rotate the starting point so the same worker isn't always the one woken
+	U64 start = wakeCursor.fetch_add(1, std::memory_order_relaxed);
+
+	for (U64 i = 0; i < threadCount; ++i)
+	{
+		if (workers[(start + i) % threadCount].parker.Unpark())
+		{
+			parkedCount.fetch_sub(1, std::memory_order_relaxed);
+			return;
+		}
+	}
+}
+
+Job* Jobs::FindJob(U32 workerIndex)
+{
+	Job* job = nullptr;
+
+	for (I32 priority = JOB_PRIORITY_COUNT - 1; priority >= 0; --priority)
+	{
+		if (workerIndex < threadCount && workers[workerIndex].queues[priority].jobs.Pop(job))
+		{
+			PROFILE_COUNTER(QueueDepthNames[priority], workers[workerIndex].queues[priority].jobs.Size());
+			return job;
+		}
+
+		if (injectionQueues[priority].Pop(job)) { return job; }
+
+		if (workers == nullptr) { continue; }
+
+		// Start at a random victim so thieves don't all hammer the same deque
+		U64 start = 0;
+		if (workerIndex < threadCount)
+		{
+			U64& state = workers[workerIndex].randomState;
+			state ^= state << 13;
+			state ^= state >> 7;
+			state ^= state << 17;
+			start = state;
+		}
+
+		// Steal from workers sharing our cache first, pulling work across domains (ex. Zen CCXs) is much more expensive
+		U32 domain = workerIndex < threadCount ? workers[workerIndex].processor.cache : U32_MAX;
+
+		for (U32 pass = 0; pass < 2; ++pass)
+		{
+			for (U64 i = 0; i < threadCount; ++i)
+			{
+				U64 victim = (start + i) % threadCount;
+				if (victim == workerIndex || (workers[victim].processor.cache == domain) != (pass == 0)) { continue; }
+
+				if (workers[victim].queues[priority].jobs.Steal(job))
+				{
+					PROFILE_INSTANT("Steal");
+					return job;
+				}
+			}
+		}
+	}
+
+	return nullptr;
+}
+
+void Jobs::RunJob(Job* job)
+{
+	PROFILE_BEGIN(JobZoneNames[job->priority]);
+	job->function();
+	PROFILE_END();
+
+	JobCounter* counter = job->counter;
+
+	job->function = nullptr;
+	job->active.store(false, std::memory_order_release);
+
+	if (counter && counter->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		Job* continuation;
+
+		{
+			LockGuard lock(counter->lock);
+			continuation = counter->continuations;
+			counter->continuations = nullptr;
+			counter->generation.fetch_add(1, std::memory_order_seq_cst);
+		}
+
+		if (counter->waiters.load(std::memory_order_seq_cst)) { ThreadSafety::WakeAll(counter->generation); }
+
+		counter->active.store(false, std::memory_order_release);
+
+		// Continuations were already counted as active when they were deferred
+		while (continuation)
+		{
+			Job* next = continuation->next;
+			continuation->next = nullptr;
+			Push(continuation, continuation->priority);
+			continuation = next;
+		}
+	}
+
+	SafeDecrement(&activeJobCount);
 }
 
+bool JobHandle::Done() const
+{
+	return counter == nullptr || counter->generation.load(std::memory_order_acquire) != generation;
+}
+
+JobGraph::JobGraph() {}
+
+JobGraph::~JobGraph() { Destroy(); }
+
+void JobGraph::Destroy()
+{
+	nodes.Destroy();
+	pending.Destroy();
+	counter = nullptr;
+}
+
+void JobGraph::Clear()
+{
+	nodes.Clear();
+	pending.Clear();
+	counter = nullptr;
+}
+
+U32 JobGraph::AddNode(const Function<void()>& function, JobPriority priority)
+{
+	Node node{};
+	node.function = function;
+	node.priority = priority;
+
+	nodes.Push(Move(node));
+
+	return (U32)nodes.Size() - 1;
+}
+
+void JobGraph::AddDependency(U32 before, U32 after)
+{
+	nodes[before].successors.Push(after);
+	++nodes[after].dependencyCount;
+}
+
+bool JobGraph::Validate()
+{
+	// Kahn's algorithm, pending doubles as the in-degrees and the visited order as the queue
+	U32 nodeCount = (U32)nodes.Size();
+
+	pending.Resize(nodeCount);
+	Vector<U32> order(nodeCount);
+
+	for (U32 i = 0; i < nodeCount; ++i)
+	{
+		pending[i] = nodes[i].dependencyCount;
+		if (pending[i] == 0) { order.Push(i); }
+	}
+
+	for (U32 i = 0; i < order.Size(); ++i)
+	{
+		for (U32 successor : nodes[order[i]].successors)
+		{
+			if (--pending[successor] == 0) { order.Push(successor); }
+		}
+	}
+
+	return order.Size() == nodeCount;
+}
+
+JobHandle JobGraph::Execute()
+{
+	if (nodes.Size() == 0) { return {}; }
+
+	// A node on a cycle never runs and the handle would never complete
+	if (!Validate()) { Logger::Error("JobGraph Has A Dependency Cycle, Not Running It!"); return {}; }
+
+	counter = Jobs::AcquireCounter((U32)nodes.Size());
+	JobHandle handle = Jobs::MakeHandle(counter);
+
+	pending.Resize(nodes.Size());
+
+	for (U32 i = 0; i < nodes.Size(); ++i)
+	{
+		pending[i] = nodes[i].dependencyCount;
+	}
+
+	for (U32 i = 0; i < nodes.Size(); ++i)
+	{
+		if (nodes[i].dependencyCount == 0) { RunNode(i); }
+	}
+
+	return handle;
+}
+
+void JobGraph::RunNode(U32 index)
+{
+	Job* job = Jobs::AllocateJob();
+	job->counter = counter;
+	job->function = [this, index]() {
+		nodes[index].function();
+
+		for (U32 successor : nodes[index].successors)
+		{
+			if (SafeDecrement(pending.Data() + successor) == 0) { RunNode(successor); }
+		}
+	};
+
+	Jobs::Submit(job, nodes[index].priority);
+}
+
+U32 Jobs::WorkerCount() { return (U32)threadCount; }
+
+U32 Jobs::CurrentWorker() { return currentWorker; }
+
+U32 Jobs::CacheDomain(U32 worker) { return worker < threadCount ? workers[worker].processor.cache : 0; }
+
+const CpuTopology& Jobs::Topology() { return topology; }
+
 void Jobs::SleepForSeconds(U64 s)
 {
+#if defined NH_PLATFORM_WINDOWS
 	LARGE_INTEGER interval;
 	interval.QuadPart = -(I64)(s * 10000000);
 	NtDelayExecution(false, &interval);
+#elif defined NH_PLATFORM_LINUX
+	timespec interval{ (time_t)s, 0 };
+	while (nanosleep(&interval, &interval) == -1 && errno == EINTR) {}
+#endif
 }
 
 void Jobs::SleepForMilli(U64 ms)
 {
+#if defined NH_PLATFORM_WINDOWS
 	LARGE_INTEGER interval;
 	interval.QuadPart = -(I64)(ms * 10000);
 	NtDelayExecution(false, &interval);
+#elif defined NH_PLATFORM_LINUX
+	timespec interval{ (time_t)(ms / 1000), (long)((ms % 1000) * 1000000) };
+	while (nanosleep(&interval, &interval) == -1 && errno == EINTR) {}
+#endif
 }
 
 void Jobs::SleepForMicro(U64 us)
 {
+#if defined NH_PLATFORM_WINDOWS
 	LARGE_INTEGER interval;
 	interval.QuadPart = -(I64)(us * 10);
 	NtDelayExecution(false, &interval);
+#elif defined NH_PLATFORM_LINUX
+	timespec interval{ (time_t)(us / 1000000), (long)((us % 1000000) * 1000) };
+	while (nanosleep(&interval, &interval) == -1 && errno == EINTR) {}
+#endif
+}
+
+#if defined NH_PLATFORM_WINDOWS
+U32 __stdcall Jobs::RunThread(void* data)
+{
+	RunWorker((U32)(U64)data);
+
+	_endthreadex(0);
+	return 0;
+}
+#elif defined NH_PLATFORM_LINUX
+void* Jobs::RunThread(void* data)
+{
+	RunWorker((U32)(U64)data);
+
+	return nullptr;
 }
+#endif
 
-U32 __stdcall Jobs::RunThread(void*)
+void Jobs::RunWorker(U32 index)
 {
-	Function<void()> job;
+	currentWorker = index;
+
+	Parker& parker = workers[currentWorker].parker;
+	Backoff backoff;
 
 	while (running)
 	{
-		bool found = false;
+		Job* job = FindJob(currentWorker);
+
+		if (job) { RunJob(job); backoff.Reset(); continue; }
+		if (!backoff.ShouldPark()) { backoff.Pause(); continue; }
 
-		do
+		parker.Prepare();
+		U32 parked = parkedCount.fetch_add(1, std::memory_order_seq_cst) + 1;
+		PROFILE_COUNTER("Parked Workers", parked);
+
+		// Look once more now that Notify can see us, a job pushed before this point would otherwise be missed
+		job = FindJob(currentWorker);
+
+		if (job || !running)
 		{
-			found = false;
-			for (I32 i = JOB_PRIORITY_COUNT - 1; i >= 0; --i)
-			{
-				if (jobQueues[i].jobs.Pop(job))
-				{
-					job();
-					SafeDecrement(&activeJobCount);
-					found = true;
-					break;
-				}
-			}
-		} while (found);
+			if (parker.Cancel()) { parkedCount.fetch_sub(1, std::memory_order_relaxed); }
+			if (job) { RunJob(job); }
+		}
+		else
+		{
+			PROFILE_BEGIN("Park");
+			parker.Park();
+			PROFILE_END();
+		}
 
-		semaphore.Wait();
+		backoff.Reset();
 	}
-
-	_endthreadex(0);
-	return 0;
 }
\ No newline at end of file
@@ -2,9 +2,12 @@
 
 #include "Defines.hpp"
 
-#include "Semaphore.hpp"
+#include "ThreadSafety.hpp"
+#include "Topology.hpp"
 
 #include "Containers\SafeQueue.hpp"
+#include "Containers\WorkStealingQueue.hpp"
+#include "Containers\Vector.hpp"
 #include "Core\Function.hpp"
 
 enum NH_API JobPriority
@@ -16,9 +19,68 @@ enum NH_API JobPriority
 	JOB_PRIORITY_COUNT
 };
 
+static constexpr inline U32 MaxJobsPerWorker = 2048;
+static constexpr inline U32 MaxInjectedJobs = 1024;
+static constexpr inline U32 MaxJobCounters = 4096;
+
+struct Job;
+
+/*
+* Tracks how many jobs of a submission are still in flight, counters are pooled and recycled once they reach zero
+*/
+struct NH_API JobCounter
+{
+	std::atomic<U32> remaining{ 0 };
+	std::atomic<U32> generation{ 0 };
+	std::atomic<bool> active{ false };
+
+	// Threads sleeping in WaitFor until generation changes
+	std::atomic<U32> waiters{ 0 };
+
+	// Jobs to submit once remaining reaches zero, guarded by lock
+	SpinLock lock;
+	Job* continuations{ nullptr };
+};
+
+struct NH_API JobHandle
+{
+	/// <summary>
+	/// Checks if every job this handle refers to has finished
+	/// </summary>
+	/// <returns>true if the work is done or the handle is empty, false otherwise</returns>
+	bool Done() const;
+
+	JobCounter* counter{ nullptr };
+	U32 generation{ 0 };
+};
+
+struct NH_API Job
+{
+	Function<void()> function;
+	JobCounter* counter{ nullptr };
+	Job* next{ nullptr };
+	JobPriority priority{ JOB_PRIORITY_MEDIUM };
+	std::atomic<bool> active{ false };
+};
+
+struct NH_API JobPool
+{
+	Job jobs[MaxJobsPerWorker];
+	std::atomic<U32> next{ 0 };
+};
+
 struct NH_API JobQueue
 {
-	SafeQueue<Function<void()>, 256> jobs;
+	WorkStealingQueue<Job*, MaxJobsPerWorker> jobs;
+};
+
+struct NH_API alignas(CacheLineSize) JobWorker
+{
+	JobQueue queues[JOB_PRIORITY_COUNT];
+	JobPool pool;
+	Parker parker;
+	LogicalProcessor processor;
+	U64 randomState;
 };
 
 struct NH_API DispatchArgs
@@ -27,38 +89,158 @@ struct NH_API DispatchArgs
 	U32 groupIndex;
 };
 
+/*
+* Builds a small dependency graph of jobs, ex. Collide -> Solve -> Events
+* The graph must outlive its execution, wait on the handle returned by Execute before changing or destroying it
+*/
+struct NH_API JobGraph
+{
+public:
+	JobGraph();
+	~JobGraph();
+	void Destroy();
+	void Clear();
+
+	/// <summary>
+	/// Adds a job to the graph, it won't run until every node it depends on has finished
+	/// </summary>
+	/// <param name="function:">The work to do</param>
+	/// <param name="priority:">The priority the job is submitted with</param>
+	/// <returns>The index of the node, used to add dependencies</returns>
+	U32 AddNode(const Function<void()>& function, JobPriority priority = JOB_PRIORITY_MEDIUM);
+
+	/// <summary>
+	/// Makes after wait until before has finished
+	/// </summary>
+	void AddDependency(U32 before, U32 after);
+
+	/// <summary>
+	/// Submits every node without dependencies, the rest are submitted as their dependencies finish
+	/// </summary>
+	/// <returns>A handle that's done once every node has run</returns>
+	JobHandle Execute();
+
+	/// <summary>
+	/// Checks every node can run, a dependency cycle would leave its nodes and the graph's handle waiting forever
+	/// </summary>
+	/// <returns>true if the nodes have a topological order, false if there's a cycle</returns>
+	bool Validate();
+
+private:
+	struct Node
+	{
+		Function<void()> function;
+		Vector<U32> successors;
+		U32 dependencyCount{ 0 };
+		JobPriority priority{ JOB_PRIORITY_MEDIUM };
+	};
+
+	void RunNode(U32 index);
+
+	Vector<Node> nodes;
+	Vector<U32> pending;
+	JobCounter* counter{ nullptr };
+};
+
 /*
 * TODO: This syntax would be ideal: StartJob<func>(param, param, ...);
 */
 class NH_API Jobs
 {
 public:
-	static void Excecute(const Function<void()>& job, JobPriority priority = JOB_PRIORITY_MEDIUM);
-	static bool Dispatch(U32 jobCount, U32 groupSize, const Function<void(DispatchArgs)>& job, JobPriority priority = JOB_PRIORITY_MEDIUM);
+	static JobHandle Excecute(const Function<void()>& job, JobPriority priority = JOB_PRIORITY_MEDIUM);
+	static JobHandle Dispatch(U32 jobCount, U32 groupSize, const Function<void(DispatchArgs)>& job, JobPriority priority = JOB_PRIORITY_MEDIUM);
+
+	/// <summary>
+	/// Runs body over [begin, end) split into batches across the workers, the calling thread runs batches too and returns once every batch has finished
+	/// <para/>Batches start large and shrink towards minBatch as the range runs out so late finishers can balance the load
+	/// </summary>
+	/// <param name="begin:">The first index</param>
+	/// <param name="end:">One past the last index</param>
+	/// <param name="minBatch:">The smallest range handed to body, pick this so a batch takes at least a few microseconds</param>
+	/// <param name="body:">Called with the start and end of each batch</param>
+	static void ParallelFor(U32 begin, U32 end, U32 minBatch, const Function<void(U32, U32)>& body, JobPriority priority = JOB_PRIORITY_HIGH);
+
+	/// <summary>
+	/// Submits a job that will only start once the work referred to by handle has finished
+	/// </summary>
+	/// <returns>A handle to the new job</returns>
+	static JobHandle Then(const JobHandle& handle, const Function<void()>& job, JobPriority priority = JOB_PRIORITY_MEDIUM);
+
+	/// <summary>
+	/// Waits until the work referred to by handle has finished, running other pending jobs in the meantime
+	/// </summary>
+	static void WaitFor(const JobHandle& handle);
 
 	static void Wait(JobPriority minPriority);
 
+	/// <summary>
+	/// The number of workers including the main thread
+	/// </summary>
+	static U32 WorkerCount();
+
+	/// <summary>
+	/// The index of the calling worker, 0 is the main thread, U32_MAX if the caller isn't a worker
+	/// </summary>
+	static U32 CurrentWorker();
+
+	/// <summary>
+	/// The cache domain a worker runs in, workers with neighbouring indices share a domain where possible
+	/// </summary>
+	static U32 CacheDomain(U32 worker);
+
+	static const CpuTopology& Topology();
+
 	static void SleepForSeconds(U64 s);
 	static void SleepForMilli(U64 ms);
 	static void SleepForMicro(U64 us);
 
 private:
-	static bool Initialize();
+	static bool Initialize(JobAffinity affinity = JOB_AFFINITY_PHYSICAL_CORES);
 	static void Shutdown();
 
 	static void Poll();
 
+	static Job* AllocateJob();
+	static Job* AllocateJob(JobPool& pool);
+	static JobCounter* AcquireCounter(U32 count);
+	static JobHandle MakeHandle(JobCounter* counter);
+	static void Submit(Job* job, JobPriority priority);
+	static void Push(Job* job, JobPriority priority);
+	static void Notify();
+	static Job* FindJob(U32 workerIndex);
+	static void RunJob(Job* job);
+	static void RunWorker(U32 index);
+
 	static bool running;
 	static U64 threadCount;
 	static U64 activeJobCount;
-	static Semaphore semaphore;
-	static JobQueue jobQueues[JOB_PRIORITY_COUNT];
+
+	// Idle workers spin, then yield, then park, submissions wake a single parked worker
+	static std::atomic<U32> parkedCount;
+	static std::atomic<U32> wakeCursor;
+
+	// Each worker (the main thread is worker 0) owns one deque per priority, other workers steal from the top
+	static JobWorker* workers;
+	static CpuTopology topology;
+
+	// Submissions from threads that aren't workers go through these shared queues
+	static JobPool injectionPool;
+	static SafeQueue<Job*, MaxInjectedJobs> injectionQueues[JOB_PRIORITY_COUNT];
+
+	static JobCounter counters[MaxJobCounters];
+	static std::atomic<U32> nextCounter;
 
 #if defined NH_PLATFORM_WINDOWS
 	static U32 __stdcall RunThread(void*);
 	static UL32 sleepRes;
+#elif defined NH_PLATFORM_LINUX
+	static void* RunThread(void*);
 #endif
 
 	STATIC_CLASS(Jobs);
 	friend class Engine;
+	friend struct JobGraph;
+	template<class Type> friend struct Task;
+	friend struct JobsTests;
 };
\ No newline at end of file
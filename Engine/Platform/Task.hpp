@@ -0,0 +1,338 @@
+#pragma once
+
+#include "Defines.hpp"
+#include "TypeTraits.hpp"
+
+#include "Jobs.hpp"
+
+#include "Core\File.hpp"
+#include "Containers\Vector.hpp"
+
+#include <coroutine>
+#include <atomic>
+#include <tuple>
+
+/*
+* Coroutine tasks that run on the job system
+* Tasks are lazy, they start when they're awaited or when Start/Wait is called, and every resumption happens on a Jobs worker
+*
+* Example:
+* Task<Vector<U8>> LoadTexture(String path)
+* {
+*	Vector<U8> data = co_await ReadFileAsync(path);
+*	co_await Jobs::Excecute([&]() { Decode(data); });
+*	co_return data;
+* }
+*/
+
+template<class Type> struct Task;
+
+struct NH_API TaskPromiseBase
+{
+	struct FinalAwaiter
+	{
+		bool await_ready() const noexcept { return false; }
+
+		template<class Promise>
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+		{
+			// Swapping in Finished hands off to an awaiter that already arrived, one that arrives later sees Finished and doesn't suspend.
+			// The frame may be destroyed as soon as the swap is done so nothing in it is touched afterwards
+			void* continuation = handle.promise().continuation.exchange(Finished, std::memory_order_acq_rel);
+
+			if (continuation) { return std::coroutine_handle<>::from_address(continuation); }
+			return std::noop_coroutine();
+		}
+
+		void await_resume() const noexcept {}
+	};
+
+	std::suspend_always initial_suspend() const noexcept { return {}; }
+	FinalAwaiter final_suspend() const noexcept { return {}; }
+	void unhandled_exception() const noexcept { BreakPoint; }
+
+	bool Done() const { return continuation.load(std::memory_order_acquire) == Finished; }
+
+	/// <summary>
+	/// Claims the first resume of the coroutine, only the caller that gets true may schedule it
+	/// </summary>
+	bool TryStart() { return !started.exchange(true, std::memory_order_acq_rel); }
+
+	// The awaiting coroutine's address, nullptr until something awaits, Finished once the task has completed
+	static inline void* const Finished = (void*)1;
+
+	std::atomic<void*> continuation{ nullptr };
+	std::atomic<bool> started{ false };
+	JobPriority priority{ JOB_PRIORITY_MEDIUM };
+};
+
+template<class Type>
+struct TaskPromise : public TaskPromiseBase
+{
+	Task<Type> get_return_object() noexcept;
+
+	template<class Value>
+	void return_value(Value&& value) { result = Forward<Value>(value); }
+
+	Type result{};
+};
+
+template<>
+struct TaskPromise<void> : public TaskPromiseBase
+{
+	Task<void> get_return_object() noexcept;
+
+	void return_void() const noexcept {}
+};
+
+/// <summary>
+/// Suspends the current coroutine and resumes it as a job on a worker thread
+/// </summary>
+struct NH_API ResumeOnWorker
+{
+	bool await_ready() const noexcept { return false; }
+	void await_suspend(std::coroutine_handle<> handle) const { Jobs::Excecute([handle]() { handle.resume(); }, priority); }
+	void await_resume() const noexcept {}
+
+	JobPriority priority{ JOB_PRIORITY_MEDIUM };
+};
+
+template<class Type>
+struct Task
+{
+	using promise_type = TaskPromise<Type>;
+	using Handle = std::coroutine_handle<promise_type>;
+
+	struct Awaiter
+	{
+		bool await_ready() const noexcept { return !handle || handle.promise().Done(); }
+
+		bool await_suspend(std::coroutine_handle<> awaiting)
+		{
+			promise_type& promise = handle.promise();
+
+			// A task that was already started is running or queued, resuming it again would be a double resume
+			bool start = promise.TryStart();
+
+			void* previous = promise.continuation.exchange(awaiting.address(), std::memory_order_acq_rel);
+
+			// Finished between await_ready and here, put the marker back and carry on without suspending
+			if (previous == TaskPromiseBase::Finished)
+			{
+				promise.continuation.store(TaskPromiseBase::Finished, std::memory_order_release);
+				return false;
+			}
+
+			if (start) { ResumeOnWorker{ promise.priority }.await_suspend(handle); }
+
+			return true;
+		}
+
+		Type await_resume()
+		{
+			if constexpr (!IsVoid<Type>) { return Move(handle.promise().result); }
+		}
+
+		Handle handle;
+	};
+
+public:
+	Task() {}
+	explicit Task(Handle handle) : handle(handle) {}
+	Task(Task&& other) noexcept : handle(other.handle) { other.handle = nullptr; }
+	Task& operator=(Task&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Destroy();
+			handle = other.handle;
+			other.handle = nullptr;
+		}
+
+		return *this;
+	}
+
+	/// <summary>
+	/// Destroys the coroutine frame, the task must be finished or never started
+	/// </summary>
+	~Task() { Destroy(); }
+
+	void Destroy()
+	{
+		if (handle)
+		{
+			ASSERT(!handle.promise().started.load(std::memory_order_acquire) || Done());
+			handle.destroy();
+			handle = nullptr;
+		}
+	}
+
+	/// <summary>
+	/// Schedules the task on a worker without anything waiting on it
+	/// </summary>
+	void Start(JobPriority priority = JOB_PRIORITY_MEDIUM)
+	{
+		if (!handle || !handle.promise().TryStart()) { return; }
+
+		handle.promise().priority = priority;
+		ResumeOnWorker{ priority }.await_suspend(handle);
+	}
+
+	/// <summary>
+	/// Starts the task if needed and waits for it, running other jobs in the meantime, don't call this from inside a task
+	/// </summary>
+	Type Wait()
+	{
+		Start();
+
+		while (!Done()) { Jobs::Poll(); }
+
+		if constexpr (!IsVoid<Type>) { return Move(handle.promise().result); }
+	}
+
+	bool Done() const { return !handle || handle.promise().Done(); }
+
+	Awaiter operator co_await() noexcept { return Awaiter{ handle }; }
+
+private:
+	Handle handle{ nullptr };
+
+	Task(const Task&) = delete;
+	Task& operator=(const Task&) = delete;
+};
+
+template<class Type>
+inline Task<Type> TaskPromise<Type>::get_return_object() noexcept { return Task<Type>{ std::coroutine_handle<TaskPromise<Type>>::from_promise(*this) }; }
+
+inline Task<void> TaskPromise<void>::get_return_object() noexcept { return Task<void>{ std::coroutine_handle<TaskPromise<void>>::from_promise(*this) }; }
+
+/// <summary>
+/// Awaiting a job handle suspends the coroutine until the work is done, then resumes it on a worker
+/// </summary>
+struct NH_API JobHandleAwaiter
+{
+	bool await_ready() const noexcept { return handle.Done(); }
+	void await_suspend(std::coroutine_handle<> awaiting) const { Jobs::Then(handle, [awaiting]() { awaiting.resume(); }); }
+	void await_resume() const noexcept {}
+
+	JobHandle handle;
+};
+
+inline JobHandleAwaiter operator co_await(const JobHandle& handle) noexcept { return { handle }; }
+
+/// <summary>
+/// Reads a whole file on a low priority job, the coroutine resumes on that job once the data is ready
+/// <para/>NOTE: File is synchronous, so the read occupies the job it runs on, but no worker is ever blocked waiting for it
+/// </summary>
+struct NH_API FileReadAwaiter
+{
+	bool await_ready() const noexcept { return false; }
+
+	void await_suspend(std::coroutine_handle<> awaiting)
+	{
+		Jobs::Excecute([this, awaiting]() {
+			File file(path, FILE_OPEN_RESOURCE_READ);
+			if (file.Opened()) { file.ReadAll(data); }
+			awaiting.resume();
+		}, JOB_PRIORITY_LOW);
+	}
+
+	Vector<U8> await_resume() noexcept { return Move(data); }
+
+	String path;
+	Vector<U8> data;
+};
+
+inline FileReadAwaiter ReadFileAsync(const String& path) { return { path }; }
+
+struct DetachedTask
+{
+	struct promise_type
+	{
+		DetachedTask get_return_object() const noexcept { return {}; }
+		std::suspend_never initial_suspend() const noexcept { return {}; }
+		std::suspend_never final_suspend() const noexcept { return {}; }
+		void return_void() const noexcept {}
+		void unhandled_exception() const noexcept { BreakPoint; }
+	};
+};
+
+struct WhenAllLatch
+{
+	/// <summary>
+	/// Counts one extra so the awaiting coroutine can't be resumed while it's still starting the tasks
+	/// </summary>
+	bool Arrive() { return remaining.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+
+	std::atomic<U32> remaining{ 1 };
+	std::coroutine_handle<> awaiting;
+};
+
+template<class Type>
+inline DetachedTask WhenAllEntry(Task<Type>& task, WhenAllLatch& latch)
+{
+	co_await task;
+
+	if (latch.Arrive()) { latch.awaiting.resume(); }
+}
+
+template<class Type>
+struct WhenAllAwaiter
+{
+	bool await_ready() const noexcept { return tasks.Size() == 0; }
+
+	bool await_suspend(std::coroutine_handle<> awaiting)
+	{
+		latch.awaiting = awaiting;
+		latch.remaining.store((U32)tasks.Size() + 1, std::memory_order_relaxed);
+
+		for (Task<Type>& task : tasks) { WhenAllEntry(task, latch); }
+
+		// If every task already finished, don't suspend
+		return !latch.Arrive();
+	}
+
+	void await_resume() const noexcept {}
+
+	Vector<Task<Type>>& tasks;
+	WhenAllLatch latch;
+};
+
+/// <summary>
+/// Runs every task in parallel and finishes once they all have, results stay in the tasks
+/// </summary>
+template<class Type>
+inline Task<void> WhenAll(Vector<Task<Type>>& tasks)
+{
+	co_await WhenAllAwaiter<Type>{ tasks };
+}
+
+template<class... Types>
+struct WhenAllPackAwaiter
+{
+	bool await_ready() const noexcept { return sizeof...(Types) == 0; }
+
+	bool await_suspend(std::coroutine_handle<> awaiting)
+	{
+		latch.awaiting = awaiting;
+		latch.remaining.store((U32)sizeof...(Types) + 1, std::memory_order_relaxed);
+
+		std::apply([this](Task<Types>&... task) { (WhenAllEntry(task, latch), ...); }, tasks);
+
+		return !latch.Arrive();
+	}
+
+	void await_resume() const noexcept {}
+
+	std::tuple<Task<Types>&...> tasks;
+	WhenAllLatch latch;
+};
+
+/// <summary>
+/// Runs every task in parallel and finishes once they all have, results stay in the tasks
+/// </summary>
+template<class... Types>
+inline Task<void> WhenAll(Task<Types>&... tasks)
+{
+	co_await WhenAllPackAwaiter<Types...>{ { tasks... } };
+}
\ No newline at end of file
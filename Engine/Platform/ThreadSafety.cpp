@@ -2,6 +2,12 @@
 
 #if defined(NH_PLATFORM_WINDOWS)
 #include <Windows.h>
+#pragma comment(lib, "synchronization.lib")
+#elif defined(NH_PLATFORM_LINUX)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <climits>
 #endif
 
 #if defined(NH_PLATFORM_WINDOWS)
@@ -27,4 +33,35 @@ L32 ThreadSafety::SafeCheckAndReset32(volatile L32* t, L32 pos) { return Interlo
 I64 ThreadSafety::SafeCompareAndExchange64(volatile I64* t, I64 exchange, I64 comperand) { return InterlockedCompareExchange64(t, exchange, comperand); }
 L32 ThreadSafety::SafeCompareAndExchange32(volatile L32* t, L32 exchange, L32 comperand) { return InterlockedCompareExchange(t, exchange, comperand); }
 
-#endif
\ No newline at end of file
+void ThreadSafety::WaitOnValue(std::atomic<U32>& value, U32 compare) { ::WaitOnAddress(&value, &compare, sizeof(U32), INFINITE); }
+void ThreadSafety::WakeOne(std::atomic<U32>& value) { WakeByAddressSingle(&value); }
+void ThreadSafety::WakeAll(std::atomic<U32>& value) { WakeByAddressAll(&value); }
+
+#elif defined(NH_PLATFORM_LINUX)
+
+I64 ThreadSafety::SafeIncrement64(volatile I64* t) { return __atomic_add_fetch(t, 1, __ATOMIC_SEQ_CST); }
+L32 ThreadSafety::SafeIncrement32(volatile L32* t) { return __atomic_add_fetch(t, 1, __ATOMIC_SEQ_CST); }
+
+I64 ThreadSafety::SafeAdd64(volatile I64* t, I64 value) { return __atomic_add_fetch(t, value, __ATOMIC_SEQ_CST); }
+L32 ThreadSafety::SafeAdd32(volatile L32* t, L32 value) { return __atomic_add_fetch(t, value, __ATOMIC_SEQ_CST); }
+
+I64 ThreadSafety::SafeDecrement64(volatile I64* t) { return __atomic_sub_fetch(t, 1, __ATOMIC_SEQ_CST); }
+L32 ThreadSafety::SafeDecrement32(volatile L32* t) { return __atomic_sub_fetch(t, 1, __ATOMIC_SEQ_CST); }
+
+I64 ThreadSafety::SafeSubtract64(volatile I64* t, I64 value) { return __atomic_sub_fetch(t, value, __ATOMIC_SEQ_CST); }
+L32 ThreadSafety::SafeSubtract32(volatile L32* t, L32 value) { return __atomic_sub_fetch(t, value, __ATOMIC_SEQ_CST); }
+
+I64 ThreadSafety::SafeCheckAndSet64(volatile I64* t, I64 pos) { return (__atomic_fetch_or(t, 1ll << pos, __ATOMIC_SEQ_CST) >> pos) & 1; }
+L32 ThreadSafety::SafeCheckAndSet32(volatile L32* t, L32 pos) { return (__atomic_fetch_or(t, 1l << pos, __ATOMIC_SEQ_CST) >> pos) & 1; }
+
+I64 ThreadSafety::SafeCheckAndReset64(volatile I64* t, I64 pos) { return (__atomic_fetch_and(t, ~(1ll << pos), __ATOMIC_SEQ_CST) >> pos) & 1; }
+L32 ThreadSafety::SafeCheckAndReset32(volatile L32* t, L32 pos) { return (__atomic_fetch_and(t, ~(1l << pos), __ATOMIC_SEQ_CST) >> pos) & 1; }
+
+I64 ThreadSafety::SafeCompareAndExchange64(volatile I64* t, I64 exchange, I64 comperand) { __atomic_compare_exchange_n(t, &comperand, exchange, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST); return comperand; }
+L32 ThreadSafety::SafeCompareAndExchange32(volatile L32* t, L32 exchange, L32 comperand) { __atomic_compare_exchange_n(t, &comperand, exchange, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST); return comperand; }
+
+void ThreadSafety::WaitOnValue(std::atomic<U32>& value, U32 compare) { syscall(SYS_futex, &value, FUTEX_WAIT_PRIVATE, compare, nullptr, nullptr, 0); }
+void ThreadSafety::WakeOne(std::atomic<U32>& value) { syscall(SYS_futex, &value, FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0); }
+void ThreadSafety::WakeAll(std::atomic<U32>& value) { syscall(SYS_futex, &value, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0); }
+
+#endif
@@ -3,10 +3,68 @@
 #include "Defines.hpp"
 #include "TypeTraits.hpp"
 
-#include <xthreads.h>
 #include <atomic>
 
-inline void YieldThread() noexcept { _Thrd_yield(); }
+#if defined NH_PLATFORM_WINDOWS
+#include <xthreads.h>
+#else
+#include <sched.h>
+#endif
+
+#if defined NH_CPU_X86_X64
+#include <immintrin.h>
+#elif defined _M_ARM64 || defined _M_ARM
+#include <intrin.h>
+#endif
+
+inline constexpr U64 CacheLineSize = 64;
+
+inline void YieldThread() noexcept
+{
+#if defined NH_PLATFORM_WINDOWS
+	_Thrd_yield();
+#else
+	sched_yield();
+#endif
+}
+
+/// <summary>
+/// Tells the cpu we're in a spin loop so it can back off the pipeline and the other hyperthread
+/// </summary>
+inline void CpuRelax() noexcept
+{
+#if defined NH_CPU_X86_X64
+	_mm_pause();
+#elif defined _M_ARM64 || defined _M_ARM
+	__yield();
+#elif defined NH_CPU_ARM
+	__asm__ __volatile__("yield");
+#endif
+}
+
+/*
+* Adaptive backoff for spin loops, pauses exponentially longer then starts yielding the time slice
+* Once yielding stops paying off ShouldPark returns true and the caller should sleep on a futex instead
+*/
+struct NH_API Backoff
+{
+	static constexpr inline U32 SpinLimit = 6;
+	static constexpr inline U32 YieldLimit = 10;
+
+	void Pause()
+	{
+		if (step <= SpinLimit) { for (U32 i = 0; i < (1u << step); ++i) { CpuRelax(); } }
+		else { YieldThread(); }
+
+		if (step <= YieldLimit) { ++step; }
+	}
+
+	bool ShouldPark() const { return step > YieldLimit; }
+
+	void Reset() { step = 0; }
+
+	U32 step{ 0 };
+};
 
 struct NH_API SpinLock
 {
@@ -15,10 +73,12 @@ struct NH_API SpinLock
 public:
 	void Lock()
 	{
+		Backoff backoff;
+
 		while (true)
 		{
 			if (!lockFlag.exchange(true, std::memory_order_acquire)) { break; }
-			while (lockFlag.load(std::memory_order_relaxed)) { YieldThread(); }
+			while (lockFlag.load(std::memory_order_relaxed)) { backoff.Pause(); }
 		}
 	}
 
@@ -66,6 +126,63 @@ public:
 
 	static I64 SafeCompareAndExchange64(volatile I64* t, I64 exchange, I64 comperand);
 	static L32 SafeCompareAndExchange32(volatile L32* t, L32 exchange, L32 comperand);
+
+	/// <summary>
+	/// Sleeps while value equals compare, uses WaitOnAddress on Windows and futex on Linux, may wake spuriously
+	/// </summary>
+	static void WaitOnValue(std::atomic<U32>& value, U32 compare);
+
+	/// <summary>
+	/// Wakes one thread sleeping in WaitOnValue on value
+	/// </summary>
+	static void WakeOne(std::atomic<U32>& value);
+
+	/// <summary>
+	/// Wakes every thread sleeping in WaitOnValue on value
+	/// </summary>
+	static void WakeAll(std::atomic<U32>& value);
+};
+
+/*
+* Lets one thread sleep until another has work for it, an idle thread parked here costs no cpu time
+* The owner calls Prepare, checks for work one last time, then either Cancel or Park, any thread may Unpark it
+*/
+struct NH_API Parker
+{
+	static constexpr inline U32 Awake = 0;
+	static constexpr inline U32 Parked = 1;
+
+	void Prepare() { state.store(Parked, std::memory_order_seq_cst); }
+
+	/// <summary>
+	/// Undoes Prepare
+	/// </summary>
+	/// <returns>true if we cancelled, false if another thread already unparked us</returns>
+	bool Cancel()
+	{
+		U32 expected = Parked;
+		return state.compare_exchange_strong(expected, Awake, std::memory_order_acq_rel);
+	}
+
+	void Park()
+	{
+		while (state.load(std::memory_order_acquire) == Parked) { ThreadSafety::WaitOnValue(state, Parked); }
+	}
+
+	/// <summary>
+	/// Wakes the owning thread if it's parked or about to park
+	/// </summary>
+	/// <returns>true if this call woke it, false if it was already awake</returns>
+	bool Unpark()
+	{
+		U32 expected = Parked;
+		if (!state.compare_exchange_strong(expected, Awake, std::memory_order_acq_rel)) { return false; }
+
+		ThreadSafety::WakeOne(state);
+		return true;
+	}
+
+	alignas(CacheLineSize) std::atomic<U32> state{ Awake };
 };
 
 template<Integer Int>
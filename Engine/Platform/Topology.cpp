@@ -0,0 +1,305 @@
+#include "Topology.hpp"
+
+#include "Memory\Memory.hpp"
+
+#if defined(NH_PLATFORM_WINDOWS)
+#include <Windows.h>
+#elif defined(NH_PLATFORM_LINUX)
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#endif
+
+static U32 DenseIndex(Vector<U64>& keys, U64 key)
+{
+	for (U32 i = 0; i < keys.Size(); ++i)
+	{
+		if (keys[i] == key) { return i; }
+	}
+
+	keys.Push(key);
+	return (U32)keys.Size() - 1;
+}
+
+#if defined(NH_PLATFORM_LINUX)
+static bool ReadSysfs(const C8* path, C8* buffer, U32 capacity)
+{
+	I32 file = open(path, O_RDONLY);
+	if (file < 0) { return false; }
+
+	I64 count = read(file, buffer, capacity - 1);
+	close(file);
+
+	if (count <= 0) { return false; }
+
+	buffer[count] = 0;
+	return true;
+}
+
+static bool ReadSysfsNumber(const C8* path, U32& value)
+{
+	C8 buffer[32];
+	if (!ReadSysfs(path, buffer, sizeof(buffer))) { return false; }
+
+	value = (U32)strtoul(buffer, nullptr, 10);
+	return true;
+}
+
+/// <summary>
+/// Parses a sysfs cpu list, ex. "0-3,8,10-11"
+/// </summary>
+static void ParseCpuList(const C8* list, Vector<U32>& cpus)
+{
+	C8* it = (C8*)list;
+
+	while (*it >= '0' && *it <= '9')
+	{
+		U32 first = (U32)strtoul(it, &it, 10);
+		U32 last = first;
+
+		if (*it == '-') { last = (U32)strtoul(it + 1, &it, 10); }
+
+		for (U32 cpu = first; cpu <= last; ++cpu) { cpus.Push(cpu); }
+
+		if (*it == ',') { ++it; }
+	}
+}
+#endif
+
+bool CpuTopology::Detect()
+{
+	processors.Clear();
+	coreCount = 0;
+	cacheCount = 0;
+	nodeCount = 0;
+
+#if defined(NH_PLATFORM_WINDOWS)
+	UL32 length = 0;
+	GetLogicalProcessorInformationEx(RelationAll, nullptr, &length);
+
+	U8* buffer = nullptr;
+	Memory::AllocateArray(&buffer, length);
+
+	if (GetLogicalProcessorInformationEx(RelationAll, (SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*)buffer, &length))
+	{
+		// Cores first, caches and nodes refer back to them by mask
+		for (U8* it = buffer; it < buffer + length; it += ((SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*)it)->Size)
+		{
+			SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX* info = (SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*)it;
+			if (info->Relationship != RelationProcessorCore) { continue; }
+
+			U32 sibling = 0;
+			for (U16 i = 0; i < info->Processor.GroupCount; ++i)
+			{
+				const GROUP_AFFINITY& affinity = info->Processor.GroupMask[i];
+
+				for (U32 bit = 0; bit < 64; ++bit)
+				{
+					if (!(affinity.Mask & (1ull << bit))) { continue; }
+
+					LogicalProcessor processor{};
+					processor.id = bit;
+					processor.group = affinity.Group;
+					processor.core = coreCount;
+					processor.sibling = sibling++;
+
+					processors.Push(processor);
+				}
+			}
+
+			++coreCount;
+		}
+
+		for (U8* it = buffer; it < buffer + length; it += ((SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*)it)->Size)
+		{
+			SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX* info = (SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*)it;
+
+			if (info->Relationship == RelationCache && info->Cache.Level == 3)
+			{
+				for (LogicalProcessor& processor : processors)
+				{
+					if (processor.group == info->Cache.GroupMask.Group && (info->Cache.GroupMask.Mask & (1ull << processor.id))) { processor.cache = cacheCount; }
+				}
+
+				++cacheCount;
+			}
+			else if (info->Relationship == RelationNumaNode)
+			{
+				for (LogicalProcessor& processor : processors)
+				{
+					if (processor.group == info->NumaNode.GroupMask.Group && (info->NumaNode.GroupMask.Mask & (1ull << processor.id))) { processor.node = info->NumaNode.NodeNumber; }
+				}
+
+				if (info->NumaNode.NodeNumber + 1 > nodeCount) { nodeCount = info->NumaNode.NodeNumber + 1; }
+			}
+		}
+	}
+
+	Memory::Free(&buffer);
+#elif defined(NH_PLATFORM_LINUX)
+	C8 path[128];
+	C8 buffer[1024];
+
+	Vector<U32> online;
+	if (ReadSysfs("/sys/devices/system/cpu/online", buffer, sizeof(buffer))) { ParseCpuList(buffer, online); }
+
+	Vector<U64> coreKeys;
+	Vector<U64> cacheKeys;
+	Vector<U32> sharedCpus;
+
+	for (U32 cpu : online)
+	{
+		LogicalProcessor processor{};
+		processor.id = cpu;
+
+		U32 package = 0;
+		U32 coreId = cpu;
+
+		snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/topology/physical_package_id", cpu);
+		ReadSysfsNumber(path, package);
+		snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/topology/core_id", cpu);
+		ReadSysfsNumber(path, coreId);
+
+		// core_id is only unique within a package
+		processor.core = DenseIndex(coreKeys, ((U64)package << 32) | coreId);
+
+		for (const LogicalProcessor& other : processors)
+		{
+			if (other.core == processor.core) { ++processor.sibling; }
+		}
+
+		// The lowest cpu sharing the L3 identifies the domain
+		for (U32 index = 0; ; ++index)
+		{
+			U32 level;
+			snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/cache/index%u/level", cpu, index);
+			if (!ReadSysfsNumber(path, level)) { break; }
+			if (level != 3) { continue; }
+
+			snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/cache/index%u/shared_cpu_list", cpu, index);
+			if (ReadSysfs(path, buffer, sizeof(buffer)))
+			{
+				sharedCpus.Clear();
+				ParseCpuList(buffer, sharedCpus);
+				if (sharedCpus.Size()) { processor.cache = DenseIndex(cacheKeys, sharedCpus[0]); }
+			}
+
+			break;
+		}
+
+		processors.Push(processor);
+	}
+
+	coreCount = (U32)coreKeys.Size();
+	cacheCount = (U32)cacheKeys.Size();
+
+	for (U32 node = 0; ; ++node)
+	{
+		snprintf(path, sizeof(path), "/sys/devices/system/node/node%u/cpulist", node);
+		if (!ReadSysfs(path, buffer, sizeof(buffer))) { break; }
+
+		sharedCpus.Clear();
+		ParseCpuList(buffer, sharedCpus);
+
+		for (LogicalProcessor& processor : processors)
+		{
+			for (U32 cpu : sharedCpus)
+			{
+				if (processor.id == cpu) { processor.node = node; }
+			}
+		}
+
+		nodeCount = node + 1;
+	}
+
+	online.Destroy();
+	coreKeys.Destroy();
+	cacheKeys.Destroy();
+	sharedCpus.Destroy();
+#endif
+
+	if (cacheCount == 0) { cacheCount = 1; }
+	if (nodeCount == 0) { nodeCount = 1; }
+
+	if (processors.Size()) { return true; }
+
+	// The OS didn't tell us anything, treat every logical processor as its own core
+#if defined(NH_PLATFORM_WINDOWS)
+	SYSTEM_INFO sysInfo;
+	GetSystemInfo(&sysInfo);
+	U32 count = sysInfo.dwNumberOfProcessors;
+#elif defined(NH_PLATFORM_LINUX)
+	U32 count = (U32)sysconf(_SC_NPROCESSORS_ONLN);
+#else
+	U32 count = 1;
+#endif
+
+	for (U32 i = 0; i < count; ++i)
+	{
+		LogicalProcessor processor{};
+		processor.id = i;
+		processor.core = i;
+
+		processors.Push(processor);
+	}
+
+	coreCount = count;
+
+	return false;
+}
+
+void CpuTopology::Destroy()
+{
+	processors.Destroy();
+	coreCount = 0;
+	cacheCount = 0;
+	nodeCount = 0;
+}
+
+void CpuTopology::Select(JobAffinity affinity, Vector<LogicalProcessor>& selected) const
+{
+	selected.Clear();
+
+	const LogicalProcessor* current = Current();
+	U32 mainCache = current ? current->cache : 0;
+
+	for (const LogicalProcessor& processor : processors)
+	{
+		if (affinity != JOB_AFFINITY_LOGICAL_CORES && processor.sibling != 0) { continue; }
+		if (affinity == JOB_AFFINITY_CACHE_DOMAIN && processor.cache != mainCache) { continue; }
+
+		// The main thread's domain first, then by domain, then physical cores before their SMT siblings
+		selected.SortedInsert([mainCache](const LogicalProcessor& a, const LogicalProcessor& b) {
+			if ((a.cache == mainCache) != (b.cache == mainCache)) { return a.cache == mainCache; }
+			if (a.cache != b.cache) { return a.cache < b.cache; }
+			if (a.sibling != b.sibling) { return a.sibling < b.sibling; }
+			return a.core < b.core;
+		}, processor);
+	}
+
+	if (selected.Size() == 0) { selected.Push(LogicalProcessor{}); }
+}
+
+const LogicalProcessor* CpuTopology::Current() const
+{
+#if defined(NH_PLATFORM_WINDOWS)
+	PROCESSOR_NUMBER number;
+	GetCurrentProcessorNumberEx(&number);
+
+	for (const LogicalProcessor& processor : processors)
+	{
+		if (processor.group == number.Group && processor.id == number.Number) { return &processor; }
+	}
+#elif defined(NH_PLATFORM_LINUX)
+	I32 cpu = sched_getcpu();
+
+	for (const LogicalProcessor& processor : processors)
+	{
+		if ((I32)processor.id == cpu) { return &processor; }
+	}
+#endif
+
+	return nullptr;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Defines.hpp"
+
+#include "Containers\Vector.hpp"
+
+/// <summary>
+/// How job workers are pinned to processors
+/// </summary>
+enum NH_API JobAffinity
+{
+	JOB_AFFINITY_NONE,				// One worker per physical core, the OS decides where they run
+	JOB_AFFINITY_PHYSICAL_CORES,	// One worker pinned to each physical core, SMT siblings are left free
+	JOB_AFFINITY_LOGICAL_CORES,		// One worker pinned to each logical processor
+	JOB_AFFINITY_CACHE_DOMAIN,		// One worker pinned to each physical core sharing the main thread's L3, ex. a single Zen CCX
+};
+
+struct NH_API LogicalProcessor
+{
+	U32 id{ 0 };		// OS index, the cpu number on Linux, the index in its group on Windows
+	U16 group{ 0 };		// Windows processor group, always 0 on Linux
+	U32 core{ 0 };		// Physical core
+	U32 sibling{ 0 };	// SMT index within its core, 0 is the first hardware thread
+	U32 cache{ 0 };		// Last level cache domain (L3/CCX)
+	U32 node{ 0 };		// NUMA node
+};
+
+/*
+* Physical layout of the processors, read from GetLogicalProcessorInformationEx on Windows and sysfs on Linux
+* core, cache and node are dense indices starting at 0
+*/
+struct NH_API CpuTopology
+{
+	/// <summary>
+	/// Reads the topology from the OS, falls back to treating every logical processor as its own core if that fails
+	/// </summary>
+	/// <returns>true if the OS reported a topology, false if the fallback was used</returns>
+	bool Detect();
+	void Destroy();
+
+	/// <summary>
+	/// Picks the processors to run workers on, ordered so workers sharing a cache domain have neighbouring indices
+	/// </summary>
+	/// <param name="affinity:">The pinning policy</param>
+	/// <param name="selected:">The chosen processors, the first one is reserved for the main thread</param>
+	void Select(JobAffinity affinity, Vector<LogicalProcessor>& selected) const;
+
+	/// <summary>
+	/// Finds the processor the calling thread is running on
+	/// </summary>
+	/// <returns>A pointer to the processor, nullptr if it isn't known</returns>
+	const LogicalProcessor* Current() const;
+
+	Vector<LogicalProcessor> processors;
+	U32 coreCount{ 0 };
+	U32 cacheCount{ 0 };
+	U32 nodeCount{ 0 };
+};
@@ -77,15 +77,15 @@ void CommandBufferRing::ResetDraw(U32 frameIndex)
 	vkResetCommandBuffer(drawCommandBuffers[frameIndex].vkCommandBuffer, 0);
 }
 
-void CommandBufferRing::ResetPool(U32 frameIndex)
+void CommandBufferRing::ResetPool(U32 poolIndex)
 {
-	freeCommandBuffers[frameIndex].Reset();
+	freeCommandBuffers[poolIndex].Reset();
 
-	vkResetCommandPool(Renderer::device, commandPools[frameIndex], 0);
+	vkResetCommandPool(Renderer::device, commandPools[poolIndex], 0);
 
 	for (U32 i = 0; i < buffersPerPool; ++i)
 	{
-		commandBuffers[frameIndex * buffersPerPool + i].recorded = false;
+		commandBuffers[poolIndex * buffersPerPool + i].recorded = false;
 	}
 }
 
@@ -94,13 +94,13 @@ CommandBuffer* CommandBufferRing::GetDrawCommandBuffer(U32 frameIndex)
 	return &drawCommandBuffers[frameIndex];
 }
 
-CommandBuffer* CommandBufferRing::GetWriteCommandBuffer(U32 frameIndex)
+CommandBuffer* CommandBufferRing::GetWriteCommandBuffer(U32 poolIndex)
 {
-	I32 index = freeCommandBuffers[frameIndex].GetFree();
+	I32 index = freeCommandBuffers[poolIndex].GetFree();
 
 	if (index == U32_MAX) { BreakPoint; }
 
-	return &commandBuffers[frameIndex * buffersPerPool + index];
+	return &commandBuffers[poolIndex * buffersPerPool + index];
 }
 
 static constexpr const C8* extensions[]{
@@ -188,8 +188,9 @@ bool								Renderer::resized = false;
 Scene* Renderer::currentScene;
 VmaAllocator_T* Renderer::allocator;
 CommandBufferRing					Renderer::commandBufferRing;
-Vector<VkCommandBuffer_T*>			Renderer::commandBuffers[MAX_SWAPCHAIN_IMAGES];
-Buffer								Renderer::stagingBuffer;
+Vector<VkCommandBuffer_T*>			Renderer::commandBuffers[MAX_UPLOAD_SLOTS];
+Buffer								Renderer::stagingBuffers[MAX_UPLOAD_SLOTS];
+U32									Renderer::uploadIndex = 0;
 Buffer								Renderer::materialBuffer;
 Buffer								Renderer::globalsBuffer;
 ShadowData							Renderer::shadowData;
@@ -203,9 +204,15 @@ ResourceRef<Texture>				Renderer::defaultDepthTarget;
 VkSemaphore							Renderer::imageAcquired = nullptr;
 VkSemaphore							Renderer::presentReady[MAX_SWAPCHAIN_IMAGES];
 VkSemaphore							Renderer::renderCompleted[MAX_SWAPCHAIN_IMAGES];
-VkSemaphore							Renderer::transferCompleted[MAX_SWAPCHAIN_IMAGES];
+VkSemaphore							Renderer::transferCompleted = nullptr;
 U64									Renderer::renderWaitValues[MAX_SWAPCHAIN_IMAGES];
 U64									Renderer::transferWaitValues[MAX_SWAPCHAIN_IMAGES];
+U64									Renderer::uploadWaitValues[MAX_UPLOAD_SLOTS];
+U64									Renderer::transferValue = 0;
+VkSemaphore							Renderer::lastRenderSemaphore = nullptr;
+U64									Renderer::lastRenderValue = 0;
+SpinLock							Renderer::queueLock;
+JobHandle							Renderer::frameJob;
 
 // DEBUG
 VkDebugUtilsMessengerEXT			Renderer::debugMessenger;
@@ -244,6 +251,8 @@ void Renderer::Shutdown()
 {
 	Logger::Trace("Shutting Down Renderer...");
 
+	WaitForFrame();
+
 	if (currentScene)
 	{
 		Resources::SaveScene(currentScene);
@@ -253,14 +262,14 @@ void Renderer::Shutdown()
 
 	commandBufferRing.Destroy();
 
-	for (U32 i = 0; i < MAX_SWAPCHAIN_IMAGES; ++i) { commandBuffers[i].Destroy(); }
+	for (U32 i = 0; i < MAX_UPLOAD_SLOTS; ++i) { commandBuffers[i].Destroy(); }
 
 	vkDestroySemaphore(device, imageAcquired, allocationCallbacks);
 	for (U32 i = 0; i < MAX_SWAPCHAIN_IMAGES; ++i) { vkDestroySemaphore(device, presentReady[i], allocationCallbacks); }
 	for (U32 i = 0; i < MAX_SWAPCHAIN_IMAGES; ++i) { vkDestroySemaphore(device, renderCompleted[i], allocationCallbacks); }
-	for (U32 i = 0; i < MAX_SWAPCHAIN_IMAGES; ++i) { vkDestroySemaphore(device, transferCompleted[i], allocationCallbacks); }
+	vkDestroySemaphore(device, transferCompleted, allocationCallbacks);
 
-	DestroyBuffer(stagingBuffer);
+	for (U32 i = 0; i < MAX_UPLOAD_SLOTS; ++i) { DestroyBuffer(stagingBuffers[i]); }
 	DestroyBuffer(materialBuffer);
 	DestroyBuffer(globalsBuffer);
 
@@ -602,14 +611,15 @@ bool Renderer::CreateResources()
 	{
 		vkCreateSemaphore(device, &semaphoreInfo, allocationCallbacks, &renderCompleted[i]);
 		SetResourceName(VK_OBJECT_TYPE_SEMAPHORE, (U64)renderCompleted[i], "render_completed_semaphore");
-
-		vkCreateSemaphore(device, &semaphoreInfo, allocationCallbacks, &transferCompleted[i]);
-		SetResourceName(VK_OBJECT_TYPE_SEMAPHORE, (U64)transferCompleted[i], "transfer_complete_semaphore");
 	}
 
+	vkCreateSemaphore(device, &semaphoreInfo, allocationCallbacks, &transferCompleted);
+	SetResourceName(VK_OBJECT_TYPE_SEMAPHORE, (U64)transferCompleted, "transfer_complete_semaphore");
+
 	commandBufferRing.Create();
 
-	stagingBuffer = CreateBuffer(Megabytes(512), BUFFER_USAGE_TRANSFER_SRC, BUFFER_MEMORY_TYPE_CPU_VISIBLE | BUFFER_MEMORY_TYPE_CPU_COHERENT, "renderer_staging_buffer");
+	stagingBuffers[0] = CreateBuffer(Megabytes(256), BUFFER_USAGE_TRANSFER_SRC, BUFFER_MEMORY_TYPE_CPU_VISIBLE | BUFFER_MEMORY_TYPE_CPU_COHERENT, "renderer_staging_buffer_0");
+	stagingBuffers[1] = CreateBuffer(Megabytes(256), BUFFER_USAGE_TRANSFER_SRC, BUFFER_MEMORY_TYPE_CPU_VISIBLE | BUFFER_MEMORY_TYPE_CPU_COHERENT, "renderer_staging_buffer_1");
 	materialBuffer = CreateBuffer(Megabytes(128), BUFFER_USAGE_STORAGE_BUFFER | BUFFER_USAGE_TRANSFER_DST, BUFFER_MEMORY_TYPE_GPU_LOCAL, "renderer_material_buffer");
 	globalsBuffer = CreateBuffer(sizeof(GlobalData), BUFFER_USAGE_STORAGE_BUFFER | BUFFER_USAGE_TRANSFER_DST, BUFFER_MEMORY_TYPE_GPU_LOCAL, "renderer_globals_buffer");
 
@@ -667,8 +677,13 @@ void Renderer::InitialSubmit()
 
 bool Renderer::BeginFrame()
 {
+	WaitForFrame();
+
 	if (!currentScene) { return false; }
 
+	// SubmitFrame only flags a stale swapchain, recreating it touches the scene and the render area so it happens here
+	if (resized) { Resize(); }
+
 	VkResult result = swapchain.Update();
 	if (result == VK_ERROR_OUT_OF_DATE_KHR) { Resize(); }
 	else if (result == VK_NOT_READY) { return false; }
@@ -680,37 +695,52 @@ bool Renderer::BeginFrame()
 		return false;
 	}
 
-	VkSemaphore waits[]{ renderCompleted[previousFrame], transferCompleted[previousFrame] };
-	U64 waitValues[]{ renderWaitValues[previousFrame], transferWaitValues[previousFrame] };
+	return true;
+}
+
+void Renderer::EndFrame()
+{
+	ExtractFrame();
+	SubmitFrame();
+}
+
+// The snapshot point, game state is copied into the current upload slot here on the main thread with no SubmitFrame in flight
+// After this the frame only needs render state that changes in BeginFrame or LoadScene, both of which wait for the job first
+void Renderer::ExtractFrame()
+{
+	currentScene->Update();
+	Resources::Update();
+
+	SubmitTransfer();
+	transferWaitValues[frameIndex] = transferValue;
+
+	++absoluteFrame;
+}
+
+// Waits for the last frame, records, submits and presents this one, when pipelined this runs on a job while the next frame simulates
+// previousFrame, renderWaitValues, the draw command buffers and the descriptor pools belong to this function, nothing on the main thread touches them
+void Renderer::SubmitFrame()
+{
+	VkSemaphore frameWaits[]{ renderCompleted[previousFrame], transferCompleted };
+	U64 frameWaitValues[]{ renderWaitValues[previousFrame], transferWaitValues[previousFrame] };
 
 	VkSemaphoreWaitInfo waitInfo{ VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO };
 	waitInfo.pNext = nullptr;
 	waitInfo.flags = 0;
-	waitInfo.semaphoreCount = CountOf32(waits);
-	waitInfo.pSemaphores = waits;
-	waitInfo.pValues = waitValues;
+	waitInfo.semaphoreCount = CountOf32(frameWaits);
+	waitInfo.pSemaphores = frameWaits;
+	waitInfo.pValues = frameWaitValues;
 
 	vkWaitSemaphores(device, &waitInfo, U64_MAX);
 
 	commandBufferRing.ResetDraw(previousFrame);
-	commandBufferRing.ResetPool(previousFrame);
 	VkValidateF(vkResetDescriptorPool(device, descriptorPools[previousFrame], 0));
 
-	stagingBuffer.allocationOffset = 0;
-
-	return true;
-}
-
-void Renderer::EndFrame()
-{
-	currentScene->Update();
-	Resources::Update();
-	SubmitTransfer();
-	VkCommandBuffer frameCB = Record();
+	VkCommandBuffer commandBuffer = Record();
 
 	++renderWaitValues[frameIndex];
 
-	VkSemaphore waits[]{ transferCompleted[frameIndex], imageAcquired };
+	VkSemaphore waits[]{ transferCompleted, imageAcquired };
 	U64 waitValues[]{ transferWaitValues[frameIndex], 1 };
 
 	VkSemaphore signals[]{ renderCompleted[frameIndex], presentReady[frameIndex] };
@@ -730,48 +760,80 @@ void Renderer::EndFrame()
 	submitInfo.pWaitSemaphores = waits;
 	submitInfo.pWaitDstStageMask = submitStageMasks;
 	submitInfo.commandBufferCount = 1u;
-	submitInfo.pCommandBuffers = &frameCB;
+	submitInfo.pCommandBuffers = &commandBuffer;
 	submitInfo.signalSemaphoreCount = CountOf32(signals);
 	submitInfo.pSignalSemaphores = signals;
 
+	// The main thread can still submit transfers while this runs on a job if it runs out of staging memory
+	queueLock.Lock();
 	VkValidate(vkQueueSubmit(renderQueue, 1u, &submitInfo, nullptr));
-	commandBuffers[frameIndex].Clear();
-
-	previousFrame = frameIndex;
 	VkResult result = swapchain.Present(renderQueue, frameIndex, 1, &presentReady[frameIndex]);
+	lastRenderSemaphore = renderCompleted[frameIndex];
+	lastRenderValue = renderWaitValues[frameIndex];
+	queueLock.Unlock();
 
-	if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) { Resize(); }
+	if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) { resized = true; }
 
-	++absoluteFrame;
+	previousFrame = frameIndex;
+}
+
+void Renderer::WaitForFrame()
+{
+	Jobs::WaitFor(frameJob);
+	frameJob = {};
 }
 
 void Renderer::SubmitTransfer()
 {
-	if (commandBuffers[frameIndex].Size())
+	if (commandBuffers[uploadIndex].Size())
 	{
-		++transferWaitValues[frameIndex];
+		++transferValue;
+
+		VkPipelineStageFlags waitStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
 
 		VkTimelineSemaphoreSubmitInfo timelineInfo{ VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO };
 		timelineInfo.pNext = nullptr;
-		timelineInfo.waitSemaphoreValueCount = 0;
-		timelineInfo.pWaitSemaphoreValues = nullptr;
 		timelineInfo.signalSemaphoreValueCount = 1;
-		timelineInfo.pSignalSemaphoreValues = &transferWaitValues[frameIndex];
+		timelineInfo.pSignalSemaphoreValues = &transferValue;
 
 		VkSubmitInfo submitInfo{ VK_STRUCTURE_TYPE_SUBMIT_INFO };
 		submitInfo.pNext = &timelineInfo;
-		submitInfo.waitSemaphoreCount = 0;
-		submitInfo.pWaitSemaphores = nullptr;
-		submitInfo.pWaitDstStageMask = nullptr;
-		submitInfo.commandBufferCount = (U32)commandBuffers[frameIndex].Size();
-		submitInfo.pCommandBuffers = commandBuffers[frameIndex].Data();
+		submitInfo.pWaitDstStageMask = &waitStageMask;
+		submitInfo.commandBufferCount = (U32)commandBuffers[uploadIndex].Size();
+		submitInfo.pCommandBuffers = commandBuffers[uploadIndex].Data();
 		submitInfo.signalSemaphoreCount = 1;
-		submitInfo.pSignalSemaphores = &transferCompleted[frameIndex];
+		submitInfo.pSignalSemaphores = &transferCompleted;
+
+		queueLock.Lock();
+
+		// The CPU no longer waits for the last frame before extracting, so the copies wait on the GPU instead of overwriting buffers it may still be reading
+		VkSemaphore renderSemaphore = lastRenderSemaphore;
+		U64 renderValue = lastRenderValue;
+		timelineInfo.waitSemaphoreValueCount = renderSemaphore ? 1 : 0;
+		timelineInfo.pWaitSemaphoreValues = &renderValue;
+		submitInfo.waitSemaphoreCount = renderSemaphore ? 1 : 0;
+		submitInfo.pWaitSemaphores = &renderSemaphore;
 
 		VkValidateF(vkQueueSubmit(renderQueue, 1, &submitInfo, nullptr)); //TODO: use transfer queue
-		commandBuffers[frameIndex].Clear();
+		queueLock.Unlock();
+
+		commandBuffers[uploadIndex].Clear();
+		uploadWaitValues[uploadIndex] = transferValue;
+
+		// The GPU reads this slot's staging memory and command buffers until the transfer completes, so keep writing into the other one
+		uploadIndex = (uploadIndex + 1) % MAX_UPLOAD_SLOTS;
 
-		stagingBuffer.allocationOffset = 0;
+		VkSemaphoreWaitInfo waitInfo{ VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO };
+		waitInfo.pNext = nullptr;
+		waitInfo.flags = 0;
+		waitInfo.semaphoreCount = 1;
+		waitInfo.pSemaphores = &transferCompleted;
+		waitInfo.pValues = &uploadWaitValues[uploadIndex];
+
+		vkWaitSemaphores(device, &waitInfo, U64_MAX);
+
+		commandBufferRing.ResetPool(uploadIndex);
+		stagingBuffers[uploadIndex].allocationOffset = 0;
 	}
 }
 
@@ -825,6 +887,7 @@ void Renderer::Resize()
 	vkDeviceWaitIdle(device);
 
 	Platform::resized = false;
+	resized = false;
 }
 
 void Renderer::SetRenderArea()
@@ -856,6 +919,9 @@ void Renderer::SetRenderArea()
 
 void Renderer::LoadScene(Scene* scene)
 {
+	// Swapping scenes rebuilds the pipelines and renderpasses the frame job records from
+	WaitForFrame();
+
 	if (currentScene)
 	{
 		currentScene->Unload();
@@ -1005,58 +1071,49 @@ void Renderer::FillBuffer(Buffer& buffer, U64 size, const void* data, U32 region
 {
 	VkBufferMemoryBarrier2 memoryBarrier = BufferBarrier(buffer.vkBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_MEMORY_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_MEMORY_READ_BIT);
 
-	if (stagingBuffer.allocationOffset + size > stagingBuffer.size)
+	if (stagingBuffers[uploadIndex].allocationOffset + size > stagingBuffers[uploadIndex].size)
 	{
 		Logger::Warn("Out Of Staging Memory!");
 		Renderer::SubmitTransfer();
-
-		VkSemaphoreWaitInfo waitInfo{ VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO };
-		waitInfo.pNext = nullptr;
-		waitInfo.flags = 0;
-		waitInfo.semaphoreCount = 1;
-		waitInfo.pSemaphores = &transferCompleted[frameIndex];
-		waitInfo.pValues = &transferWaitValues[previousFrame];
-
-		vkWaitSemaphores(device, &waitInfo, U64_MAX);
 	}
 
-	Copy((U8*)stagingBuffer.data + stagingBuffer.allocationOffset, (U8*)data, size);
+	Copy((U8*)stagingBuffers[uploadIndex].data + stagingBuffers[uploadIndex].allocationOffset, (U8*)data, size);
 	for (U32 i = 0; i < regionCount; ++i)
 	{
 		if (regions[i].srcOffset + regions[i].size > size) { Logger::Error("Trying To Upload Data Outside Of Source Buffer Range!"); BreakPoint; }
 		if (regions[i].dstOffset + regions[i].size > buffer.size) { Logger::Error("Trying To Upload Data Outside Of Destination Buffer Range!"); BreakPoint; }
-		regions[i].srcOffset += stagingBuffer.allocationOffset;
+		regions[i].srcOffset += stagingBuffers[uploadIndex].allocationOffset;
 	}
 
-	CommandBuffer* commandBuffer = commandBufferRing.GetWriteCommandBuffer(frameIndex);
+	CommandBuffer* commandBuffer = commandBufferRing.GetWriteCommandBuffer(uploadIndex);
 
 	commandBuffer->Begin();
-	commandBuffer->BufferToBuffer(stagingBuffer, buffer, regionCount, regions);
+	commandBuffer->BufferToBuffer(stagingBuffers[uploadIndex], buffer, regionCount, regions);
 	commandBuffer->PipelineBarrier(0, 1, &memoryBarrier, 0, nullptr);
 	commandBuffer->End();
 
-	commandBuffers[frameIndex].Push(commandBuffer->vkCommandBuffer);
+	commandBuffers[uploadIndex].Push(commandBuffer->vkCommandBuffer);
 
 	for (U32 i = 0; i < regionCount; ++i)
 	{
-		regions[i].srcOffset -= stagingBuffer.allocationOffset; //TODO: Better way to do this
+		regions[i].srcOffset -= stagingBuffers[uploadIndex].allocationOffset; //TODO: Better way to do this
 	}
 
-	stagingBuffer.allocationOffset += size;
+	stagingBuffers[uploadIndex].allocationOffset += size;
 }
 
 void Renderer::FillBuffer(Buffer& buffer, const Buffer& stagingBuffer, U32 regionCount, VkBufferCopy* regions)
 {
 	VkBufferMemoryBarrier2 memoryBarrier = BufferBarrier(buffer.vkBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_MEMORY_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_MEMORY_READ_BIT);
 
-	CommandBuffer* commandBuffer = commandBufferRing.GetWriteCommandBuffer(frameIndex);
+	CommandBuffer* commandBuffer = commandBufferRing.GetWriteCommandBuffer(uploadIndex);
 
 	commandBuffer->Begin();
 	commandBuffer->BufferToBuffer(stagingBuffer, buffer, regionCount, regions);
 	commandBuffer->PipelineBarrier(0, 1, &memoryBarrier, 0, nullptr);
 	commandBuffer->End();
 
-	commandBuffers[frameIndex].Push(commandBuffer->vkCommandBuffer);
+	commandBuffers[uploadIndex].Push(commandBuffer->vkCommandBuffer);
 }
 
 U64 Renderer::UploadToBuffer(Buffer& buffer, U64 size, const void* data)
@@ -1171,26 +1228,17 @@ bool Renderer::CreateTexture(Texture* texture, void* data)
 
 	if (data)
 	{
-		stagingBuffer.allocationOffset = NextMultipleOf(stagingBuffer.allocationOffset, 16);
-		if (stagingBuffer.allocationOffset + texture->size > stagingBuffer.size)
+		stagingBuffers[uploadIndex].allocationOffset = NextMultipleOf(stagingBuffers[uploadIndex].allocationOffset, 16);
+		if (stagingBuffers[uploadIndex].allocationOffset + texture->size > stagingBuffers[uploadIndex].size)
 		{
 			Logger::Warn("Out Of Staging Memory!");
 			Renderer::SubmitTransfer();
-
-			VkSemaphoreWaitInfo waitInfo{ VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO };
-			waitInfo.pNext = nullptr;
-			waitInfo.flags = 0;
-			waitInfo.semaphoreCount = 1;
-			waitInfo.pSemaphores = &transferCompleted[frameIndex];
-			waitInfo.pValues = &transferWaitValues[previousFrame];
-
-			vkWaitSemaphores(device, &waitInfo, U64_MAX);
 		}
 
-		Copy((U8*)stagingBuffer.data + stagingBuffer.allocationOffset, (U8*)data, texture->size);
+		Copy((U8*)stagingBuffers[uploadIndex].data + stagingBuffers[uploadIndex].allocationOffset, (U8*)data, texture->size);
 
 		VkBufferImageCopy region{};
-		region.bufferOffset = stagingBuffer.allocationOffset;
+		region.bufferOffset = stagingBuffers[uploadIndex].allocationOffset;
 		region.bufferRowLength = 0;
 		region.bufferImageHeight = 0;
 
@@ -1202,17 +1250,17 @@ bool Renderer::CreateTexture(Texture* texture, void* data)
 		region.imageOffset = { 0, 0, 0 };
 		region.imageExtent = { texture->width, texture->height, texture->depth };
 
-		stagingBuffer.allocationOffset += texture->size;
+		stagingBuffers[uploadIndex].allocationOffset += texture->size;
 
 		VkImageMemoryBarrier2 copyBarrier = ImageBarrier(texture->image, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, VK_IMAGE_LAYOUT_UNDEFINED,
 			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT, 0, 1);
 		VkImageMemoryBarrier2 mipBarrier = ImageBarrier(texture->image, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
 			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT, 0, 1);
 
-		CommandBuffer* commandBuffer = commandBufferRing.GetWriteCommandBuffer(frameIndex);
+		CommandBuffer* commandBuffer = commandBufferRing.GetWriteCommandBuffer(uploadIndex);
 		commandBuffer->Begin();
 		commandBuffer->PipelineBarrier(0, 0, nullptr, 1, &copyBarrier);
-		commandBuffer->BufferToImage(stagingBuffer, texture, 1, &region);
+		commandBuffer->BufferToImage(stagingBuffers[uploadIndex], texture, 1, &region);
 		commandBuffer->PipelineBarrier(0, 0, nullptr, 1, &mipBarrier);
 
 		info.subresourceRange.levelCount = 1;
@@ -1276,7 +1324,7 @@ bool Renderer::CreateTexture(Texture* texture, void* data)
 		commandBuffer->PipelineBarrier(0, 0, nullptr, 1, &finalBarrier);
 		commandBuffer->End();
 
-		commandBuffers[frameIndex].Push(commandBuffer->vkCommandBuffer);
+		commandBuffers[uploadIndex].Push(commandBuffer->vkCommandBuffer);
 
 		texture->imageLayout = finalBarrier.newLayout;
 	}
@@ -1347,28 +1395,19 @@ bool Renderer::CreateCubemap(Texture* texture, void* data, U32* layerSizes)
 
 	SetResourceName(VK_OBJECT_TYPE_IMAGE, (U64)texture->image, texture->Name());
 
-	stagingBuffer.allocationOffset = NextMultipleOf(stagingBuffer.allocationOffset, 16);
-	if (stagingBuffer.allocationOffset + texture->size > stagingBuffer.size)
+	stagingBuffers[uploadIndex].allocationOffset = NextMultipleOf(stagingBuffers[uploadIndex].allocationOffset, 16);
+	if (stagingBuffers[uploadIndex].allocationOffset + texture->size > stagingBuffers[uploadIndex].size)
 	{
 		Logger::Warn("Out Of Staging Memory!");
 		Renderer::SubmitTransfer();
-
-		VkSemaphoreWaitInfo waitInfo{ VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO };
-		waitInfo.pNext = nullptr;
-		waitInfo.flags = 0;
-		waitInfo.semaphoreCount = 1;
-		waitInfo.pSemaphores = &transferCompleted[frameIndex];
-		waitInfo.pValues = &transferWaitValues[previousFrame];
-
-		vkWaitSemaphores(device, &waitInfo, U64_MAX);
 	}
 
-	Copy((U8*)stagingBuffer.data + stagingBuffer.allocationOffset, (U8*)data, texture->size);
+	Copy((U8*)stagingBuffers[uploadIndex].data + stagingBuffers[uploadIndex].allocationOffset, (U8*)data, texture->size);
 
 	VkBufferImageCopy bufferCopyRegions[6 * 14];
 	U32 regionCount = 0;
-	U64 offset = stagingBuffer.allocationOffset;
-	stagingBuffer.allocationOffset += texture->size;
+	U64 offset = stagingBuffers[uploadIndex].allocationOffset;
+	stagingBuffers[uploadIndex].allocationOffset += texture->size;
 
 	for (U32 level = 0; level < texture->mipmapCount; ++level)
 	{
@@ -1393,14 +1432,14 @@ bool Renderer::CreateCubemap(Texture* texture, void* data, U32* layerSizes)
 	VkImageMemoryBarrier2 finalBarrier = ImageBarrier(texture->image, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
 		VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT, 0, texture->mipmapCount, 6);
 
-	CommandBuffer* commandBuffer = commandBufferRing.GetWriteCommandBuffer(frameIndex);
+	CommandBuffer* commandBuffer = commandBufferRing.GetWriteCommandBuffer(uploadIndex);
 	commandBuffer->Begin();
 	commandBuffer->PipelineBarrier(0, 0, nullptr, 1, &copyBarrier);
-	commandBuffer->BufferToImage(stagingBuffer, texture, regionCount, bufferCopyRegions);
+	commandBuffer->BufferToImage(stagingBuffers[uploadIndex], texture, regionCount, bufferCopyRegions);
 	commandBuffer->PipelineBarrier(0, 0, nullptr, 1, &finalBarrier);
 	commandBuffer->End();
 
-	commandBuffers[frameIndex].Push(commandBuffer->vkCommandBuffer);
+	commandBuffers[uploadIndex].Push(commandBuffer->vkCommandBuffer);
 
 	texture->imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
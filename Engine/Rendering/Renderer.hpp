@@ -8,6 +8,8 @@
 
 #include "Containers\Vector.hpp"
 #include "Containers\Freelist.hpp"
+#include "Platform\ThreadSafety.hpp"
+#include "Platform\Jobs.hpp"
 
 struct Scene;
 struct VkImage_T;
@@ -40,10 +42,10 @@ struct CommandBufferRing
 
 	void							ResetDrawPool();
 	void							ResetDraw(U32 frameIndex);
-	void							ResetPool(U32 frameIndex);
+	void							ResetPool(U32 poolIndex);
 
 	CommandBuffer*					GetDrawCommandBuffer(U32 frameIndex);
-	CommandBuffer*					GetWriteCommandBuffer(U32 frameIndex);
+	CommandBuffer*					GetWriteCommandBuffer(U32 poolIndex);
 
 	static constexpr U16			maxPools = MAX_SWAPCHAIN_IMAGES;
 	static constexpr U16			buffersPerPool = 128;
@@ -112,6 +114,9 @@ private:
 	static void							InitialSubmit();
 	static bool							BeginFrame();
 	static void							EndFrame();
+	static void							ExtractFrame();
+	static void							SubmitFrame();
+	static void							WaitForFrame();
 	static void							SubmitTransfer();
 	static VkCommandBuffer_T*			Record();
 	static void							Resize();
@@ -166,8 +171,9 @@ private:
 	static Scene*								currentScene;
 	static VmaAllocator_T*						allocator;
 	static CommandBufferRing					commandBufferRing;
-	static Vector<VkCommandBuffer_T*>			commandBuffers[MAX_SWAPCHAIN_IMAGES];
-	static Buffer								stagingBuffer;
+	static Vector<VkCommandBuffer_T*>			commandBuffers[MAX_UPLOAD_SLOTS];
+	static Buffer								stagingBuffers[MAX_UPLOAD_SLOTS];
+	static U32									uploadIndex;
 	static Buffer								materialBuffer;
 	static Buffer								globalsBuffer;
 	static ShadowData							shadowData;
@@ -181,9 +187,15 @@ private:
 	static VkSemaphore_T*						imageAcquired;
 	static VkSemaphore_T*						presentReady[MAX_SWAPCHAIN_IMAGES];
 	static VkSemaphore_T*						renderCompleted[MAX_SWAPCHAIN_IMAGES];
-	static VkSemaphore_T*						transferCompleted[MAX_SWAPCHAIN_IMAGES];
+	static VkSemaphore_T*						transferCompleted;
 	static U64									renderWaitValues[MAX_SWAPCHAIN_IMAGES];
 	static U64									transferWaitValues[MAX_SWAPCHAIN_IMAGES];
+	static U64									uploadWaitValues[MAX_UPLOAD_SLOTS];
+	static U64									transferValue;
+	static VkSemaphore_T*						lastRenderSemaphore;
+	static U64									lastRenderValue;
+	static SpinLock								queueLock;
+	static JobHandle							frameJob;
 
 	// DEBUG
 	static VkDebugUtilsMessengerEXT_T*			debugMessenger;
@@ -6,6 +6,7 @@
 #include "Resources\Resources.hpp"
 #include "Resources\Scene.hpp"
 #include "Platform\Input.hpp"
+#include "Math\Physics.hpp"
 
 TilemapComponent::TilemapComponent(U16 width, U16 height, Vector2 tileSize) : width(width), height(height), tileSize(tileSize * 8.0f)
 {
@@ -28,6 +29,8 @@ TilemapComponent::TilemapComponent(U16 width, U16 height, Vector2 tileSize) : wi
 	staging.allocationOffset += width * height * sizeof(U8);
 
 	Renderer::FillBuffer(tiles, staging, 1, &copy);
+
+	collision.Create(width, height);
 }
 
 //void TilemapComponent::Update(Scene* scene)
@@ -82,8 +85,10 @@ Vector2Int TilemapComponent::MouseToTilemap(const Camera& camera) const
 	return Vector2Int{ (((Input::MousePosition() - area.xy()) * camera.Zoom() + cameraPos) / tileSize) * (1920.0f / area.z) };
 }
 
-U8 TilemapComponent::AddTile(const ResourceRef<Texture>& texture)
+U8 TilemapComponent::AddTile(const ResourceRef<Texture>& texture, bool solid)
 {
+	solidTiles[tileCount] = solid;
+
 	*(U16*)((U8*)staging.data + staging.allocationOffset) = (U16)texture->Handle();
 
 	VkBufferCopy copy{};
@@ -102,6 +107,8 @@ void TilemapComponent::ChangeTile(const Vector2Int& pos, U8 id)
 {
 	if ((U32)pos.x >= width || (U32)pos.y >= height) { return; }
 
+	collision.SetSolid(pos.x, pos.y, id != U8_MAX && solidTiles[id]);
+
 	*((U8*)staging.data + staging.allocationOffset) = id;
 
 	VkBufferCopy copy{};
@@ -110,4 +117,273 @@ void TilemapComponent::ChangeTile(const Vector2Int& pos, U8 id)
 	copy.srcOffset = staging.allocationOffset;
 
 	Renderer::FillBuffer(tiles, staging, 1, &copy);
-}
\ No newline at end of file
+}
+
+void TilemapComponent::EnableCollision(const Vector2& origin, const Vector2& worldTileSize, const ShapeDef& shapeDef)
+{
+	collision.Enable(origin, worldTileSize, shapeDef);
+}
+
+void TilemapComponent::DisableCollision()
+{
+	collision.Disable();
+}
+
+//TILEMAP COLLISION
+
+void TilemapCollision::Create(U32 width, U32 height)
+{
+	this->width = width;
+	this->height = height;
+	solid.Clear();
+	solid.Resize((U64)width * height, 0);
+}
+
+void TilemapCollision::Destroy()
+{
+	Disable();
+
+	solid.Destroy();
+	for (Vector<I32>& chains : chunkChains) { chains.Destroy(); }
+	chunkChains.Destroy();
+}
+
+void TilemapCollision::SetSolid(I32 x, I32 y, bool isSolid)
+{
+	if ((U32)x >= width || (U32)y >= height) { return; }
+
+	U8& tile = solid[x + y * width];
+	if (tile == (U8)isSolid) { return; }
+	tile = isSolid;
+
+	if (!enabled) { return; }
+
+	// A tile changes the edges of its neighbors and how edges join at its corners, rebuild every chunk that owns one of them
+	I32 chunkX0 = Math::Max(x - 1, 0) / ChunkSize;
+	I32 chunkX1 = Math::Min(x + 1, (I32)width - 1) / ChunkSize;
+	I32 chunkY0 = Math::Max(y - 1, 0) / ChunkSize;
+	I32 chunkY1 = Math::Min(y + 1, (I32)height - 1) / ChunkSize;
+
+	for (I32 chunkY = chunkY0; chunkY <= chunkY1; ++chunkY)
+	{
+		for (I32 chunkX = chunkX0; chunkX <= chunkX1; ++chunkX)
+		{
+			BuildChunk(chunkX, chunkY);
+		}
+	}
+}
+
+void TilemapCollision::Enable(const Vector2& origin, const Vector2& tileSize, const ShapeDef& shapeDef)
+{
+	Disable();
+
+	if (bodyId == NullIndex)
+	{
+		RigidBody2DDef bodyDef{};
+		bodyDef.type = BODY_TYPE_STATIC;
+		bodyDef.position = origin;
+
+		bodyId = Physics::CreateRigidBody(bodyDef);
+	}
+	else { Physics::GetRigidBody(bodyId).SetTransform(origin, Quaternion2Identity); }
+
+	enabled = true;
+	this->shapeDef = shapeDef;
+	this->tileSize = tileSize;
+	chunksX = ((I32)width + ChunkSize - 1) / ChunkSize;
+	chunksY = ((I32)height + ChunkSize - 1) / ChunkSize;
+
+	while (chunkChains.Size() < (U64)(chunksX * chunksY)) { chunkChains.Push({}); }
+
+	for (I32 chunkY = 0; chunkY < chunksY; ++chunkY)
+	{
+		for (I32 chunkX = 0; chunkX < chunksX; ++chunkX)
+		{
+			BuildChunk(chunkX, chunkY);
+		}
+	}
+}
+
+void TilemapCollision::Disable()
+{
+	if (!enabled) { return; }
+
+	RigidBody2D& body = Physics::GetRigidBody(bodyId);
+
+	for (Vector<I32>& chains : chunkChains)
+	{
+		for (I32 chainId : chains) { body.DestroyChain(chainId); }
+		chains.Clear();
+	}
+
+	enabled = false;
+}
+
+bool TilemapCollision::Enabled() const
+{
+	return enabled;
+}
+
+/*
+* Collision edges run along tile sides between vertex (i, j), the top left corner of tile (i, j), and its neighbor in a direction:
+* 0 is +x, 1 is up (-j), 2 is -x and 3 is down (+j), tile rows go down but world y goes up. Edges keep the solid tile on their
+* left so outlines wind counter-clockwise in world space, which puts the one-sided chain segments' collision outside the walls
+*/
+
+static constexpr I32 DirectionX[4]{ 1, 0, -1, 0 };
+static constexpr I32 DirectionY[4]{ 0, -1, 0, 1 };
+
+bool TilemapCollision::Solid(I32 x, I32 y) const
+{
+	if ((U32)x >= width || (U32)y >= height) { return false; }
+
+	return solid[x + y * width];
+}
+
+bool TilemapCollision::HasEdge(I32 i, I32 j, I32 direction) const
+{
+	switch (direction)
+	{
+	case 0: return Solid(i, j - 1) && !Solid(i, j);
+	case 1: return Solid(i - 1, j - 1) && !Solid(i, j - 1);
+	case 2: return Solid(i - 1, j) && !Solid(i - 1, j - 1);
+	case 3: return Solid(i, j) && !Solid(i - 1, j);
+	default: return false;
+	}
+}
+
+I32 TilemapCollision::NextDirection(I32 i, I32 j, I32 direction) const
+{
+	// Turning left first keeps tiles that only touch diagonally as separate outlines
+	I32 left = (direction + 1) & 3;
+	if (HasEdge(i, j, left)) { return left; }
+	if (HasEdge(i, j, direction)) { return direction; }
+	return (direction + 3) & 3;
+}
+
+I32 TilemapCollision::PrevDirection(I32 i, I32 j, I32 direction) const
+{
+	I32 candidates[3]{ (direction + 3) & 3, direction, (direction + 1) & 3 };
+
+	for (I32 previous : candidates)
+	{
+		I32 startI = i - DirectionX[previous];
+		I32 startJ = j - DirectionY[previous];
+		if (HasEdge(startI, startJ, previous) && NextDirection(i, j, previous) == direction) { return previous; }
+	}
+
+	return NullIndex;
+}
+
+void TilemapCollision::BuildChunk(I32 chunkX, I32 chunkY)
+{
+	static constexpr I32 Stride = ChunkSize + 1;
+	static constexpr U8 EdgeOwned = 1;
+	static constexpr U8 EdgeVisited = 2;
+
+	RigidBody2D& body = Physics::GetRigidBody(bodyId);
+	Vector<I32>& chains = chunkChains[chunkX + chunkY * chunksX];
+
+	for (I32 chainId : chains) { body.DestroyChain(chainId); }
+	chains.Clear();
+
+	I32 x0 = chunkX * ChunkSize;
+	I32 y0 = chunkY * ChunkSize;
+	I32 x1 = Math::Min(x0 + ChunkSize, (I32)width);
+	I32 y1 = Math::Min(y0 + ChunkSize, (I32)height);
+
+	// Edges belong to the chunk of the solid tile they border, indexed by their start vertex relative to the chunk
+	U8 edges[Stride * Stride * 4]{};
+
+	auto EdgeIndex = [&](I32 i, I32 j, I32 direction) { return ((j - y0) * Stride + (i - x0)) * 4 + direction; };
+	auto Owned = [&](I32 i, I32 j, I32 direction) {
+		I32 x = i - (direction == 1 || direction == 2);
+		I32 y = j - (direction == 0 || direction == 1);
+		return x >= x0 && x < x1 && y >= y0 && y < y1 && HasEdge(i, j, direction);
+	};
+
+	for (I32 y = y0; y < y1; ++y)
+	{
+		for (I32 x = x0; x < x1; ++x)
+		{
+			if (!Solid(x, y)) { continue; }
+
+			if (!Solid(x, y + 1)) { edges[EdgeIndex(x, y + 1, 0)] = EdgeOwned; }
+			if (!Solid(x + 1, y)) { edges[EdgeIndex(x + 1, y + 1, 1)] = EdgeOwned; }
+			if (!Solid(x, y - 1)) { edges[EdgeIndex(x + 1, y, 2)] = EdgeOwned; }
+			if (!Solid(x - 1, y)) { edges[EdgeIndex(x, y, 3)] = EdgeOwned; }
+		}
+	}
+
+	Vector<Vector2> points;
+
+	auto Point = [&](I32 i, I32 j) { return Vector2{ i * tileSize.x, -j * tileSize.y }; };
+
+	// Walks the outline from an edge, straight runs of edges collapse into one segment, stops at the chunk border or back at the start
+	auto Trace = [&](I32 i, I32 j, I32 direction) {
+		I32 startI = i, startJ = j, startDirection = direction;
+
+		points.Push(Point(i, j));
+
+		while (true)
+		{
+			edges[EdgeIndex(i, j, direction)] = EdgeVisited;
+
+			i += DirectionX[direction];
+			j += DirectionY[direction];
+			I32 next = NextDirection(i, j, direction);
+
+			if (i == startI && j == startJ && next == startDirection) { return true; }
+			if (!Owned(i, j, next))
+			{
+				points.Push(Point(i, j));
+				points.Push(Point(i + DirectionX[next], j + DirectionY[next]));
+				return false;
+			}
+
+			if (next != direction) { points.Push(Point(i, j)); }
+			direction = next;
+		}
+	};
+
+	// Outlines that cross the chunk border become open chains, their ghost vertices come from the neighboring chunk's
+	// edges so bodies crossing the seam see one smooth surface
+	for (I32 j = y0; j <= y1; ++j)
+	{
+		for (I32 i = x0; i <= x1; ++i)
+		{
+			for (I32 direction = 0; direction < 4; ++direction)
+			{
+				if (edges[EdgeIndex(i, j, direction)] != EdgeOwned) { continue; }
+
+				I32 previous = PrevDirection(i, j, direction);
+				if (Owned(i - DirectionX[previous], j - DirectionY[previous], previous)) { continue; }
+
+				points.Clear();
+				points.Push(Point(i - DirectionX[previous], j - DirectionY[previous]));
+				Trace(i, j, direction);
+
+				chains.Push(body.AddChain(shapeDef, points.Data(), (I32)points.Size(), false));
+			}
+		}
+	}
+
+	// Whatever is left are outlines closed within the chunk, start them on a corner so the first point isn't mid-run
+	for (I32 j = y0; j <= y1; ++j)
+	{
+		for (I32 i = x0; i <= x1; ++i)
+		{
+			for (I32 direction = 0; direction < 4; ++direction)
+			{
+				if (edges[EdgeIndex(i, j, direction)] != EdgeOwned || PrevDirection(i, j, direction) == direction) { continue; }
+
+				points.Clear();
+				Trace(i, j, direction);
+
+				chains.Push(body.AddChain(shapeDef, points.Data(), (I32)points.Size(), true));
+			}
+		}
+	}
+
+	points.Destroy();
+}
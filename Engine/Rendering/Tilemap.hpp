@@ -2,6 +2,7 @@
 
 #include "Resources\Mesh.hpp"
 #include "Resources\Scene.hpp"
+#include "Math\PhysicsDefines.hpp"
 
 struct alignas(16) NH_API TilemapData
 {
@@ -11,18 +12,88 @@ struct alignas(16) NH_API TilemapData
 	U32 height;
 };
 
+/*
+* Collision for a tilemap, the outlines of solid tiles are traced into chains on one static body, each chunk owns its own chains
+* Only the CPU side lives here so it can be built and rebuilt without a renderer
+*/
+struct NH_API TilemapCollision
+{
+	void Create(U32 width, U32 height);
+	void Destroy();
+
+	/// <summary>
+	/// Marks a tile solid or empty, if collision is enabled and the tile's solidity changed only the chunks around it are rebuilt
+	/// </summary>
+	void SetSolid(I32 x, I32 y, bool isSolid);
+
+	/// <summary>
+	/// Traces every chunk onto the static body, the body is created the first time and reused after that
+	/// </summary>
+	/// <param name="origin:">The world position of the top left corner of tile (0, 0)</param>
+	/// <param name="tileSize:">The size of a tile in world units</param>
+	void Enable(const Vector2& origin, const Vector2& tileSize, const ShapeDef& shapeDef);
+
+	/// <summary>
+	/// Destroys every chain, the empty body is kept for the next Enable since bodies can't be destroyed yet
+	/// </summary>
+	void Disable();
+
+	bool Enabled() const;
+
+private:
+	static constexpr I32 ChunkSize = 32;
+
+	bool Solid(I32 x, I32 y) const;
+	bool HasEdge(I32 i, I32 j, I32 direction) const;
+	I32 NextDirection(I32 i, I32 j, I32 direction) const;
+	I32 PrevDirection(I32 i, I32 j, I32 direction) const;
+	void BuildChunk(I32 chunkX, I32 chunkY);
+
+	U32 width = 0;
+	U32 height = 0;
+	Vector<U8> solid;
+
+	I32 bodyId = NullIndex;
+	bool enabled = false;
+	ShapeDef shapeDef;
+	Vector2 tileSize;
+	I32 chunksX = 0;
+	I32 chunksY = 0;
+	Vector<Vector<I32>> chunkChains;
+
+	friend struct PhysicsTests;
+};
+
 struct Camera;
 
 //TODO: Paralax
-//TODO: Tilemap Collision
 struct NH_API TilemapComponent
 {
 	TilemapComponent(U16 width, U16 height, Vector2 tileSize);
 
 	Vector2Int MouseToTilemap(const Camera& camera) const;
-	U8 AddTile(const ResourceRef<Texture>& texture);
+
+	/// <summary>
+	/// Adds a tile type to the legend
+	/// </summary>
+	/// <param name="solid:">Whether tiles of this type get collision</param>
+	/// <returns>The tile's id</returns>
+	U8 AddTile(const ResourceRef<Texture>& texture, bool solid = true);
+
+	/// <summary>
+	/// Sets a tile, if collision is enabled and the tile's solidity changed only the chunks around it are rebuilt
+	/// </summary>
 	void ChangeTile(const Vector2Int& pos, U8 id);
 
+	/// <summary>
+	/// Builds collision for the solid tiles, the outlines of solid regions are traced into chains on one static body so a map
+	/// costs one proxy per straight run of wall instead of one per tile, and bodies slide across tile seams without catching
+	/// </summary>
+	/// <param name="origin:">The world position of the top left corner of tile (0, 0)</param>
+	/// <param name="worldTileSize:">The size of a tile in world units</param>
+	void EnableCollision(const Vector2& origin, const Vector2& worldTileSize, const ShapeDef& shapeDef = {});
+	void DisableCollision();
+
 private:
 	TilemapData data;
 	Buffer tiles;
@@ -32,4 +103,7 @@ private:
 	Vector2 tileSize;
 	U32 width;
 	U32 height;
+
+	bool solidTiles[256]{};
+	TilemapCollision collision;
 };
\ No newline at end of file
@@ -15,6 +15,7 @@ static constexpr U8 MAX_SPECIALIZATION_CONSTANTS = 8;	// Maximum specialization
 static constexpr U8	MAX_VERTEX_BUFFERS = 8;
 static constexpr U8	MAX_PROGRAM_PASSES = 8;				// Maximum number of passes in a program pass group
 static constexpr U8	MAX_SWAPCHAIN_IMAGES = 3;			// Maximum images a swapchain can support
+static constexpr U8	MAX_UPLOAD_SLOTS = 2;				// Staging buffers and transfer lists the renderer alternates between
 static constexpr U8	MAX_VIEWPORTS = 8;					// Maximum viewports a renderpass can have
 static constexpr U8	MAX_BLOOM_PASSES = 8;				// Maximum renderpasses to calculate bloom
 static constexpr U8	MAX_SCISSORS = 8;					// Maximum scissors a renderpass can have
@@ -43,6 +43,7 @@ void Scene::Create(CameraType cameraType)
 	}
 
 	stagingBuffer = Renderer::CreateBuffer(Megabytes(32), BUFFER_USAGE_TRANSFER_SRC, BUFFER_MEMORY_TYPE_CPU_VISIBLE | BUFFER_MEMORY_TYPE_CPU_COHERENT, name + "_staging_buffer");
+	renderStagingBuffer = Renderer::CreateBuffer(Megabytes(32), BUFFER_USAGE_TRANSFER_SRC, BUFFER_MEMORY_TYPE_CPU_VISIBLE | BUFFER_MEMORY_TYPE_CPU_COHERENT, name + "_render_staging_buffer");
 	entitiesBuffer = Renderer::CreateBuffer(Megabytes(32), BUFFER_USAGE_STORAGE_BUFFER | BUFFER_USAGE_TRANSFER_DST, BUFFER_MEMORY_TYPE_GPU_LOCAL, name + "_entities_buffer");
 	instanceBuffer = Renderer::CreateBuffer(Megabytes(32), BUFFER_USAGE_VERTEX_BUFFER | BUFFER_USAGE_TRANSFER_DST, BUFFER_MEMORY_TYPE_GPU_LOCAL, name + "_instance_buffer");
 	indexBuffer = Renderer::CreateBuffer(Megabytes(64), BUFFER_USAGE_INDEX_BUFFER | BUFFER_USAGE_TRANSFER_DST, BUFFER_MEMORY_TYPE_GPU_LOCAL, name + "_index_buffer");
@@ -73,6 +74,7 @@ void Scene::Destroy()
 	}
 
 	Renderer::DestroyBuffer(stagingBuffer);
+	Renderer::DestroyBuffer(renderStagingBuffer);
 	Renderer::DestroyBuffer(entitiesBuffer);
 	Renderer::DestroyBuffer(instanceBuffer);
 	Renderer::DestroyBuffer(indexBuffer);
@@ -543,6 +545,8 @@ void Scene::Update()
 		drawWrites.Clear();
 	}
 
+	// The copies recorded above read from this buffer until the frame is on the GPU, the next frame writes to the other one
+	Swap(stagingBuffer, renderStagingBuffer);
 	stagingBuffer.allocationOffset = 0;
 }
 
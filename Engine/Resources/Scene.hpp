@@ -250,6 +250,7 @@ private:
 	bool							hasPostProcessing = false;
 
 	Buffer							stagingBuffer;
+	Buffer							renderStagingBuffer;	// The copy the last extracted frame uploads from, swapped with stagingBuffer each frame
 	Buffer							entitiesBuffer;
 	Buffer							vertexBuffers[VERTEX_TYPE_COUNT - 1];
 	Buffer							instanceBuffer;
@@ -13,10 +13,11 @@ typedef __m256 FloatW;
 
 inline static const F256 ZeroF256 = _mm256_setzero_ps();
 inline static const D256 ZeroD256 = _mm256_setzero_pd();
-inline static const D256 ZeroI256 = _mm256_setzero_si256();
+inline static const I256 ZeroI256 = _mm256_setzero_si256();
 inline static const FloatW ZeroFloatW = _mm256_setzero_ps();
 
 static inline FloatW SplatW(F32 scalar) { return _mm256_set1_ps(scalar); }
+static inline FloatW SetW(F32 a, F32 b, F32 c, F32 d, F32 e, F32 f, F32 g, F32 h) { return _mm256_setr_ps(a, b, c, d, e, f, g, h); }
 static inline FloatW operator+(const FloatW& a, const FloatW& b) { return _mm256_add_ps(a, b); }
 static inline FloatW operator-(const FloatW& a, const FloatW& b) { return _mm256_sub_ps(a, b); }
 static inline FloatW operator*(const FloatW& a, const FloatW& b) { return _mm256_mul_ps(a, b); }
@@ -29,16 +30,24 @@ static inline FloatW& operator*=(FloatW& a, const FloatW& b) { a = _mm256_mul_ps
 static inline FloatW& operator/=(FloatW& a, const FloatW& b) { a = _mm256_div_ps(a, b); return a; }
 static inline FloatW& operator&=(FloatW& a, const FloatW& b) { a = _mm256_and_ps(a, b); return a; }
 static inline FloatW& operator|=(FloatW& a, const FloatW& b) { a = _mm256_or_ps(a, b); return a; }
+// Not fused even with AVX2, FMA rounds once and the 8 wide solver has to match the 4 wide one bit for bit
 static inline FloatW MulAddW(const FloatW& a, const FloatW& b, const FloatW& c) { return _mm256_add_ps(_mm256_mul_ps(b, c), a); }
 static inline FloatW MulSubW(const FloatW& a, const FloatW& b, const FloatW& c) { return _mm256_sub_ps(a, _mm256_mul_ps(b, c)); }
 static inline FloatW operator<(const FloatW& a, const FloatW& b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
 static inline FloatW operator>(const FloatW& a, const FloatW& b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
-static inline FloatW operator<=(const FloatW& b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
-static inline FloatW operator>=(const FloatW& b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
-static inline FloatW operator==(const FloatW& b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+static inline FloatW operator<=(const FloatW& a, const FloatW& b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+static inline FloatW operator>=(const FloatW& a, const FloatW& b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+static inline FloatW operator==(const FloatW& a, const FloatW& b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
 static inline FloatW MinW(const FloatW& a, const FloatW& b) { return _mm256_min_ps(a, b); }
 static inline FloatW MaxW(const FloatW& a, const FloatW& b) { return _mm256_max_ps(a, b); }
+// Interleaves within each 128 bit half, not across the whole register
+static inline FloatW UnpackLoW(const FloatW& a, const FloatW& b) { return _mm256_unpacklo_ps(a, b); }
+static inline FloatW UnpackHiW(const FloatW& a, const FloatW& b) { return _mm256_unpackhi_ps(a, b); }
 static inline FloatW BlendW(const FloatW& a, const FloatW& b, const FloatW& mask) { return _mm256_blendv_ps(a, b, mask); }
+// Pool allocations are only 16 byte aligned, unaligned access costs nothing on aligned data
+static inline FloatW LoadW(const F32* data) { return _mm256_loadu_ps(data); }
+static inline void StoreW(F32* data, const FloatW& a) { _mm256_storeu_ps(data, a); }
+static inline I32 MaskW(const FloatW& a) { return _mm256_movemask_ps(a); }
 
 #elif defined NH_SIMD_SSE || defined NH_SIMD_SSE2
 
@@ -78,6 +87,33 @@ static inline FloatW UnpackHiW(const FloatW& a, const FloatW& b) { return _mm_un
 static inline FloatW BlendW(const FloatW& a, const FloatW& b, const FloatW& mask) { return _mm_or_ps(_mm_and_ps(mask, b), _mm_andnot_ps(mask, a)); }
 static inline FloatW LoadW(const F32* data) { return _mm_load_ps(data); }
 static inline void StoreW(F32* data, const FloatW& a) { _mm_store_ps(data, a); }
+static inline I32 MaskW(const FloatW& a) { return _mm_movemask_ps(a); }
+
+#ifdef NH_CPU_X86_X64
+
+#include <immintrin.h>
+
+// Two FloatW side by side, 4 wide builds use these in kernels marked NH_TARGET_AVX2 that are only picked when the CPU has AVX2
+#define NH_SIMD_PAIR
+
+typedef __m256 FloatPairW;
+
+NH_TARGET_AVX2 static inline FloatPairW SplatPairW(F32 scalar) { return _mm256_set1_ps(scalar); }
+NH_TARGET_AVX2 static inline FloatPairW JoinW(const FloatW& low, const FloatW& high) { return _mm256_set_m128(high, low); }
+NH_TARGET_AVX2 static inline FloatW LowW(const FloatPairW& a) { return _mm256_castps256_ps128(a); }
+NH_TARGET_AVX2 static inline FloatW HighW(const FloatPairW& a) { return _mm256_extractf128_ps(a, 1); }
+NH_TARGET_AVX2 static inline FloatPairW operator+(const FloatPairW& a, const FloatPairW& b) { return _mm256_add_ps(a, b); }
+NH_TARGET_AVX2 static inline FloatPairW operator-(const FloatPairW& a, const FloatPairW& b) { return _mm256_sub_ps(a, b); }
+NH_TARGET_AVX2 static inline FloatPairW operator*(const FloatPairW& a, const FloatPairW& b) { return _mm256_mul_ps(a, b); }
+NH_TARGET_AVX2 static inline FloatPairW operator>(const FloatPairW& a, const FloatPairW& b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+// Not fused, each lane has to round exactly like the FloatW version
+NH_TARGET_AVX2 static inline FloatPairW MulAddW(const FloatPairW& a, const FloatPairW& b, const FloatPairW& c) { return _mm256_add_ps(a, _mm256_mul_ps(b, c)); }
+NH_TARGET_AVX2 static inline FloatPairW MulSubW(const FloatPairW& a, const FloatPairW& b, const FloatPairW& c) { return _mm256_sub_ps(a, _mm256_mul_ps(b, c)); }
+NH_TARGET_AVX2 static inline FloatPairW MinW(const FloatPairW& a, const FloatPairW& b) { return _mm256_min_ps(a, b); }
+NH_TARGET_AVX2 static inline FloatPairW MaxW(const FloatPairW& a, const FloatPairW& b) { return _mm256_max_ps(a, b); }
+NH_TARGET_AVX2 static inline FloatPairW BlendW(const FloatPairW& a, const FloatPairW& b, const FloatPairW& mask) { return _mm256_blendv_ps(a, b, mask); }
+
+#endif
 
 #elif defined NH_SIMD_NEON
 
@@ -116,6 +152,11 @@ static inline FloatW b2UnpackHiW(const FloatW& a, const FloatW& b) { return vzip
 static inline FloatW b2BlendW(const FloatW& a, const FloatW& b, const FloatW& mask) { return vbslq_f32(vreinterpretq_u32_f32(mask), b, a); }
 static inline FloatW b2LoadW(const float32_t* data) { return vld1q_f32(data); }
 static inline void b2StoreW(float32_t* data, const FloatW& a) { return vst1q_f32(data, a); }
+static inline I32 MaskW(const FloatW& a)
+{
+	uint32x4_t bits = vshrq_n_u32(vreinterpretq_u32_f32(a), 31);
+	return (I32)(vgetq_lane_u32(bits, 0) | (vgetq_lane_u32(bits, 1) << 1) | (vgetq_lane_u32(bits, 2) << 2) | (vgetq_lane_u32(bits, 3) << 3));
+}
 
 #else
 
@@ -149,6 +190,8 @@ static inline FloatW operator==(const FloatW& a, const FloatW& b) { return { (F3
 static inline FloatW MinW(const FloatW& a, const FloatW& b) { return { a.x <= b.x ? a.x : b.x, a.y <= b.y ? a.y : b.y, a.z <= b.z ? a.z : b.z, a.w <= b.w ? a.w : b.w }; }
 static inline FloatW MaxW(const FloatW& a, const FloatW& b) { return { a.x >= b.x ? a.x : b.x, a.y >= b.y ? a.y : b.y, a.z >= b.z ? a.z : b.z, a.w >= b.w ? a.w : b.w }; }
 static inline FloatW BlendW(const FloatW& a, const FloatW& b, const FloatW& mask) { return { mask.x ? b.x : a.x, mask.y ? b.y : a.y, mask.z ? b.z : a.z, mask.w ? b.w : a.w }; }
+static inline FloatW LoadW(const F32* data) { return { data[0], data[1], data[2], data[3] }; }
+static inline I32 MaskW(const FloatW& a) { return (a.x != 0.0f) | ((a.y != 0.0f) << 1) | ((a.z != 0.0f) << 2) | ((a.w != 0.0f) << 3); }
 
 #endif
 
@@ -160,27 +203,36 @@ static inline void Pause() { __yield(); }
 static inline void Pause() {}
 #endif
 
-struct Vector2W
+// Templated on the lane type so kernels written once can also run on FloatPairW
+template<class Wide>
+struct Vector2T
 {
-	FloatW x, y;
+	Wide x, y;
 };
 
-struct Quaternion2W
+template<class Wide>
+struct Quaternion2T
 {
-	FloatW c, s;
+	Wide c, s;
 };
 
-static inline FloatW DotW(const Vector2W& a, const Vector2W& b)
+typedef Vector2T<FloatW> Vector2W;
+typedef Quaternion2T<FloatW> Quaternion2W;
+
+template<class Wide>
+static inline Wide DotW(const Vector2T<Wide>& a, const Vector2T<Wide>& b)
 {
 	return a.x * b.x + a.y * b.y;
 }
 
-static inline FloatW CrossW(const Vector2W& a, const Vector2W& b)
+template<class Wide>
+static inline Wide CrossW(const Vector2T<Wide>& a, const Vector2T<Wide>& b)
 {
 	return a.x * b.y - a.y * b.x;
 }
 
-static inline Vector2W RotateVectorW(const Quaternion2W& q, const Vector2W& v)
+template<class Wide>
+static inline Vector2T<Wide> RotateVectorW(const Quaternion2T<Wide>& q, const Vector2T<Wide>& v)
 {
 	return { q.c * v.x - q.s * v.y, q.s * v.x + q.c * v.y };
 }
\ No newline at end of file
@@ -1,12 +1,32 @@
 #include "Defines.hpp"
 
 #include "Math\Math.hpp"
+#include "Math\Physics.hpp"
+#include "Rendering\Tilemap.hpp"
 #include "Core\Time.hpp"
 #include "Containers\Vector.hpp"
+#include "Containers\Bitset.hpp"
+#include "Platform\CpuFeatures.hpp"
+#include "Platform\Jobs.hpp"
+#include "Platform\Task.hpp"
+
+#if defined NH_PLATFORM_WINDOWS
+#include <Windows.h>
+#elif defined NH_PLATFORM_LINUX
+#include <sys/resource.h>
+#endif
 
 #define BEGIN_TEST Timer timer; timer.Start()
 #define END_TEST(b) timer.Stop(); if(b) {Logger::Info("{}	{}", __FUNCTION__, timer.CurrentTime());} else {Logger::Error("{}	{}", __FUNCTION__, timer.CurrentTime());}
 
+static U32 randomSeed = 12345;
+
+static F32 RandomF32()
+{
+	randomSeed = randomSeed * 1664525 + 1013904223;
+	return (F32)(randomSeed >> 8) / 16777216.0f;
+}
+
 #pragma region Vector Tests
 
 struct SimpleData
@@ -132,6 +152,1396 @@ void Vector_Push1000000()
 }
 #pragma endregion
 
+#pragma region Bitset Tests
+
+// Odd block counts so every kernel also runs its scalar tail
+void Bitset_InPlaceUnion()
+{
+	BEGIN_TEST;
+
+	bool passed = true;
+
+	for (U64 blockCount = 1; blockCount < 40; blockCount += 3)
+	{
+		Bitset a, b;
+		a.Create(blockCount * 64);
+		b.Create(blockCount * 64);
+		a.GrowBitSet(blockCount);
+		b.GrowBitSet(blockCount);
+
+		Vector<U64> expected(blockCount);
+		for (U64 i = 0; i < blockCount; ++i)
+		{
+			a.bits[i] = ((U64)(RandomF32() * 16777216.0f) << 40) | (U64)(RandomF32() * 16777216.0f);
+			b.bits[i] = ((U64)(RandomF32() * 16777216.0f) << 40) | (U64)(RandomF32() * 16777216.0f);
+			expected.Push(a.bits[i] | b.bits[i]);
+		}
+
+		a.InPlaceUnion(b);
+
+		for (U64 i = 0; i < blockCount; ++i) { passed = passed && a.bits[i] == expected[i]; }
+
+		a.Destroy();
+		b.Destroy();
+	}
+
+	Logger::Info("Bitset kernels running {}", CpuFeatures::IsaName());
+
+	END_TEST(passed)
+}
+#pragma endregion
+
+#pragma region Jobs Tests
+
+struct JobsTests
+{
+	static bool Initialize() { return Jobs::Initialize(); }
+	static void Shutdown() { Jobs::Shutdown(); }
+};
+
+static F64 ProcessCpuTime()
+{
+#if defined NH_PLATFORM_WINDOWS
+	FILETIME creation, exit, kernel, user;
+	GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user);
+
+	ULARGE_INTEGER kernelTime{ kernel.dwLowDateTime, kernel.dwHighDateTime };
+	ULARGE_INTEGER userTime{ user.dwLowDateTime, user.dwHighDateTime };
+
+	return (F64)(kernelTime.QuadPart + userTime.QuadPart) * 0.0000001;
+#elif defined NH_PLATFORM_LINUX
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+
+	return (F64)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) + (F64)(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 0.000001;
+#endif
+}
+
+void Jobs_IdleCpuUsage()
+{
+	BEGIN_TEST;
+
+	// Give the workers time to run out of spins and park
+	Jobs::SleepForMilli(50);
+
+	F64 cpuStart = ProcessCpuTime();
+	F64 wallStart = Time::AbsoluteTime();
+
+	Jobs::SleepForSeconds(1);
+
+	F64 cores = (ProcessCpuTime() - cpuStart) / (Time::AbsoluteTime() - wallStart);
+
+	Logger::Info("Idle cpu usage: {} cores", cores);
+
+	bool passed = cores < 0.05;
+
+	END_TEST(passed)
+}
+
+void Jobs_WakeLatency()
+{
+	BEGIN_TEST;
+
+	constexpr U32 SampleCount = 100;
+
+	F64 total = 0.0;
+	F64 worst = 0.0;
+
+	for (U32 i = 0; i < SampleCount; ++i)
+	{
+		Jobs::SleepForMilli(5);
+
+		std::atomic<bool> ran{ false };
+		F64 startTime = 0.0;
+
+		F64 submitTime = Time::AbsoluteTime();
+		Jobs::Excecute([&]() { startTime = Time::AbsoluteTime(); ran.store(true, std::memory_order_release); });
+
+		// Don't help, a parked worker has to wake up and steal the job
+		while (!ran.load(std::memory_order_acquire)) { CpuRelax(); }
+
+		F64 latency = startTime - submitTime;
+		total += latency;
+		if (latency > worst) { worst = latency; }
+	}
+
+	Logger::Info("Wake latency: average {}us, worst {}us", total / SampleCount * 1000000.0, worst * 1000000.0);
+
+	bool passed = worst < 0.005;
+
+	END_TEST(passed)
+}
+
+// A diamond runs in dependency order, a graph with a root but also a cycle is refused instead of hanging
+void Jobs_GraphCycle()
+{
+	BEGIN_TEST;
+
+	std::atomic<U32> step{ 0 };
+	std::atomic<U32> outOfOrder{ 0 };
+
+	JobGraph graph;
+	U32 a = graph.AddNode([&]() { if (step.fetch_add(1) != 0) { outOfOrder.fetch_add(1); } });
+	U32 b = graph.AddNode([&]() { if (step.fetch_add(1) == 0) { outOfOrder.fetch_add(1); } });
+	U32 c = graph.AddNode([&]() { if (step.fetch_add(1) == 0) { outOfOrder.fetch_add(1); } });
+	U32 d = graph.AddNode([&]() { if (step.fetch_add(1) != 3) { outOfOrder.fetch_add(1); } });
+	graph.AddDependency(a, b);
+	graph.AddDependency(a, c);
+	graph.AddDependency(b, d);
+	graph.AddDependency(c, d);
+
+	Jobs::WaitFor(graph.Execute());
+
+	bool passed = outOfOrder.load() == 0 && step.load() == 4 && graph.Validate();
+
+	graph.AddDependency(d, b);
+	passed &= !graph.Validate() && graph.Execute().Done();
+
+	graph.Destroy();
+
+	END_TEST(passed)
+}
+
+static std::atomic<U32> taskRuns{ 0 };
+
+static Task<U32> CountedTask()
+{
+	taskRuns.fetch_add(1);
+	co_return 7;
+}
+
+static Task<U32> AwaitTasks(Task<U32>& started)
+{
+	Task<U32> lazy = CountedTask();
+	U32 sum = co_await started;
+	sum += co_await lazy;
+	co_return sum;
+}
+
+// Awaiting a task that was already started must not resume it a second time
+void Jobs_TaskAwaitStarted()
+{
+	BEGIN_TEST;
+
+	taskRuns.store(0);
+
+	Task<U32> started = CountedTask();
+	started.Start();
+
+	Task<U32> outer = AwaitTasks(started);
+	U32 sum = outer.Wait();
+
+	Vector<Task<U32>> tasks(8);
+	for (U32 i = 0; i < 8; ++i)
+	{
+		tasks.Push(CountedTask());
+		if (i & 1) { tasks[i].Start(); }
+	}
+
+	WhenAll(tasks).Wait();
+
+	bool passed = sum == 14 && taskRuns.load() == 10;
+
+	END_TEST(passed)
+}
+#pragma endregion
+
+#pragma region Time Tests
+
+void Time_FrameLimiterDeviation()
+{
+	BEGIN_TEST;
+
+	constexpr U32 FrameCount = 300;
+	constexpr F64 Period = 1.0 / 144.0;
+
+	FrameLimiter limiter;
+	limiter.Wait(Period);
+
+	F64 total = 0.0;
+	F64 totalSquared = 0.0;
+
+	F64 last = Time::AbsoluteTime();
+
+	for (U32 i = 0; i < FrameCount; ++i)
+	{
+		limiter.Wait(Period);
+
+		F64 now = Time::AbsoluteTime();
+		F64 frameTime = now - last;
+		last = now;
+
+		total += frameTime;
+		totalSquared += frameTime * frameTime;
+	}
+
+	F64 mean = total / FrameCount;
+	F64 deviation = Math::Sqrt(Math::Max(totalSquared / FrameCount - mean * mean, 0.0));
+
+	Logger::Info("Frame limiter: mean {}us, target {}us, deviation {}us", mean * 1000000.0, Period * 1000000.0, deviation * 1000000.0);
+
+	bool passed = Math::Abs(mean - Period) < 0.00005 && deviation < 0.001;
+
+	END_TEST(passed)
+}
+#pragma endregion
+
+#pragma region Physics Tests
+
+static constexpr U32 ScatteredProxyCount = 50000;
+static constexpr F32 ScatteredWorldSize = 1000.0f;
+
+static Vector2 RandomRay(F32 length)
+{
+	return Vector2{ RandomF32() - 0.5f, RandomF32() - 0.5f }.Normalized() * length;
+}
+
+struct PhysicsTests
+{
+	static bool Initialize() { return Physics::Initialize(); }
+	static void Shutdown() { Physics::Shutdown(); }
+
+	// Static boxes and circles scattered over the world, they all land in the static tree
+	static void CreateScatteredWorld()
+	{
+		Physics::rigidBodies.Reserve(ScatteredProxyCount);
+
+		ShapeDef shapeDef{};
+		ConvexPolygon box = Physics::CreateBox(0.5f, 0.5f);
+		Circle circle = { Vector2Zero, 0.5f };
+
+		for (U32 i = 0; i < ScatteredProxyCount; ++i)
+		{
+			RigidBody2DDef bodyDef{};
+			bodyDef.position = { RandomF32() * ScatteredWorldSize, RandomF32() * ScatteredWorldSize };
+			bodyDef.rotation = Quaternion2(RandomF32() * 360.0f);
+
+			RigidBody2D& body = Physics::rigidBodies.Emplace(bodyDef);
+
+			if (i & 1) { body.AddCollider(shapeDef, box); }
+			else { body.AddCollider(shapeDef, circle); }
+		}
+	}
+
+	// Tests every shape without the tree, the reference the tree traversal is checked against
+	static RaycastResult BruteForceRaycast(const Vector2& origin, const Vector2& translation)
+	{
+		RaycastInput input = { origin, translation, 1.0f };
+		RaycastResult closest = {};
+
+		for (U32 i = 0; i < Physics::shapes.Size(); ++i)
+		{
+			const Shape& shape = Physics::shapes[i];
+			Transform2D transform = Physics::GetBodySim(Physics::rigidBodies[shape.bodyId]).transform;
+
+			CastOutput output = Physics::RaycastShape(input, shape, transform);
+			if (output.hit && output.fraction < input.maxFraction)
+			{
+				input.maxFraction = output.fraction;
+				closest = { shape.id + 1, shape.bodyId, output.point, output.normal, output.fraction, true };
+			}
+		}
+
+		return closest;
+	}
+
+	static U32 BruteForceOverlapCount(const AABB& box)
+	{
+		U32 count = 0;
+
+		for (U32 i = 0; i < Physics::shapes.Size(); ++i)
+		{
+			count += Physics::shapes[i].aabb.Overlaps(box);
+		}
+
+		return count;
+	}
+
+	static SimdBody GatherBodies(const BodyState* states, int* indices) { return Physics::GatherBodies(states, indices); }
+	static void ScatterBodies(BodyState* states, int* indices, const SimdBody& simdBody) { Physics::ScatterBodies(states, indices, simdBody); }
+
+#ifdef NH_SIMD_PAIR
+	static void SolveContactPairs(bool enabled) { Physics::solveContacts = enabled ? Physics::SolveContactPairsTask : Physics::SolveContactsTask; }
+#endif
+
+	// A pyramid of dynamic boxes on a static ground, away from the scattered world so nothing else touches it
+	static I32 CreatePyramid(const Vector2& base, I32 rows)
+	{
+		Physics::rigidBodies.Reserve(Physics::rigidBodies.Size() + rows * (rows + 1) / 2 + 1);
+
+		ShapeDef shapeDef{};
+
+		RigidBody2DDef groundDef{};
+		groundDef.position = base;
+		Physics::rigidBodies.Emplace(groundDef).AddCollider(shapeDef, Physics::CreateBox(rows * 1.0f + 10.0f, 0.5f));
+
+		I32 first = (I32)Physics::rigidBodies.Size();
+		ConvexPolygon box = Physics::CreateBox(0.5f, 0.5f);
+
+		for (I32 row = 0; row < rows; ++row)
+		{
+			for (I32 column = row; column < rows; ++column)
+			{
+				RigidBody2DDef bodyDef{};
+				bodyDef.type = BODY_TYPE_DYNAMIC;
+				bodyDef.position = base + Vector2{ (column - row * 0.5f - rows * 0.5f) * 1.0f, 1.0f + row * 1.0f };
+
+				Physics::rigidBodies.Emplace(bodyDef).AddCollider(shapeDef, box);
+			}
+		}
+
+		return first;
+	}
+
+	static void Step(U32 count)
+	{
+		for (U32 i = 0; i < count; ++i) { Physics::Step(1.0f / 60.0f, 4); }
+	}
+
+	static Transform2D BodyTransform(I32 bodyId) { return Physics::GetBodySim(Physics::rigidBodies[bodyId]).transform; }
+
+	// One fixed step the way Update takes it, leaving the render alpha partway to the next step
+	static void StepInterpolated(F32 alpha)
+	{
+		Physics::StorePreviousTransforms();
+		Physics::Step(1.0f / 60.0f, 4);
+		Physics::interpolationAlpha = alpha;
+	}
+
+	static U64 HashBodies(I32 first, I32 count)
+	{
+		U64 hash = 0;
+
+		for (I32 i = first; i < first + count; ++i)
+		{
+			hash = Hash::SeededHash(BodyTransform(i), hash);
+		}
+
+		return hash;
+	}
+
+	static U64 BodyCount() { return Physics::rigidBodies.Size(); }
+
+	// Separate rows of slightly overlapping boxes, each row starts as one island and pushes apart into one island per box
+	static I32 CreateOverlappingRows(const Vector2& base, I32 rows, I32 columns)
+	{
+		Physics::rigidBodies.Reserve(Physics::rigidBodies.Size() + rows * columns + 1);
+
+		ShapeDef shapeDef{};
+
+		RigidBody2DDef groundDef{};
+		groundDef.position = base;
+		Physics::rigidBodies.Emplace(groundDef).AddCollider(shapeDef, Physics::CreateBox(rows * columns * 2.0f, 0.5f));
+
+		I32 first = (I32)Physics::rigidBodies.Size();
+		ConvexPolygon box = Physics::CreateBox(0.5f, 0.5f);
+
+		for (I32 row = 0; row < rows; ++row)
+		{
+			for (I32 column = 0; column < columns; ++column)
+			{
+				RigidBody2DDef bodyDef{};
+				bodyDef.type = BODY_TYPE_DYNAMIC;
+				bodyDef.position = base + Vector2{ (row * (columns + 4) + column * 0.95f) * 1.0f - rows * columns * 0.5f, 1.0f };
+
+				Physics::rigidBodies.Emplace(bodyDef).AddCollider(shapeDef, box);
+			}
+		}
+
+		return first;
+	}
+
+	// A thin static wall with a column of small bullets fired at it, each one crosses the wall several times over in a single step
+	static I32 CreateBullets(const Vector2& base, I32 count, F32 speed)
+	{
+		Physics::rigidBodies.Reserve(Physics::rigidBodies.Size() + count + 1);
+
+		ShapeDef shapeDef{};
+
+		RigidBody2DDef wallDef{};
+		wallDef.position = base;
+		Physics::rigidBodies.Emplace(wallDef).AddCollider(shapeDef, Physics::CreateBox(0.1f, count * 0.5f + 10.0f));
+
+		I32 first = (I32)Physics::rigidBodies.Size();
+		Circle circle = { Vector2Zero, 0.1f };
+
+		for (I32 i = 0; i < count; ++i)
+		{
+			RigidBody2DDef bodyDef{};
+			bodyDef.type = BODY_TYPE_DYNAMIC;
+			bodyDef.isBullet = true;
+			bodyDef.gravityScale = 0.0f;
+			bodyDef.position = base + Vector2{ -20.0f, (i - count * 0.5f) * 0.5f };
+			bodyDef.linearVelocity = { speed, 0.0f };
+
+			Physics::rigidBodies.Emplace(bodyDef).AddCollider(shapeDef, circle);
+		}
+
+		return first;
+	}
+
+	// A static outline as one counter-clockwise chain loop with a row of circles dropped on it
+	static I32 CreateChainGround(const Vector2& base, I32 count, I32& chainId)
+	{
+		Physics::rigidBodies.Reserve(Physics::rigidBodies.Size() + count + 1);
+
+		ShapeDef shapeDef{};
+		F32 halfWidth = count * 0.5f + 5.0f;
+		Vector2 points[]{ { -halfWidth, -1.0f }, { halfWidth, -1.0f }, { halfWidth, 0.0f }, { -halfWidth, 0.0f } };
+
+		RigidBody2DDef groundDef{};
+		groundDef.position = base;
+		chainId = Physics::rigidBodies.Emplace(groundDef).AddChain(shapeDef, points, (I32)CountOf(points), true);
+
+		I32 first = (I32)Physics::rigidBodies.Size();
+		Circle circle = { Vector2Zero, 0.25f };
+
+		for (I32 i = 0; i < count; ++i)
+		{
+			RigidBody2DDef bodyDef{};
+			bodyDef.type = BODY_TYPE_DYNAMIC;
+			bodyDef.position = base + Vector2{ (i - count * 0.5f), 2.0f };
+
+			Physics::rigidBodies.Emplace(bodyDef).AddCollider(shapeDef, circle);
+		}
+
+		return first;
+	}
+
+	static U64 ShapeCount() { return Physics::shapes.Size(); }
+
+	// A static sensor zone with a row of circles above it, nothing stops them falling straight through
+	static void CreateSensorZone(const Vector2& base, I32 count)
+	{
+		Physics::rigidBodies.Reserve(Physics::rigidBodies.Size() + count + 1);
+
+		ShapeDef sensorDef{};
+		sensorDef.isSensor = true;
+
+		RigidBody2DDef zoneDef{};
+		zoneDef.position = base;
+		Physics::rigidBodies.Emplace(zoneDef).AddCollider(sensorDef, Physics::CreateBox(count * 0.5f + 5.0f, 2.0f));
+
+		ShapeDef shapeDef{};
+		Circle circle = { Vector2Zero, 0.25f };
+
+		for (I32 i = 0; i < count; ++i)
+		{
+			RigidBody2DDef bodyDef{};
+			bodyDef.type = BODY_TYPE_DYNAMIC;
+			bodyDef.position = base + Vector2{ (i - count * 0.5f), 5.0f };
+
+			Physics::rigidBodies.Emplace(bodyDef).AddCollider(shapeDef, circle);
+		}
+	}
+
+	// Every segment of every chain a tilemap chunk owns, in the order they were traced
+	static void TilemapSegments(const TilemapCollision& collision, I32 chunk, Vector<ChainSegment>& segments)
+	{
+		for (I32 chainId : collision.chunkChains[chunk])
+		{
+			const ChainShape& chain = Physics::chains[chainId - 1];
+			for (I32 i = 0; i < chain.count; ++i) { segments.Push(Physics::shapes[chain.shapeIndices[i]].chainSegment); }
+		}
+	}
+
+	// Chain ids get reused, the revision tells a rebuilt chain apart from the one it replaced
+	static void TilemapChainRevisions(const TilemapCollision& collision, I32 chunk, Vector<U32>& revisions)
+	{
+		for (I32 chainId : collision.chunkChains[chunk])
+		{
+			revisions.Push(((U32)chainId << 16) | Physics::chains[chainId - 1].revision);
+		}
+	}
+
+	static I32 TilemapChainCount(const TilemapCollision& collision, I32 chunk) { return (I32)collision.chunkChains[chunk].Size(); }
+	static I32 TilemapChunkCount(const TilemapCollision& collision) { return collision.chunksX * collision.chunksY; }
+	static I32 TilemapBody(const TilemapCollision& collision) { return collision.bodyId; }
+
+	// Collision is on the right of a segment, so the right has to be empty and the left solid
+	static bool TilemapSegmentFacesOut(const TilemapCollision& collision, const ChainSegment& chainSegment, const Vector2& tileSize)
+	{
+		Vector2 direction = chainSegment.segment.point2 - chainSegment.segment.point1;
+		Vector2 right = Vector2{ direction.y, -direction.x }.Normalized() * 0.25f;
+		Vector2 middle = (chainSegment.segment.point1 + chainSegment.segment.point2) * 0.5f;
+
+		Vector2 outside = middle + right;
+		Vector2 inside = middle - right;
+
+		return !collision.Solid((I32)Math::Floor(outside.x / tileSize.x), (I32)Math::Floor(-outside.y / tileSize.y)) &&
+			collision.Solid((I32)Math::Floor(inside.x / tileSize.x), (I32)Math::Floor(-inside.y / tileSize.y));
+	}
+
+	static U64 SensorBeginCount() { return Physics::sensorBeginEvents.Size(); }
+	static U64 SensorEndCount() { return Physics::sensorEndEvents.Size(); }
+
+	static I32 SleepingCount(I32 first, I32 count)
+	{
+		I32 sleeping = 0;
+
+		for (I32 i = first; i < first + count; ++i)
+		{
+			sleeping += Physics::rigidBodies[i].setIndex >= SET_TYPE_FIRST_SLEEPING;
+		}
+
+		return sleeping;
+	}
+
+	// Every island's body, contact and joint lists have to agree with their counts and point back at the island
+	static bool ValidateIslands()
+	{
+		for (const Island& island : Physics::islands)
+		{
+			if (island.setIndex == NullIndex) { continue; }
+
+			I32 count = 0;
+			I32 previous = NullIndex;
+			for (I32 id = island.headBody; id != NullIndex; id = Physics::rigidBodies[id].islandNext, ++count)
+			{
+				const RigidBody2D& body = Physics::rigidBodies[id];
+				if (body.islandId != island.islandId || body.islandPrev != previous) { return false; }
+				previous = id;
+			}
+
+			if (count != island.bodyCount || previous != island.tailBody) { return false; }
+
+			count = 0;
+			previous = NullIndex;
+			for (I32 id = island.headContact; id != NullIndex; id = Physics::contacts[id].islandNext, ++count)
+			{
+				const Contact& contact = Physics::contacts[id];
+				if (contact.islandId != island.islandId || contact.islandPrev != previous) { return false; }
+				previous = id;
+			}
+
+			if (count != island.contactCount || previous != island.tailContact) { return false; }
+
+			count = 0;
+			previous = NullIndex;
+			for (I32 id = island.headJoint; id != NullIndex; id = Physics::joints[id].islandNext, ++count)
+			{
+				const Joint& joint = Physics::joints[id];
+				if (joint.islandId != island.islandId || joint.islandPrev != previous) { return false; }
+				previous = id;
+			}
+
+			if (count != island.jointCount || previous != island.tailJoint) { return false; }
+		}
+
+		return true;
+	}
+};
+
+static bool SameBits(F32 a, F32 b) { return *(U32*)&a == *(U32*)&b; }
+
+// Every lane must match the scalar op exactly, that is what lets the 4 and 8 wide solvers agree bit for bit
+void Physics_SimdLanes()
+{
+	BEGIN_TEST;
+
+	bool passed = true;
+
+	for (U32 iteration = 0; iteration < 1000; ++iteration)
+	{
+		alignas(32) F32 a[NH_SIMD_WIDTH];
+		alignas(32) F32 b[NH_SIMD_WIDTH];
+		alignas(32) F32 c[NH_SIMD_WIDTH];
+
+		for (U32 lane = 0; lane < NH_SIMD_WIDTH; ++lane)
+		{
+			a[lane] = (RandomF32() - 0.5f) * 100.0f;
+			b[lane] = lane == 3 ? a[lane] : (RandomF32() - 0.5f) * 100.0f;
+			c[lane] = RandomF32() + 0.5f;
+		}
+
+		FloatW wa = LoadW(a);
+		FloatW wb = LoadW(b);
+		FloatW wc = LoadW(c);
+
+		FloatW add = wa + wb;
+		FloatW sub = wa - wb;
+		FloatW mul = wa * wb;
+		FloatW div = wa / wc;
+		FloatW mulAdd = MulAddW(wa, wb, wc);
+		FloatW mulSub = MulSubW(wa, wb, wc);
+		FloatW min = MinW(wa, wb);
+		FloatW max = MaxW(wa, wb);
+		FloatW blend = BlendW(wa, wb, wa < wb);
+
+		I32 less = MaskW(wa < wb);
+		I32 greater = MaskW(wa > wb);
+		I32 lessEqual = MaskW(wa <= wb);
+		I32 greaterEqual = MaskW(wa >= wb);
+		I32 equal = MaskW(wa == wb);
+
+		for (U32 lane = 0; lane < NH_SIMD_WIDTH; ++lane)
+		{
+			F32 x = a[lane], y = b[lane], z = c[lane];
+
+			passed = passed && SameBits(((F32*)&add)[lane], x + y) && SameBits(((F32*)&sub)[lane], x - y) &&
+				SameBits(((F32*)&mul)[lane], x * y) && SameBits(((F32*)&div)[lane], x / z) &&
+				SameBits(((F32*)&mulAdd)[lane], x + y * z) && SameBits(((F32*)&mulSub)[lane], x - y * z) &&
+				SameBits(((F32*)&min)[lane], x < y ? x : y) && SameBits(((F32*)&max)[lane], x > y ? x : y) &&
+				SameBits(((F32*)&blend)[lane], x < y ? y : x);
+
+			passed = passed && ((less >> lane) & 1) == (x < y) && ((greater >> lane) & 1) == (x > y) &&
+				((lessEqual >> lane) & 1) == (x <= y) && ((greaterEqual >> lane) & 1) == (x >= y) && ((equal >> lane) & 1) == (x == y);
+		}
+	}
+
+	END_TEST(passed)
+}
+
+void Physics_GatherScatter()
+{
+	BEGIN_TEST;
+
+	constexpr I32 StateCount = NH_SIMD_WIDTH * 2;
+
+	BodyState states[StateCount];
+	for (I32 i = 0; i < StateCount; ++i)
+	{
+		states[i] = { { RandomF32(), RandomF32() }, RandomF32(), i, { RandomF32(), RandomF32() }, Quaternion2(RandomF32() * 360.0f) };
+	}
+
+	BodyState original[StateCount];
+	for (I32 i = 0; i < StateCount; ++i) { original[i] = states[i]; }
+
+	// Odd lanes point at every other state, even lanes are empty
+	int indices[NH_SIMD_WIDTH];
+	for (I32 lane = 0; lane < NH_SIMD_WIDTH; ++lane) { indices[lane] = (lane & 1) ? lane * 2 : NullIndex; }
+
+	SimdBody body = PhysicsTests::GatherBodies(states, indices);
+
+	bool passed = true;
+
+	for (I32 lane = 0; lane < NH_SIMD_WIDTH; ++lane)
+	{
+		const BodyState& state = indices[lane] == NullIndex ? BodyStateIdentity : states[indices[lane]];
+
+		passed = passed && ((F32*)&body.v.x)[lane] == state.linearVelocity.x && ((F32*)&body.v.y)[lane] == state.linearVelocity.y &&
+			((F32*)&body.w)[lane] == state.angularVelocity && ((F32*)&body.dp.x)[lane] == state.deltaPosition.x &&
+			((F32*)&body.dp.y)[lane] == state.deltaPosition.y && ((F32*)&body.dq.c)[lane] == state.deltaRotation.x &&
+			((F32*)&body.dq.s)[lane] == state.deltaRotation.y;
+	}
+
+	body.v.x += SplatW(1.0f);
+	body.w += SplatW(2.0f);
+
+	PhysicsTests::ScatterBodies(states, indices, body);
+
+	for (I32 i = 0; i < StateCount; ++i)
+	{
+		bool written = false;
+		for (I32 lane = 0; lane < NH_SIMD_WIDTH; ++lane) { written = written || indices[lane] == i; }
+
+		F32 dv = written ? 1.0f : 0.0f;
+		F32 dw = written ? 2.0f : 0.0f;
+
+		passed = passed && states[i].linearVelocity.x == original[i].linearVelocity.x + dv && states[i].linearVelocity.y == original[i].linearVelocity.y &&
+			states[i].angularVelocity == original[i].angularVelocity + dw && states[i].flags == original[i].flags &&
+			states[i].deltaPosition.x == original[i].deltaPosition.x && states[i].deltaRotation.x == original[i].deltaRotation.x;
+	}
+
+	END_TEST(passed)
+}
+
+// The hash is logged so builds with different NH_SIMD_WIDTH can be compared on the same scene
+void Physics_SolverPyramid()
+{
+	BEGIN_TEST;
+
+	constexpr I32 Rows = 20;
+	constexpr I32 BodyCount = Rows * (Rows + 1) / 2;
+	constexpr U32 StepCount = 300;
+
+	I32 first = PhysicsTests::CreatePyramid({ -500.0f, 0.0f }, Rows);
+	F32 topStart = PhysicsTests::BodyTransform(first + BodyCount - 1).position.y;
+
+	F64 start = Time::AbsoluteTime();
+	PhysicsTests::Step(StepCount);
+	F64 elapsed = Time::AbsoluteTime() - start;
+
+	F32 topEnd = PhysicsTests::BodyTransform(first + BodyCount - 1).position.y;
+	U64 hash = PhysicsTests::HashBodies(first, BodyCount);
+
+	Logger::Info("{} wide solver, {} box pyramid, {} steps: {}s, hash {}", NH_SIMD_WIDTH, BodyCount, StepCount, elapsed, hash);
+
+	// A settled pyramid only sinks into its contacts a little
+	bool passed = Math::Abs(topEnd - topStart) < 0.5f;
+
+	END_TEST(passed)
+}
+
+// The AVX2 contact solve takes two 4 wide constraints at a time, stepping the same snapshot with each solve has to give the same bodies
+void Physics_SolverPairs()
+{
+	BEGIN_TEST;
+
+	bool passed = true;
+
+#ifdef NH_SIMD_PAIR
+	if (CpuFeatures::Has(CPU_FEATURE_AVX2))
+	{
+		constexpr I32 Rows = 20;
+		constexpr I32 BodyCount = Rows * (Rows + 1) / 2;
+		constexpr U32 StepCount = 60;
+
+		I32 first = PhysicsTests::CreatePyramid({ -500.0f, 1500.0f }, Rows);
+
+		Vector<U8> snapshot;
+		Physics::Snapshot(snapshot);
+
+		PhysicsTests::SolveContactPairs(false);
+
+		F64 start = Time::AbsoluteTime();
+		PhysicsTests::Step(StepCount);
+		F64 singleTime = Time::AbsoluteTime() - start;
+
+		U64 expected = PhysicsTests::HashBodies(first, BodyCount);
+
+		passed = Physics::Restore(snapshot);
+		PhysicsTests::SolveContactPairs(true);
+
+		start = Time::AbsoluteTime();
+		PhysicsTests::Step(StepCount);
+		F64 pairTime = Time::AbsoluteTime() - start;
+
+		passed &= PhysicsTests::HashBodies(first, BodyCount) == expected;
+
+		Logger::Info("{} box pyramid, {} steps: 4 wide solve {}s, AVX2 pair solve {}s", BodyCount, StepCount, singleTime, pairTime);
+	}
+	else
+	{
+		Logger::Info("No AVX2, contacts are only solved 4 wide");
+	}
+#else
+	Logger::Info("{} wide build, contacts are solved at full width", NH_SIMD_WIDTH);
+#endif
+
+	END_TEST(passed)
+}
+
+// Stepping on from a restore has to match the steps taken after the snapshot, contacts and their warm starting included
+void Physics_SnapshotRestore()
+{
+	BEGIN_TEST;
+
+	constexpr I32 Rows = 20;
+	constexpr I32 BodyCount = Rows * (Rows + 1) / 2;
+	constexpr U32 StepCount = 60;
+
+	I32 first = PhysicsTests::CreatePyramid({ 500.0f, 0.0f }, Rows);
+	PhysicsTests::Step(30);
+
+	Vector<U8> snapshot;
+
+	F64 start = Time::AbsoluteTime();
+	Physics::Snapshot(snapshot);
+	F64 snapshotTime = Time::AbsoluteTime() - start;
+
+	PhysicsTests::Step(StepCount);
+	U64 expected = PhysicsTests::HashBodies(first, BodyCount);
+
+	start = Time::AbsoluteTime();
+	bool restored = Physics::Restore(snapshot);
+	F64 restoreTime = Time::AbsoluteTime() - start;
+
+	PhysicsTests::Step(StepCount);
+	U64 hash = PhysicsTests::HashBodies(first, BodyCount);
+
+	Logger::Info("{} bodies, {} byte snapshot: snapshot {}s, restore {}s", PhysicsTests::BodyCount(), snapshot.Size(), snapshotTime, restoreTime);
+
+	Vector<U8> invalid;
+	bool passed = restored && hash == expected && !Physics::Restore(invalid);
+
+	END_TEST(passed)
+}
+
+// Every step's hash has to repeat after a restore, the final hash is logged so Debug and Release builds can be compared
+void Physics_Deterministic()
+{
+	BEGIN_TEST;
+
+	constexpr I32 Rows = 20;
+	constexpr U32 StepCount = 120;
+
+	Physics::SetDeterministic(true);
+
+	PhysicsTests::CreatePyramid({ 1500.0f, 0.0f }, Rows);
+
+	Vector<U8> snapshot;
+	Physics::Snapshot(snapshot);
+
+	U64 hashes[StepCount];
+	for (U32 i = 0; i < StepCount; ++i)
+	{
+		PhysicsTests::Step(1);
+		hashes[i] = Physics::StateHash();
+	}
+
+	bool passed = Physics::Restore(snapshot);
+
+	for (U32 i = 0; i < StepCount; ++i)
+	{
+		PhysicsTests::Step(1);
+		passed &= Physics::StateHash() == hashes[i];
+	}
+
+	Logger::Info("Deterministic state hash after {} steps: {}", StepCount, Physics::StateHash());
+
+	Physics::SetDeterministic(false);
+
+	END_TEST(passed)
+}
+
+// Every row separates at once, so many islands need splitting in the same step
+void Physics_IslandSplitting()
+{
+	BEGIN_TEST;
+
+	constexpr I32 Rows = 16;
+	constexpr I32 Columns = 16;
+	constexpr I32 BodyCount = Rows * Columns;
+	constexpr U32 StepCount = 240;
+
+	I32 first = PhysicsTests::CreateOverlappingRows({ 0.0f, -500.0f }, Rows, Columns);
+
+	bool passed = true;
+	F64 slowestStep = 0.0;
+	U32 mostSplits = 0;
+
+	for (U32 i = 0; i < StepCount; ++i)
+	{
+		F64 start = Time::AbsoluteTime();
+		PhysicsTests::Step(1);
+		slowestStep = Math::Max(slowestStep, Time::AbsoluteTime() - start);
+		mostSplits = Math::Max(mostSplits, Physics::Profile().splitIslands);
+
+		passed &= PhysicsTests::ValidateIslands();
+	}
+
+	I32 sleeping = PhysicsTests::SleepingCount(first, BodyCount);
+
+	Logger::Info("{} of {} split bodies asleep after {} steps, up to {} islands split in one step, slowest step {}s", sleeping, BodyCount, StepCount, mostSplits, slowestStep);
+
+	// The rows come apart together, so their islands have to be split in the same step rather than one per step
+	passed &= mostSplits > 1 && sleeping == BodyCount;
+
+	END_TEST(passed)
+}
+
+// Bullets are swept against the wall in parallel, none may end up on the far side
+void Physics_Bullets()
+{
+	BEGIN_TEST;
+
+	constexpr I32 BulletCount = 512;
+	constexpr U32 StepCount = 30;
+	constexpr Vector2 Wall = { -1500.0f, 0.0f };
+
+	I32 first = PhysicsTests::CreateBullets(Wall, BulletCount, 1000.0f);
+
+	F64 start = Time::AbsoluteTime();
+	PhysicsTests::Step(StepCount);
+	F64 elapsed = Time::AbsoluteTime() - start;
+
+	I32 tunneled = 0;
+	for (I32 i = first; i < first + BulletCount; ++i)
+	{
+		tunneled += PhysicsTests::BodyTransform(i).position.x > Wall.x;
+	}
+
+	Logger::Info("{} bullets, {} steps: {}s, {} tunneled", BulletCount, StepCount, elapsed, tunneled);
+
+	bool passed = tunneled == 0;
+
+	END_TEST(passed)
+}
+
+// Circles have to land on the chain, and a rebuilt chain has to reuse the destroyed chain's shapes
+void Physics_Chains()
+{
+	BEGIN_TEST;
+
+	constexpr I32 CircleCount = 64;
+	constexpr U32 StepCount = 120;
+	constexpr Vector2 Ground = { 1500.0f, 1500.0f };
+
+	I32 chainId;
+	I32 first = PhysicsTests::CreateChainGround(Ground, CircleCount, chainId);
+	RigidBody2D& ground = Physics::GetRigidBody(first - 1);
+
+	PhysicsTests::Step(StepCount);
+
+	I32 fallen = 0;
+	for (I32 i = first; i < first + CircleCount; ++i)
+	{
+		fallen += PhysicsTests::BodyTransform(i).position.y < Ground.y;
+	}
+
+	U64 shapeCount = PhysicsTests::ShapeCount();
+
+	F32 halfWidth = CircleCount * 0.5f + 5.0f;
+	Vector2 points[]{ { -halfWidth, -1.0f }, { halfWidth, -1.0f }, { halfWidth, 0.0f }, { -halfWidth, 0.0f } };
+
+	ground.DestroyChain(chainId);
+	chainId = ground.AddChain({}, points, (I32)CountOf(points), true);
+	PhysicsTests::Step(1);
+
+	Logger::Info("{} circles on a chain, {} fell through, {} shapes after rebuilding {}", CircleCount, fallen, PhysicsTests::ShapeCount(), shapeCount);
+
+	bool passed = fallen == 0 && chainId != 0 && PhysicsTests::ShapeCount() == shapeCount;
+
+	END_TEST(passed)
+}
+
+// A block, a ring and two tiles touching at a corner, every outline has to be a loop of merged runs with collision facing out
+void Physics_TilemapOutlines()
+{
+	BEGIN_TEST;
+
+	constexpr Vector2 TileSize = { 0.5f, 0.5f };
+
+	TilemapCollision collision;
+	collision.Create(16, 16);
+
+	for (I32 x = 2; x < 5; ++x) { for (I32 y = 2; y < 4; ++y) { collision.SetSolid(x, y, true); } }
+
+	for (I32 x = 8; x < 13; ++x)
+	{
+		for (I32 y = 8; y < 13; ++y) { collision.SetSolid(x, y, x == 8 || x == 12 || y == 8 || y == 12); }
+	}
+
+	collision.SetSolid(2, 10, true);
+	collision.SetSolid(3, 11, true);
+
+	collision.Enable({ -3000.0f, -1500.0f }, TileSize, {});
+
+	Vector<ChainSegment> segments;
+	PhysicsTests::TilemapSegments(collision, 0, segments);
+
+	bool facesOut = true;
+	for (const ChainSegment& chainSegment : segments)
+	{
+		facesOut &= PhysicsTests::TilemapSegmentFacesOut(collision, chainSegment, TileSize);
+	}
+
+	// Block 1 loop, ring 2 loops, corner tiles 2 loops, each loop is 4 runs
+	I32 chainCount = PhysicsTests::TilemapChainCount(collision, 0);
+
+	Logger::Info("{} chains, {} segments, facing out {}", chainCount, segments.Size(), facesOut);
+
+	bool passed = chainCount == 5 && segments.Size() == 20 && facesOut;
+
+	collision.Destroy();
+
+	END_TEST(passed)
+}
+
+// A wall crossing a chunk border is two open chains, where they meet each has to see the other's points as its ghosts
+void Physics_TilemapSeams()
+{
+	BEGIN_TEST;
+
+	constexpr Vector2 TileSize = { 1.0f, 1.0f };
+
+	TilemapCollision collision;
+	collision.Create(64, 4);
+
+	for (I32 x = 0; x < 64; ++x) { collision.SetSolid(x, 1, true); }
+
+	collision.Enable({ -3000.0f, -1600.0f }, TileSize, {});
+
+	Vector<ChainSegment> left;
+	Vector<ChainSegment> right;
+	PhysicsTests::TilemapSegments(collision, 0, left);
+	PhysicsTests::TilemapSegments(collision, 1, right);
+
+	I32 joins = 0;
+	bool smooth = true;
+
+	// Ghosts only give the direction the surface carries on in, they don't have to be the neighbor's far point
+	auto SameDirection = [](const Vector2& a, const Vector2& b) { return Math::IsZero(a.Cross(b)) && a.Dot(b) > 0.0f; };
+
+	auto Join = [&](const ChainSegment& a, const ChainSegment& b) {
+		if (!(a.segment.point2 == b.segment.point1)) { return; }
+
+		++joins;
+		smooth &= SameDirection(a.ghost2 - a.segment.point2, b.segment.point2 - b.segment.point1) &&
+			SameDirection(b.ghost1 - b.segment.point1, a.segment.point1 - a.segment.point2);
+	};
+
+	for (const ChainSegment& a : left) { for (const ChainSegment& b : right) { Join(a, b); Join(b, a); } }
+
+	Logger::Info("{} and {} segments either side of the seam, {} joins, smooth {}", left.Size(), right.Size(), joins, smooth);
+
+	bool passed = PhysicsTests::TilemapChainCount(collision, 0) == 1 && PhysicsTests::TilemapChainCount(collision, 1) == 1 &&
+		left.Size() == 3 && right.Size() == 3 && joins == 2 && smooth;
+
+	collision.Destroy();
+
+	END_TEST(passed)
+}
+
+// Changing a tile only rebuilds its chunk, the result has to match a full rebuild, and re-enabling reuses the body
+void Physics_TilemapRebuild()
+{
+	BEGIN_TEST;
+
+	constexpr I32 Side = 96;
+	constexpr I32 Center = Side / 2;
+	constexpr Vector2 TileSize = { 1.0f, 1.0f };
+	constexpr Vector2 Origin = { -3000.0f, -1700.0f };
+
+	TilemapCollision collision;
+	collision.Create(Side, Side);
+
+	for (I32 x = 0; x < Side; ++x) { for (I32 y = 0; y < Side; ++y) { collision.SetSolid(x, y, RandomF32() < 0.4f); } }
+	collision.SetSolid(Center, Center, false);
+
+	collision.Enable(Origin, TileSize, {});
+
+	I32 chunkCount = PhysicsTests::TilemapChunkCount(collision);
+	I32 centerChunk = chunkCount / 2;
+
+	Vector<Vector<U32>> before(chunkCount);
+	for (I32 i = 0; i < chunkCount; ++i) { PhysicsTests::TilemapChainRevisions(collision, i, before.Push({})); }
+
+	// Far enough from the chunk's border that none of its neighbors own an edge it changes
+	collision.SetSolid(Center, Center, true);
+
+	bool onlyCenter = true;
+	for (I32 i = 0; i < chunkCount; ++i)
+	{
+		Vector<U32> after;
+		PhysicsTests::TilemapChainRevisions(collision, i, after);
+
+		bool same = after.Size() == before[i].Size();
+		for (U64 j = 0; same && j < after.Size(); ++j) { same = after[j] == before[i][j]; }
+
+		onlyCenter &= same == (i != centerChunk);
+	}
+
+	// Setting a tile to what it already is doesn't rebuild anything
+	Vector<U32> centerBefore;
+	Vector<U32> centerAfter;
+	PhysicsTests::TilemapChainRevisions(collision, centerChunk, centerBefore);
+	collision.SetSolid(Center, Center, true);
+	PhysicsTests::TilemapChainRevisions(collision, centerChunk, centerAfter);
+
+	bool unchanged = centerBefore.Size() == centerAfter.Size();
+	for (U64 i = 0; unchanged && i < centerAfter.Size(); ++i) { unchanged = centerBefore[i] == centerAfter[i]; }
+
+	Vector<ChainSegment> incremental;
+	for (I32 i = 0; i < chunkCount; ++i) { PhysicsTests::TilemapSegments(collision, i, incremental); }
+
+	I32 bodyId = PhysicsTests::TilemapBody(collision);
+	U64 bodyCount = PhysicsTests::BodyCount();
+	U64 shapeCount = PhysicsTests::ShapeCount();
+
+	collision.Disable();
+	collision.Enable(Origin, TileSize, {});
+
+	Vector<ChainSegment> full;
+	for (I32 i = 0; i < chunkCount; ++i) { PhysicsTests::TilemapSegments(collision, i, full); }
+
+	bool matches = incremental.Size() == full.Size();
+	for (U64 i = 0; matches && i < full.Size(); ++i)
+	{
+		matches = incremental[i].segment.point1 == full[i].segment.point1 && incremental[i].segment.point2 == full[i].segment.point2 &&
+			incremental[i].ghost1 == full[i].ghost1 && incremental[i].ghost2 == full[i].ghost2;
+	}
+
+	bool reused = PhysicsTests::TilemapBody(collision) == bodyId && PhysicsTests::BodyCount() == bodyCount && PhysicsTests::ShapeCount() == shapeCount;
+
+	Logger::Info("{} segments, only the changed chunk rebuilt {}, unchanged tile skipped {}, matches a full rebuild {}, body reused {}",
+		full.Size(), onlyCenter, unchanged, matches, reused);
+
+	bool passed = onlyCenter && unchanged && matches && reused;
+
+	collision.Destroy();
+
+	END_TEST(passed)
+}
+
+// Every circle falls through the zone, each has to begin and end overlapping it exactly once
+void Physics_Sensors()
+{
+	BEGIN_TEST;
+
+	constexpr I32 CircleCount = 16;
+	constexpr U32 StepCount = 120;
+
+	U64 beginStart = PhysicsTests::SensorBeginCount();
+	U64 endStart = PhysicsTests::SensorEndCount();
+
+	PhysicsTests::CreateSensorZone({ -1500.0f, 1500.0f }, CircleCount);
+	PhysicsTests::Step(StepCount);
+
+	U64 begins = PhysicsTests::SensorBeginCount() - beginStart;
+	U64 ends = PhysicsTests::SensorEndCount() - endStart;
+
+	Logger::Info("{} circles through a sensor, {} begin events, {} end events", CircleCount, begins, ends);
+
+	bool passed = begins == (U64)CircleCount && ends == (U64)CircleCount;
+
+	END_TEST(passed)
+}
+
+// A static sensor with nothing near it skips its query, a body created inside it between steps still has to be seen
+void Physics_IdleSensors()
+{
+	BEGIN_TEST;
+
+	constexpr U32 IdleSteps = 10;
+	constexpr Vector2 Zone = { 3000.0f, 1500.0f };
+
+	PhysicsTests::CreateSensorZone(Zone, 0);
+	PhysicsTests::Step(IdleSteps);
+
+	U64 beginStart = PhysicsTests::SensorBeginCount();
+
+	RigidBody2DDef bodyDef{};
+	bodyDef.type = BODY_TYPE_DYNAMIC;
+	bodyDef.position = Zone;
+
+	I32 bodyId = Physics::CreateRigidBody(bodyDef);
+	Physics::GetRigidBody(bodyId).AddCollider(ShapeDef{}, Circle{ Vector2Zero, 0.25f });
+
+	PhysicsTests::Step(1);
+
+	bool passed = PhysicsTests::SensorBeginCount() - beginStart == 1;
+
+	END_TEST(passed)
+}
+
+// A resting pyramid mostly reuses its manifolds, where it ends up has to match running the narrowphase every step
+void Physics_ManifoldReuse()
+{
+	BEGIN_TEST;
+
+	constexpr I32 Rows = 20;
+	constexpr I32 BodyCount = Rows * (Rows + 1) / 2;
+	constexpr U32 StepCount = 120;
+
+	I32 first = PhysicsTests::CreatePyramid({ -1500.0f, 0.0f }, Rows);
+
+	Vector<U8> snapshot;
+	Physics::Snapshot(snapshot);
+
+	Vector2 positions[BodyCount];
+	F64 collideTimes[2] = {};
+	U32 reused[2] = {};
+
+	for (U32 run = 0; run < 2; ++run)
+	{
+		Physics::Restore(snapshot);
+		Physics::EnableManifoldReuse(run == 1);
+
+		for (U32 i = 0; i < StepCount; ++i)
+		{
+			PhysicsTests::Step(1);
+			collideTimes[run] += Physics::Profile().collide;
+			reused[run] += Physics::Profile().reusedManifolds;
+		}
+
+		if (run == 0)
+		{
+			for (I32 i = 0; i < BodyCount; ++i) { positions[i] = PhysicsTests::BodyTransform(first + i).position; }
+		}
+	}
+
+	F32 maxError = 0.0f;
+	for (I32 i = 0; i < BodyCount; ++i)
+	{
+		maxError = Math::Max(maxError, (PhysicsTests::BodyTransform(first + i).position - positions[i]).Magnitude());
+	}
+
+	Logger::Info("{} box pyramid, {} steps: narrowphase {}ms, reusing manifolds {}ms ({} reused), max position error {}", BodyCount, StepCount,
+		collideTimes[0], collideTimes[1], reused[1], maxError);
+
+	// Reuse has to have skipped the narrowphase, otherwise the positions matching proves nothing
+	bool passed = maxError < 0.01f && reused[0] == 0 && reused[1] > 0;
+
+	END_TEST(passed)
+}
+
+// Rendering sits between the last two steps, but a teleported body has nothing to interpolate from
+void Physics_Interpolation()
+{
+	BEGIN_TEST;
+
+	RigidBody2DDef bodyDef{};
+	bodyDef.type = BODY_TYPE_DYNAMIC;
+	bodyDef.position = { -3000.0f, 0.0f };
+
+	I32 bodyId = Physics::CreateRigidBody(bodyDef);
+	Physics::GetRigidBody(bodyId).AddCollider(ShapeDef{}, Circle{ Vector2Zero, 0.5f });
+
+	PhysicsTests::StepInterpolated(0.5f);
+	F32 before = PhysicsTests::BodyTransform(bodyId).position.y;
+
+	PhysicsTests::StepInterpolated(0.5f);
+	F32 after = PhysicsTests::BodyTransform(bodyId).position.y;
+	F32 interpolated = Physics::InterpolatedTransform(bodyId).position.y;
+
+	bool passed = after < before && Math::Abs(interpolated - (before + after) * 0.5f) < 0.0001f;
+
+	Physics::GetRigidBody(bodyId).SetTransform({ -3100.0f, 50.0f }, Quaternion2Identity);
+	Vector2 teleported = Physics::InterpolatedTransform(bodyId).position;
+
+	passed = passed && teleported.x == -3100.0f && teleported.y == 50.0f;
+
+	END_TEST(passed)
+}
+
+void Physics_Raycast1000000()
+{
+	BEGIN_TEST;
+
+	constexpr U32 RayCount = 1000000;
+	constexpr U32 VerifyCount = 100;
+	constexpr F32 RayLength = 20.0f;
+
+	bool passed = true;
+
+	for (U32 i = 0; i < VerifyCount; ++i)
+	{
+		Vector2 origin = { RandomF32() * ScatteredWorldSize, RandomF32() * ScatteredWorldSize };
+		Vector2 translation = RandomRay(RayLength);
+
+		RaycastResult tree = Physics::CastRayClosest(origin, translation);
+		RaycastResult reference = PhysicsTests::BruteForceRaycast(origin, translation);
+
+		passed = passed && tree.hit == reference.hit && (!tree.hit || Math::Abs(tree.fraction - reference.fraction) < 0.0001f);
+	}
+
+	U32 hitCount = 0;
+	F64 start = Time::AbsoluteTime();
+
+	for (U32 i = 0; i < RayCount; ++i)
+	{
+		Vector2 origin = { RandomF32() * ScatteredWorldSize, RandomF32() * ScatteredWorldSize };
+		Vector2 translation = RandomRay(RayLength);
+
+		hitCount += Physics::CastRayClosest(origin, translation).hit;
+	}
+
+	F64 elapsed = Time::AbsoluteTime() - start;
+
+	Logger::Info("{} rays against {} proxies: {}s, {} rays/s, {} hits", RayCount, ScatteredProxyCount, elapsed, RayCount / elapsed, hitCount);
+
+	passed = passed && hitCount > 0;
+
+	END_TEST(passed)
+}
+
+void Physics_RaycastBatch()
+{
+	BEGIN_TEST;
+
+	constexpr U32 RayCount = 262144;
+	constexpr F32 RayLength = 20.0f;
+
+	Vector<RaycastInput> rays(RayCount);
+	for (U32 i = 0; i < RayCount; ++i)
+	{
+		rays.Push({ { RandomF32() * ScatteredWorldSize, RandomF32() * ScatteredWorldSize }, RandomRay(RayLength), 1.0f });
+	}
+
+	Vector<RaycastResult> single(RayCount);
+
+	F64 start = Time::AbsoluteTime();
+	for (const RaycastInput& ray : rays) { single.Push(Physics::CastRayClosest(ray.origin, ray.translation)); }
+	F64 singleTime = Time::AbsoluteTime() - start;
+
+	Vector<RaycastResult> batch;
+
+	start = Time::AbsoluteTime();
+	Physics::CastRayBatch(rays.Data(), RayCount, DefaultQueryFilter, batch);
+	F64 batchTime = Time::AbsoluteTime() - start;
+
+	bool passed = batch.Size() == RayCount;
+
+	for (U32 i = 0; passed && i < RayCount; ++i)
+	{
+		passed = batch[i].hit == single[i].hit && (!batch[i].hit || Math::Abs(batch[i].fraction - single[i].fraction) < 0.0001f);
+	}
+
+	Logger::Info("{} rays, one at a time: {}s, batched: {}s, {}x", RayCount, singleTime, batchTime, singleTime / batchTime);
+
+	END_TEST(passed)
+}
+
+void Physics_QueryBatch()
+{
+	BEGIN_TEST;
+
+	constexpr U32 QueryCount = 262144;
+	constexpr U32 VerifyCount = 100;
+	constexpr F32 QuerySize = 10.0f;
+
+	Vector<AABB> boxes(QueryCount);
+	for (U32 i = 0; i < QueryCount; ++i)
+	{
+		Vector2 lower = { RandomF32() * ScatteredWorldSize, RandomF32() * ScatteredWorldSize };
+		boxes.Push({ lower, lower + Vector2{ QuerySize, QuerySize } });
+	}
+
+	QueryBatchResults results;
+
+	F64 start = Time::AbsoluteTime();
+	Physics::QueryBatch(boxes.Data(), QueryCount, DefaultQueryFilter, results);
+	F64 elapsed = Time::AbsoluteTime() - start;
+
+	bool passed = results.counts.Size() == QueryCount;
+
+	for (U32 i = 0; passed && i < VerifyCount; ++i)
+	{
+		passed = results.counts[i] == PhysicsTests::BruteForceOverlapCount(boxes[i]);
+	}
+
+	Logger::Info("{} box queries: {}s, {} hits", QueryCount, elapsed, results.shapeIds.Size());
+
+	END_TEST(passed)
+}
+
+// The scattered world is big enough that the top of the tree is split serially and the subtrees are built as jobs
+void Physics_RebuildStaticTree()
+{
+	BEGIN_TEST;
+
+	constexpr U32 QueryCount = 1024;
+	constexpr F32 QuerySize = 10.0f;
+
+	F64 start = Time::AbsoluteTime();
+	Physics::RebuildStaticTree();
+	F64 elapsed = Time::AbsoluteTime() - start;
+
+	Vector<AABB> boxes(QueryCount);
+	for (U32 i = 0; i < QueryCount; ++i)
+	{
+		Vector2 lower = { RandomF32() * ScatteredWorldSize, RandomF32() * ScatteredWorldSize };
+		boxes.Push({ lower, lower + Vector2{ QuerySize, QuerySize } });
+	}
+
+	QueryBatchResults results;
+	Physics::QueryBatch(boxes.Data(), QueryCount, DefaultQueryFilter, results);
+
+	bool passed = results.counts.Size() == QueryCount;
+
+	for (U32 i = 0; passed && i < QueryCount; ++i)
+	{
+		passed = results.counts[i] == PhysicsTests::BruteForceOverlapCount(boxes[i]);
+	}
+
+	Logger::Info("{} static proxies rebuilt: {}s", ScatteredProxyCount, elapsed);
+
+	END_TEST(passed)
+}
+#pragma endregion
+
 int main()
 {
 	Vector2 v;
@@ -146,6 +1556,48 @@ int main()
 
 	Vector_Push1000000();
 
+	Time_FrameLimiterDeviation();
+
+	Bitset_InPlaceUnion();
+
+	if (JobsTests::Initialize())
+	{
+		Jobs_IdleCpuUsage();
+		Jobs_WakeLatency();
+		Jobs_GraphCycle();
+		Jobs_TaskAwaitStarted();
+
+		if (PhysicsTests::Initialize())
+		{
+			PhysicsTests::CreateScatteredWorld();
+
+			Physics_Raycast1000000();
+			Physics_RaycastBatch();
+			Physics_QueryBatch();
+			Physics_RebuildStaticTree();
+			Physics_SimdLanes();
+			Physics_GatherScatter();
+			Physics_SolverPyramid();
+			Physics_SolverPairs();
+			Physics_SnapshotRestore();
+			Physics_Deterministic();
+			Physics_IslandSplitting();
+			Physics_Bullets();
+			Physics_Chains();
+			Physics_TilemapOutlines();
+			Physics_TilemapSeams();
+			Physics_TilemapRebuild();
+			Physics_Sensors();
+			Physics_IdleSensors();
+			Physics_ManifoldReuse();
+			Physics_Interpolation();
+
+			PhysicsTests::Shutdown();
+		}
+
+		JobsTests::Shutdown();
+	}
+
 	BreakPoint;
 }
 